@@ -13,25 +13,13 @@ if [ ! -d "$DATA_DIR" ]; then
     exit 1
 fi
 
-echo "Launching 5 domain analysis windows..."
+echo "Launching analyzer with 5 domain tabs..."
 echo ""
 
-# Launch each domain in background
-./build/bin/tensor-trace-analyzer "$DATA_DIR/domain-1-code" &
-sleep 0.5
-
-./build/bin/tensor-trace-analyzer "$DATA_DIR/domain-2-math" &
-sleep 0.5
-
-./build/bin/tensor-trace-analyzer "$DATA_DIR/domain-3-creative" &
-sleep 0.5
-
-./build/bin/tensor-trace-analyzer "$DATA_DIR/domain-4-factual" &
-sleep 0.5
-
-./build/bin/tensor-trace-analyzer "$DATA_DIR/domain-5-mixed" &
-
-echo "✓ Launched 5 windows"
-echo "Press Ctrl+C to close all windows"
-
-wait
+# One process: domains share the memory map and the loader pool
+./build/bin/tensor-trace-analyzer \
+    "$DATA_DIR/domain-1-code" \
+    "$DATA_DIR/domain-2-math" \
+    "$DATA_DIR/domain-3-creative" \
+    "$DATA_DIR/domain-4-factual" \
+    "$DATA_DIR/domain-5-mixed"
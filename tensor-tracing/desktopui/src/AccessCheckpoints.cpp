@@ -0,0 +1,68 @@
+#include "AccessCheckpoints.h"
+#include <algorithm>
+#include <cstring>
+
+AccessCheckpoints::AccessCheckpoints()
+    : store_(nullptr)
+    , tensor_count_(0)
+    , interval_(DEFAULT_INTERVAL)
+    , max_count_(0)
+{
+}
+
+void AccessCheckpoints::clear() {
+    store_ = nullptr;
+    tensor_count_ = 0;
+    snapshots_.clear();
+    time_prefix_max_.clear();
+    max_count_ = 0;
+}
+
+void AccessCheckpoints::build(const TraceStore& store, size_t tensor_count, size_t interval) {
+    clear();
+    store_ = &store;
+    tensor_count_ = tensor_count;
+    interval_ = std::max<size_t>(interval, 1);
+
+    const size_t entry_count = store.size();
+    const size_t last_snapshot = entry_count / interval_;
+
+    // Snapshot k, then advance the running counts by the entries up to snapshot k + 1
+    std::vector<uint32_t> counts(tensor_count_, 0);
+    snapshots_.reserve((last_snapshot + 1) * tensor_count_);
+    for (size_t k = 0; k <= last_snapshot; k++) {
+        snapshots_.insert(snapshots_.end(), counts.begin(), counts.end());
+        store.countAccesses(k * interval_, std::min((k + 1) * interval_, entry_count), counts);
+    }
+
+    for (uint32_t count : counts) {
+        max_count_ = std::max(max_count_, count);
+    }
+
+    const float* relative_ms = store.relativeMsColumn();
+    time_prefix_max_.resize(entry_count);
+    float running_max = 0.0f;
+    for (size_t i = 0; i < entry_count; i++) {
+        running_max = i == 0 ? relative_ms[i] : std::max(running_max, relative_ms[i]);
+        time_prefix_max_[i] = running_max;
+    }
+}
+
+size_t AccessCheckpoints::entryEndAt(float time_ms) const {
+    // First entry later than time_ms is the first point where the running max exceeds it
+    auto it = std::upper_bound(time_prefix_max_.begin(), time_prefix_max_.end(), time_ms);
+    return static_cast<size_t>(it - time_prefix_max_.begin());
+}
+
+void AccessCheckpoints::countsAt(size_t entry_end, std::vector<uint32_t>& counts) const {
+    counts.resize(tensor_count_);
+    if (!store_ || tensor_count_ == 0) {
+        std::fill(counts.begin(), counts.end(), 0);
+        return;
+    }
+
+    entry_end = std::min(entry_end, store_->size());
+    size_t k = entry_end / interval_;
+    std::memcpy(counts.data(), snapshots_.data() + k * tensor_count_, tensor_count_ * sizeof(uint32_t));
+    store_->countAccesses(k * interval_, entry_end, counts);
+}
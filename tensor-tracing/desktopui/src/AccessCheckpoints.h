@@ -0,0 +1,43 @@
+#pragma once
+
+#include "TraceStore.h"
+#include <cstdint>
+#include <vector>
+
+// Prefix snapshots of per-tensor access counts for one token
+//
+// Snapshot k holds the counts of entries [0, k * interval). Counts at any
+// point of the timeline are one copy of the nearest earlier snapshot plus
+// the accesses of at most interval - 1 entries, so scrubbing the timeline
+// no longer rescans the token from the start.
+class AccessCheckpoints {
+public:
+    static constexpr size_t DEFAULT_INTERVAL = 128;  // Entries between snapshots
+
+    AccessCheckpoints();
+
+    // Build snapshots for store (accesses must be resolved); tensor_count = MemoryMap size
+    void build(const TraceStore& store, size_t tensor_count, size_t interval = DEFAULT_INTERVAL);
+    void clear();
+
+    bool empty() const { return store_ == nullptr; }
+    size_t getSnapshotCount() const { return tensor_count_ ? snapshots_.size() / tensor_count_ : 0; }
+
+    // Number of leading entries at or before time_ms (same cut as a scan
+    // that stops at the first later entry, even if timestamps interleave)
+    size_t entryEndAt(float time_ms) const;
+
+    // counts = accesses of entries [0, entry_end)
+    void countsAt(size_t entry_end, std::vector<uint32_t>& counts) const;
+
+    // Highest per-tensor count over the whole token
+    uint32_t getMaxCount() const { return max_count_; }
+
+private:
+    const TraceStore* store_;
+    size_t tensor_count_;
+    size_t interval_;
+    std::vector<uint32_t> snapshots_;   // snapshot-major, tensor_count_ per snapshot
+    std::vector<float> time_prefix_max_; // Running max of relative_ms (monotonic, binary searchable)
+    uint32_t max_count_;
+};
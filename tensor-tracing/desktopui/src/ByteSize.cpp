@@ -0,0 +1,17 @@
+#include "ByteSize.h"
+#include <cstdlib>
+
+uint64_t parseBytes(const std::string& text) {
+    char* end = nullptr;
+    uint64_t value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str()) {
+        return 0;
+    }
+    switch (*end) {
+        case '\0': return value;
+        case 'K': case 'k': return value << 10;
+        case 'M': case 'm': return value << 20;
+        case 'G': case 'g': return value << 30;
+    }
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Command-line sizes: "256K", "1M", "4G", "4096" -> bytes (0 if malformed)
+uint64_t parseBytes(const std::string& text);
@@ -0,0 +1,303 @@
+#include "CachePolicy.h"
+#include <algorithm>
+
+const char* cachePolicyName(CachePolicyKind kind) {
+    switch (kind) {
+        case CachePolicyKind::LRU: return "LRU";
+        case CachePolicyKind::CLOCK: return "CLOCK";
+        case CachePolicyKind::ARC: return "ARC";
+        case CachePolicyKind::TwoQ: return "2Q";
+    }
+    return "";
+}
+
+bool cachePolicyFromName(const std::string& name, CachePolicyKind& out_kind) {
+    for (size_t i = 0; i < CACHE_POLICY_COUNT; i++) {
+        CachePolicyKind kind = static_cast<CachePolicyKind>(i);
+        if (name == cachePolicyName(kind)) {
+            out_kind = kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PageLists::reset(uint32_t page_count, size_t list_count) {
+    prev_.assign(page_count, NIL);
+    next_.assign(page_count, NIL);
+    where_.assign(page_count, NONE);
+    lists_.assign(list_count, List{NIL, NIL, 0});
+}
+
+void PageLists::pushFront(uint8_t list, uint32_t page) {
+    List& l = lists_[list];
+    prev_[page] = NIL;
+    next_[page] = l.head;
+    if (l.head != NIL) {
+        prev_[l.head] = page;
+    } else {
+        l.tail = page;
+    }
+    l.head = page;
+    l.size++;
+    where_[page] = list;
+}
+
+void PageLists::remove(uint32_t page) {
+    List& l = lists_[where_[page]];
+    uint32_t p = prev_[page];
+    uint32_t n = next_[page];
+    if (p != NIL) {
+        next_[p] = n;
+    } else {
+        l.head = n;
+    }
+    if (n != NIL) {
+        prev_[n] = p;
+    } else {
+        l.tail = p;
+    }
+    l.size--;
+    where_[page] = NONE;
+}
+
+uint32_t PageLists::popBack(uint8_t list) {
+    uint32_t page = lists_[list].tail;
+    if (page != NIL) {
+        remove(page);
+    }
+    return page;
+}
+
+namespace {
+// Runs call the concrete access() directly (no virtual dispatch per page)
+template <typename Derived>
+class CachePolicyBase : public CachePolicy {
+public:
+    uint32_t accessRun(uint32_t first_page, uint32_t count) override {
+        Derived& self = static_cast<Derived&>(*this);
+        uint32_t hits = 0;
+        for (uint32_t p = first_page; p < first_page + count; p++) {
+            hits += self.Derived::access(p) ? 1 : 0;
+        }
+        return hits;
+    }
+};
+
+// Least recently used: one list, evict the tail
+class LRUPolicy final : public CachePolicyBase<LRUPolicy> {
+public:
+    const char* name() const override { return "LRU"; }
+
+    void reset(uint32_t page_count, uint32_t capacity_pages) override {
+        capacity_ = std::max<uint32_t>(capacity_pages, 1);
+        lists_.reset(page_count, 1);
+    }
+
+    bool access(uint32_t page) override {
+        if (lists_.where(page) == 0) {
+            lists_.moveToFront(0, page);
+            return true;
+        }
+        if (lists_.size(0) >= capacity_) {
+            lists_.popBack(0);
+        }
+        lists_.pushFront(0, page);
+        return false;
+    }
+
+private:
+    uint32_t capacity_ = 1;
+    PageLists lists_;
+};
+
+// CLOCK (second chance): frames in a ring, a hit only sets the reference bit
+class ClockPolicy final : public CachePolicyBase<ClockPolicy> {
+public:
+    static constexpr uint32_t NO_FRAME = 0xFFFFFFFF;
+
+    const char* name() const override { return "CLOCK"; }
+
+    void reset(uint32_t page_count, uint32_t capacity_pages) override {
+        capacity_ = std::max<uint32_t>(capacity_pages, 1);
+        frame_of_.assign(page_count, NO_FRAME);
+        frames_.clear();
+        frames_.reserve(std::min(capacity_, page_count));
+        referenced_.clear();
+        hand_ = 0;
+    }
+
+    bool access(uint32_t page) override {
+        uint32_t frame = frame_of_[page];
+        if (frame != NO_FRAME) {
+            referenced_[frame] = 1;
+            return true;
+        }
+
+        if (frames_.size() < capacity_) {
+            frame_of_[page] = static_cast<uint32_t>(frames_.size());
+            frames_.push_back(page);
+            referenced_.push_back(0);
+            return false;
+        }
+
+        // Sweep clearing reference bits until an unreferenced frame comes up
+        while (referenced_[hand_]) {
+            referenced_[hand_] = 0;
+            hand_ = hand_ + 1 == frames_.size() ? 0 : hand_ + 1;
+        }
+        frame_of_[frames_[hand_]] = NO_FRAME;
+        frames_[hand_] = page;
+        frame_of_[page] = static_cast<uint32_t>(hand_);
+        hand_ = hand_ + 1 == frames_.size() ? 0 : hand_ + 1;
+        return false;
+    }
+
+private:
+    uint32_t capacity_ = 1;
+    std::vector<uint32_t> frame_of_;
+    std::vector<uint32_t> frames_;
+    std::vector<uint8_t> referenced_;
+    size_t hand_ = 0;
+};
+
+// ARC (Megiddo & Modha, FAST '03): recency list T1, frequency list T2 and
+// their ghost histories B1/B2 steer the target size p of T1
+class ARCPolicy final : public CachePolicyBase<ARCPolicy> {
+public:
+    const char* name() const override { return "ARC"; }
+
+    void reset(uint32_t page_count, uint32_t capacity_pages) override {
+        capacity_ = std::max<uint32_t>(capacity_pages, 1);
+        target_t1_ = 0;
+        lists_.reset(page_count, 4);
+    }
+
+    bool access(uint32_t page) override {
+        uint8_t list = lists_.where(page);
+        if (list == T1 || list == T2) {
+            lists_.moveToFront(T2, page);
+            return true;
+        }
+
+        const uint32_t b1 = lists_.size(B1);
+        const uint32_t b2 = lists_.size(B2);
+        if (list == B1) {
+            target_t1_ = std::min<uint32_t>(capacity_, target_t1_ + std::max<uint32_t>(b2 / b1, 1));
+            replace(false);
+            lists_.moveToFront(T2, page);
+            return false;
+        }
+        if (list == B2) {
+            uint32_t delta = std::max<uint32_t>(b1 / b2, 1);
+            target_t1_ = target_t1_ > delta ? target_t1_ - delta : 0;
+            replace(true);
+            lists_.moveToFront(T2, page);
+            return false;
+        }
+
+        // Not in cache or history
+        const uint32_t t1 = lists_.size(T1);
+        const uint32_t l1 = t1 + b1;
+        const uint32_t total = l1 + lists_.size(T2) + b2;
+        if (l1 == capacity_) {
+            if (t1 < capacity_) {
+                lists_.popBack(B1);
+                replace(false);
+            } else {
+                lists_.popBack(T1);
+            }
+        } else if (total >= capacity_) {
+            if (total >= 2 * capacity_) {
+                lists_.popBack(B2);
+            }
+            replace(false);
+        }
+        lists_.pushFront(T1, page);
+        return false;
+    }
+
+private:
+    enum : uint8_t { T1 = 0, T2 = 1, B1 = 2, B2 = 3 };
+
+    uint32_t capacity_ = 1;
+    uint32_t target_t1_ = 0;  // p
+    PageLists lists_;
+
+    // Evict one resident page into its ghost list
+    void replace(bool hit_in_b2) {
+        const uint32_t t1 = lists_.size(T1);
+        if (t1 > 0 && (t1 > target_t1_ || (hit_in_b2 && t1 == target_t1_) || lists_.size(T2) == 0)) {
+            lists_.pushFront(B1, lists_.popBack(T1));
+        } else if (lists_.size(T2) > 0) {
+            lists_.pushFront(B2, lists_.popBack(T2));
+        }
+    }
+};
+
+// Full 2Q (Johnson & Shasha, VLDB '94): new pages enter the A1in FIFO,
+// pages seen again after leaving it (A1out ghosts) are promoted to the Am LRU
+class TwoQPolicy final : public CachePolicyBase<TwoQPolicy> {
+public:
+    const char* name() const override { return "2Q"; }
+
+    void reset(uint32_t page_count, uint32_t capacity_pages) override {
+        capacity_ = std::max<uint32_t>(capacity_pages, 1);
+        k_in_ = std::max<uint32_t>(capacity_ / 4, 1);
+        k_out_ = std::max<uint32_t>(capacity_ / 2, 1);
+        lists_.reset(page_count, 3);
+    }
+
+    bool access(uint32_t page) override {
+        uint8_t list = lists_.where(page);
+        if (list == AM) {
+            lists_.moveToFront(AM, page);
+            return true;
+        }
+        if (list == A1_IN) {
+            return true;
+        }
+
+        // Leave the ghost list first so reclaiming cannot drop this page from it
+        if (list == A1_OUT) {
+            lists_.remove(page);
+        }
+        reclaim();
+        lists_.pushFront(list == A1_OUT ? AM : A1_IN, page);
+        return false;
+    }
+
+private:
+    enum : uint8_t { A1_IN = 0, A1_OUT = 1, AM = 2 };
+
+    uint32_t capacity_ = 1;
+    uint32_t k_in_ = 1;
+    uint32_t k_out_ = 1;
+    PageLists lists_;
+
+    // Free one resident slot if the cache is full
+    void reclaim() {
+        if (lists_.size(A1_IN) + lists_.size(AM) < capacity_) {
+            return;
+        }
+        if (lists_.size(A1_IN) > k_in_ || lists_.size(AM) == 0) {
+            lists_.pushFront(A1_OUT, lists_.popBack(A1_IN));
+            if (lists_.size(A1_OUT) > k_out_) {
+                lists_.popBack(A1_OUT);
+            }
+        } else {
+            lists_.popBack(AM);
+        }
+    }
+};
+}
+
+std::unique_ptr<CachePolicy> createCachePolicy(CachePolicyKind kind) {
+    switch (kind) {
+        case CachePolicyKind::LRU: return std::make_unique<LRUPolicy>();
+        case CachePolicyKind::CLOCK: return std::make_unique<ClockPolicy>();
+        case CachePolicyKind::ARC: return std::make_unique<ARCPolicy>();
+        case CachePolicyKind::TwoQ: return std::make_unique<TwoQPolicy>();
+    }
+    return nullptr;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Page cache replacement policies for the replay simulator
+enum class CachePolicyKind : uint8_t {
+    LRU = 0,
+    CLOCK = 1,
+    ARC = 2,
+    TwoQ = 3,
+};
+
+constexpr size_t CACHE_POLICY_COUNT = 4;
+
+const char* cachePolicyName(CachePolicyKind kind);
+bool cachePolicyFromName(const std::string& name, CachePolicyKind& out_kind);
+
+// One cache model over dense page ids [0, page_count)
+//
+// Implementations keep their per-page state in flat arrays sized by the file,
+// so a reference is a few array reads instead of a hash lookup. New policies
+// only need to implement reset() and access(), then be added to the factory.
+class CachePolicy {
+public:
+    virtual ~CachePolicy() = default;
+
+    virtual const char* name() const = 0;
+
+    // Empty cache holding at most capacity_pages pages (>= 1)
+    virtual void reset(uint32_t page_count, uint32_t capacity_pages) = 0;
+
+    // Reference one page; returns true on a hit (misses insert the page)
+    virtual bool access(uint32_t page) = 0;
+
+    // Reference count consecutive pages; returns the number of hits
+    virtual uint32_t accessRun(uint32_t first_page, uint32_t count) {
+        uint32_t hits = 0;
+        for (uint32_t p = first_page; p < first_page + count; p++) {
+            hits += access(p) ? 1 : 0;
+        }
+        return hits;
+    }
+};
+
+std::unique_ptr<CachePolicy> createCachePolicy(CachePolicyKind kind);
+
+// Page counters of one replay (whole run, one token or one layer)
+struct CacheSimStats {
+    uint64_t accesses = 0;
+    uint64_t hits = 0;
+    uint64_t cold_misses = 0;      // First touch of a page (any cache misses these)
+    uint64_t capacity_misses = 0;  // Evicted earlier, read again
+
+    uint64_t misses() const { return cold_misses + capacity_misses; }
+    double hitRatio() const { return accesses ? static_cast<double>(hits) / accesses : 0.0; }
+};
+
+// Intrusive doubly linked lists over page ids (MRU at head)
+// A page is on at most one list; where() tells which (NONE if none).
+class PageLists {
+public:
+    static constexpr uint32_t NIL = 0xFFFFFFFF;
+    static constexpr uint8_t NONE = 0xFF;
+
+    void reset(uint32_t page_count, size_t list_count);
+
+    uint8_t where(uint32_t page) const { return where_[page]; }
+    uint32_t size(uint8_t list) const { return lists_[list].size; }
+    uint32_t back(uint8_t list) const { return lists_[list].tail; }
+
+    void pushFront(uint8_t list, uint32_t page);
+    void remove(uint32_t page);
+    uint32_t popBack(uint8_t list);  // NIL if empty
+
+    void moveToFront(uint8_t list, uint32_t page) {
+        remove(page);
+        pushFront(list, page);
+    }
+
+private:
+    struct List {
+        uint32_t head;
+        uint32_t tail;
+        uint32_t size;
+    };
+
+    std::vector<uint32_t> prev_;
+    std::vector<uint32_t> next_;
+    std::vector<uint8_t> where_;
+    std::vector<List> lists_;
+};
@@ -0,0 +1,287 @@
+#include "CacheSimView.h"
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+constexpr double BYTES_PER_GB = 1024.0 * 1024.0 * 1024.0;
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+}
+
+CacheSimView::CacheSimView()
+    : curves_ready_(false)
+    , metric_(Metric::HitRatio)
+    , selected_budget_(0)
+    , selected_policy_(0)
+{
+}
+
+void CacheSimView::render(const DomainLoader& loader, ThreadPool& pool) {
+    if (!ImGui::CollapsingHeader("Page Cache Simulation")) {
+        return;
+    }
+
+    const bool running = simulation_ && simulation_->isRunning();
+    ImGui::BeginDisabled(running || !loader.isFinished() || !loader.isMemoryMapReady());
+    if (ImGui::Button(simulation_ ? "Re-run" : "Run")) {
+        if (!simulation_) {
+            simulation_ = std::make_unique<CacheSimulation>(pool);
+            simulation_->setProgressCallback(progress_callback_);
+        }
+        curves_ready_ = false;
+        simulation_->start(loader, CacheSimConfig());
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+
+    if (!simulation_) {
+        ImGui::TextWrapped("Replays every DISK access of this domain through LRU, CLOCK, ARC and 2Q "
+                           "page caches (4 KB pages) across RAM budgets up to the touched footprint, "
+                           "next to the Belady OPT lower bound.");
+        return;
+    }
+    if (running) {
+        ImGui::ProgressBar(simulation_->getProgress(), ImVec2(200, 0), "Simulating...");
+        return;
+    }
+
+    if (!curves_ready_) {
+        rebuildCurves();
+    }
+    if (budget_gb_.empty()) {
+        ImGui::Text("No DISK accesses to replay");
+        return;
+    }
+
+    const PageStream& stream = simulation_->getStream();
+    ImGui::Text("%zu page reads, %s touched of %s", stream.getAccessCount(),
+                formatSize(stream.getDistinctPageCount() * stream.getPageSize()).c_str(),
+                formatSize(static_cast<uint64_t>(stream.getPageCount()) * stream.getPageSize()).c_str());
+
+    int metric = static_cast<int>(metric_);
+    ImGui::RadioButton("Hit ratio", &metric, static_cast<int>(Metric::HitRatio));
+    ImGui::SameLine();
+    ImGui::RadioButton("SSD reads (GB)", &metric, static_cast<int>(Metric::ReadGB));
+    metric_ = static_cast<Metric>(metric);
+
+    renderCurves();
+    renderBudgetTable();
+
+    const CacheSimResult* result = findResult(selected_policy_, selected_budget_);
+    if (result) {
+        renderLayerTable(*result);
+        renderTokenGraph(*result);
+    }
+}
+
+void CacheSimView::rebuildCurves() {
+    budget_gb_.clear();
+    curves_.clear();
+    curves_ready_ = true;
+
+    const CacheSimConfig& config = simulation_->getConfig();
+    for (uint64_t budget : config.budgets_bytes) {
+        budget_gb_.push_back(budget / BYTES_PER_GB);
+    }
+
+    for (size_t p = 0; p < config.policies.size(); p++) {
+        Curve curve;
+        curve.label = cachePolicyName(config.policies[p]);
+        for (size_t b = 0; b < budget_gb_.size(); b++) {
+            const CacheSimResult* result = findResult(p, b);
+            curve.hit_ratio.push_back(result ? result->total.hitRatio() : 0.0);
+            curve.read_gb.push_back(result ? result->bytesRead(config.page_size) / BYTES_PER_GB : 0.0);
+        }
+        curves_.push_back(std::move(curve));
+    }
+
+    // Belady MIN lower bound at the same budgets (drawn after the policies)
+    const OptimalCurve& optimal = simulation_->getOptimal();
+    if (!optimal.empty()) {
+        Curve curve;
+        curve.label = "OPT";
+        for (uint64_t budget : config.budgets_bytes) {
+            CacheSimStats stats = optimal.getStats(std::max<uint64_t>(budget / config.page_size, 1));
+            curve.hit_ratio.push_back(stats.hitRatio());
+            curve.read_gb.push_back(stats.misses() * config.page_size / BYTES_PER_GB);
+        }
+        curves_.push_back(std::move(curve));
+    }
+
+    selected_budget_ = std::min(selected_budget_, static_cast<int>(budget_gb_.size()) - 1);
+    selected_budget_ = std::max(selected_budget_, 0);
+    selected_policy_ = std::min(selected_policy_, std::max(static_cast<int>(config.policies.size()) - 1, 0));
+}
+
+void CacheSimView::renderCurves() {
+    if (ImPlot::BeginPlot("##cache_curves", ImVec2(-1, 260))) {
+        ImPlot::SetupAxis(ImAxis_X1, "RAM Budget (GB)", ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y1, metric_ == Metric::HitRatio ? "Hit Ratio" : "Read from SSD (GB)",
+                          ImPlotAxisFlags_AutoFit);
+
+        for (size_t c = 0; c < curves_.size(); c++) {
+            const Curve& curve = curves_[c];
+            const std::vector<double>& ys = metric_ == Metric::HitRatio ? curve.hit_ratio : curve.read_gb;
+            if (c < simulation_->getConfig().policies.size()) {
+                ImPlot::SetNextMarkerStyle(ImPlotMarker_Circle, 2.5f);
+            } else {
+                ImPlot::SetNextLineStyle(ImVec4(1.0f, 1.0f, 1.0f, 1.0f), 2.0f);  // OPT bound
+            }
+            ImPlot::PlotLine(curve.label.c_str(), budget_gb_.data(), ys.data(), static_cast<int>(ys.size()));
+        }
+
+        // Selected budget
+        double selected = budget_gb_[selected_budget_];
+        ImPlot::PlotInfLines("##selected_budget", &selected, 1);
+
+        ImPlot::EndPlot();
+    }
+
+    ImGui::PushItemWidth(300);
+    char label[64];
+    snprintf(label, sizeof(label), "%s", formatSize(simulation_->getConfig().budgets_bytes[selected_budget_]).c_str());
+    ImGui::SliderInt("Budget", &selected_budget_, 0, static_cast<int>(budget_gb_.size()) - 1, label);
+    ImGui::PopItemWidth();
+}
+
+void CacheSimView::renderBudgetTable() {
+    const size_t page_size = simulation_->getConfig().page_size;
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+
+    if (ImGui::BeginTable("cache_policies", 5, flags)) {
+        ImGui::TableSetupColumn("Policy", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableSetupColumn("Hit Ratio", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Read from SSD", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Cold Misses", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Capacity Misses", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (size_t p = 0; p < curves_.size(); p++) {
+            // Policy rows are selectable for the detail below; OPT has totals only
+            CacheSimStats stats;
+            const CacheSimResult* result = findResult(p, selected_budget_);
+            if (result) {
+                stats = result->total;
+            } else if (p == simulation_->getConfig().policies.size()) {
+                uint64_t budget = simulation_->getConfig().budgets_bytes[selected_budget_];
+                stats = simulation_->getOptimal().getStats(std::max<uint64_t>(budget / page_size, 1));
+            } else {
+                continue;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (result) {
+                if (ImGui::Selectable(curves_[p].label.c_str(), selected_policy_ == static_cast<int>(p),
+                                      ImGuiSelectableFlags_SpanAllColumns)) {
+                    selected_policy_ = static_cast<int>(p);
+                }
+            } else {
+                ImGui::TextUnformatted(curves_[p].label.c_str());
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", stats.hitRatio() * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatSize(stats.misses() * page_size).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.cold_misses));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.capacity_misses));
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+void CacheSimView::renderLayerTable(const CacheSimResult& result) {
+    if (!ImGui::TreeNode("Per layer")) {
+        return;
+    }
+
+    const size_t page_size = simulation_->getConfig().page_size;
+    ImGuiTableFlags flags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg |
+                            ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+
+    if (ImGui::BeginTable("cache_layers", 5, flags, ImVec2(0.0f, 200.0f))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Layer", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Hit Ratio", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Read from SSD", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Cold Misses", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Capacity Misses", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (size_t slot = 0; slot < result.per_layer.size(); slot++) {
+            const CacheSimStats& stats = result.per_layer[slot];
+            if (stats.accesses == 0) {
+                continue;
+            }
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", PageStream::layerSlotName(slot).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", stats.hitRatio() * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatSize(stats.misses() * page_size).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.cold_misses));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.capacity_misses));
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::TreePop();
+}
+
+void CacheSimView::renderTokenGraph(const CacheSimResult& result) {
+    if (!ImGui::TreeNode("Per token")) {
+        return;
+    }
+
+    // Cold vs capacity reads per token, stacked
+    const double page_mb = simulation_->getConfig().page_size / BYTES_PER_MB;
+    std::vector<double> cold(result.per_token.size());
+    std::vector<double> total(result.per_token.size());
+    for (size_t t = 0; t < result.per_token.size(); t++) {
+        cold[t] = result.per_token[t].cold_misses * page_mb;
+        total[t] = result.per_token[t].misses() * page_mb;
+    }
+
+    if (ImPlot::BeginPlot("##cache_tokens", ImVec2(-1, 200))) {
+        ImPlot::SetupAxis(ImAxis_X1, "Token", ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y1, "Read from SSD (MB)", ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotBars("Capacity", total.data(), static_cast<int>(total.size()), 0.8);
+        ImPlot::PlotBars("Cold", cold.data(), static_cast<int>(cold.size()), 0.8);
+        ImPlot::EndPlot();
+    }
+
+    ImGui::TreePop();
+}
+
+const CacheSimResult* CacheSimView::findResult(size_t policy, size_t budget) const {
+    // Results are policy-major: one run per budget for each policy in turn
+    const std::vector<CacheSimResult>& results = simulation_->getResults();
+    size_t budgets = simulation_->getConfig().budgets_bytes.size();
+    size_t index = policy * budgets + budget;
+    return budget < budgets && index < results.size() ? &results[index] : nullptr;
+}
+
+std::string CacheSimView::formatSize(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    int unit_index = 0;
+    double size = static_cast<double>(bytes);
+
+    while (size >= 1024.0 && unit_index < 3) {
+        size /= 1024.0;
+        unit_index++;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[unit_index];
+    return oss.str();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "CacheSimulation.h"
+#include "DomainLoader.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Page cache simulation panel for one domain
+//
+// Runs a CacheSimulation on demand and plots hit ratio / SSD reads against
+// the RAM budget (one line per policy plus the OPT bound), with per-policy,
+// per-layer and per-token detail for a selected budget.
+class CacheSimView {
+public:
+    CacheSimView();
+
+    // Called from pool workers while a run progresses (e.g. to wake the UI)
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Loader must be finished before Run is enabled; pool runs the replays
+    void render(const DomainLoader& loader, ThreadPool& pool);
+
+private:
+    enum class Metric { HitRatio = 0, ReadGB = 1 };
+
+    std::unique_ptr<CacheSimulation> simulation_;
+    std::function<void()> progress_callback_;
+
+    // Plot series, rebuilt once per finished run (one per policy, then OPT)
+    struct Curve {
+        std::string label;
+        std::vector<double> hit_ratio;
+        std::vector<double> read_gb;
+    };
+    std::vector<double> budget_gb_;
+    std::vector<Curve> curves_;
+    bool curves_ready_;
+
+    Metric metric_;
+    int selected_budget_;
+    int selected_policy_;
+
+    void rebuildCurves();
+    void renderCurves();
+    void renderBudgetTable();
+    void renderLayerTable(const CacheSimResult& result);
+    void renderTokenGraph(const CacheSimResult& result);
+
+    const CacheSimResult* findResult(size_t policy, size_t budget) const;
+
+    static std::string formatSize(uint64_t bytes);
+};
@@ -0,0 +1,130 @@
+#include "CacheSimulation.h"
+#include <algorithm>
+#include <iostream>
+
+CacheSimulation::CacheSimulation(ThreadPool& pool)
+    : tasks_(pool)
+    , started_(false)
+    , total_runs_(0)
+    , completed_(0)
+    , finished_(false)
+{
+    tasks_.setCompletionCallback([this] { finishRun(); });
+}
+
+CacheSimulation::~CacheSimulation() {
+    wait();
+}
+
+void CacheSimulation::start(const DomainLoader& loader, const CacheSimConfig& config) {
+    wait();
+    config_ = config;
+    stream_.clear();
+    results_.clear();
+    optimal_.clear();
+    started_ = true;
+    total_runs_ = 0;
+    completed_ = 0;
+    finished_.store(false, std::memory_order_release);
+
+    // The stream build queues one task per budget into the same group
+    tasks_.submit([this, &loader] { runBudgets(loader); });
+}
+
+void CacheSimulation::wait() {
+    tasks_.wait();
+}
+
+float CacheSimulation::getProgress() const {
+    if (isFinished()) {
+        return 1.0f;
+    }
+    size_t total = total_runs_.load(std::memory_order_relaxed);
+    return total ? static_cast<float>(completed_.load(std::memory_order_relaxed)) / total : 0.0f;
+}
+
+void CacheSimulation::runBudgets(const DomainLoader& loader) {
+    if (!stream_.build(loader, config_.page_size)) {
+        std::cerr << "Cache simulation: " << stream_.getLastError() << std::endl;
+        return;
+    }
+
+    // Default budgets: even steps up to the pages the trace ever touches
+    if (config_.budgets_bytes.empty()) {
+        uint64_t footprint = stream_.getDistinctPageCount() * config_.page_size;
+        for (size_t i = 1; i <= CacheSimConfig::DEFAULT_BUDGET_COUNT; i++) {
+            config_.budgets_bytes.push_back(footprint * i / CacheSimConfig::DEFAULT_BUDGET_COUNT);
+        }
+    }
+
+    // Slots are sized before any task runs, tasks only fill their own
+    for (CachePolicyKind policy : config_.policies) {
+        for (uint64_t budget : config_.budgets_bytes) {
+            CacheSimResult result;
+            result.policy = policy;
+            result.budget_bytes = budget;
+            uint64_t pages = std::max<uint64_t>(budget / config_.page_size, 1);
+            result.capacity_pages = static_cast<uint32_t>(std::min<uint64_t>(pages, UINT32_MAX));
+            results_.push_back(std::move(result));
+        }
+    }
+
+    const size_t runs = results_.size() + (config_.optimal ? 1 : 0);
+    total_runs_.store(runs, std::memory_order_relaxed);
+    if (config_.optimal) {
+        tasks_.submit([this] {
+            if (!optimal_.build(stream_) && !ThreadPool::isTaskCancelled()) {
+                std::cerr << "Cache simulation: " << optimal_.getLastError() << std::endl;
+            }
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            notifyProgress();
+        });
+    }
+    for (size_t r = 0; r < results_.size(); r++) {
+        tasks_.submit([this, r] {
+            // Policies size their state by the page count, so skip even that at shutdown
+            if (!ThreadPool::isTaskCancelled()) {
+                std::unique_ptr<CachePolicy> policy = createCachePolicy(results_[r].policy);
+                replay(stream_, *policy, results_[r].capacity_pages, results_[r]);
+            }
+            completed_.fetch_add(1, std::memory_order_relaxed);
+            notifyProgress();
+        });
+    }
+}
+
+void CacheSimulation::replay(const PageStream& stream, CachePolicy& policy, uint32_t capacity_pages, CacheSimResult& out) {
+    out.total = CacheSimStats();
+    out.per_token.assign(stream.getTokenCount(), CacheSimStats());
+    out.per_layer.assign(stream.getLayerSlotCount(), CacheSimStats());
+    policy.reset(stream.getPageCount(), capacity_pages);
+
+    for (const PageExtent& extent : stream.getExtents()) {
+        // Replays of long traces take seconds; give up at shutdown
+        if (ThreadPool::isTaskCancelled()) {
+            return;
+        }
+        uint32_t hits = policy.accessRun(extent.first_page, extent.page_count);
+        uint32_t misses = extent.page_count - hits;
+        uint32_t capacity_misses = misses - std::min(misses, extent.cold_pages);
+
+        for (CacheSimStats* stats : {&out.total, &out.per_token[extent.token], &out.per_layer[extent.layer_slot]}) {
+            stats->accesses += extent.page_count;
+            stats->hits += hits;
+            stats->cold_misses += misses - capacity_misses;
+            stats->capacity_misses += capacity_misses;
+        }
+    }
+}
+
+void CacheSimulation::finishRun() {
+    // Runs on the worker that finished the last task, before wait() returns
+    finished_.store(true, std::memory_order_release);
+    notifyProgress();
+}
+
+void CacheSimulation::notifyProgress() {
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "CachePolicy.h"
+#include "DomainLoader.h"
+#include "OptimalCurve.h"
+#include "PageStream.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// One (policy, budget) replay
+struct CacheSimResult {
+    CachePolicyKind policy;
+    uint64_t budget_bytes;
+    uint32_t capacity_pages;
+    CacheSimStats total;
+    std::vector<CacheSimStats> per_token;   // Indexed by token
+    std::vector<CacheSimStats> per_layer;   // Indexed by PageStream layer slot
+
+    uint64_t bytesRead(size_t page_size) const { return total.misses() * page_size; }
+};
+
+struct CacheSimConfig {
+    size_t page_size = PageStream::DEFAULT_PAGE_SIZE;
+    std::vector<CachePolicyKind> policies = {CachePolicyKind::LRU, CachePolicyKind::CLOCK,
+                                             CachePolicyKind::ARC, CachePolicyKind::TwoQ};
+    std::vector<uint64_t> budgets_bytes;    // Empty = DEFAULT_BUDGET_COUNT steps up to the footprint
+    bool optimal = true;                    // Also compute the Belady MIN curve
+
+    static constexpr size_t DEFAULT_BUDGET_COUNT = 24;
+};
+
+// Replays a domain's DISK accesses through page cache models
+//
+// start() builds the PageStream on the pool and then replays every
+// (policy, budget) pair as its own task, so budgets run in parallel. The
+// OPT curve (all budgets in one pass) runs as one more task next to them.
+// Results are published once isFinished() returns true.
+class CacheSimulation {
+public:
+    explicit CacheSimulation(ThreadPool& pool);
+    ~CacheSimulation();
+
+    CacheSimulation(const CacheSimulation&) = delete;
+    CacheSimulation& operator=(const CacheSimulation&) = delete;
+
+    // Loader must be finished and outlive the run (returns immediately)
+    void start(const DomainLoader& loader, const CacheSimConfig& config);
+
+    // Called from pool workers after each finished replay (e.g. to wake the UI)
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Block until the current run has completed
+    void wait();
+
+    bool isRunning() const { return started_ && !isFinished(); }
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+    float getProgress() const;
+
+    // Valid once isFinished()
+    const PageStream& getStream() const { return stream_; }
+    const CacheSimConfig& getConfig() const { return config_; }
+    const std::vector<CacheSimResult>& getResults() const { return results_; }
+    const OptimalCurve& getOptimal() const { return optimal_; }   // Empty unless config.optimal
+
+    // Replay stream through policy with capacity_pages (used by the tasks, callable directly)
+    static void replay(const PageStream& stream, CachePolicy& policy, uint32_t capacity_pages, CacheSimResult& out);
+
+private:
+    TaskGroup tasks_;
+    CacheSimConfig config_;
+    PageStream stream_;
+    std::vector<CacheSimResult> results_;
+    OptimalCurve optimal_;
+    std::function<void()> progress_callback_;
+
+    bool started_;
+    std::atomic<size_t> total_runs_;    // Published once results_ is sized
+    std::atomic<size_t> completed_;
+    std::atomic<bool> finished_;
+
+    void runBudgets(const DomainLoader& loader);
+    void finishRun();
+    void notifyProgress();
+};
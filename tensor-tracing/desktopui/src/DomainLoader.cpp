@@ -0,0 +1,261 @@
+#include "DomainLoader.h"
+#include "JSONLoader.h"
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <sys/stat.h>
+
+namespace {
+std::string tokenJsonPath(const std::string& domain_path, size_t token_index) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/traces/token-%05zu.json", domain_path.c_str(), token_index);
+    return path;
+}
+
+bool fileExists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+}
+
+DomainLoader::DomainLoader(ThreadPool& pool, MemoryMapCache& memory_maps, std::shared_ptr<TraceSymbols> symbols)
+    : pool_(pool)
+    , tasks_(pool)
+    , memory_maps_(memory_maps)
+    , memory_map_state_(SLOT_PENDING)
+    , symbols_(symbols ? std::move(symbols) : std::make_shared<TraceSymbols>())
+    , token_count_(0)
+    , loaded_count_(0)
+    , failed_count_(0)
+    , setup_remaining_(0)
+    , finished_(false)
+    , max_accumulated_count_(0)
+{
+    tasks_.setCompletionCallback([this] { finishLoad(); });
+}
+
+DomainLoader::~DomainLoader() {
+    wait();
+}
+
+void DomainLoader::start(const std::string& domain_path) {
+    domain_path_ = domain_path;
+    setup_remaining_ = 2;
+
+    std::cout << "Loading domain data from: " << domain_path_ << std::endl;
+
+    // memory-map.json from parse_csv.py, or the model file's own header
+    std::string memory_map_path = model_path_;
+    if (memory_map_path.empty()) {
+        memory_map_path = domain_path_ + "/memory-map.json";
+        if (!fileExists(memory_map_path) && fileExists(domain_path_ + "/model.gguf")) {
+            memory_map_path = domain_path_ + "/model.gguf";
+        }
+    }
+
+    // Both setup tasks are counted up front, so the domain cannot finish between them
+    tasks_.submit(2, [this, memory_map_path](size_t task) {
+        if (task == 0) {
+            loadMemoryMap(memory_map_path);
+        } else {
+            planTokens();
+        }
+    });
+}
+
+void DomainLoader::wait() {
+    tasks_.wait();
+}
+
+float DomainLoader::getProgress() const {
+    size_t count = getTokenCount();
+    if (count == 0) {
+        return isFinished() ? 1.0f : 0.0f;
+    }
+    return static_cast<float>(getLoadedCount() + getFailedCount()) / static_cast<float>(count);
+}
+
+void DomainLoader::loadMemoryMap(const std::string& memory_map_path) {
+    // Identical maps of sibling domains are parsed and indexed only once
+    memory_map_ = memory_maps_.acquire(memory_map_path);
+    if (memory_map_->ok) {
+        memory_map_state_.store(SLOT_READY, std::memory_order_release);
+    } else {
+        std::cerr << "Failed to load memory map: " << memory_map_->error << std::endl;
+        memory_map_state_.store(SLOT_FAILED, std::memory_order_release);
+    }
+    notifyProgress();
+    finishSetup();
+}
+
+void DomainLoader::planTokens() {
+    // Prefer the raw binary trace (no JSON conversion step needed),
+    // fall back to per-token JSON files from parse_trace.py --export-json
+    TraceSourceFile source_file;
+    if (TraceCache::statSourceFile(domain_path_, "tensor_trace.bin", source_file)) {
+        source_files_.push_back(source_file);
+    } else {
+        char relative_path[64];
+        for (size_t i = 0; i < 100000; i++) {
+            snprintf(relative_path, sizeof(relative_path), "traces/token-%05zu.json", i);
+            if (!TraceCache::statSourceFile(domain_path_, relative_path, source_file)) {
+                break;
+            }
+            source_files_.push_back(source_file);
+        }
+    }
+
+    // Columnar cache from a previous launch skips parsing entirely
+    size_t count = 0;
+    if (trace_cache_.open(TraceCache::getCachePath(domain_path_), source_files_)) {
+        trace_cache_.internSymbols(*symbols_);
+        count = trace_cache_.getTokenCount();
+    } else if (fileExists(TraceCache::getCachePath(domain_path_))) {
+        std::cout << "Ignoring trace cache: " << trace_cache_.getLastError() << std::endl;
+    }
+
+    if (!trace_cache_.isOpen()) {
+        bool is_binary = !source_files_.empty() && source_files_.front().path == "tensor_trace.bin";
+        if (is_binary && trace_file_.open(domain_path_ + "/" + source_files_.front().path)) {
+            // Decode the mapped records straight into the cache and attach to it,
+            // so tokens are never materialized; build them one by one only if that fails
+            if (!trace_file_.getTokenRanges().empty() && convertTraceFile()) {
+                count = trace_cache_.getTokenCount();
+            } else {
+                count = trace_file_.getTokenRanges().size();
+            }
+        } else if (!is_binary) {
+            count = source_files_.size();
+        }
+    }
+
+    // Page cache residency recorded alongside the trace, if any
+    std::string residency_path = domain_path_ + "/" + RESIDENCY_FILE_NAME;
+    if (fileExists(residency_path)) {
+        if (residency_.load(residency_path)) {
+            std::cout << "✓ Page residency: " << residency_.getRecordCount() << " samples with changes" << std::endl;
+        } else {
+            std::cerr << "Warning: " << residency_.getLastError() << std::endl;
+        }
+    }
+
+    std::cout << "Loading " << count << " token traces on " << pool_.getThreadCount() << " threads..." << std::endl;
+
+    tokens_.resize(count);
+    token_states_.reset(new std::atomic<uint8_t>[count]);
+    for (size_t i = 0; i < count; i++) {
+        tokens_[i].entries.setSymbols(symbols_);
+        token_states_[i].store(SLOT_PENDING, std::memory_order_relaxed);
+    }
+
+    token_count_.store(count, std::memory_order_release);
+
+    finishSetup();
+}
+
+bool DomainLoader::convertTraceFile() {
+    const std::string cache_path = TraceCache::getCachePath(domain_path_);
+    TraceCache writer;
+    if (!writer.write(cache_path, source_files_, trace_file_)) {
+        std::cerr << "Warning: " << writer.getLastError() << std::endl;
+        return false;
+    }
+    if (!trace_cache_.open(cache_path, source_files_)) {
+        std::cerr << "Warning: " << trace_cache_.getLastError() << std::endl;
+        return false;
+    }
+    trace_cache_.internSymbols(*symbols_);
+    trace_file_.close();
+    return true;
+}
+
+void DomainLoader::finishSetup() {
+    if (setup_remaining_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // Both the tensor index and the token plan are in place
+    tasks_.submit(getTokenCount(), [this](size_t index) { loadToken(index); });
+}
+
+void DomainLoader::loadToken(size_t index) {
+    bool ok = true;
+    if (pool_.isCancelled()) {
+        ok = false;  // Shutting down: skip the remaining tokens
+    } else if (trace_cache_.isOpen()) {
+        trace_cache_.attachTraceData(index, tokens_[index]);
+    } else if (trace_file_.isOpen()) {
+        trace_file_.buildTraceData(trace_file_.getTokenRanges()[index], tokens_[index]);
+    } else {
+        ok = JSONLoader::loadTraceData(tokenJsonPath(domain_path_, index), tokens_[index]);
+        if (!ok) {
+            std::cerr << "Warning: Failed to load token " << index << ": " << JSONLoader::getLastError() << std::endl;
+        }
+    }
+
+    // Accesses depend on the memory map, so they are resolved here rather than cached
+    if (ok && isMemoryMapReady()) {
+        tokens_[index].entries.resolveAccesses(memory_map_->index);
+    }
+
+    token_states_[index].store(ok ? SLOT_READY : SLOT_FAILED, std::memory_order_release);
+    (ok ? loaded_count_ : failed_count_).fetch_add(1, std::memory_order_relaxed);
+    notifyProgress();
+}
+
+void DomainLoader::finishLoad() {
+    // Runs on the worker that finished the last task, before wait() returns
+    if (pool_.isCancelled()) {
+        trace_file_.close();
+        finished_.store(true, std::memory_order_release);
+        notifyProgress();
+        return;
+    }
+
+    // Persist a columnar cache after the first complete parse (binary traces
+    // that are still open here already failed to convert in planTokens())
+    if (!trace_cache_.isOpen() && !trace_file_.isOpen() && !tokens_.empty() && getFailedCount() == 0) {
+        TraceCache writer;
+        if (!writer.write(TraceCache::getCachePath(domain_path_), source_files_, tokens_)) {
+            std::cerr << "Warning: " << writer.getLastError() << std::endl;
+        }
+    }
+
+    // Parsed tokens own their entries; cached ones stay attached to the mapping
+    trace_file_.close();
+
+    // Domain-wide aggregates on this worker, so domains sum in parallel
+    computeAccumulatedCounts();
+    expert_routing_.build(*this);
+    finished_.store(true, std::memory_order_release);
+    std::cout << "✓ Loaded " << getLoadedCount() << " tokens from " << domain_path_ << std::endl;
+    std::cout << "  Symbols: " << symbols_->getStringCount() << " strings, "
+              << symbols_->getSourceCount() << " distinct source tensors" << std::endl;
+    notifyProgress();
+}
+
+void DomainLoader::computeAccumulatedCounts() {
+    accumulated_counts_.clear();
+    max_accumulated_count_ = 0;
+    if (!isMemoryMapReady()) {
+        return;
+    }
+
+    accumulated_counts_.assign(memory_map_->map.tensors.size(), 0);
+    for (size_t i = 0; i < getTokenCount(); i++) {
+        if (isTokenReady(i)) {
+            const TraceStore& store = tokens_[i].entries;
+            store.countAccesses(store.size(), accumulated_counts_);
+        }
+    }
+
+    for (uint32_t count : accumulated_counts_) {
+        max_accumulated_count_ = std::max(max_accumulated_count_, count);
+    }
+}
+
+void DomainLoader::notifyProgress() {
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "ExpertRouting.h"
+#include "MemoryMap.h"
+#include "MemoryMapCache.h"
+#include "PageResidency.h"
+#include "TensorIndex.h"
+#include "TraceData.h"
+#include "TraceFile.h"
+#include "TraceCache.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Loads one domain directory (memory map + per-token traces) in the background
+// Tokens become visible one by one as workers finish decoding them. Decoding
+// starts once the memory map is indexed so every token is published with its
+// DISK accesses already resolved to tensor indices. The memory map comes from
+// a MemoryMapCache and strings are interned into a caller-provided symbol
+// table, so domains of one workspace share both.
+class DomainLoader {
+public:
+    DomainLoader(ThreadPool& pool, MemoryMapCache& memory_maps, std::shared_ptr<TraceSymbols> symbols);
+    ~DomainLoader();
+
+    // Queue loading of <domain_path>/memory-map.json and its traces (returns immediately)
+    // Without memory-map.json the map is read from <domain_path>/model.gguf
+    void start(const std::string& domain_path);
+
+    // Read the memory map from this GGUF model file (or memory-map JSON) instead; set before start()
+    void setModelPath(const std::string& model_path) { model_path_ = model_path; }
+
+    // Called from worker threads whenever something new is published (memory
+    // map, a token, completion); set before start()
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Block until this domain's queued loads have completed (other pool work is not waited on)
+    void wait();
+
+    // Memory map (valid once isMemoryMapReady() returns true)
+    bool isMemoryMapReady() const { return memory_map_state_.load(std::memory_order_acquire) == SLOT_READY; }
+    bool hasMemoryMapFailed() const { return memory_map_state_.load(std::memory_order_acquire) == SLOT_FAILED; }
+    const MemoryMap& getMemoryMap() const { return memory_map_->map; }
+    const TensorIndex& getTensorIndex() const { return memory_map_->index; }
+
+    // Token slots (count is 0 until the trace source has been scanned)
+    size_t getTokenCount() const { return token_count_.load(std::memory_order_acquire); }
+    bool isTokenReady(size_t index) const { return token_states_[index].load(std::memory_order_acquire) == SLOT_READY; }
+    const TraceData& getToken(size_t index) const { return tokens_[index]; }
+
+    // Progress
+    size_t getLoadedCount() const { return loaded_count_.load(std::memory_order_relaxed); }
+    size_t getFailedCount() const { return failed_count_.load(std::memory_order_relaxed); }
+    float getProgress() const;
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+
+    // DISK accesses per tensor summed over every loaded token (valid once isFinished())
+    const std::vector<uint32_t>& getAccumulatedCounts() const { return accumulated_counts_; }
+    uint32_t getMaxAccumulatedCount() const { return max_accumulated_count_; }
+
+    // Routed experts per token and layer (valid once isFinished())
+    const ExpertRouting& getExpertRouting() const { return expert_routing_; }
+
+    // <domain_path>/page_residency.bin from residency-sampler (valid once
+    // isFinished(); not loaded if the domain has none)
+    const PageResidency& getResidency() const { return residency_; }
+
+private:
+    enum SlotState : uint8_t {
+        SLOT_PENDING = 0,
+        SLOT_READY = 1,
+        SLOT_FAILED = 2,
+    };
+
+    ThreadPool& pool_;
+    TaskGroup tasks_;   // Finishes the domain once its last task returns
+    std::string domain_path_;
+    std::string model_path_;
+
+    MemoryMapCache& memory_maps_;
+    std::shared_ptr<const SharedMemoryMap> memory_map_;  // Set before memory_map_state_ leaves PENDING
+    std::atomic<uint8_t> memory_map_state_;
+
+    TraceFile trace_file_;
+    TraceCache trace_cache_;   // Stays mapped while tokens_ are attached to it
+    std::vector<TraceSourceFile> source_files_;
+    std::shared_ptr<TraceSymbols> symbols_;  // Shared by every token's TraceStore (and other domains)
+    std::vector<TraceData> tokens_;
+    std::unique_ptr<std::atomic<uint8_t>[]> token_states_;
+    std::atomic<size_t> token_count_;
+
+    std::atomic<size_t> loaded_count_;
+    std::atomic<size_t> failed_count_;
+    std::atomic<int> setup_remaining_;   // Memory map + token planning
+    std::atomic<bool> finished_;
+    std::function<void()> progress_callback_;
+
+    std::vector<uint32_t> accumulated_counts_;
+    uint32_t max_accumulated_count_;
+    ExpertRouting expert_routing_;
+    PageResidency residency_;
+
+    void notifyProgress();
+    void loadMemoryMap(const std::string& memory_map_path);
+    void planTokens();
+    bool convertTraceFile();
+    void finishSetup();
+    void loadToken(size_t index);
+    void computeAccumulatedCounts();
+    void finishLoad();
+};
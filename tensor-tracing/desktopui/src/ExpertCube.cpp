@@ -0,0 +1,190 @@
+#include "ExpertCube.h"
+#include <algorithm>
+
+namespace {
+// popcount(a & (b >> shift)) over words bitsets, bit t of word t / 64
+uint64_t shiftedOverlap(const uint64_t* a, const uint64_t* b, size_t words, size_t shift) {
+    const size_t word_shift = shift / 64;
+    const size_t bit_shift = shift % 64;
+    uint64_t count = 0;
+    for (size_t w = 0; w + word_shift < words; w++) {
+        uint64_t shifted = b[w + word_shift] >> bit_shift;
+        if (bit_shift != 0 && w + word_shift + 1 < words) {
+            shifted |= b[w + word_shift + 1] << (64 - bit_shift);
+        }
+        count += __builtin_popcountll(a[w] & shifted);
+    }
+    return count;
+}
+
+// Of two masks, not both empty
+double jaccard(uint64_t a, uint64_t b) {
+    return static_cast<double>(__builtin_popcountll(a & b)) / __builtin_popcountll(a | b);
+}
+}
+
+void ExpertActivity::compute(const ExpertRouting& routing, size_t lags) {
+    *this = ExpertActivity();
+    layer_count = routing.getLayerCount();
+    expert_count = routing.getExpertCount();
+    max_lag = lags;
+
+    // Tokens that failed to load (or routed nothing) have all-zero masks
+    std::vector<const uint64_t*> routed;
+    for (size_t t = 0; t < routing.getTokenCount(); t++) {
+        const uint64_t* masks = routing.getTokenMasks(t);
+        if (std::any_of(masks, masks + layer_count, [](uint64_t mask) { return mask != 0; })) {
+            routed.push_back(masks);
+        }
+    }
+    token_count = routed.size();
+    const size_t units = layer_count * expert_count;
+    const size_t words = (token_count + 63) / 64;
+
+    // Transpose the masks into one token bitset per (layer, expert)
+    std::vector<uint64_t> columns(units * words, 0);
+    for (size_t t = 0; t < token_count; t++) {
+        const uint64_t* masks = routed[t];
+        for (size_t layer = 0; layer < layer_count; layer++) {
+            for (uint64_t mask = masks[layer]; mask; mask &= mask - 1) {
+                size_t unit = layer * expert_count + __builtin_ctzll(mask);
+                columns[unit * words + t / 64] |= uint64_t(1) << (t % 64);
+            }
+        }
+    }
+    auto column = [&](size_t unit) { return columns.data() + unit * words; };
+
+    frequency.assign(units, 0);
+    coactivation.assign(units * expert_count, 0);
+    for (size_t layer = 0; layer < layer_count; layer++) {
+        for (size_t i = 0; i < expert_count; i++) {
+            const uint64_t* a = column(layer * expert_count + i);
+            for (size_t j = i; j < expert_count; j++) {
+                const uint64_t* b = column(layer * expert_count + j);
+                uint32_t count = 0;
+                for (size_t w = 0; w < words; w++) {
+                    count += static_cast<uint32_t>(__builtin_popcountll(a[w] & b[w]));
+                }
+                coactivation[(layer * expert_count + i) * expert_count + j] = count;
+                coactivation[(layer * expert_count + j) * expert_count + i] = count;
+            }
+            frequency[layer * expert_count + i] = coactivation[(layer * expert_count + i) * expert_count + i];
+        }
+    }
+
+    // Normalized autocorrelation of a 0/1 series with share p:
+    // r(lag) = (E[x(t) x(t + lag)] - p^2) / (p - p^2)
+    autocorrelation.assign(units * max_lag, 0.0);
+    mean_autocorrelation.assign(max_lag, 0.0);
+    size_t varying = 0;
+    for (size_t unit = 0; unit < units; unit++) {
+        if (frequency[unit] == 0 || frequency[unit] == token_count) {
+            continue;
+        }
+        varying++;
+        const double p = static_cast<double>(frequency[unit]) / token_count;
+        for (size_t lag = 1; lag <= max_lag && lag < token_count; lag++) {
+            double pairs = static_cast<double>(shiftedOverlap(column(unit), column(unit), words, lag));
+            double r = (pairs / (token_count - lag) - p * p) / (p - p * p);
+            autocorrelation[unit * max_lag + lag - 1] = r;
+            mean_autocorrelation[lag - 1] += r;
+        }
+    }
+    for (double& r : mean_autocorrelation) {
+        r = varying ? r / varying : 0.0;
+    }
+
+    // Consecutive tokens, straight from the masks; a layer neither token
+    // routed says nothing about overlap and is left out of both means
+    token_jaccard.assign(token_count, 0.0);
+    layer_jaccard.assign(layer_count, 0.0);
+    std::vector<size_t> layer_pairs(layer_count, 0);
+    for (size_t t = 1; t < token_count; t++) {
+        const uint64_t* previous = routed[t - 1];
+        const uint64_t* masks = routed[t];
+        double sum = 0.0;
+        size_t pairs = 0;
+        for (size_t layer = 0; layer < layer_count; layer++) {
+            if ((previous[layer] | masks[layer]) == 0) {
+                continue;
+            }
+            double j = jaccard(previous[layer], masks[layer]);
+            layer_jaccard[layer] += j;
+            layer_pairs[layer]++;
+            sum += j;
+            pairs++;
+        }
+        token_jaccard[t] = pairs ? sum / pairs : 0.0;
+    }
+    for (size_t layer = 0; layer < layer_count; layer++) {
+        layer_jaccard[layer] = layer_pairs[layer] ? layer_jaccard[layer] / layer_pairs[layer] : 0.0;
+    }
+}
+
+double ExpertActivity::coactivationJaccard(size_t layer, size_t i, size_t j) const {
+    uint32_t both = coactivation[(layer * expert_count + i) * expert_count + j];
+    uint32_t either = frequency[layer * expert_count + i] + frequency[layer * expert_count + j] - both;
+    return either ? static_cast<double>(both) / either : 0.0;
+}
+
+ExpertCube::ExpertCube()
+    : layer_count_(0)
+    , expert_count_(0)
+{
+}
+
+void ExpertCube::clear() {
+    layer_count_ = 0;
+    expert_count_ = 0;
+    activity_.clear();
+    similarity_.clear();
+    layer_similarity_.clear();
+}
+
+void ExpertCube::build(const std::vector<const ExpertRouting*>& domains, size_t max_lag) {
+    clear();
+    const size_t domain_count = domains.size();
+    activity_.resize(domain_count);
+    for (size_t d = 0; d < domain_count; d++) {
+        if (domains[d]) {
+            activity_[d].compute(*domains[d], max_lag);
+            layer_count_ = std::max(layer_count_, activity_[d].layer_count);
+            expert_count_ = std::max(expert_count_, activity_[d].expert_count);
+        }
+    }
+
+    auto share = [this](size_t d, size_t layer, size_t expert) {
+        const ExpertActivity& activity = activity_[d];
+        if (layer >= activity.layer_count || expert >= activity.expert_count) {
+            return 0.0;
+        }
+        return activity.share(layer, expert);
+    };
+
+    layer_similarity_.assign(layer_count_ * domain_count * domain_count, 0.0);
+    similarity_.assign(domain_count * domain_count, 0.0);
+    for (size_t a = 0; a < domain_count; a++) {
+        for (size_t b = a; b < domain_count; b++) {
+            double sum = 0.0;
+            size_t layers = 0;
+            for (size_t layer = 0; layer < layer_count_; layer++) {
+                double low = 0.0, high = 0.0;
+                for (size_t e = 0; e < expert_count_; e++) {
+                    double x = share(a, layer, e);
+                    double y = share(b, layer, e);
+                    low += std::min(x, y);
+                    high += std::max(x, y);
+                }
+                // Layers neither domain routed are left out of the mean
+                if (high > 0.0) {
+                    double s = low / high;
+                    layer_similarity_[(layer * domain_count + a) * domain_count + b] = s;
+                    layer_similarity_[(layer * domain_count + b) * domain_count + a] = s;
+                    sum += s;
+                    layers++;
+                }
+            }
+            similarity_[a * domain_count + b] = similarity_[b * domain_count + a] = layers ? sum / layers : 0.0;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ExpertRouting.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Routing statistics of one domain
+//
+// Counts come from token bitsets: for every (layer, expert) one bit per
+// token, so frequency, co-activation and lagged overlaps are AND + popcount
+// over (tokens / 64) words instead of walking expert id lists. Tokens that
+// routed nothing (not loaded) are left out, so t counts routed tokens, and
+// the Jaccard means skip pairs where neither token routed the layer.
+struct ExpertActivity {
+    size_t token_count = 0;
+    size_t layer_count = 0;
+    size_t expert_count = 0;
+    size_t max_lag = 0;
+
+    std::vector<uint32_t> frequency;        // layer * expert_count + e: tokens routing e
+    std::vector<uint32_t> coactivation;     // (layer * expert_count + i) * expert_count + j (diagonal = frequency)
+    std::vector<double> token_jaccard;      // t: mean over layers of J(mask[t - 1], mask[t]) (0 for t = 0)
+    std::vector<double> layer_jaccard;      // layer: mean J(mask[t - 1], mask[t]) over tokens
+
+    // Autocorrelation of each expert's 0/1 series at lags 1..max_lag:
+    // (layer * expert_count + e) * max_lag + lag - 1. Experts routed in
+    // every token or never have no variance and stay 0.
+    std::vector<double> autocorrelation;
+    std::vector<double> mean_autocorrelation;   // lag - 1: mean over experts with variance
+
+    void compute(const ExpertRouting& routing, size_t lags);
+
+    double share(size_t layer, size_t expert) const {
+        return token_count ? static_cast<double>(frequency[layer * expert_count + expert]) / token_count : 0.0;
+    }
+    // Jaccard of two experts' token sets in one layer
+    double coactivationJaccard(size_t layer, size_t i, size_t j) const;
+};
+
+// (domain, token, layer) expert cube: the ExpertRouting of each domain plus
+// its ExpertActivity, and pairwise domain similarity
+//
+// Domain similarity of a layer is the weighted Jaccard of the two domains'
+// expert shares, sum(min) / sum(max), which compares domains of different
+// lengths. Layers and experts beyond a domain's own counts read as unused.
+class ExpertCube {
+public:
+    static constexpr size_t DEFAULT_MAX_LAG = 16;
+
+    ExpertCube();
+
+    // nullptr entries (e.g. domains still loading) contribute empty activity
+    void build(const std::vector<const ExpertRouting*>& domains, size_t max_lag = DEFAULT_MAX_LAG);
+    void clear();
+
+    size_t getDomainCount() const { return activity_.size(); }
+    size_t getLayerCount() const { return layer_count_; }
+    size_t getExpertCount() const { return expert_count_; }
+
+    const ExpertActivity& getActivity(size_t domain) const { return activity_[domain]; }
+
+    double getSimilarity(size_t a, size_t b) const { return similarity_[a * activity_.size() + b]; }
+    double getLayerSimilarity(size_t layer, size_t a, size_t b) const {
+        return layer_similarity_[(layer * activity_.size() + a) * activity_.size() + b];
+    }
+
+private:
+    size_t layer_count_;
+    size_t expert_count_;
+    std::vector<ExpertActivity> activity_;
+    std::vector<double> similarity_;          // a * domains + b, mean over layers
+    std::vector<double> layer_similarity_;    // (layer * domains + a) * domains + b
+};
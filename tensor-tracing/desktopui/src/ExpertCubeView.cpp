@@ -0,0 +1,248 @@
+#include "ExpertCubeView.h"
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <cmath>
+
+ExpertCubeView::ExpertCubeView()
+    : metric_(Metric::Share)
+    , lag_(1)
+    , compare_domain_(0)
+    , selected_layer_(0)
+{
+}
+
+void ExpertCubeView::render(const ExpertCube& cube, const Workspace& workspace, size_t active_domain,
+                            int current_token) {
+    if (!ImGui::CollapsingHeader("Expert Routing")) {
+        return;
+    }
+
+    if (active_domain >= cube.getDomainCount() || cube.getActivity(active_domain).token_count == 0) {
+        ImGui::TextDisabled("Available once the domain has loaded (needs MUL_MAT_ID entries with expert ids)");
+        return;
+    }
+    const ExpertActivity& activity = cube.getActivity(active_domain);
+    selected_layer_ = std::min(selected_layer_, static_cast<int>(activity.layer_count) - 1);
+
+    renderControls(cube, workspace, active_domain);
+    if (ImPlot::BeginSubplots("##expert_grids", 1, 2, ImVec2(-1, 360), ImPlotSubplotFlags_NoTitle)) {
+        renderLayerGrid(cube, active_domain);
+        renderCoactivation(activity);
+        ImPlot::EndSubplots();
+    }
+    renderTrends(cube, workspace, active_domain, current_token);
+    renderSimilarityTable(cube, workspace);
+}
+
+void ExpertCubeView::renderControls(const ExpertCube& cube, const Workspace& workspace, size_t active_domain) {
+    int metric = static_cast<int>(metric_);
+    ImGui::RadioButton("Activation share", &metric, static_cast<int>(Metric::Share));
+    ImGui::SameLine();
+    ImGui::RadioButton("Autocorrelation", &metric, static_cast<int>(Metric::Autocorrelation));
+    if (cube.getDomainCount() > 1) {
+        ImGui::SameLine();
+        ImGui::RadioButton("Difference to domain", &metric, static_cast<int>(Metric::DomainDifference));
+    }
+    metric_ = static_cast<Metric>(metric);
+
+    ImGui::PushItemWidth(200);
+    if (metric_ == Metric::Autocorrelation) {
+        ImGui::SameLine();
+        ImGui::SliderInt("Lag", &lag_, 1, static_cast<int>(std::max<size_t>(cube.getActivity(active_domain).max_lag, 1)));
+    } else if (metric_ == Metric::DomainDifference) {
+        compare_domain_ = std::min(compare_domain_, static_cast<int>(cube.getDomainCount()) - 1);
+        ImGui::SameLine();
+        if (ImGui::BeginCombo("##compare_domain", workspace.getDomainName(compare_domain_).c_str())) {
+            for (size_t d = 0; d < cube.getDomainCount(); d++) {
+                if (ImGui::Selectable(workspace.getDomainName(d).c_str(), compare_domain_ == static_cast<int>(d))) {
+                    compare_domain_ = static_cast<int>(d);
+                }
+            }
+            ImGui::EndCombo();
+        }
+    }
+    ImGui::PopItemWidth();
+}
+
+double ExpertCubeView::cellValue(const ExpertCube& cube, size_t active_domain, size_t layer, size_t expert) const {
+    const ExpertActivity& activity = cube.getActivity(active_domain);
+    if (layer >= activity.layer_count || expert >= activity.expert_count) {
+        return 0.0;
+    }
+    switch (metric_) {
+        case Metric::Share:
+            return activity.share(layer, expert);
+        case Metric::Autocorrelation:
+            if (static_cast<size_t>(lag_) > activity.max_lag) {
+                return 0.0;
+            }
+            return activity.autocorrelation[(layer * activity.expert_count + expert) * activity.max_lag + lag_ - 1];
+        case Metric::DomainDifference: {
+            const ExpertActivity& other = cube.getActivity(compare_domain_);
+            double share = layer < other.layer_count && expert < other.expert_count ? other.share(layer, expert) : 0.0;
+            return activity.share(layer, expert) - share;
+        }
+    }
+    return 0.0;
+}
+
+void ExpertCubeView::renderLayerGrid(const ExpertCube& cube, size_t active_domain) {
+    const ExpertActivity& activity = cube.getActivity(active_domain);
+    const size_t layers = activity.layer_count;
+    const size_t experts = activity.expert_count;
+
+    double scale_min = 0.0, scale_max = 0.0;
+    grid_.resize(layers * experts);
+    for (size_t layer = 0; layer < layers; layer++) {
+        for (size_t e = 0; e < experts; e++) {
+            double value = cellValue(cube, active_domain, layer, e);
+            grid_[(layers - 1 - layer) * experts + e] = value;
+            scale_max = std::max(scale_max, std::fabs(value));
+        }
+    }
+    // Signed metrics get a symmetric diverging scale
+    const bool is_signed = metric_ != Metric::Share;
+    scale_max = std::max(scale_max, 1e-6);
+    if (is_signed) {
+        scale_min = -scale_max;
+    }
+
+    if (ImPlot::BeginPlot("##layer_expert_grid")) {
+        ImPlot::SetupAxis(ImAxis_X1, "Expert", ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y1, "Layer", ImPlotAxisFlags_AutoFit);
+        ImPlot::PushColormap(is_signed ? ImPlotColormap_RdBu : ImPlotColormap_Viridis);
+        ImPlot::PlotHeatmap("##grid", grid_.data(), static_cast<int>(layers), static_cast<int>(experts),
+                            scale_min, scale_max, nullptr, ImPlotPoint(0.0, 0.0),
+                            ImPlotPoint(static_cast<double>(experts), static_cast<double>(layers)));
+        ImPlot::PopColormap();
+
+        // Selected layer outline
+        double band[] = {static_cast<double>(selected_layer_), selected_layer_ + 1.0};
+        ImPlot::PlotInfLines("##selected_layer", band, 2, ImPlotInfLinesFlags_Horizontal);
+
+        if (ImPlot::IsPlotHovered()) {
+            ImPlotPoint mouse = ImPlot::GetPlotMousePos();
+            if (mouse.x >= 0.0 && mouse.y >= 0.0 && mouse.x < experts && mouse.y < layers) {
+                size_t expert = static_cast<size_t>(mouse.x);
+                size_t layer = static_cast<size_t>(mouse.y);
+                if (ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+                    selected_layer_ = static_cast<int>(layer);
+                }
+                ImGui::BeginTooltip();
+                ImGui::Text("Layer %zu, expert %zu", layer, expert);
+                ImGui::Text("Routed in %u / %zu tokens (%.1f%%)", activity.frequency[layer * experts + expert],
+                            activity.token_count, activity.share(layer, expert) * 100.0);
+                if (metric_ != Metric::Share) {
+                    ImGui::Text("Value: %+.3f", cellValue(cube, active_domain, layer, expert));
+                }
+                ImGui::EndTooltip();
+            }
+        }
+        ImPlot::EndPlot();
+    }
+}
+
+void ExpertCubeView::renderCoactivation(const ExpertActivity& activity) {
+    const size_t experts = activity.expert_count;
+    const size_t layer = static_cast<size_t>(selected_layer_);
+    coactivation_.resize(experts * experts);
+    for (size_t i = 0; i < experts; i++) {
+        for (size_t j = 0; j < experts; j++) {
+            coactivation_[(experts - 1 - i) * experts + j] = i == j ? 0.0 : activity.coactivationJaccard(layer, i, j);
+        }
+    }
+
+    char title[64];
+    snprintf(title, sizeof(title), "Co-activation (Jaccard), layer %zu", layer);
+    if (ImPlot::BeginPlot(title)) {
+        ImPlot::SetupAxis(ImAxis_X1, "Expert", ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y1, "Expert", ImPlotAxisFlags_AutoFit);
+        ImPlot::PushColormap(ImPlotColormap_Viridis);
+        double scale_max = std::max(1e-6, *std::max_element(coactivation_.begin(), coactivation_.end()));
+        ImPlot::PlotHeatmap("##coactivation", coactivation_.data(), static_cast<int>(experts),
+                            static_cast<int>(experts), 0.0, scale_max, nullptr, ImPlotPoint(0.0, 0.0),
+                            ImPlotPoint(static_cast<double>(experts), static_cast<double>(experts)));
+        ImPlot::PopColormap();
+
+        if (ImPlot::IsPlotHovered()) {
+            ImPlotPoint mouse = ImPlot::GetPlotMousePos();
+            if (mouse.x >= 0.0 && mouse.y >= 0.0 && mouse.x < experts && mouse.y < experts) {
+                size_t i = static_cast<size_t>(mouse.y);
+                size_t j = static_cast<size_t>(mouse.x);
+                ImGui::BeginTooltip();
+                ImGui::Text("Experts %zu + %zu", i, j);
+                ImGui::Text("Together in %u tokens (Jaccard %.3f)",
+                            activity.coactivation[(layer * experts + i) * experts + j],
+                            activity.coactivationJaccard(layer, i, j));
+                ImGui::EndTooltip();
+            }
+        }
+        ImPlot::EndPlot();
+    }
+}
+
+void ExpertCubeView::renderTrends(const ExpertCube& cube, const Workspace& workspace, size_t active_domain,
+                                  int current_token) {
+    const ExpertActivity& activity = cube.getActivity(active_domain);
+    if (ImPlot::BeginSubplots("##expert_trends", 1, 2, ImVec2(-1, 220), ImPlotSubplotFlags_NoTitle)) {
+        if (ImPlot::BeginPlot("##token_jaccard")) {
+            ImPlot::SetupAxis(ImAxis_X1, "Token", ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y1, "Jaccard to Previous Token", ImPlotAxisFlags_None);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImGuiCond_Always);
+            if (activity.token_jaccard.size() > 1) {
+                ImPlot::PlotLine("Mean over layers", activity.token_jaccard.data() + 1,
+                                 static_cast<int>(activity.token_jaccard.size() - 1), 1.0, 1.0);
+            }
+            double token = current_token;
+            ImPlot::PlotInfLines("##current_token", &token, 1);
+            ImPlot::EndPlot();
+        }
+
+        // Every domain, so persistence can be compared across workloads
+        if (ImPlot::BeginPlot("##autocorrelation")) {
+            ImPlot::SetupAxis(ImAxis_X1, "Lag (tokens)", ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y1, "Mean Autocorrelation", ImPlotAxisFlags_AutoFit);
+            for (size_t d = 0; d < cube.getDomainCount(); d++) {
+                const std::vector<double>& r = cube.getActivity(d).mean_autocorrelation;
+                if (!r.empty()) {
+                    ImPlot::PlotLine(workspace.getDomainName(d).c_str(), r.data(), static_cast<int>(r.size()), 1.0, 1.0);
+                }
+            }
+            ImPlot::EndPlot();
+        }
+        ImPlot::EndSubplots();
+    }
+}
+
+void ExpertCubeView::renderSimilarityTable(const ExpertCube& cube, const Workspace& workspace) {
+    const size_t domains = cube.getDomainCount();
+    if (domains < 2) {
+        return;
+    }
+
+    ImGui::Text("Domain similarity (weighted Jaccard of expert shares; mean over layers / layer %d)", selected_layer_);
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    if (ImGui::BeginTable("domain_similarity", static_cast<int>(domains + 1), flags)) {
+        ImGui::TableSetupColumn("Domain", ImGuiTableColumnFlags_WidthFixed, 140.0f);
+        for (size_t d = 0; d < domains; d++) {
+            ImGui::TableSetupColumn(workspace.getDomainName(d).c_str(), ImGuiTableColumnFlags_WidthStretch);
+        }
+        ImGui::TableHeadersRow();
+
+        for (size_t a = 0; a < domains; a++) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", workspace.getDomainName(a).c_str());
+            for (size_t b = 0; b < domains; b++) {
+                ImGui::TableNextColumn();
+                if (static_cast<size_t>(selected_layer_) < cube.getLayerCount()) {
+                    ImGui::Text("%.3f / %.3f", cube.getSimilarity(a, b), cube.getLayerSimilarity(selected_layer_, a, b));
+                } else {
+                    ImGui::Text("%.3f", cube.getSimilarity(a, b));
+                }
+            }
+        }
+        ImGui::EndTable();
+    }
+}
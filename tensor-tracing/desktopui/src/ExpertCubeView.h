@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ExpertCube.h"
+#include "Workspace.h"
+#include <vector>
+
+// Expert routing panel (shared by every domain tab)
+//
+// Layer x expert heat grid of the active domain (activation share, lagged
+// autocorrelation or share difference to another domain); clicking a row
+// selects the layer whose expert co-activation matrix is drawn next to it.
+// Below: consecutive-token Jaccard, autocorrelation by lag for every domain
+// and the domain similarity matrix.
+class ExpertCubeView {
+public:
+    ExpertCubeView();
+
+    void render(const ExpertCube& cube, const Workspace& workspace, size_t active_domain, int current_token);
+
+private:
+    enum class Metric { Share = 0, Autocorrelation = 1, DomainDifference = 2 };
+
+    Metric metric_;
+    int lag_;
+    int compare_domain_;
+    int selected_layer_;
+
+    // Heatmap scratch, rows flipped so layer 0 sits at the bottom
+    std::vector<double> grid_;
+    std::vector<double> coactivation_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+
+    void renderControls(const ExpertCube& cube, const Workspace& workspace, size_t active_domain);
+    void renderLayerGrid(const ExpertCube& cube, size_t active_domain);
+    void renderCoactivation(const ExpertActivity& activity);
+    void renderTrends(const ExpertCube& cube, const Workspace& workspace, size_t active_domain, int current_token);
+    void renderSimilarityTable(const ExpertCube& cube, const Workspace& workspace);
+
+    double cellValue(const ExpertCube& cube, size_t active_domain, size_t layer, size_t expert) const;
+};
@@ -0,0 +1,128 @@
+#include "ExpertPredictionView.h"
+#include "imgui.h"
+#include "implot.h"
+#include <iomanip>
+#include <sstream>
+
+ExpertPredictionView::ExpertPredictionView()
+    : top_k_(static_cast<int>(EXPERT_ACCESS_TOP_K))
+    , evaluated_top_k_(0)
+{
+}
+
+void ExpertPredictionView::render(const DomainLoader& loader) {
+    if (!ImGui::CollapsingHeader("Expert Prediction")) {
+        return;
+    }
+
+    if (!loader.isFinished()) {
+        ImGui::TextDisabled("Waiting for the domain to finish loading...");
+        return;
+    }
+    const ExpertRouting& routing = loader.getExpertRouting();
+    if (routing.empty()) {
+        ImGui::TextDisabled("No MUL_MAT_ID entries with expert ids in this domain");
+        return;
+    }
+
+    ImGui::PushItemWidth(200);
+    ImGui::SliderInt("Top-k", &top_k_, 1, static_cast<int>(routing.getExpertCount()));
+    ImGui::PopItemWidth();
+    if (top_k_ != evaluated_top_k_) {
+        evaluate(routing);
+    }
+
+    ImGui::SameLine();
+    ImGui::TextDisabled("%zu tokens, %zu layers, %zu experts", routing.getTokenCount(), routing.getLayerCount(),
+                        routing.getExpertCount());
+
+    renderSummaryTable();
+    renderLayerPlot();
+}
+
+void ExpertPredictionView::evaluate(const ExpertRouting& routing) {
+    results_.resize(EXPERT_PREDICTOR_COUNT);
+    for (size_t p = 0; p < EXPERT_PREDICTOR_COUNT; p++) {
+        evaluateExpertPredictor(routing, static_cast<ExpertPredictorKind>(p), static_cast<size_t>(top_k_), results_[p]);
+    }
+    evaluated_top_k_ = top_k_;
+}
+
+void ExpertPredictionView::renderSummaryTable() {
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    if (ImGui::BeginTable("expert_predictors", 6, flags)) {
+        ImGui::TableSetupColumn("Predictor", ImGuiTableColumnFlags_WidthFixed, 110.0f);
+        ImGui::TableSetupColumn("Precision", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Recall", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Prefetched", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Needed", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Wasted / Missed", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableHeadersRow();
+
+        for (const ExpertPredictionResult& result : results_) {
+            const ExpertPredictionStats& stats = result.total;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", expertPredictorName(result.kind));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", stats.precision() * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f%%", stats.recall() * 100.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatSize(stats.bytes_prefetched).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatSize(stats.bytes_needed).c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%s / %s", formatSize(stats.bytesWasted()).c_str(), formatSize(stats.bytesMissed()).c_str());
+        }
+        ImGui::EndTable();
+    }
+}
+
+void ExpertPredictionView::renderLayerPlot() {
+    if (results_.empty() || results_[0].per_layer.empty()) {
+        return;
+    }
+
+    // Predictor-major so one PlotBarGroups call draws every layer
+    const size_t layer_count = results_[0].per_layer.size();
+    std::vector<const char*> labels;
+    std::vector<double> precision;
+    std::vector<double> recall;
+    for (const ExpertPredictionResult& result : results_) {
+        labels.push_back(expertPredictorName(result.kind));
+        for (const ExpertPredictionStats& stats : result.per_layer) {
+            precision.push_back(stats.precision());
+            recall.push_back(stats.recall());
+        }
+    }
+
+    const char* titles[] = {"##expert_precision", "##expert_recall"};
+    const char* axes[] = {"Precision", "Recall"};
+    const std::vector<double>* values[] = {&precision, &recall};
+    for (size_t plot = 0; plot < 2; plot++) {
+        if (ImPlot::BeginPlot(titles[plot], ImVec2(-1, 180))) {
+            ImPlot::SetupAxis(ImAxis_X1, "Layer", ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y1, axes[plot], ImPlotAxisFlags_None);
+            ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImGuiCond_Always);
+            ImPlot::PlotBarGroups(labels.data(), values[plot]->data(), static_cast<int>(labels.size()),
+                                  static_cast<int>(layer_count), 0.8);
+            ImPlot::EndPlot();
+        }
+    }
+}
+
+std::string ExpertPredictionView::formatSize(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    int unit_index = 0;
+    double size = static_cast<double>(bytes);
+
+    while (size >= 1024.0 && unit_index < 3) {
+        size /= 1024.0;
+        unit_index++;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[unit_index];
+    return oss.str();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "ExpertPredictor.h"
+#include <string>
+#include <vector>
+
+// Expert prediction panel for one domain
+//
+// Replays the domain's routing through every predictor once the loader has
+// finished (a few milliseconds, so on the UI thread) and shows precision,
+// recall and prefetch bytes overall and per layer. Changing top-k re-scores.
+class ExpertPredictionView {
+public:
+    ExpertPredictionView();
+
+    void render(const DomainLoader& loader);
+
+private:
+    std::vector<ExpertPredictionResult> results_;   // One per predictor
+    int top_k_;
+    int evaluated_top_k_;                           // 0 until the first evaluation
+
+    void evaluate(const ExpertRouting& routing);
+    void renderSummaryTable();
+    void renderLayerPlot();
+
+    static std::string formatSize(uint64_t bytes);
+};
@@ -0,0 +1,196 @@
+#include "ExpertPredictor.h"
+#include <algorithm>
+
+const char* expertPredictorName(ExpertPredictorKind kind) {
+    switch (kind) {
+        case ExpertPredictorKind::PreviousToken: return "Previous token";
+        case ExpertPredictorKind::LayerFrequency: return "Layer frequency";
+        case ExpertPredictorKind::Markov: return "Markov";
+    }
+    return "";
+}
+
+bool expertPredictorFromName(const std::string& name, ExpertPredictorKind& out_kind) {
+    for (size_t i = 0; i < EXPERT_PREDICTOR_COUNT; i++) {
+        ExpertPredictorKind kind = static_cast<ExpertPredictorKind>(i);
+        if (name == expertPredictorName(kind)) {
+            out_kind = kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ExpertPredictionStats::add(const ExpertPredictionStats& other) {
+    predictions += other.predictions;
+    predicted += other.predicted;
+    actual += other.actual;
+    hits += other.hits;
+    bytes_prefetched += other.bytes_prefetched;
+    bytes_needed += other.bytes_needed;
+    bytes_useful += other.bytes_useful;
+}
+
+namespace {
+// Mask of the top_k highest scores (ties go to the lower expert id)
+uint64_t topExperts(const uint32_t* scores, size_t expert_count, size_t top_k) {
+    uint64_t mask = 0;
+    for (size_t k = 0; k < top_k; k++) {
+        size_t best = expert_count;
+        for (size_t e = 0; e < expert_count; e++) {
+            if (!(mask >> e & 1) && scores[e] > 0 && (best == expert_count || scores[e] > scores[best])) {
+                best = e;
+            }
+        }
+        if (best == expert_count) {
+            break;
+        }
+        mask |= uint64_t(1) << best;
+    }
+    return mask;
+}
+
+class PreviousTokenPredictor final : public ExpertPredictor {
+public:
+    const char* name() const override { return "Previous token"; }
+
+    void reset(size_t layer_count, size_t, size_t) override {
+        previous_.assign(layer_count, 0);
+    }
+
+    uint64_t predict(size_t layer) const override { return previous_[layer]; }
+
+    void observe(size_t layer, uint64_t actual) override { previous_[layer] = actual; }
+
+private:
+    std::vector<uint64_t> previous_;
+};
+
+class LayerFrequencyPredictor final : public ExpertPredictor {
+public:
+    const char* name() const override { return "Layer frequency"; }
+
+    void reset(size_t layer_count, size_t expert_count, size_t top_k) override {
+        expert_count_ = expert_count;
+        top_k_ = top_k;
+        counts_.assign(layer_count * expert_count, 0);
+    }
+
+    uint64_t predict(size_t layer) const override {
+        return topExperts(counts_.data() + layer * expert_count_, expert_count_, top_k_);
+    }
+
+    void observe(size_t layer, uint64_t actual) override {
+        uint32_t* counts = counts_.data() + layer * expert_count_;
+        for (; actual; actual &= actual - 1) {
+            counts[__builtin_ctzll(actual)]++;
+        }
+    }
+
+private:
+    size_t expert_count_ = 0;
+    size_t top_k_ = 0;
+    std::vector<uint32_t> counts_;   // layer * expert_count_ + expert
+};
+
+// transitions[layer][i][j] counts tokens routing j right after a token that
+// routed i; the previous set votes with the sum of its rows
+class MarkovPredictor final : public ExpertPredictor {
+public:
+    const char* name() const override { return "Markov"; }
+
+    void reset(size_t layer_count, size_t expert_count, size_t top_k) override {
+        expert_count_ = expert_count;
+        top_k_ = top_k;
+        transitions_.assign(layer_count * expert_count * expert_count, 0);
+        previous_.assign(layer_count, 0);
+        scores_.assign(expert_count, 0);
+    }
+
+    uint64_t predict(size_t layer) const override {
+        std::fill(scores_.begin(), scores_.end(), 0);
+        for (uint64_t from = previous_[layer]; from; from &= from - 1) {
+            const uint32_t* row = transitionRow(layer, __builtin_ctzll(from));
+            for (size_t j = 0; j < expert_count_; j++) {
+                scores_[j] += row[j];
+            }
+        }
+        uint64_t mask = topExperts(scores_.data(), expert_count_, top_k_);
+        // No transition seen from these experts yet
+        return mask ? mask : previous_[layer];
+    }
+
+    void observe(size_t layer, uint64_t actual) override {
+        for (uint64_t from = previous_[layer]; from; from &= from - 1) {
+            uint32_t* row = transitionRow(layer, __builtin_ctzll(from));
+            for (uint64_t to = actual; to; to &= to - 1) {
+                row[__builtin_ctzll(to)]++;
+            }
+        }
+        previous_[layer] = actual;
+    }
+
+private:
+    size_t expert_count_ = 0;
+    size_t top_k_ = 0;
+    std::vector<uint32_t> transitions_;
+    std::vector<uint64_t> previous_;
+    mutable std::vector<uint32_t> scores_;
+
+    uint32_t* transitionRow(size_t layer, size_t from) {
+        return transitions_.data() + (layer * expert_count_ + from) * expert_count_;
+    }
+    const uint32_t* transitionRow(size_t layer, size_t from) const {
+        return transitions_.data() + (layer * expert_count_ + from) * expert_count_;
+    }
+};
+}
+
+std::unique_ptr<ExpertPredictor> createExpertPredictor(ExpertPredictorKind kind) {
+    switch (kind) {
+        case ExpertPredictorKind::PreviousToken: return std::make_unique<PreviousTokenPredictor>();
+        case ExpertPredictorKind::LayerFrequency: return std::make_unique<LayerFrequencyPredictor>();
+        case ExpertPredictorKind::Markov: return std::make_unique<MarkovPredictor>();
+    }
+    return nullptr;
+}
+
+void evaluateExpertPredictor(const ExpertRouting& routing, ExpertPredictorKind kind, size_t top_k,
+                             ExpertPredictionResult& out) {
+    const size_t layer_count = routing.getLayerCount();
+    out = ExpertPredictionResult();
+    out.kind = kind;
+    out.top_k = top_k;
+    out.per_layer.assign(layer_count, ExpertPredictionStats());
+
+    std::unique_ptr<ExpertPredictor> predictor = createExpertPredictor(kind);
+    predictor->reset(layer_count, routing.getExpertCount(), top_k);
+    std::vector<uint8_t> seeded(layer_count, 0);
+
+    for (size_t t = 0; t < routing.getTokenCount(); t++) {
+        const uint64_t* masks = routing.getTokenMasks(t);
+        for (size_t layer = 0; layer < layer_count; layer++) {
+            const uint64_t actual = masks[layer];
+            if (actual == 0) {
+                continue;
+            }
+            if (seeded[layer]) {
+                const uint64_t predicted = predictor->predict(layer);
+                ExpertPredictionStats& stats = out.per_layer[layer];
+                stats.predictions++;
+                stats.predicted += __builtin_popcountll(predicted);
+                stats.actual += __builtin_popcountll(actual);
+                stats.hits += __builtin_popcountll(predicted & actual);
+                stats.bytes_prefetched += routing.getMaskBytes(layer, predicted);
+                stats.bytes_needed += routing.getMaskBytes(layer, actual);
+                stats.bytes_useful += routing.getMaskBytes(layer, predicted & actual);
+            }
+            predictor->observe(layer, actual);
+            seeded[layer] = 1;
+        }
+    }
+
+    for (const ExpertPredictionStats& stats : out.per_layer) {
+        out.total.add(stats);
+    }
+}
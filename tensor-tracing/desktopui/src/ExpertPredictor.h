@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ExpertRouting.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Next-token expert predictors
+enum class ExpertPredictorKind : uint8_t {
+    PreviousToken = 0,    // Same experts as the layer's previous token
+    LayerFrequency = 1,   // Top-k most routed experts of the layer so far
+    Markov = 2,           // Top-k of first-order transition counts from the previous set
+};
+
+constexpr size_t EXPERT_PREDICTOR_COUNT = 3;
+
+const char* expertPredictorName(ExpertPredictorKind kind);
+bool expertPredictorFromName(const std::string& name, ExpertPredictorKind& out_kind);
+
+// Online predictor of the experts each layer routes to in the next token
+//
+// Selections are ExpertRouting bitmasks. The evaluation alternates predict()
+// and observe() per layer in token order, so a predictor only ever sees the
+// past. New predictors implement these three calls and join the factory.
+class ExpertPredictor {
+public:
+    virtual ~ExpertPredictor() = default;
+
+    virtual const char* name() const = 0;
+
+    // No history; predictions hold at most top_k experts, except for copies
+    // of the previous set (PreviousToken, Markov without transitions yet)
+    virtual void reset(size_t layer_count, size_t expert_count, size_t top_k) = 0;
+
+    // Experts to prefetch for the layer's next token
+    virtual uint64_t predict(size_t layer) const = 0;
+
+    // Experts the layer actually routed to in that token
+    virtual void observe(size_t layer, uint64_t actual) = 0;
+};
+
+std::unique_ptr<ExpertPredictor> createExpertPredictor(ExpertPredictorKind kind);
+
+// Counters of one predictor over one layer (or all of them)
+struct ExpertPredictionStats {
+    uint64_t predictions = 0;       // (token, layer) pairs predicted
+    uint64_t predicted = 0;         // Experts predicted
+    uint64_t actual = 0;            // Experts routed
+    uint64_t hits = 0;              // Experts both predicted and routed
+    uint64_t bytes_prefetched = 0;  // Slice bytes of the predicted experts
+    uint64_t bytes_needed = 0;      // Slice bytes of the routed experts
+    uint64_t bytes_useful = 0;      // Prefetched bytes that were routed
+
+    void add(const ExpertPredictionStats& other);
+    double precision() const { return predicted ? static_cast<double>(hits) / predicted : 0.0; }
+    double recall() const { return actual ? static_cast<double>(hits) / actual : 0.0; }
+    uint64_t bytesWasted() const { return bytes_prefetched - bytes_useful; }
+    uint64_t bytesMissed() const { return bytes_needed - bytes_useful; }
+};
+
+struct ExpertPredictionResult {
+    ExpertPredictorKind kind = ExpertPredictorKind::PreviousToken;
+    size_t top_k = 0;
+    ExpertPredictionStats total;
+    std::vector<ExpertPredictionStats> per_layer;
+};
+
+// Replay a domain's routing through one predictor
+//
+// Each layer is scored from its second routed token on (the first only
+// seeds history). Tokens where a layer routed nothing, e.g. failed loads,
+// are neither scored nor observed. Cost is O(tokens * layers * experts).
+void evaluateExpertPredictor(const ExpertRouting& routing, ExpertPredictorKind kind, size_t top_k,
+                             ExpertPredictionResult& out);
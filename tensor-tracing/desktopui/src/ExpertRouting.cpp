@@ -0,0 +1,92 @@
+#include "ExpertRouting.h"
+#include "DomainLoader.h"
+#include <algorithm>
+#include <iostream>
+
+ExpertRouting::ExpertRouting()
+    : token_count_(0)
+    , layer_count_(0)
+    , expert_count_(0)
+    , dropped_ids_(0)
+{
+}
+
+void ExpertRouting::clear() {
+    token_count_ = 0;
+    layer_count_ = 0;
+    expert_count_ = 0;
+    dropped_ids_ = 0;
+    masks_.clear();
+    expert_bytes_.clear();
+}
+
+void ExpertRouting::build(const DomainLoader& loader) {
+    clear();
+    const uint8_t mul_mat_id = ggmlOpFromName("MUL_MAT_ID");
+
+    // Layer count from the routed entries themselves (memory map may be absent)
+    token_count_ = loader.getTokenCount();
+    for (size_t t = 0; t < token_count_; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        for (size_t i = 0; i < store.size(); i++) {
+            if (store.op(i) == mul_mat_id && store.numExperts(i) > 0 && store.layerId(i) >= 0) {
+                layer_count_ = std::max<size_t>(layer_count_, store.layerId(i) + 1);
+            }
+        }
+    }
+    if (layer_count_ == 0) {
+        token_count_ = 0;
+        return;
+    }
+
+    masks_.assign(token_count_ * layer_count_, 0);
+    for (size_t t = 0; t < token_count_; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        uint64_t* row = masks_.data() + t * layer_count_;
+        for (size_t i = 0; i < store.size(); i++) {
+            if (store.op(i) != mul_mat_id || store.layerId(i) < 0) {
+                continue;
+            }
+            const uint8_t* experts = store.expertIds(i);
+            size_t top_k = std::min<size_t>(EXPERT_ACCESS_TOP_K, store.numExperts(i));
+            for (size_t e = 0; e < top_k; e++) {
+                if (experts[e] < MAX_EXPERTS) {
+                    row[store.layerId(i)] |= uint64_t(1) << experts[e];
+                    expert_count_ = std::max<size_t>(expert_count_, experts[e] + 1);
+                } else {
+                    dropped_ids_++;
+                }
+            }
+        }
+    }
+    if (dropped_ids_ > 0) {
+        std::cerr << "Warning: " << dropped_ids_ << " routed expert ids outside 0.." << MAX_EXPERTS - 1
+                  << " left out of the routing masks" << std::endl;
+    }
+
+    expert_bytes_.assign(layer_count_ * MAX_EXPERTS, 0);
+    if (loader.isMemoryMapReady()) {
+        for (const MemoryTensor& tensor : loader.getMemoryMap().tensors) {
+            if (tensor.expert_id >= 0 && static_cast<size_t>(tensor.expert_id) < MAX_EXPERTS &&
+                tensor.layer_id >= 0 && static_cast<size_t>(tensor.layer_id) < layer_count_) {
+                expert_bytes_[tensor.layer_id * MAX_EXPERTS + tensor.expert_id] += tensor.size_bytes;
+            }
+        }
+    }
+}
+
+uint64_t ExpertRouting::getMaskBytes(size_t layer, uint64_t mask) const {
+    uint64_t bytes = 0;
+    const uint64_t* layer_bytes = expert_bytes_.data() + layer * MAX_EXPERTS;
+    while (mask) {
+        bytes += layer_bytes[__builtin_ctzll(mask)];
+        mask &= mask - 1;
+    }
+    return bytes;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class DomainLoader;
+
+// Routed experts of one domain as a dense (token, layer) grid of bitmasks
+//
+// Bit e of a mask is set when any MUL_MAT_ID entry of that token and layer
+// routed to expert e within its top-k (EXPERT_ACCESS_TOP_K, the same
+// experts the DISK accesses resolve to). 0 means the layer had no routed op
+// in that token. Set operations on selections are then single-word ops.
+class ExpertRouting {
+public:
+    static constexpr size_t MAX_EXPERTS = 64;
+
+    ExpertRouting();
+
+    // Tokens that are not ready stay 0; expert bytes need the memory map
+    void build(const DomainLoader& loader);
+    void clear();
+
+    bool empty() const { return masks_.empty(); }
+    size_t getTokenCount() const { return token_count_; }
+    size_t getLayerCount() const { return layer_count_; }
+    size_t getExpertCount() const { return expert_count_; }     // Highest routed expert id + 1
+    // Routed ids a mask cannot hold (negative or >= MAX_EXPERTS), left out of the masks
+    size_t getDroppedIdCount() const { return dropped_ids_; }
+
+    uint64_t getMask(size_t token, size_t layer) const { return masks_[token * layer_count_ + layer]; }
+    const uint64_t* getTokenMasks(size_t token) const { return masks_.data() + token * layer_count_; }
+
+    // File bytes of expert e in a layer (all of its "_exps." slices)
+    uint64_t getExpertBytes(size_t layer, size_t expert) const { return expert_bytes_[layer * MAX_EXPERTS + expert]; }
+    // Bytes of every expert set in mask
+    uint64_t getMaskBytes(size_t layer, uint64_t mask) const;
+
+private:
+    size_t token_count_;
+    size_t layer_count_;
+    size_t expert_count_;
+    size_t dropped_ids_;
+    std::vector<uint64_t> masks_;          // token * layer_count_ + layer
+    std::vector<uint64_t> expert_bytes_;   // layer * MAX_EXPERTS + expert
+};
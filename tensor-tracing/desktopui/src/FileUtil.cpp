@@ -0,0 +1,73 @@
+#include "FileUtil.h"
+#include <algorithm>
+#include <cerrno>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+#ifdef __APPLE__
+using MincoreVector = char*;
+#else
+using MincoreVector = unsigned char*;
+#endif
+}
+
+bool writeAll(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = pwrite(fd, p, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            if (n == 0) {
+                errno = EIO;
+            }
+            return false;
+        }
+        p += n;
+        offset += static_cast<uint64_t>(n);
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+PageCacheMapping::PageCacheMapping()
+    : mapping_(nullptr)
+    , file_size_(0)
+    , page_size_(static_cast<uint64_t>(sysconf(_SC_PAGESIZE)))
+{
+}
+
+PageCacheMapping::~PageCacheMapping() {
+    unmap();
+}
+
+bool PageCacheMapping::map(int fd, uint64_t file_size) {
+    unmap();
+    void* mapping = mmap(nullptr, file_size, PROT_NONE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    mapping_ = mapping;
+    file_size_ = file_size;
+    return true;
+}
+
+void PageCacheMapping::unmap() {
+    if (mapping_) {
+        munmap(mapping_, file_size_);
+        mapping_ = nullptr;
+    }
+    file_size_ = 0;
+}
+
+bool PageCacheMapping::residency(uint64_t first_page, size_t page_count, unsigned char* out) const {
+    const uint64_t offset = first_page * page_size_;
+    if (!mapping_ || offset + page_count * page_size_ > getPageCount() * page_size_) {
+        errno = EINVAL;
+        return false;
+    }
+    const uint64_t length = std::min<uint64_t>(page_count * page_size_, file_size_ - offset);
+    return mincore(static_cast<char*>(mapping_) + offset, length, reinterpret_cast<MincoreVector>(out)) == 0;
+}
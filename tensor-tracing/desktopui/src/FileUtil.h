@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Write all of data at offset with pwrite, retrying short writes and EINTR
+// Returns true on success, false on failure (errno tells why)
+bool writeAll(int fd, const void* data, size_t size, uint64_t offset);
+
+// PROT_NONE mapping of a file, only there so mincore() can see its page cache
+//
+// The mapping is never touched, so asking does not fault anything in. On
+// Linux mincore() reports other processes' page cache only for files the
+// caller owns or may write; otherwise every page reads as resident.
+class PageCacheMapping {
+public:
+    PageCacheMapping();
+    ~PageCacheMapping();
+
+    PageCacheMapping(const PageCacheMapping&) = delete;
+    PageCacheMapping& operator=(const PageCacheMapping&) = delete;
+
+    // Returns true on success, false on failure (errno tells why)
+    bool map(int fd, uint64_t file_size);
+    void unmap();
+
+    bool isMapped() const { return mapping_ != nullptr; }
+    uint64_t getPageSize() const { return page_size_; }
+    uint64_t getPageCount() const { return (file_size_ + page_size_ - 1) / page_size_; }
+
+    // One mincore() byte per page of [first_page, first_page + page_count)
+    // into out, low bit set when resident; false on failure (errno tells why)
+    bool residency(uint64_t first_page, size_t page_count, unsigned char* out) const;
+
+private:
+    void* mapping_;
+    uint64_t file_size_;
+    uint64_t page_size_;
+};
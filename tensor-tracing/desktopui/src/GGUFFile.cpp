@@ -0,0 +1,570 @@
+#include "GGUFFile.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t GGUF_MAGIC = 0x46554747;   // "GGUF" read little-endian
+constexpr uint64_t DEFAULT_ALIGNMENT = 32;
+constexpr size_t READ_CHUNK = 1024 * 1024;
+
+// ggml_type -> elements per block, bytes per block (0: removed or unknown)
+struct TypeTraits {
+    uint32_t block;
+    uint32_t bytes;
+};
+
+constexpr TypeTraits TYPE_TRAITS[] = {
+    {1, 4},      //  0 F32
+    {1, 2},      //  1 F16
+    {32, 18},    //  2 Q4_0
+    {32, 20},    //  3 Q4_1
+    {0, 0},      //  4 (removed)
+    {0, 0},      //  5 (removed)
+    {32, 22},    //  6 Q5_0
+    {32, 24},    //  7 Q5_1
+    {32, 34},    //  8 Q8_0
+    {32, 36},    //  9 Q8_1
+    {256, 84},   // 10 Q2_K
+    {256, 110},  // 11 Q3_K
+    {256, 144},  // 12 Q4_K
+    {256, 176},  // 13 Q5_K
+    {256, 210},  // 14 Q6_K
+    {256, 292},  // 15 Q8_K
+    {256, 66},   // 16 IQ2_XXS
+    {256, 74},   // 17 IQ2_XS
+    {256, 98},   // 18 IQ3_XXS
+    {256, 50},   // 19 IQ1_S
+    {32, 18},    // 20 IQ4_NL
+    {256, 110},  // 21 IQ3_S
+    {256, 82},   // 22 IQ2_S
+    {256, 136},  // 23 IQ4_XS
+    {1, 1},      // 24 I8
+    {1, 2},      // 25 I16
+    {1, 4},      // 26 I32
+    {1, 8},      // 27 I64
+    {1, 8},      // 28 F64
+    {256, 56},   // 29 IQ1_M
+    {1, 2},      // 30 BF16
+    {0, 0},      // 31 (removed)
+    {0, 0},      // 32 (removed)
+    {0, 0},      // 33 (removed)
+    {256, 54},   // 34 TQ1_0
+    {256, 66},   // 35 TQ2_0
+    {0, 0},      // 36 (removed)
+    {0, 0},      // 37 (removed)
+    {0, 0},      // 38 (removed)
+    {32, 17},    // 39 MXFP4
+};
+
+// Sequential little-endian reads through a pread window
+class HeaderReader {
+public:
+    HeaderReader(int fd, uint64_t file_size)
+        : fd_(fd)
+        , file_size_(file_size)
+        , window_start_(0)
+        , position_(0)
+        , ok_(true)
+    {
+    }
+
+    bool ok() const { return ok_; }
+    uint64_t position() const { return position_; }
+
+    bool read(void* out, size_t size) {
+        if (!ensure(size)) {
+            return false;
+        }
+        std::memcpy(out, window_.data() + (position_ - window_start_), size);
+        position_ += size;
+        return true;
+    }
+
+    template <typename T>
+    T value() {
+        T v{};
+        read(&v, sizeof(v));
+        return v;
+    }
+
+    std::string string() {
+        uint64_t length = value<uint64_t>();
+        if (!ok_ || length > file_size_ - position_) {
+            ok_ = false;
+            return std::string();
+        }
+        std::string s(length, '\0');
+        read(s.data(), length);
+        return s;
+    }
+
+    void skip(uint64_t size) {
+        if (size > file_size_ - position_) {
+            ok_ = false;
+            return;
+        }
+        position_ += size;
+    }
+
+private:
+    int fd_;
+    uint64_t file_size_;
+    std::vector<uint8_t> window_;
+    uint64_t window_start_;
+    uint64_t position_;
+    bool ok_;
+
+    bool ensure(size_t size) {
+        if (!ok_) {
+            return false;
+        }
+        if (position_ >= window_start_ && position_ + size <= window_start_ + window_.size()) {
+            return true;
+        }
+        if (size > file_size_ - position_) {
+            ok_ = false;
+            return false;
+        }
+        size_t length = static_cast<size_t>(std::min<uint64_t>(std::max(size, READ_CHUNK), file_size_ - position_));
+        window_.resize(length);
+        size_t done = 0;
+        while (done < length) {
+            ssize_t n = pread(fd_, window_.data() + done, length - done, static_cast<off_t>(position_ + done));
+            if (n <= 0) {
+                ok_ = false;
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        window_start_ = position_;
+        return true;
+    }
+};
+
+size_t scalarSize(GGUFValueType type) {
+    switch (type) {
+        case GGUFValueType::Uint8:
+        case GGUFValueType::Int8:
+        case GGUFValueType::Bool: return 1;
+        case GGUFValueType::Uint16:
+        case GGUFValueType::Int16: return 2;
+        case GGUFValueType::Uint32:
+        case GGUFValueType::Int32:
+        case GGUFValueType::Float32: return 4;
+        case GGUFValueType::Uint64:
+        case GGUFValueType::Int64:
+        case GGUFValueType::Float64: return 8;
+        default: return 0;
+    }
+}
+
+void readScalar(HeaderReader& reader, GGUFKeyValue& kv) {
+    switch (kv.type) {
+        case GGUFValueType::Uint8:
+        case GGUFValueType::Bool: kv.uint_value = reader.value<uint8_t>(); break;
+        case GGUFValueType::Int8: kv.uint_value = static_cast<uint64_t>(static_cast<int64_t>(reader.value<int8_t>())); break;
+        case GGUFValueType::Uint16: kv.uint_value = reader.value<uint16_t>(); break;
+        case GGUFValueType::Int16: kv.uint_value = static_cast<uint64_t>(static_cast<int64_t>(reader.value<int16_t>())); break;
+        case GGUFValueType::Uint32: kv.uint_value = reader.value<uint32_t>(); break;
+        case GGUFValueType::Int32: kv.uint_value = static_cast<uint64_t>(static_cast<int64_t>(reader.value<int32_t>())); break;
+        case GGUFValueType::Uint64: kv.uint_value = reader.value<uint64_t>(); break;
+        case GGUFValueType::Int64: kv.uint_value = static_cast<uint64_t>(reader.value<int64_t>()); break;
+        case GGUFValueType::Float32: kv.float_value = reader.value<float>(); break;
+        case GGUFValueType::Float64: kv.float_value = reader.value<double>(); break;
+        default: break;
+    }
+}
+
+// Component type as llama-gguf-dump labels it, first match wins
+const char* componentTypeOf(const std::string& name) {
+    static const char* const RULES[][2] = {
+        {"attn_q", "Attention Q"},
+        {"attn_k", "Attention K"},
+        {"attn_v", "Attention V"},
+        {"attn_output", "Output Projection"},
+        {"ffn_up", "FFN Up"},
+        {"ffn_down", "FFN Down"},
+        {"ffn_gate", "FFN Gate"},
+        {"attn_norm", "Attention Norm"},
+        {"ffn_norm", "FFN Norm"},
+        {"token_embd", "Token Embeddings"},
+        {"output", "Output Projection"},
+    };
+    for (const auto& rule : RULES) {
+        if (name.find(rule[0]) != std::string::npos) {
+            return rule[1];
+        }
+    }
+    return "Other";
+}
+
+std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// Same rules as categorize_tensor() in tools/parse_csv.py
+std::string categoryOf(const std::string& component_type, const std::string& name) {
+    const std::string component = toLower(component_type);
+    const std::string lower_name = toLower(name);
+    auto has = [](const std::string& s, const char* part) { return s.find(part) != std::string::npos; };
+    if (has(component, "embedding") || has(lower_name, "embd")) {
+        return "embedding";
+    }
+    if (has(component, "attention") || has(lower_name, "attn")) {
+        return "attention";
+    }
+    if (has(component, "ffn") || has(component, "feed_forward")) {
+        return "ffn";
+    }
+    if (has(component, "norm")) {
+        return "norm";
+    }
+    if (has(component, "output")) {
+        return "output";
+    }
+    return "other";
+}
+
+// Same rules as get_component_name() in tools/parse_csv.py
+std::string componentOf(const std::string& component_type) {
+    const std::string component = toLower(component_type);
+    auto has = [&component](const char* part) { return component.find(part) != std::string::npos; };
+    if (has("attention q") || has("attn_q")) {
+        return "query";
+    }
+    if (has("attention k") || has("attn_k")) {
+        return "key";
+    }
+    if (has("attention v") || has("attn_v")) {
+        return "value";
+    }
+    if (has("output projection")) {
+        return "output";
+    }
+    if (has("ffn gate") || has("ffn_gate")) {
+        return "gate";
+    }
+    if (has("ffn up") || has("ffn_up")) {
+        return "up";
+    }
+    if (has("ffn down") || has("ffn_down")) {
+        return "down";
+    }
+    if (has("norm")) {
+        return "norm";
+    }
+    return "other";
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& out, T v) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&v);
+    out.insert(out.end(), bytes, bytes + sizeof(v));
+}
+}
+
+int layerOf(const std::string& name) {
+    if (name.compare(0, 4, "blk.") != 0) {
+        return -1;
+    }
+    return std::atoi(name.c_str() + 4);
+}
+
+GGUFFile::GGUFFile()
+    : fd_(-1)
+    , file_size_(0)
+    , version_(0)
+    , alignment_(DEFAULT_ALIGNMENT)
+    , data_offset_(0)
+    , metadata_begin_(0)
+    , metadata_end_(0)
+{
+}
+
+GGUFFile::~GGUFFile() {
+    close();
+}
+
+bool GGUFFile::open(const std::string& filepath) {
+    close();
+
+    path_ = filepath;
+    fd_ = ::open(filepath.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        last_error_ = "Failed to open file: " + filepath;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        last_error_ = "Failed to stat file: " + filepath;
+        close();
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+
+    HeaderReader reader(fd_, file_size_);
+    const uint32_t magic = reader.value<uint32_t>();
+    version_ = reader.value<uint32_t>();
+    const uint64_t tensor_count = reader.value<uint64_t>();
+    const uint64_t kv_count = reader.value<uint64_t>();
+    if (!reader.ok() || magic != GGUF_MAGIC) {
+        last_error_ = "Not a GGUF file: " + filepath;
+        close();
+        return false;
+    }
+    if (version_ < 2 || version_ > 3) {
+        last_error_ = "Unsupported GGUF version " + std::to_string(version_) + ": " + filepath;
+        close();
+        return false;
+    }
+
+    // Metadata: scalars and strings are decoded, arrays only skipped
+    const uint64_t kv_begin = reader.position();
+    for (uint64_t k = 0; k < kv_count && reader.ok(); k++) {
+        GGUFKeyValue kv;
+        kv.key = reader.string();
+        kv.type = static_cast<GGUFValueType>(reader.value<uint32_t>());
+        if (kv.type == GGUFValueType::String) {
+            kv.string_value = reader.string();
+        } else if (kv.type == GGUFValueType::Array) {
+            kv.array_type = static_cast<GGUFValueType>(reader.value<uint32_t>());
+            kv.array_count = reader.value<uint64_t>();
+            if (kv.array_type == GGUFValueType::String) {
+                for (uint64_t i = 0; i < kv.array_count && reader.ok(); i++) {
+                    reader.skip(reader.value<uint64_t>());
+                }
+            } else if (scalarSize(kv.array_type) != 0 &&
+                       kv.array_count <= (file_size_ - reader.position()) / scalarSize(kv.array_type)) {
+                reader.skip(kv.array_count * scalarSize(kv.array_type));
+            } else {
+                last_error_ = "Unsupported array type in metadata key " + kv.key;
+                close();
+                return false;
+            }
+        } else if (scalarSize(kv.type) != 0) {
+            readScalar(reader, kv);
+        } else {
+            last_error_ = "Unknown metadata type in key " + kv.key;
+            close();
+            return false;
+        }
+        metadata_.push_back(std::move(kv));
+    }
+    const uint64_t kv_end = reader.position();
+
+    for (uint64_t t = 0; t < tensor_count && reader.ok(); t++) {
+        GGUFTensorInfo info;
+        info.name = reader.string();
+        uint32_t n_dims = reader.value<uint32_t>();
+        if (n_dims > 8) {
+            last_error_ = "Bad dimension count for tensor " + info.name;
+            close();
+            return false;
+        }
+        for (uint32_t d = 0; d < n_dims; d++) {
+            info.shape.push_back(reader.value<uint64_t>());
+        }
+        info.type = reader.value<uint32_t>();
+        info.offset = reader.value<uint64_t>();
+        tensors_.push_back(std::move(info));
+    }
+    if (!reader.ok()) {
+        last_error_ = "Truncated GGUF header: " + filepath;
+        close();
+        return false;
+    }
+
+    uint64_t alignment = DEFAULT_ALIGNMENT;
+    if (getUint("general.alignment", alignment) && alignment != 0) {
+        alignment_ = alignment;
+    }
+    data_offset_ = (reader.position() + alignment_ - 1) / alignment_ * alignment_;
+
+    metadata_begin_ = kv_begin;
+    metadata_end_ = kv_end;
+
+    // Sizes by type; unknown types span up to the next tensor
+    std::vector<size_t> by_offset(tensors_.size());
+    std::iota(by_offset.begin(), by_offset.end(), 0);
+    std::sort(by_offset.begin(), by_offset.end(),
+              [this](size_t a, size_t b) { return tensors_[a].offset < tensors_[b].offset; });
+    const uint64_t data_size = file_size_ > data_offset_ ? file_size_ - data_offset_ : 0;
+    for (size_t i = 0; i < by_offset.size(); i++) {
+        GGUFTensorInfo& info = tensors_[by_offset[i]];
+        info.size_bytes = tensorBytes(info.type, info.shape);
+        if (info.size_bytes == 0) {
+            uint64_t next = i + 1 < by_offset.size() ? tensors_[by_offset[i + 1]].offset : data_size;
+            info.size_bytes = next > info.offset ? next - info.offset : 0;
+        }
+        if (info.offset > data_size || info.size_bytes > data_size - info.offset) {
+            last_error_ = "Tensor " + info.name + " extends past the end of " + filepath;
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void GGUFFile::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    path_.clear();
+    fd_ = -1;
+    file_size_ = 0;
+    version_ = 0;
+    alignment_ = DEFAULT_ALIGNMENT;
+    data_offset_ = 0;
+    metadata_begin_ = 0;
+    metadata_end_ = 0;
+    metadata_.clear();
+    tensors_.clear();
+}
+
+const GGUFKeyValue* GGUFFile::findKey(const std::string& key) const {
+    for (const GGUFKeyValue& kv : metadata_) {
+        if (kv.key == key) {
+            return &kv;
+        }
+    }
+    return nullptr;
+}
+
+bool GGUFFile::getString(const std::string& key, std::string& out) const {
+    const GGUFKeyValue* kv = findKey(key);
+    if (kv == nullptr || kv->type != GGUFValueType::String) {
+        return false;
+    }
+    out = kv->string_value;
+    return true;
+}
+
+bool GGUFFile::getUint(const std::string& key, uint64_t& out) const {
+    const GGUFKeyValue* kv = findKey(key);
+    if (kv == nullptr || kv->type == GGUFValueType::String || kv->type == GGUFValueType::Array ||
+        kv->type == GGUFValueType::Float32 || kv->type == GGUFValueType::Float64) {
+        return false;
+    }
+    out = kv->uint_value;
+    return true;
+}
+
+void GGUFFile::buildMemoryMap(MemoryMap& out) const {
+    out = MemoryMap();
+
+    // Named after the file, like parse_csv.py names it after the CSV
+    std::string name = path_.substr(path_.find_last_of('/') + 1);
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".gguf") == 0) {
+        name.resize(name.size() - 5);
+    }
+    out.model_name = name;
+    out.total_size_bytes = 0;
+    out.metadata = MemoryMapMetadata{0, 0, 0, 0};
+
+    for (const GGUFTensorInfo& info : tensors_) {
+        MemoryTensor tensor;
+        tensor.name = info.name;
+        tensor.offset_start = data_offset_ + info.offset;
+        tensor.size_bytes = info.size_bytes;
+        tensor.shape = info.shape;
+        tensor.component_type = componentTypeOf(info.name);
+        tensor.category = categoryOf(tensor.component_type, info.name);
+        tensor.component = componentOf(tensor.component_type);
+        tensor.layer_id = layerOf(info.name);
+        tensor.expert_id = -1;
+
+        if (tensor.layer_id >= 0) {
+            out.metadata.n_layers = std::max(out.metadata.n_layers, tensor.layer_id + 1);
+        }
+        if (info.name.find("token_embd") != std::string::npos && info.shape.size() >= 2) {
+            out.metadata.n_embd = static_cast<int>(info.shape[0]);
+            out.metadata.n_vocab = static_cast<int>(info.shape[1]);
+        }
+
+        // Stacked expert weights: expert e is the e-th run along the last dimension
+        const uint64_t experts = info.shape.size() == 3 ? info.shape[2] : 0;
+        if (info.name.find("_exps.") != std::string::npos && experts > 0) {
+            const uint64_t slice = info.size_bytes / experts;
+            tensor.shape.pop_back();
+            tensor.size_bytes = slice;
+            for (uint64_t e = 0; e < experts; e++) {
+                MemoryTensor expert = tensor;
+                expert.name = info.name + "[" + std::to_string(e) + "]";
+                expert.offset_start = tensor.offset_start + e * slice;
+                expert.offset_end = expert.offset_start + slice;
+                expert.component_type = tensor.component_type + " Expert " + std::to_string(e);
+                expert.expert_id = static_cast<int>(e);
+                out.total_size_bytes = std::max(out.total_size_bytes, expert.offset_end);
+                out.tensors.push_back(std::move(expert));
+            }
+            continue;
+        }
+        tensor.offset_end = tensor.offset_start + tensor.size_bytes;
+        out.total_size_bytes = std::max(out.total_size_bytes, tensor.offset_end);
+        out.tensors.push_back(std::move(tensor));
+    }
+
+    std::stable_sort(out.tensors.begin(), out.tensors.end(), [](const MemoryTensor& a, const MemoryTensor& b) {
+        return a.offset_start < b.offset_start;
+    });
+    out.metadata.n_tensors = static_cast<int>(out.tensors.size());
+}
+
+bool GGUFFile::buildHeader(const std::vector<GGUFTensorInfo>& tensors, std::vector<uint8_t>& out,
+                           uint64_t& out_data_offset) {
+    out.clear();
+    append<uint32_t>(out, GGUF_MAGIC);
+    append<uint32_t>(out, version_);
+    append<uint64_t>(out, tensors.size());
+    append<uint64_t>(out, metadata_.size());
+
+    // Metadata section copied as stored (read here, open() only parses it)
+    const size_t metadata_at = out.size();
+    out.resize(metadata_at + (metadata_end_ - metadata_begin_));
+    size_t done = 0;
+    while (metadata_at + done < out.size()) {
+        ssize_t n = pread(fd_, out.data() + metadata_at + done, out.size() - metadata_at - done,
+                          static_cast<off_t>(metadata_begin_ + done));
+        if (n <= 0) {
+            last_error_ = "Failed to read metadata: " + path_;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    for (const GGUFTensorInfo& info : tensors) {
+        append<uint64_t>(out, info.name.size());
+        out.insert(out.end(), info.name.begin(), info.name.end());
+        append<uint32_t>(out, static_cast<uint32_t>(info.shape.size()));
+        for (uint64_t dim : info.shape) {
+            append<uint64_t>(out, dim);
+        }
+        append<uint32_t>(out, info.type);
+        append<uint64_t>(out, info.offset);
+    }
+    out_data_offset = (out.size() + alignment_ - 1) / alignment_ * alignment_;
+    out.resize(out_data_offset, 0);
+    return true;
+}
+
+uint64_t GGUFFile::tensorBytes(uint32_t type, const std::vector<uint64_t>& shape) {
+    if (type >= sizeof(TYPE_TRAITS) / sizeof(TYPE_TRAITS[0]) || TYPE_TRAITS[type].block == 0 || shape.empty()) {
+        return 0;
+    }
+    const TypeTraits& traits = TYPE_TRAITS[type];
+    if (shape[0] % traits.block != 0) {
+        return 0;
+    }
+    uint64_t bytes = shape[0] / traits.block * traits.bytes;
+    for (size_t d = 1; d < shape.size(); d++) {
+        bytes *= shape[d];
+    }
+    return bytes;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "MemoryMap.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// GGUF metadata value types
+enum class GGUFValueType : uint32_t {
+    Uint8 = 0,
+    Int8 = 1,
+    Uint16 = 2,
+    Int16 = 3,
+    Uint32 = 4,
+    Int32 = 5,
+    Float32 = 6,
+    Bool = 7,
+    String = 8,
+    Array = 9,
+    Uint64 = 10,
+    Int64 = 11,
+    Float64 = 12,
+};
+
+// One metadata key/value (arrays keep only their element type and count)
+struct GGUFKeyValue {
+    std::string key;
+    GGUFValueType type = GGUFValueType::Uint8;
+    uint64_t uint_value = 0;       // Integer and bool types (signed ones sign-extended)
+    double float_value = 0.0;      // Float types
+    std::string string_value;      // String
+    GGUFValueType array_type = GGUFValueType::Uint8;
+    uint64_t array_count = 0;
+};
+
+// One entry of the tensor-info section
+struct GGUFTensorInfo {
+    std::string name;
+    std::vector<uint64_t> shape;   // ne[0] first (fastest varying)
+    uint32_t type = 0;             // ggml_type
+    uint64_t offset = 0;           // Relative to the data section
+    uint64_t size_bytes = 0;
+};
+
+// Block of a tensor name: "blk.12.attn_q.weight" -> 12, -1 outside the blocks
+int layerOf(const std::string& name);
+
+// Header of a GGUF model file (v2/v3), read with pread only
+//
+// Parses the key/value metadata and the tensor-info section; tensor data is
+// never touched. Tensor sizes come from the ggml block size of each type, or
+// from the gap to the next tensor for types this table does not know. The
+// metadata section's extent is kept so a rewriter can copy it verbatim.
+//
+// buildMemoryMap() derives the same MemoryMap tools/parse_csv.py produces
+// from a llama-gguf-dump CSV, without running either.
+class GGUFFile {
+public:
+    GGUFFile();
+    ~GGUFFile();
+
+    GGUFFile(const GGUFFile&) = delete;
+    GGUFFile& operator=(const GGUFFile&) = delete;
+
+    // Returns true on success, false on failure (see getLastError)
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    int getFd() const { return fd_; }
+    uint64_t getFileSize() const { return file_size_; }
+    uint32_t getVersion() const { return version_; }
+    uint64_t getAlignment() const { return alignment_; }
+    uint64_t getDataOffset() const { return data_offset_; }   // Absolute start of tensor data
+
+    const std::vector<GGUFKeyValue>& getMetadata() const { return metadata_; }
+    const GGUFKeyValue* findKey(const std::string& key) const;
+    bool getString(const std::string& key, std::string& out) const;
+    bool getUint(const std::string& key, uint64_t& out) const;
+
+    const std::vector<GGUFTensorInfo>& getTensors() const { return tensors_; }
+
+    // Memory map with absolute offsets, sorted by offset: one entry per tensor,
+    // and one per expert for "_exps" tensors (split along their last dimension)
+    void buildMemoryMap(MemoryMap& out) const;
+
+    // Serialize a header with this file's metadata and the given tensor infos
+    // (in that order), padded to the alignment; data_offset is where tensor
+    // data starts in the result. Returns false if the metadata can't be read.
+    bool buildHeader(const std::vector<GGUFTensorInfo>& tensors, std::vector<uint8_t>& out,
+                     uint64_t& out_data_offset);
+
+    const std::string& getLastError() const { return last_error_; }
+
+    // Bytes of a tensor of a ggml type, 0 for unknown types
+    static uint64_t tensorBytes(uint32_t type, const std::vector<uint64_t>& shape);
+
+private:
+    std::string path_;
+    int fd_;
+    uint64_t file_size_;
+    uint32_t version_;
+    uint64_t alignment_;
+    uint64_t data_offset_;
+    std::vector<GGUFKeyValue> metadata_;
+    uint64_t metadata_begin_;             // Key/value section as stored
+    uint64_t metadata_end_;
+    std::vector<GGUFTensorInfo> tensors_;
+    std::string last_error_;
+};
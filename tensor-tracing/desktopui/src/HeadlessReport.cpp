@@ -0,0 +1,515 @@
+#include "HeadlessReport.h"
+#include "ExpertPredictor.h"
+#include "StripRaster.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sys/stat.h>
+
+using json = nlohmann::json;
+
+thread_local std::string HeadlessReport::last_error_;
+
+namespace {
+struct Rgb {
+    uint8_t r, g, b;
+};
+
+// Same colors as the GUI: gray-700 for unaccessed, ImPlot's viridis stops, graph blue
+const Rgb UNACCESSED_COLOR = {55, 65, 81};
+const Rgb BACKGROUND_COLOR = {26, 26, 26};
+const Rgb GRAPH_COLOR = {51, 128, 204};
+const Rgb VIRIDIS[] = {
+    {68, 1, 84}, {72, 36, 117}, {65, 68, 135}, {53, 95, 141}, {42, 120, 142}, {33, 145, 140},
+    {34, 168, 132}, {68, 191, 112}, {122, 209, 81}, {189, 223, 38}, {253, 231, 37},
+};
+constexpr int VIRIDIS_STOPS = sizeof(VIRIDIS) / sizeof(VIRIDIS[0]);
+
+Rgb sampleViridis(float t) {
+    t = std::min(std::max(t, 0.0f), 1.0f) * (VIRIDIS_STOPS - 1);
+    int i = std::min(static_cast<int>(t), VIRIDIS_STOPS - 2);
+    float f = t - i;
+    const Rgb& a = VIRIDIS[i];
+    const Rgb& b = VIRIDIS[i + 1];
+    return {static_cast<uint8_t>(a.r + (b.r - a.r) * f + 0.5f),
+            static_cast<uint8_t>(a.g + (b.g - a.g) * f + 0.5f),
+            static_cast<uint8_t>(a.b + (b.b - a.b) * f + 0.5f)};
+}
+
+// StripRaster level -> color (level 0 = unaccessed)
+Rgb levelColor(uint8_t level) {
+    if (level == 0) {
+        return UNACCESSED_COLOR;
+    }
+    return sampleViridis(static_cast<float>(level - 1) / static_cast<float>(StripRaster::LEVELS - 2));
+}
+
+// RGB image written as binary PPM
+class Image {
+public:
+    Image(int width, int height, Rgb fill)
+        : width_(width)
+        , height_(height)
+        , pixels_(static_cast<size_t>(width) * height * 3)
+    {
+        fillRect(0, 0, width, height, fill);
+    }
+
+    void fillRect(int x, int y, int w, int h, Rgb color) {
+        for (int row = std::max(y, 0); row < std::min(y + h, height_); row++) {
+            uint8_t* p = pixels_.data() + (static_cast<size_t>(row) * width_ + std::max(x, 0)) * 3;
+            for (int col = std::max(x, 0); col < std::min(x + w, width_); col++) {
+                *p++ = color.r;
+                *p++ = color.g;
+                *p++ = color.b;
+            }
+        }
+    }
+
+    bool writePPM(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << "P6\n" << width_ << " " << height_ << "\n255\n";
+        file.write(reinterpret_cast<const char*>(pixels_.data()), static_cast<std::streamsize>(pixels_.size()));
+        return file.good();
+    }
+
+private:
+    int width_;
+    int height_;
+    std::vector<uint8_t> pixels_;
+};
+
+bool makeDirectory(const std::string& path) {
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+}
+
+HeadlessReport::HeadlessReport(const HeadlessOptions& options)
+    : options_(options)
+{
+}
+
+bool HeadlessReport::writeDomain(const std::string& domain_name, const std::string& domain_path,
+                                 const DomainLoader& loader) const {
+    if (!loader.isMemoryMapReady()) {
+        last_error_ = domain_name + ": memory map not loaded";
+        return false;
+    }
+
+    const std::string dir = options_.output_dir + "/" + domain_name;
+    if (!makeDirectory(options_.output_dir) || !makeDirectory(dir)) {
+        last_error_ = "Failed to create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const MemoryMap& map = loader.getMemoryMap();
+    const TensorIndex& index = loader.getTensorIndex();
+    const std::vector<uint32_t>& accumulated = loader.getAccumulatedCounts();
+    const uint32_t max_accumulated = loader.getMaxAccumulatedCount();
+    const int width = std::max(options_.width, 1);
+
+    // Colored strip over the whole file (hottest tensor per column, as in the GUI)
+    StripRaster raster;
+    raster.update(map, index, accumulated, max_accumulated, 0, map.total_size_bytes, width, StripRaster::Reduce::Max);
+
+    Image strip(width, options_.strip_height, BACKGROUND_COLOR);
+    for (int x = 0; x < raster.getWidth(); x++) {
+        strip.fillRect(x, 0, 1, options_.strip_height, levelColor(raster.getLevels()[x]));
+    }
+
+    // Accumulated graph: filled column max, bottom-up
+    Image graph(width, options_.graph_height, BACKGROUND_COLOR);
+    for (int x = 0; x < raster.getWidth() && max_accumulated > 0; x++) {
+        int h = static_cast<int>(static_cast<double>(raster.getBins()[x]) / max_accumulated * options_.graph_height + 0.5);
+        graph.fillRect(x, options_.graph_height - h, 1, h, GRAPH_COLOR);
+    }
+
+    // Per-token counts (kept so every row shares one color scale)
+    const size_t token_count = loader.getTokenCount();
+    std::vector<std::vector<uint32_t>> token_counts(token_count);
+    uint32_t max_token_count = 0;
+    json per_token = json::array();
+    size_t entry_count = 0;
+    for (size_t t = 0; t < token_count; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        token_counts[t].assign(map.tensors.size(), 0);
+        store.countAccesses(store.size(), token_counts[t]);
+        entry_count += store.size();
+
+        uint64_t total = 0;
+        uint32_t max_count = 0;
+        for (uint32_t count : token_counts[t]) {
+            total += count;
+            max_count = std::max(max_count, count);
+        }
+        max_token_count = std::max(max_token_count, max_count);
+        per_token.push_back({{"token", t}, {"entries", store.size()}, {"accesses", total}, {"max_count", max_count}});
+    }
+
+    const int row_height = std::max(options_.token_row_height, 1);
+    Image tokens(width, std::max<int>(static_cast<int>(token_count) * row_height, 1), BACKGROUND_COLOR);
+    for (size_t t = 0; t < token_count; t++) {
+        if (token_counts[t].empty()) {
+            continue;
+        }
+        raster.invalidate();
+        raster.update(map, index, token_counts[t], max_token_count, 0, map.total_size_bytes, width, StripRaster::Reduce::Max);
+        for (int x = 0; x < raster.getWidth(); x++) {
+            tokens.fillRect(x, static_cast<int>(t) * row_height, 1, row_height, levelColor(raster.getLevels()[x]));
+        }
+    }
+
+    // Per-layer totals (layer -1 = tensors outside the blocks)
+    std::map<int, std::pair<uint64_t, uint64_t>> layers;  // layer -> (accesses, bytes read)
+    uint64_t total_accesses = 0;
+    size_t tensors_accessed = 0;
+    size_t hottest = TensorIndex::NO_TENSOR;
+    for (size_t i = 0; i < map.tensors.size() && i < accumulated.size(); i++) {
+        uint32_t count = accumulated[i];
+        if (count == 0) {
+            continue;
+        }
+        total_accesses += count;
+        tensors_accessed++;
+        if (hottest == TensorIndex::NO_TENSOR || count > accumulated[hottest]) {
+            hottest = i;
+        }
+        auto& layer = layers[map.tensors[i].layer_id];
+        layer.first += count;
+        layer.second += static_cast<uint64_t>(count) * map.tensors[i].size_bytes;
+    }
+
+    json per_layer = json::array();
+    for (const auto& layer : layers) {
+        per_layer.push_back({{"layer", layer.first}, {"accesses", layer.second.first}, {"bytes", layer.second.second}});
+    }
+
+    json summary;
+    summary["domain"] = domain_name;
+    summary["domain_path"] = domain_path;
+    summary["model_name"] = map.model_name;
+    summary["total_size_bytes"] = map.total_size_bytes;
+    summary["tensor_count"] = map.tensors.size();
+    summary["token_count"] = token_count;
+    summary["tokens_loaded"] = loader.getLoadedCount();
+    summary["tokens_failed"] = loader.getFailedCount();
+    summary["entry_count"] = entry_count;
+    summary["disk_accesses"] = total_accesses;
+    summary["tensors_accessed"] = tensors_accessed;
+    summary["max_accumulated_count"] = max_accumulated;
+    summary["max_token_count"] = max_token_count;
+    summary["hottest_tensor"] = hottest != TensorIndex::NO_TENSOR ? map.tensors[hottest].name : "";
+    summary["per_layer"] = per_layer;
+    summary["per_token"] = per_token;
+    summary["images"] = {{"strip", "strip.ppm"}, {"accumulated", "accumulated.ppm"}, {"tokens", "tokens.ppm"}};
+
+    if (!strip.writePPM(dir + "/strip.ppm") || !graph.writePPM(dir + "/accumulated.ppm") ||
+        !tokens.writePPM(dir + "/tokens.ppm")) {
+        last_error_ = "Failed to write images to " + dir;
+        return false;
+    }
+
+    std::ofstream file(dir + "/summary.json");
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + dir + "/summary.json";
+        return false;
+    }
+    file << summary.dump(2) << std::endl;
+    return true;
+}
+
+bool HeadlessReport::writeCacheSim(const std::string& domain_name, const CacheSimulation& simulation) const {
+    const std::string dir = options_.output_dir + "/" + domain_name;
+    if (!makeDirectory(options_.output_dir) || !makeDirectory(dir)) {
+        last_error_ = "Failed to create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const PageStream& stream = simulation.getStream();
+    const size_t page_size = simulation.getConfig().page_size;
+
+    auto statsJson = [page_size](const CacheSimStats& stats) {
+        return json{{"accesses", stats.accesses}, {"hits", stats.hits}, {"hit_ratio", stats.hitRatio()},
+                    {"cold_misses", stats.cold_misses}, {"capacity_misses", stats.capacity_misses},
+                    {"bytes_read", stats.misses() * page_size}};
+    };
+
+    json runs = json::array();
+    for (const CacheSimResult& result : simulation.getResults()) {
+        json per_layer = json::array();
+        for (size_t slot = 0; slot < result.per_layer.size(); slot++) {
+            if (result.per_layer[slot].accesses > 0) {
+                json layer = statsJson(result.per_layer[slot]);
+                layer["layer"] = PageStream::layerSlotName(slot);
+                per_layer.push_back(layer);
+            }
+        }
+        json per_token = json::array();
+        for (const CacheSimStats& stats : result.per_token) {
+            per_token.push_back(statsJson(stats));
+        }
+
+        json run = statsJson(result.total);
+        run["policy"] = cachePolicyName(result.policy);
+        run["budget_bytes"] = result.budget_bytes;
+        run["capacity_pages"] = result.capacity_pages;
+        run["per_layer"] = per_layer;
+        run["per_token"] = per_token;
+        runs.push_back(run);
+    }
+
+    // Belady MIN at the same budgets
+    json optimal = json::array();
+    const OptimalCurve& curve = simulation.getOptimal();
+    if (!curve.empty()) {
+        for (uint64_t budget : simulation.getConfig().budgets_bytes) {
+            json point = statsJson(curve.getStats(std::max<uint64_t>(budget / page_size, 1)));
+            point["budget_bytes"] = budget;
+            optimal.push_back(point);
+        }
+    }
+
+    json report;
+    report["domain"] = domain_name;
+    report["page_size"] = page_size;
+    report["file_pages"] = stream.getPageCount();
+    report["page_accesses"] = stream.getAccessCount();
+    report["distinct_pages"] = stream.getDistinctPageCount();
+    report["runs"] = runs;
+    report["optimal"] = optimal;
+
+    std::ofstream file(dir + "/cache-sim.json");
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + dir + "/cache-sim.json";
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
+
+bool HeadlessReport::writeReuse(const std::string& domain_name, const ReuseAnalysis& analysis) const {
+    const std::string dir = options_.output_dir + "/" + domain_name;
+    if (!makeDirectory(options_.output_dir) || !makeDirectory(dir)) {
+        last_error_ = "Failed to create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // Bins are trimmed after the last non-empty one
+    auto histogramJson = [](const ReuseHistogram& histogram) {
+        size_t used = ReuseHistogram::BIN_COUNT;
+        while (used > 0 && histogram.bins[used - 1] == 0) {
+            used--;
+        }
+        return json{{"references", histogram.references}, {"cold", histogram.cold},
+                    {"bins_log2_bytes", std::vector<uint64_t>(histogram.bins.begin(), histogram.bins.begin() + used)}};
+    };
+
+    json granularities = json::array();
+    for (size_t g = 0; g < REUSE_GRANULARITY_COUNT; g++) {
+        const ReuseProfile& profile = analysis.getProfile(static_cast<ReuseGranularity>(g));
+        json per_token = json::array();
+        for (const ReuseHistogram& histogram : profile.per_token) {
+            per_token.push_back(histogramJson(histogram));
+        }
+        json working_sets = json::array();
+        for (size_t w = 0; w < profile.wss.size(); w++) {
+            working_sets.push_back({{"window_tokens", profile.window_tokens[w]}, {"bytes", profile.wss[w]}});
+        }
+
+        json entry;
+        entry["granularity"] = reuseGranularityName(profile.granularity);
+        entry["unit_count"] = profile.unit_count;
+        entry["footprint_bytes"] = profile.footprint_bytes;
+        entry["total"] = histogramJson(profile.total);
+        entry["per_token"] = per_token;
+        entry["working_sets"] = working_sets;
+        granularities.push_back(entry);
+    }
+
+    json report;
+    report["domain"] = domain_name;
+    report["granularities"] = granularities;
+
+    std::ofstream file(dir + "/reuse.json");
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + dir + "/reuse.json";
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
+
+bool HeadlessReport::writeExperts(const std::string& domain_name, const DomainLoader& loader,
+                                  const ExpertActivity& activity) const {
+    const std::string dir = options_.output_dir + "/" + domain_name;
+    if (!makeDirectory(options_.output_dir) || !makeDirectory(dir)) {
+        last_error_ = "Failed to create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    auto statsJson = [](const ExpertPredictionStats& stats) {
+        return json{{"predictions", stats.predictions},
+                    {"predicted", stats.predicted},
+                    {"actual", stats.actual},
+                    {"hits", stats.hits},
+                    {"precision", stats.precision()},
+                    {"recall", stats.recall()},
+                    {"bytes_prefetched", stats.bytes_prefetched},
+                    {"bytes_needed", stats.bytes_needed},
+                    {"bytes_useful", stats.bytes_useful}};
+    };
+
+    const ExpertRouting& routing = loader.getExpertRouting();
+    json predictors = json::array();
+    for (size_t p = 0; p < EXPERT_PREDICTOR_COUNT && !routing.empty(); p++) {
+        ExpertPredictionResult result;
+        evaluateExpertPredictor(routing, static_cast<ExpertPredictorKind>(p), EXPERT_ACCESS_TOP_K, result);
+        json per_layer = json::array();
+        for (const ExpertPredictionStats& stats : result.per_layer) {
+            per_layer.push_back(statsJson(stats));
+        }
+
+        json entry;
+        entry["predictor"] = expertPredictorName(result.kind);
+        entry["top_k"] = result.top_k;
+        entry["total"] = statsJson(result.total);
+        entry["per_layer"] = per_layer;
+        predictors.push_back(entry);
+    }
+
+    json report;
+    report["domain"] = domain_name;
+    report["tokens"] = routing.getTokenCount();
+    report["layers"] = routing.getLayerCount();
+    report["experts"] = routing.getExpertCount();
+    report["dropped_expert_ids"] = routing.getDroppedIdCount();
+    report["predictors"] = predictors;
+
+    // Rows are layers, columns experts
+    json frequency = json::array();
+    for (size_t layer = 0; layer < activity.layer_count; layer++) {
+        auto row = activity.frequency.begin() + layer * activity.expert_count;
+        frequency.push_back(std::vector<uint32_t>(row, row + activity.expert_count));
+    }
+    report["frequency"] = frequency;
+    report["layer_jaccard"] = activity.layer_jaccard;
+    report["token_jaccard"] = activity.token_jaccard;
+    report["mean_autocorrelation"] = activity.mean_autocorrelation;
+
+    std::ofstream file(dir + "/experts.json");
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + dir + "/experts.json";
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
+
+bool HeadlessReport::writeExpertSimilarity(const std::vector<std::string>& domain_names,
+                                           const ExpertCube& cube) const {
+    if (!makeDirectory(options_.output_dir)) {
+        last_error_ = "Failed to create " + options_.output_dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const size_t domains = cube.getDomainCount();
+    json mean = json::array();
+    for (size_t a = 0; a < domains; a++) {
+        json row = json::array();
+        for (size_t b = 0; b < domains; b++) {
+            row.push_back(cube.getSimilarity(a, b));
+        }
+        mean.push_back(row);
+    }
+    json per_layer = json::array();
+    for (size_t layer = 0; layer < cube.getLayerCount(); layer++) {
+        json matrix = json::array();
+        for (size_t a = 0; a < domains; a++) {
+            json row = json::array();
+            for (size_t b = 0; b < domains; b++) {
+                row.push_back(cube.getLayerSimilarity(layer, a, b));
+            }
+            matrix.push_back(row);
+        }
+        per_layer.push_back(matrix);
+    }
+
+    json report;
+    report["domains"] = domain_names;
+    report["similarity"] = mean;
+    report["per_layer"] = per_layer;
+
+    const std::string path = options_.output_dir + "/expert-similarity.json";
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + path;
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
+
+bool HeadlessReport::writeLayout(const std::string& domain_name, const DomainLoader& loader,
+                                 const LayoutOptimizer& optimizer) const {
+    const std::string dir = options_.output_dir + "/" + domain_name;
+    if (!makeDirectory(options_.output_dir) || !makeDirectory(dir)) {
+        last_error_ = "Failed to create " + dir + ": " + std::strerror(errno);
+        return false;
+    }
+
+    const MemoryMap& map = loader.getMemoryMap();
+    const SsdModel& ssd = optimizer.getConfig().ssd;
+    json layouts = json::array();
+    for (size_t o = 0; o < LAYOUT_ORDER_COUNT; o++) {
+        const TensorLayout& layout = optimizer.getLayout(static_cast<LayoutOrder>(o));
+        const LayoutScore& score = layout.score;
+
+        // Offset table in file order (expert slices keep their "[e]" names)
+        json tensors = json::array();
+        for (uint32_t tensor : layout.file_order) {
+            tensors.push_back({{"name", map.tensors[tensor].name}, {"offset_start", layout.offsets[tensor]},
+                               {"size_bytes", map.tensors[tensor].size_bytes}});
+        }
+
+        json entry;
+        entry["order"] = layoutOrderName(layout.order);
+        entry["accesses"] = score.accesses;
+        entry["seeks"] = score.seeks;
+        entry["seek_bytes"] = score.seek_bytes;
+        entry["bytes_read"] = score.bytes_read;
+        entry["read_ms"] = score.read_ms;
+        entry["mean_extents_per_token"] = score.meanExtents();
+        entry["max_extents_per_token"] = score.maxExtents();
+        entry["extents_per_token"] = score.extents_per_token;
+        entry["read_ms_per_token"] = score.read_ms_per_token;
+        entry["tensors"] = tensors;
+        layouts.push_back(entry);
+    }
+
+    json report;
+    report["domain"] = domain_name;
+    report["ssd_model"] = {{"read_latency_us", ssd.read_latency_us},
+                           {"bandwidth_gb_s", ssd.bandwidth_gb_s},
+                           {"queue_depth", ssd.queue_depth},
+                           {"max_request_bytes", ssd.max_request_bytes}};
+    report["alignment"] = optimizer.getConfig().alignment;
+    report["merge_gap_bytes"] = optimizer.getConfig().merge_gap_bytes;
+    report["layouts"] = layouts;
+
+    std::ofstream file(dir + "/layout.json");
+    if (!file.is_open()) {
+        last_error_ = "Failed to write " + dir + "/layout.json";
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
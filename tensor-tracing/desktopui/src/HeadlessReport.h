@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CacheSimulation.h"
+#include "DomainLoader.h"
+#include "ExpertCube.h"
+#include "LayoutOptimizer.h"
+#include "ReuseAnalysis.h"
+#include <string>
+#include <vector>
+
+// Output settings for --headless
+struct HeadlessOptions {
+    std::string output_dir = "headless-out";
+    int width = 1600;             // Image width (one column per file slice)
+    int strip_height = 48;        // Colored strip
+    int graph_height = 320;       // Accumulated access graph
+    int token_row_height = 4;     // Per-token heatmap: pixels per token row
+    bool cache_sim = false;       // Also replay the page cache simulation (--cache-sim)
+    bool reuse = false;           // Also write reuse distances / working sets (--reuse)
+    bool experts = false;         // Also score the expert predictors (--experts)
+    bool layout = false;          // Also propose and score tensor layouts (--layout)
+};
+
+// CPU-only figures and summary for one loaded domain (no window, no GL)
+//
+// Writes into <output_dir>/<domain_name>/:
+//   strip.ppm        accumulated counts as the GUI colored strip (gray + viridis)
+//   accumulated.ppm  accumulated counts as a filled per-column max graph
+//   tokens.ppm       one strip row per token, scaled to the hottest token
+//   summary.json     counts, maximums, per-layer and per-token totals
+//   cache-sim.json   page cache replay per policy and budget + OPT (with --cache-sim)
+//   reuse.json       reuse-distance histograms and working sets (with --reuse)
+//   experts.json     expert predictor scores and routing statistics (with --experts)
+//   layout.json      candidate tensor orders, scores and offset tables (with --layout)
+// Images are binary PPM (P6), which any image tool converts to PNG.
+class HeadlessReport {
+public:
+    explicit HeadlessReport(const HeadlessOptions& options);
+
+    // Loader must be finished; safe to call for distinct domains in parallel
+    bool writeDomain(const std::string& domain_name, const std::string& domain_path,
+                     const DomainLoader& loader) const;
+
+    // Simulation must be finished; writes <output_dir>/<domain_name>/cache-sim.json
+    bool writeCacheSim(const std::string& domain_name, const CacheSimulation& simulation) const;
+
+    // Analysis must be finished; writes <output_dir>/<domain_name>/reuse.json
+    bool writeReuse(const std::string& domain_name, const ReuseAnalysis& analysis) const;
+
+    // Loader must be finished; scores every predictor at the default top-k and
+    // writes them with the domain's routing statistics to
+    // <output_dir>/<domain_name>/experts.json
+    bool writeExperts(const std::string& domain_name, const DomainLoader& loader,
+                      const ExpertActivity& activity) const;
+
+    // Optimizer must be finished; writes <output_dir>/<domain_name>/layout.json
+    bool writeLayout(const std::string& domain_name, const DomainLoader& loader,
+                     const LayoutOptimizer& optimizer) const;
+
+    // Domain x domain similarity of expert shares; <output_dir>/expert-similarity.json
+    bool writeExpertSimilarity(const std::vector<std::string>& domain_names, const ExpertCube& cube) const;
+
+    // Get last error message (per thread, domains are written on worker threads)
+    static const std::string& getLastError() { return last_error_; }
+
+private:
+    HeadlessOptions options_;
+
+    static thread_local std::string last_error_;
+};
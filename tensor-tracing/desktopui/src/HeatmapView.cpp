@@ -4,23 +4,38 @@
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <cstdint>
 
 HeatmapView::HeatmapView()
     : memory_map_(nullptr)
+    , tensor_index_(nullptr)
     , trace_data_(nullptr)
     , zoom_level_(10.0f)  // Default: 10 pixels per MB
     , scroll_offset_(0.0f)
     , canvas_height_(30.0f)
     , current_time_ms_(0.0f)
     , max_time_ms_(0.0f)
+    , counted_entry_end_(SIZE_MAX)
     , max_access_count_(0)
+    , strip_reduce_(StripRaster::Reduce::Max)
+    , strip_colormap_(-1)
+    , residency_(nullptr)
+    , show_residency_(true)
+    , residency_valid_(false)
+    , residency_shown_(false)
+    , residency_begin_(0)
+    , residency_end_(0)
+    , resident_bytes_(0)
+    , residency_colormap_(-1)
     , hovered_tensor_(nullptr)
 {
 }
 
-void HeatmapView::setMemoryMap(const MemoryMap* map) {
+void HeatmapView::setMemoryMap(const MemoryMap* map, const TensorIndex* index) {
     memory_map_ = map;
+    tensor_index_ = index;
     if (memory_map_ && trace_data_) {
+        calculateMaxAccessCount();
         calculateAccessCounts();
     }
 }
@@ -42,98 +57,75 @@ void HeatmapView::setTraceData(const TraceData* data) {
     }
 }
 
-void HeatmapView::calculateMaxAccessCount() {
-    max_access_count_ = 0;
-
-    if (!trace_data_ || !memory_map_) {
-        return;
+void HeatmapView::setResidency(const PageResidency* residency) {
+    if (residency && !residency->isLoaded()) {
+        residency = nullptr;
+    }
+    if (residency != residency_) {
+        residency_ = residency;
+        residency_valid_ = false;
     }
+}
 
-    // Temporary map to count accesses from FULL timeline
-    std::map<std::string, uint32_t> full_counts;
+bool HeatmapView::updateResidency() {
+    if (!show_residency_ || !residency_ || !trace_data_) {
+        return false;
+    }
 
-    // Initialize
-    for (const auto& tensor : memory_map_->tensors) {
-        full_counts[tensor.name] = 0;
+    // Trace timestamps and residency records share the tracer's clock
+    const int64_t time_ns = static_cast<int64_t>(trace_data_->metadata.timestamp_start_ns) +
+                            static_cast<int64_t>(static_cast<double>(current_time_ms_) * 1e6);
+    const size_t record = residency_->recordAt(time_ns);
+    if (record == SIZE_MAX) {
+        return false;
     }
+    if (!residency_valid_ || record != residency_cursor_.getRecord()) {
+        residency_cursor_.seek(*residency_, record);
+        resident_bytes_ = residency_cursor_.residentBytes(0, residency_->getFileSize());
+        residency_levels_.clear();
+        residency_valid_ = true;
+    }
+    return true;
+}
 
-    // Count ALL entries (full timeline, no time filtering)
-    for (const auto& entry : trace_data_->entries) {
-        for (const auto& source : entry.sources) {
-            if (source.memory_source != "DISK") {
-                continue;
-            }
+void HeatmapView::calculateMaxAccessCount() {
+    max_access_count_ = 0;
+    checkpoints_.clear();
+    counted_entry_end_ = SIZE_MAX;
+    strip_raster_.invalidate();
+    access_graph_.invalidate();
 
-            bool is_expert_tensor = source.name.find("_exps.weight") != std::string::npos ||
-                                   source.name.find("_exps.bias") != std::string::npos;
-
-            if (is_expert_tensor && !entry.expert_ids.empty()) {
-                size_t top_k = std::min(size_t(4), entry.expert_ids.size());
-                for (size_t i = 0; i < top_k; i++) {
-                    int expert_id = entry.expert_ids[i];
-                    std::string expert_tensor_name = source.name + "[" + std::to_string(expert_id) + "]";
-                    full_counts[expert_tensor_name]++;
-                }
-            } else {
-                full_counts[source.name]++;
-            }
-        }
+    if (!trace_data_ || !memory_map_) {
+        return;
     }
 
-    // Find the maximum
-    for (const auto& pair : full_counts) {
-        if (pair.second > max_access_count_) {
-            max_access_count_ = pair.second;
-        }
-    }
+    // One pass over the FULL timeline: snapshots for scrubbing + the fixed max
+    checkpoints_.build(trace_data_->entries, memory_map_->tensors.size());
+    max_access_count_ = checkpoints_.getMaxCount();
 }
 
 void HeatmapView::calculateAccessCounts() {
-    access_counts_.clear();
     // DO NOT reset max_access_count_ here! It's fixed from full timeline
-
     if (!trace_data_ || !memory_map_) {
+        access_counts_.clear();
+        counted_entry_end_ = SIZE_MAX;
+        strip_raster_.invalidate();
+        access_graph_.invalidate();
         return;
     }
 
-    // Initialize all memory map tensors with 0 count
-    for (const auto& tensor : memory_map_->tensors) {
-        access_counts_[tensor.name] = 0;
+    // Only count entries that happened before current_time_ms_ (temporal filtering)
+    // Slider moves that stay between the same two entries change nothing
+    size_t entry_end = checkpoints_.entryEndAt(current_time_ms_);
+    if (entry_end == counted_entry_end_) {
+        return;
     }
 
-    // Count how many times each tensor is accessed UP TO current timeline position
-    for (const auto& entry : trace_data_->entries) {
-        // Only count entries that happened before current_time_ms_ (temporal filtering)
-        if (entry.timestamp_relative_ms > current_time_ms_) {
-            break;  // Entries are sorted by time, so we can stop here
-        }
-
-        // Count DISK accesses only (not runtime buffers)
-        for (const auto& source : entry.sources) {
-            if (source.memory_source != "DISK") {
-                continue;  // Skip buffer accesses
-            }
-
-            // Check if this is an expert tensor (contains "_exps.weight" or "_exps.bias")
-            bool is_expert_tensor = source.name.find("_exps.weight") != std::string::npos ||
-                                   source.name.find("_exps.bias") != std::string::npos;
-
-            if (is_expert_tensor && !entry.expert_ids.empty()) {
-                // For expert tensors: count access for each expert used
-                // Use top-4 experts only (like WebUI)
-                size_t top_k = std::min(size_t(4), entry.expert_ids.size());
-                for (size_t i = 0; i < top_k; i++) {
-                    int expert_id = entry.expert_ids[i];
-                    // Build expert tensor name: "blk.0.ffn_down_exps.weight[0]"
-                    std::string expert_tensor_name = source.name + "[" + std::to_string(expert_id) + "]";
-                    access_counts_[expert_tensor_name]++;
-                }
-            } else {
-                // Normal tensor access (non-expert)
-                access_counts_[source.name]++;
-            }
-        }
-    }
+    // Nearest snapshot + at most one interval of resolved DISK accesses
+    checkpoints_.countsAt(entry_end, access_counts_);
+    counted_entry_end_ = entry_end;
+    strip_raster_.invalidate();
+    access_graph_.invalidate();
 
     // max_access_count_ stays fixed (from calculateMaxAccessCount)
 }
@@ -164,6 +156,15 @@ void HeatmapView::render() {
     // Render timeline widget
     renderTimelineWidget();
 
+    // Page cache at the timeline position (after the slider, so the band follows it this frame)
+    residency_shown_ = updateResidency();
+    if (residency_shown_) {
+        const double sample_ms = (residency_->getRecordTraceNs(residency_cursor_.getRecord()) -
+                                  static_cast<int64_t>(trace_data_->metadata.timestamp_start_ns)) / 1e6;
+        ImGui::Text("Page cache: %.2f GB resident (sampled at %.1f ms%s)", resident_bytes_ / (1024.0 * 1024.0 * 1024.0),
+                    sample_ms, residency_->hasTraceBase() ? "" : ", unaligned");
+    }
+
     ImGui::Separator();
 
     // Render heatmap canvas
@@ -186,6 +187,23 @@ void HeatmapView::renderControls() {
     }
 
     ImGui::Text("%.0f pixels/MB", zoom_level_);
+
+    // How tensors sharing one pixel of the strip are combined
+    ImGui::Text("Strip:");
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Max", strip_reduce_ == StripRaster::Reduce::Max)) {
+        strip_reduce_ = StripRaster::Reduce::Max;
+    }
+    ImGui::SameLine();
+    if (ImGui::RadioButton("Sum", strip_reduce_ == StripRaster::Reduce::Sum)) {
+        strip_reduce_ = StripRaster::Reduce::Sum;
+    }
+
+    // Band under the strip: dark = not in the page cache, green = resident
+    if (residency_) {
+        ImGui::SameLine();
+        ImGui::Checkbox("Page cache", &show_residency_);
+    }
 }
 
 void HeatmapView::renderTimelineWidget() {
@@ -239,50 +257,47 @@ void HeatmapView::renderColoredStrip() {
         ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, max_gb, ImGuiCond_Once);
         ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImGuiCond_Always);
 
-        // Push viridis colormap
-        ImPlot::PushColormap(ImPlotColormap_Viridis);
-
-        // Draw colored bars
-        for (const auto& tensor : memory_map_->tensors) {
-            uint32_t access_count = 0;
-            auto it = access_counts_.find(tensor.name);
-            if (it != access_counts_.end()) {
-                access_count = it->second;
-            }
+        // Rasterize the visible byte range at one column per pixel
+        const double bytes_per_gb = 1024.0 * 1024.0 * 1024.0;
+        ImPlotRect limits = ImPlot::GetPlotLimits();
+        int width = static_cast<int>(ImPlot::GetPlotSize().x);
+        uint64_t lo = static_cast<uint64_t>(std::max(limits.X.Min, 0.0) * bytes_per_gb);
+        uint64_t hi = static_cast<uint64_t>(std::max(limits.X.Max, 0.0) * bytes_per_gb);
+        if (tensor_index_) {
+            strip_raster_.update(*memory_map_, *tensor_index_, access_counts_, max_access_count_,
+                                 lo, hi, width, strip_reduce_);
+        }
 
-            double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-            double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
+        // One heatmap item for the whole strip (level i -> colormap entry i)
+        const double strip_bottom = residency_shown_ ? 0.3 : 0.0;
+        if (tensor_index_ && !strip_raster_.empty()) {
+            ImPlot::PushColormap(getStripColormap());
+            ImPlot::PlotHeatmap("##strip", strip_raster_.getLevels(), 1, strip_raster_.getWidth(),
+                                0.0, static_cast<double>(StripRaster::LEVELS), nullptr,
+                                ImPlotPoint(strip_raster_.getBegin() / bytes_per_gb, strip_bottom),
+                                ImPlotPoint(strip_raster_.getEnd() / bytes_per_gb, 1.0));
+            ImPlot::PopColormap();
+        }
 
-            ImVec4 color;
-            if (access_count == 0) {
-                color = ImVec4(55.0f/255.0f, 65.0f/255.0f, 81.0f/255.0f, 1.0f);
-            } else {
-                float intensity = static_cast<float>(access_count) / static_cast<float>(max_access_count_);
-                color = ImPlot::SampleColormap(intensity);
+        // Page cache band over the same columns, so an access above a dark stretch read the SSD
+        if (residency_shown_ && tensor_index_ && !strip_raster_.empty()) {
+            if (residency_levels_.size() != static_cast<size_t>(strip_raster_.getWidth()) ||
+                residency_begin_ != strip_raster_.getBegin() || residency_end_ != strip_raster_.getEnd()) {
+                residency_begin_ = strip_raster_.getBegin();
+                residency_end_ = strip_raster_.getEnd();
+                residency_cursor_.rasterize(residency_begin_, residency_end_, strip_raster_.getWidth(), residency_levels_);
             }
-
-            ImPlot::PushStyleColor(ImPlotCol_Fill, color);
-            double xs[4] = {start_gb, end_gb, end_gb, start_gb};
-            double ys[4] = {0.0, 0.0, 1.0, 1.0};
-            ImPlot::PlotShaded("##tensor", xs, ys, 4);
-            ImPlot::PopStyleColor();
+            ImPlot::PushColormap(getResidencyColormap());
+            ImPlot::PlotHeatmap("##residency", residency_levels_.data(), 1, static_cast<int>(residency_levels_.size()),
+                                0.0, 255.0, nullptr,
+                                ImPlotPoint(residency_begin_ / bytes_per_gb, 0.0),
+                                ImPlotPoint(residency_end_ / bytes_per_gb, 0.25));
+            ImPlot::PopColormap();
         }
 
-        ImPlot::PopColormap();
-
         // Hover detection
         if (ImPlot::IsPlotHovered()) {
-            ImPlotPoint mouse_pos = ImPlot::GetPlotMousePos();
-            double mouse_gb = mouse_pos.x;
-            hovered_tensor_ = nullptr;
-            for (const auto& tensor : memory_map_->tensors) {
-                double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-                double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
-                if (mouse_gb >= start_gb && mouse_gb <= end_gb) {
-                    hovered_tensor_ = &tensor;
-                    break;
-                }
-            }
+            hovered_tensor_ = findTensorAtMouse();
         }
 
         ImPlot::EndPlot();
@@ -302,63 +317,53 @@ void HeatmapView::renderAccessGraph() {
         ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, max_gb, ImGuiCond_Once);
         ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, static_cast<double>(max_access_count_), ImGuiCond_Once);
 
-        // Build step function data (X positions and Y heights)
-        std::vector<double> step_x;
-        std::vector<double> step_y;
-
-        for (const auto& tensor : memory_map_->tensors) {
-            uint32_t access_count = 0;
-            auto it = access_counts_.find(tensor.name);
-            if (it != access_counts_.end()) {
-                access_count = it->second;
-            }
-
-            double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-            double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
-            double count_d = static_cast<double>(access_count);
-
-            // Add points for step function
-            step_x.push_back(start_gb);
-            step_y.push_back(count_d);
-            step_x.push_back(end_gb);
-            step_y.push_back(count_d);
+        // Step function points, decimated to the plot width (cached across frames)
+        const double bytes_per_gb = 1024.0 * 1024.0 * 1024.0;
+        ImPlotRect limits = ImPlot::GetPlotLimits();
+        int width = static_cast<int>(ImPlot::GetPlotSize().x);
+        if (tensor_index_) {
+            access_graph_.update(*memory_map_, *tensor_index_, access_counts_,
+                                 static_cast<uint64_t>(std::max(limits.X.Min, 0.0) * bytes_per_gb),
+                                 static_cast<uint64_t>(std::max(limits.X.Max, 0.0) * bytes_per_gb),
+                                 width);
         }
 
         // Draw filled area under step function (blue fill)
-        if (!step_x.empty()) {
+        if (tensor_index_ && !access_graph_.empty()) {
             // Set fill color to blue
             ImPlot::PushStyleColor(ImPlotCol_Fill, ImVec4(0.2f, 0.5f, 0.8f, 0.6f)); // Blue with transparency
 
             // Draw as shaded area (filled under curve)
-            ImPlot::PlotShaded("##step_filled", step_x.data(), step_y.data(), step_x.size(), 0.0);
+            ImPlot::PlotShaded("##step_filled", access_graph_.getXs(), access_graph_.getYs(), access_graph_.getPointCount(), 0.0);
 
             ImPlot::PopStyleColor();
 
             // Draw line on top for clear boundary
             ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(0.2f, 0.5f, 0.8f, 1.0f)); // Solid blue
-            ImPlot::PlotLine("##step_line", step_x.data(), step_y.data(), step_x.size());
+            ImPlot::PlotLine("##step_line", access_graph_.getXs(), access_graph_.getYs(), access_graph_.getPointCount());
             ImPlot::PopStyleColor();
         }
 
         // Hover detection
         if (ImPlot::IsPlotHovered()) {
-            ImPlotPoint mouse_pos = ImPlot::GetPlotMousePos();
-            double mouse_gb = mouse_pos.x;
-            hovered_tensor_ = nullptr;
-            for (const auto& tensor : memory_map_->tensors) {
-                double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-                double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
-                if (mouse_gb >= start_gb && mouse_gb <= end_gb) {
-                    hovered_tensor_ = &tensor;
-                    break;
-                }
-            }
+            hovered_tensor_ = findTensorAtMouse();
         }
 
         ImPlot::EndPlot();
     }
 }
 
+const MemoryTensor* HeatmapView::findTensorAtMouse() const {
+    ImPlotPoint mouse_pos = ImPlot::GetPlotMousePos();
+    if (!tensor_index_ || mouse_pos.x < 0.0) {
+        return nullptr;
+    }
+
+    uint64_t offset = static_cast<uint64_t>(mouse_pos.x * (1024.0 * 1024.0 * 1024.0));
+    uint32_t index = tensor_index_->findAt(offset);
+    return index != TensorIndex::NO_TENSOR ? &memory_map_->tensors[index] : nullptr;
+}
+
 void HeatmapView::renderTooltip(const MemoryTensor* tensor) {
     ImGui::BeginTooltip();
 
@@ -388,10 +393,10 @@ void HeatmapView::renderTooltip(const MemoryTensor* tensor) {
                 formatOffset(tensor->offset_end).c_str());
 
     // Access count with visual indicator
-    auto it = access_counts_.find(tensor->name);
-    if (it != access_counts_.end() && it->second > 0) {
+    size_t tensor_index = static_cast<size_t>(tensor - memory_map_->tensors.data());
+    uint32_t count = tensor_index < access_counts_.size() ? access_counts_[tensor_index] : 0;
+    if (count > 0) {
         ImGui::Separator();
-        uint32_t count = it->second;
         float intensity = static_cast<float>(count) / static_cast<float>(max_access_count_);
 
         // Show access count with color indicator
@@ -404,24 +409,48 @@ void HeatmapView::renderTooltip(const MemoryTensor* tensor) {
         ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), "Not accessed in current timeline");
     }
 
+    if (residency_shown_ && tensor->size_bytes > 0) {
+        uint64_t resident = residency_cursor_.residentBytes(tensor->offset_start, tensor->size_bytes);
+        ImGui::Text("Page cache: %.1f%% resident", 100.0 * resident / tensor->size_bytes);
+    }
+
     ImGui::EndTooltip();
 }
 
-ImU32 HeatmapView::getHeatColor(uint32_t access_count) const {
-    if (access_count == 0) {
-        // Gray for unaccessed tensors
-        return IM_COL32(55, 65, 81, 255);  // gray-700
+int HeatmapView::getStripColormap() {
+    if (strip_colormap_ >= 0) {
+        return strip_colormap_;
     }
 
-    // Calculate intensity (0.0 - 1.0)
-    float intensity = 0.0f;
-    if (max_access_count_ > 0) {
-        intensity = static_cast<float>(access_count) / static_cast<float>(max_access_count_);
+    // Qualitative map so levels never blend: gray for unaccessed, then viridis
+    strip_colormap_ = ImPlot::GetColormapIndex("HeatmapStrip");
+    if (strip_colormap_ < 0) {
+        ImVec4 colors[StripRaster::LEVELS];
+        colors[0] = ImVec4(55.0f/255.0f, 65.0f/255.0f, 81.0f/255.0f, 1.0f);
+        for (int i = 1; i < StripRaster::LEVELS; i++) {
+            float intensity = static_cast<float>(i - 1) / static_cast<float>(StripRaster::LEVELS - 2);
+            colors[i] = ImPlot::SampleColormap(intensity, ImPlotColormap_Viridis);
+        }
+        strip_colormap_ = ImPlot::AddColormap("HeatmapStrip", colors, StripRaster::LEVELS, true);
     }
+    return strip_colormap_;
+}
 
-    // Dark red -> Bright red gradient
-    int r = static_cast<int>(139 + (255 - 139) * intensity);
-    return IM_COL32(r, 0, 0, 255);
+int HeatmapView::getResidencyColormap() {
+    if (residency_colormap_ >= 0) {
+        return residency_colormap_;
+    }
+
+    // Share of resident pages per column: gray-800 (none) to green (all)
+    residency_colormap_ = ImPlot::GetColormapIndex("PageCacheBand");
+    if (residency_colormap_ < 0) {
+        ImVec4 colors[2] = {
+            ImVec4(31.0f/255.0f, 41.0f/255.0f, 55.0f/255.0f, 1.0f),
+            ImVec4(34.0f/255.0f, 197.0f/255.0f, 94.0f/255.0f, 1.0f),
+        };
+        residency_colormap_ = ImPlot::AddColormap("PageCacheBand", colors, 2, false);
+    }
+    return residency_colormap_;
 }
 
 std::string HeatmapView::formatSize(uint64_t bytes) {
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "MemoryMap.h"
+#include "TensorIndex.h"
 #include "TraceData.h"
+#include "AccessCheckpoints.h"
+#include "PageResidency.h"
+#include "StripRaster.h"
+#include "StepGraph.h"
 #include "imgui.h"
 #include <vector>
-#include <map>
 #include <string>
 
 // Heatmap visualization for memory access patterns
@@ -13,8 +17,10 @@ public:
     HeatmapView();
 
     // Set data sources
-    void setMemoryMap(const MemoryMap* map);
+    void setMemoryMap(const MemoryMap* map, const TensorIndex* index);
     void setTraceData(const TraceData* data);
+    // Page cache residency of the file the map describes (nullptr = none)
+    void setResidency(const PageResidency* residency);
 
     // Render the heatmap
     void render();
@@ -29,6 +35,7 @@ public:
 
 private:
     const MemoryMap* memory_map_;
+    const TensorIndex* tensor_index_;   // Offset index over memory_map_ (shared, owned by the loader)
     const TraceData* trace_data_;
 
     // Rendering parameters
@@ -41,24 +48,54 @@ private:
     float max_time_ms_;         // Maximum time from trace data
 
     // Access count cache (temporal - only counts up to current_time_ms_)
-    std::map<std::string, uint32_t> access_counts_;
+    // One slot per memory_map_->tensors entry
+    std::vector<uint32_t> access_counts_;
+    size_t counted_entry_end_;          // Entries included in access_counts_
     uint32_t max_access_count_;
 
+    // Prefix snapshots of the current token (rebuilt on token change)
+    AccessCheckpoints checkpoints_;
+
+    // Colored strip raster (rebuilt only on zoom/scroll/resize or count changes)
+    StripRaster strip_raster_;
+    StripRaster::Reduce strip_reduce_;
+    int strip_colormap_;                // ImPlotColormap: gray + viridis levels (-1 until created)
+
+    // Access graph vertices (rebuilt on the same triggers as the strip)
+    StepGraph access_graph_;
+
+    // Page cache band under the strip, at the residency sample of current_time_ms_
+    const PageResidency* residency_;
+    ResidencyCursor residency_cursor_;
+    bool show_residency_;
+    bool residency_valid_;              // Cursor is at a record of residency_
+    bool residency_shown_;              // This frame has a sample to draw
+    std::vector<uint8_t> residency_levels_;
+    uint64_t residency_begin_;
+    uint64_t residency_end_;
+    uint64_t resident_bytes_;           // Whole file, at the cursor
+    int residency_colormap_;
+
     // UI state
     const MemoryTensor* hovered_tensor_;
 
     // Helper methods
-    void calculateMaxAccessCount();  // Calculate max from FULL timeline (call once)
-    void calculateAccessCounts();    // Calculate counts up to current_time_ms_ (call on timeline change)
+    void calculateMaxAccessCount();  // Build checkpoints + max from FULL timeline (call once per token)
+    void calculateAccessCounts();    // Counts up to current_time_ms_ from nearest checkpoint (call on timeline change)
     void renderHeatmapCanvas();
-    void renderColoredStrip();       // Top: colored bars only (no Y-axis)
+    void renderColoredStrip();       // Top: colored bars only (no Y-axis), one heatmap item
     void renderAccessGraph();        // Bottom: step function with Y-axis
     void renderControls();
     void renderTimelineWidget();
     void renderTooltip(const MemoryTensor* tensor);
+    bool updateResidency();          // Move the cursor to current_time_ms_; false if no sample covers it
+
+    // Offset index helper (current plot only)
+    const MemoryTensor* findTensorAtMouse() const;
 
     // Color calculation
-    ImU32 getHeatColor(uint32_t access_count) const;
+    int getStripColormap();
+    int getResidencyColormap();
 
     // Formatting helpers
     static std::string formatSize(uint64_t bytes);
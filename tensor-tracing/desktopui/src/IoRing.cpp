@@ -0,0 +1,186 @@
+#include "IoRing.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IO_RING_SUPPORTED 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+IoRing::IoRing()
+    : ring_fd_(-1)
+    , sq_entries_(0)
+    , to_submit_(0)
+    , sq_ring_(nullptr)
+    , cq_ring_(nullptr)
+    , sqes_(nullptr)
+    , sq_ring_size_(0)
+    , cq_ring_size_(0)
+    , sqes_size_(0)
+    , sq_head_(nullptr)
+    , sq_tail_(nullptr)
+    , sq_mask_(nullptr)
+    , sq_array_(nullptr)
+    , cq_head_(nullptr)
+    , cq_tail_(nullptr)
+    , cq_mask_(nullptr)
+    , cqes_(nullptr)
+{
+}
+
+IoRing::~IoRing() {
+    close();
+}
+
+#ifdef IO_RING_SUPPORTED
+
+bool IoRing::init(uint32_t entries) {
+    close();
+
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+        last_error_ = std::string("io_uring_setup: ") + std::strerror(errno);
+        return false;
+    }
+    ring_fd_ = fd;
+    sq_entries_ = params.sq_entries;
+
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+        sq_ring_ = nullptr;
+        last_error_ = std::string("mmap of the submission ring: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+    if (single_mmap) {
+        cq_ring_ = sq_ring_;
+    } else {
+        cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) {
+            cq_ring_ = nullptr;
+            last_error_ = std::string("mmap of the completion ring: ") + std::strerror(errno);
+            close();
+            return false;
+        }
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) {
+        sqes_ = nullptr;
+        last_error_ = std::string("mmap of the submission entries: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    char* cq = static_cast<char*>(cq_ring_);
+    sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes_ = cq + params.cq_off.cqes;
+    return true;
+}
+
+void IoRing::close() {
+    if (sqes_) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ && cq_ring_ != sq_ring_) {
+        munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_) {
+        munmap(sq_ring_, sq_ring_size_);
+    }
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+    }
+    ring_fd_ = -1;
+    sq_entries_ = 0;
+    to_submit_ = 0;
+    sq_ring_ = cq_ring_ = sqes_ = nullptr;
+}
+
+bool IoRing::queueRead(int fd, void* buffer, uint32_t length, uint64_t offset, uint64_t user_data) {
+    const uint32_t tail = *sq_tail_;
+    const uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (tail - head >= sq_entries_) {
+        return false;
+    }
+    const uint32_t index = tail & *sq_mask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(buffer);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+    return true;
+}
+
+bool IoRing::submitAndWait(uint32_t min_complete, const std::function<void(uint64_t, int32_t)>& on_complete) {
+    if (to_submit_ > 0 || min_complete > 0) {
+        const unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int submitted = static_cast<int>(
+            syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_complete, flags, nullptr, 0));
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                return true;   // Nothing lost: retry on the next call
+            }
+            last_error_ = std::string("io_uring_enter: ") + std::strerror(errno);
+            return false;
+        }
+        to_submit_ -= std::min<uint32_t>(to_submit_, static_cast<uint32_t>(submitted));
+    }
+
+    uint32_t head = *cq_head_;
+    const uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    const io_uring_cqe* cqes = static_cast<const io_uring_cqe*>(cqes_);
+    while (head != tail) {
+        const io_uring_cqe& cqe = cqes[head & *cq_mask_];
+        on_complete(cqe.user_data, cqe.res);
+        head++;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return true;
+}
+
+#else
+
+bool IoRing::init(uint32_t) {
+    last_error_ = "io_uring is not available on this platform";
+    return false;
+}
+
+void IoRing::close() {
+}
+
+bool IoRing::queueRead(int, void*, uint32_t, uint64_t, uint64_t) {
+    return false;
+}
+
+bool IoRing::submitAndWait(uint32_t, const std::function<void(uint64_t, int32_t)>&) {
+    return false;
+}
+
+#endif
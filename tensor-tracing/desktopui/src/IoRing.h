@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Minimal io_uring submission/completion ring for file reads
+//
+// Talks to the kernel through the raw io_uring_setup/io_uring_enter syscalls
+// and the mmapped rings, so there is no liburing dependency. Single-threaded:
+// one owner queues reads, submits and reaps. On systems without io_uring
+// (non-Linux, old kernels, seccomp) init() fails and callers fall back to
+// pread.
+class IoRing {
+public:
+    IoRing();
+    ~IoRing();
+
+    IoRing(const IoRing&) = delete;
+    IoRing& operator=(const IoRing&) = delete;
+
+    // Returns true on success, false if io_uring is unavailable (see getLastError)
+    bool init(uint32_t entries);
+    void close();
+
+    bool isOpen() const { return ring_fd_ >= 0; }
+    uint32_t getCapacity() const { return sq_entries_; }
+
+    // Queue a read; false when the submission queue is full
+    bool queueRead(int fd, void* buffer, uint32_t length, uint64_t offset, uint64_t user_data);
+
+    // Submit queued reads and wait for at least min_complete completions, then
+    // call on_complete(user_data, result) for every completion available
+    // (result is bytes read or -errno). Returns false on a ring error.
+    bool submitAndWait(uint32_t min_complete, const std::function<void(uint64_t, int32_t)>& on_complete);
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    int ring_fd_;
+    uint32_t sq_entries_;
+    uint32_t to_submit_;
+
+    void* sq_ring_;
+    void* cq_ring_;
+    void* sqes_;
+    size_t sq_ring_size_;
+    size_t cq_ring_size_;
+    size_t sqes_size_;
+
+    uint32_t* sq_head_;
+    uint32_t* sq_tail_;
+    uint32_t* sq_mask_;
+    uint32_t* sq_array_;
+    uint32_t* cq_head_;
+    uint32_t* cq_tail_;
+    uint32_t* cq_mask_;
+    void* cqes_;
+
+    std::string last_error_;
+};
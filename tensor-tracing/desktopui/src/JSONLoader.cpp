@@ -2,11 +2,15 @@
 #include "json.hpp"
 #include <fstream>
 #include <iostream>
+#include <charconv>
+#include <cstring>
+#include <cstdlib>
+#include <string_view>
 
 using json = nlohmann::json;
 
 // Initialize static member
-std::string JSONLoader::last_error_ = "";
+thread_local std::string JSONLoader::last_error_ = "";
 
 bool JSONLoader::loadMemoryMap(const std::string& filepath, MemoryMap& out_map) {
     try {
@@ -91,93 +95,435 @@ bool JSONLoader::loadMemoryMap(const std::string& filepath, MemoryMap& out_map)
     }
 }
 
-bool JSONLoader::loadTraceData(const std::string& filepath, TraceData& out_data) {
-    try {
-        // Open file
-        std::ifstream file(filepath);
-        if (!file.is_open()) {
-            last_error_ = "Failed to open file: " + filepath;
+namespace {
+
+// Minimal pull-free JSON scanner: walks the raw bytes once and reports tokens
+// to a handler. Strings without escapes are passed as views into the input, so
+// nothing is allocated unless the handler keeps a value.
+template <typename Handler>
+class JsonScanner {
+public:
+    JsonScanner(const char* begin, const char* end, Handler& handler)
+        : begin_(begin), pos_(begin), end_(end), handler_(handler) {}
+
+    bool parse() {
+        skipWhitespace();
+        if (!parseValue()) {
             return false;
         }
+        skipWhitespace();
+        if (pos_ != end_) {
+            return fail("unexpected trailing characters");
+        }
+        return true;
+    }
 
-        // Parse JSON
-        json j;
-        file >> j;
+    const std::string& getError() const { return error_; }
 
-        // Clear output structure
-        out_data = TraceData();
+private:
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    Handler& handler_;
+    std::string key_scratch_;
+    std::string value_scratch_;
+    std::string error_;
+    int depth_ = 0;
 
-        // Parse metadata
-        auto& meta_json = j["metadata"];
-        out_data.metadata.total_entries = meta_json["total_entries"].get<uint32_t>();
-        out_data.metadata.duration_ms = meta_json["duration_ms"].get<double>();
-        out_data.metadata.timestamp_start_ns = meta_json["timestamp_start_ns"].get<uint64_t>();
-        out_data.metadata.format_version = meta_json["format_version"].get<std::string>();
-
-        // Parse entries array
-        auto& entries_json = j["entries"];
-        out_data.entries.reserve(entries_json.size());
-
-        for (const auto& entry_json : entries_json) {
-            TraceEntry entry;
-            entry.entry_id = entry_json["entry_id"].get<uint32_t>();
-            entry.timestamp_ns = entry_json["timestamp_ns"].get<uint64_t>();
-            entry.timestamp_relative_ms = entry_json["timestamp_relative_ms"].get<double>();
-            entry.token_id = entry_json["token_id"].get<uint32_t>();
+    bool fail(const char* message) {
+        error_ = std::string(message) + " at byte " + std::to_string(pos_ - begin_);
+        return false;
+    }
 
-            // layer_id can be null
-            if (entry_json["layer_id"].is_null()) {
-                entry.layer_id = -1;
+    void skipWhitespace() {
+        while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+            pos_++;
+        }
+    }
+
+    bool parseValue() {
+        if (pos_ == end_) {
+            return fail("unexpected end of input");
+        }
+        switch (*pos_) {
+            case '{': return parseObject();
+            case '[': return parseArray();
+            case '"': {
+                std::string_view str;
+                if (!parseString(str, value_scratch_)) return false;
+                handler_.onString(str);
+                return true;
+            }
+            case 't': return parseLiteral("true", 4) && (handler_.onBool(true), true);
+            case 'f': return parseLiteral("false", 5) && (handler_.onBool(false), true);
+            case 'n': return parseLiteral("null", 4) && (handler_.onNull(), true);
+            default: return parseNumber();
+        }
+    }
+
+    bool parseObject() {
+        if (++depth_ > 64) return fail("nesting too deep");
+        pos_++;  // '{'
+        handler_.onStartObject();
+        skipWhitespace();
+        if (pos_ != end_ && *pos_ == '}') {
+            pos_++;
+        } else {
+            while (true) {
+                skipWhitespace();
+                if (pos_ == end_ || *pos_ != '"') return fail("expected object key");
+                std::string_view key;
+                if (!parseString(key, key_scratch_)) return false;
+                handler_.onKey(key);
+
+                skipWhitespace();
+                if (pos_ == end_ || *pos_ != ':') return fail("expected ':'");
+                pos_++;
+                skipWhitespace();
+                if (!parseValue()) return false;
+
+                skipWhitespace();
+                if (pos_ == end_) return fail("unterminated object");
+                if (*pos_ == ',') { pos_++; continue; }
+                if (*pos_ == '}') { pos_++; break; }
+                return fail("expected ',' or '}'");
+            }
+        }
+        handler_.onEndObject();
+        depth_--;
+        return true;
+    }
+
+    bool parseArray() {
+        if (++depth_ > 64) return fail("nesting too deep");
+        pos_++;  // '['
+        handler_.onStartArray();
+        skipWhitespace();
+        if (pos_ != end_ && *pos_ == ']') {
+            pos_++;
+        } else {
+            while (true) {
+                skipWhitespace();
+                if (!parseValue()) return false;
+                skipWhitespace();
+                if (pos_ == end_) return fail("unterminated array");
+                if (*pos_ == ',') { pos_++; continue; }
+                if (*pos_ == ']') { pos_++; break; }
+                return fail("expected ',' or ']'");
+            }
+        }
+        handler_.onEndArray();
+        depth_--;
+        return true;
+    }
+
+    bool parseLiteral(const char* literal, size_t length) {
+        if (static_cast<size_t>(end_ - pos_) < length || std::memcmp(pos_, literal, length) != 0) {
+            return fail("invalid literal");
+        }
+        pos_ += length;
+        return true;
+    }
+
+    bool parseNumber() {
+        const char* start = pos_;
+        bool is_integer = true;
+        if (pos_ != end_ && *pos_ == '-') pos_++;
+        while (pos_ != end_) {
+            char c = *pos_;
+            if (c >= '0' && c <= '9') {
+                pos_++;
+            } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                is_integer = false;
+                pos_++;
             } else {
-                entry.layer_id = entry_json["layer_id"].get<int>();
+                break;
             }
+        }
+        if (pos_ == start) {
+            return fail("unexpected character");
+        }
 
-            entry.thread_id = entry_json["thread_id"].get<uint16_t>();
-            entry.phase = entry_json["phase"].get<std::string>();
-            entry.operation_type = entry_json["operation_type"].get<std::string>();
-            entry.dst_name = entry_json["dst_name"].get<std::string>();
-            entry.num_sources = entry_json["num_sources"].get<uint8_t>();
-
-            // Parse sources array
-            auto& sources_json = entry_json["sources"];
-            for (const auto& source_json : sources_json) {
-                TraceSource source;
-                source.name = source_json["name"].get<std::string>();
-                source.tensor_ptr = source_json["tensor_ptr"].get<std::string>();
-                source.size_bytes = source_json["size_bytes"].get<uint64_t>();
-
-                // layer_id can be null
-                if (source_json["layer_id"].is_null()) {
-                    source.layer_id = -1;
-                } else {
-                    source.layer_id = source_json["layer_id"].get<int>();
-                }
+        if (is_integer && *start != '-') {
+            uint64_t value = 0;
+            auto result = std::from_chars(start, pos_, value);
+            if (result.ec == std::errc() && result.ptr == pos_) {
+                handler_.onNumber(static_cast<double>(value), value);
+                return true;
+            }
+        }
 
-                source.memory_source = source_json["memory_source"].get<std::string>();
-
-                // disk_offset or buffer_id depending on memory_source
-                if (source.memory_source == "DISK" && source_json.contains("disk_offset")) {
-                    source.disk_offset = source_json["disk_offset"].get<uint64_t>();
-                    source.buffer_id = 0;
-                } else if (source.memory_source == "BUFFER" && source_json.contains("buffer_id")) {
-                    source.buffer_id = source_json["buffer_id"].get<uint64_t>();
-                    source.disk_offset = 0;
-                } else {
-                    source.disk_offset = 0;
-                    source.buffer_id = 0;
-                }
+        // Negative, fractional or out-of-range numbers go through strtod
+        std::string text(start, pos_);
+        char* parsed_end = nullptr;
+        double value = std::strtod(text.c_str(), &parsed_end);
+        if (parsed_end != text.c_str() + text.size()) {
+            return fail("invalid number");
+        }
+        handler_.onNumber(value, value < 0 ? static_cast<uint64_t>(static_cast<int64_t>(value)) : static_cast<uint64_t>(value));
+        return true;
+    }
+
+    bool parseString(std::string_view& out, std::string& scratch) {
+        pos_++;  // opening quote
+        const char* start = pos_;
 
-                entry.sources.push_back(source);
+        // Fast path: no escapes, return a view into the input
+        while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\') {
+            pos_++;
+        }
+        if (pos_ == end_) return fail("unterminated string");
+        if (*pos_ == '"') {
+            out = std::string_view(start, pos_ - start);
+            pos_++;
+            return true;
+        }
+
+        // Slow path: decode escapes into scratch
+        scratch.assign(start, pos_);
+        while (pos_ != end_ && *pos_ != '"') {
+            if (*pos_ != '\\') {
+                scratch.push_back(*pos_++);
+                continue;
             }
+            pos_++;
+            if (pos_ == end_) return fail("unterminated escape");
+            char esc = *pos_++;
+            switch (esc) {
+                case '"': scratch.push_back('"'); break;
+                case '\\': scratch.push_back('\\'); break;
+                case '/': scratch.push_back('/'); break;
+                case 'b': scratch.push_back('\b'); break;
+                case 'f': scratch.push_back('\f'); break;
+                case 'n': scratch.push_back('\n'); break;
+                case 'r': scratch.push_back('\r'); break;
+                case 't': scratch.push_back('\t'); break;
+                case 'u': {
+                    uint32_t code = 0;
+                    if (!parseHex4(code)) return false;
+                    if (code >= 0xD800 && code <= 0xDBFF) {
+                        // Surrogate pair
+                        uint32_t low = 0;
+                        if (end_ - pos_ < 2 || pos_[0] != '\\' || pos_[1] != 'u') return fail("invalid surrogate pair");
+                        pos_ += 2;
+                        if (!parseHex4(low)) return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(scratch, code);
+                    break;
+                }
+                default:
+                    return fail("invalid escape");
+            }
+        }
+        if (pos_ == end_) return fail("unterminated string");
+        pos_++;  // closing quote
+        out = scratch;
+        return true;
+    }
+
+    bool parseHex4(uint32_t& out) {
+        if (end_ - pos_ < 4) return fail("invalid unicode escape");
+        auto result = std::from_chars(pos_, pos_ + 4, out, 16);
+        if (result.ptr != pos_ + 4) return fail("invalid unicode escape");
+        pos_ += 4;
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+};
+
+// SAX-style handler that fills TraceData's store directly from the token stream
+// (no intermediate nlohmann DOM, so peak memory stays close to the final structures)
+class TraceSaxHandler {
+public:
+    explicit TraceSaxHandler(TraceData& out) : out_(out), seen_metadata_(false) {}
+
+    void onNull() {
+        // Only layer_id is nullable in the trace format
+        if (key_ == "layer_id") {
+            if (top() == Context::Entry) entry_.layer_id = -1;
+            if (top() == Context::Source) source_.layer_id = -1;
+        }
+    }
+
+    void onBool(bool) {}
+
+    void onNumber(double as_double, uint64_t as_unsigned) {
+        switch (top()) {
+            case Context::Metadata:
+                if (key_ == "total_entries") out_.metadata.total_entries = static_cast<uint32_t>(as_unsigned);
+                else if (key_ == "duration_ms") out_.metadata.duration_ms = as_double;
+                else if (key_ == "timestamp_start_ns") out_.metadata.timestamp_start_ns = as_unsigned;
+                break;
+            case Context::Entry:
+                if (key_ == "entry_id") entry_.entry_id = static_cast<uint32_t>(as_unsigned);
+                else if (key_ == "timestamp_ns") entry_.timestamp_ns = as_unsigned;
+                else if (key_ == "timestamp_relative_ms") entry_.timestamp_relative_ms = as_double;
+                else if (key_ == "token_id") entry_.token_id = static_cast<uint32_t>(as_unsigned);
+                else if (key_ == "layer_id") entry_.layer_id = static_cast<int>(as_unsigned);
+                else if (key_ == "thread_id") entry_.thread_id = static_cast<uint16_t>(as_unsigned);
+                else if (key_ == "num_sources") entry_.num_sources = static_cast<uint8_t>(as_unsigned);
+                else if (key_ == "num_experts") entry_.num_experts = static_cast<uint8_t>(as_unsigned);
+                break;
+            case Context::Source:
+                if (key_ == "size_bytes") source_.size_bytes = as_unsigned;
+                else if (key_ == "layer_id") source_.layer_id = static_cast<int>(as_unsigned);
+                else if (key_ == "disk_offset") source_.disk_offset = as_unsigned;
+                else if (key_ == "buffer_id") source_.buffer_id = as_unsigned;
+                break;
+            case Context::ExpertIds:
+                entry_.expert_ids.push_back(static_cast<int32_t>(as_unsigned));
+                break;
+            default:
+                break;
+        }
+    }
+
+    void onString(std::string_view val) {
+        switch (top()) {
+            case Context::Metadata:
+                if (key_ == "format_version") out_.metadata.format_version.assign(val);
+                break;
+            case Context::Entry:
+                if (key_ == "phase") entry_.phase.assign(val);
+                else if (key_ == "operation_type") entry_.operation_type.assign(val);
+                else if (key_ == "dst_name") entry_.dst_name.assign(val);
+                break;
+            case Context::Source:
+                if (key_ == "name") source_.name.assign(val);
+                else if (key_ == "tensor_ptr") source_.tensor_ptr.assign(val);
+                else if (key_ == "memory_source") source_.memory_source.assign(val);
+                break;
+            default:
+                break;
+        }
+    }
 
-            // Parse expert_ids array
-            auto& expert_ids_json = entry_json["expert_ids"];
-            for (const auto& expert_id : expert_ids_json) {
-                entry.expert_ids.push_back(expert_id.get<int32_t>());
+    void onKey(std::string_view val) {
+        key_.assign(val);
+    }
+
+    void onStartObject() {
+        Context parent = stack_.empty() ? Context::None : top();
+        if (parent == Context::None) {
+            stack_.push_back(Context::Root);
+        } else if (parent == Context::Root && key_ == "metadata") {
+            stack_.push_back(Context::Metadata);
+            seen_metadata_ = true;
+        } else if (parent == Context::Entries) {
+            entry_ = TraceEntry();
+            stack_.push_back(Context::Entry);
+        } else if (parent == Context::Sources) {
+            source_ = TraceSource();
+            stack_.push_back(Context::Source);
+        } else {
+            stack_.push_back(Context::Skip);
+        }
+    }
+
+    void onEndObject() {
+        Context ctx = top();
+        stack_.pop_back();
+
+        if (ctx == Context::Entry) {
+            out_.entries.append(entry_);
+        } else if (ctx == Context::Source) {
+            // disk_offset or buffer_id depending on memory_source
+            if (source_.memory_source == "DISK") {
+                source_.buffer_id = 0;
+            } else if (source_.memory_source == "BUFFER") {
+                source_.disk_offset = 0;
+            } else {
+                source_.disk_offset = 0;
+                source_.buffer_id = 0;
             }
-            entry.num_experts = entry_json["num_experts"].get<uint8_t>();
+            entry_.sources.push_back(std::move(source_));
+        }
+    }
+
+    void onStartArray() {
+        Context parent = stack_.empty() ? Context::None : top();
+        if (parent == Context::Root && key_ == "entries") {
+            stack_.push_back(Context::Entries);
+            out_.entries.reserve(out_.metadata.total_entries);
+        } else if (parent == Context::Entry && key_ == "sources") {
+            stack_.push_back(Context::Sources);
+        } else if (parent == Context::Entry && key_ == "expert_ids") {
+            stack_.push_back(Context::ExpertIds);
+        } else {
+            stack_.push_back(Context::Skip);
+        }
+    }
+
+    void onEndArray() {
+        stack_.pop_back();
+    }
+
+    bool hasMetadata() const { return seen_metadata_; }
 
-            out_data.entries.push_back(entry);
+private:
+    enum class Context { None, Root, Metadata, Entries, Entry, Sources, Source, ExpertIds, Skip };
+
+    TraceData& out_;
+    std::vector<Context> stack_;
+    std::string key_;
+    TraceEntry entry_;
+    TraceSource source_;
+    bool seen_metadata_;
+
+    Context top() const { return stack_.empty() ? Context::None : stack_.back(); }
+};
+
+}  // namespace
+
+bool JSONLoader::loadTraceData(const std::string& filepath, TraceData& out_data) {
+    try {
+        // Open file
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            last_error_ = "Failed to open file: " + filepath;
+            return false;
+        }
+
+        // Read raw bytes in one go (the scanner walks them without building a DOM)
+        file.seekg(0, std::ios::end);
+        std::string buffer(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0, std::ios::beg);
+        file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+
+        // Clear output structure (keeps a shared symbol table)
+        out_data.clear();
+
+        // Stream tokens straight into the TraceStore (one TraceEntry row at a time)
+        TraceSaxHandler handler(out_data);
+        JsonScanner<TraceSaxHandler> scanner(buffer.data(), buffer.data() + buffer.size(), handler);
+        if (!scanner.parse()) {
+            last_error_ = std::string("JSON parsing error: ") + scanner.getError();
+            std::cerr << "✗ " << last_error_ << std::endl;
+            return false;
+        }
+
+        if (!handler.hasMetadata()) {
+            last_error_ = "JSON parsing error: missing metadata in " + filepath;
+            std::cerr << "✗ " << last_error_ << std::endl;
+            return false;
         }
 
         std::cout << "✓ Loaded trace data: " << out_data.entries.size() << " entries" << std::endl;
@@ -186,13 +532,51 @@ bool JSONLoader::loadTraceData(const std::string& filepath, TraceData& out_data)
 
         return true;
 
-    } catch (const json::exception& e) {
-        last_error_ = std::string("JSON parsing error: ") + e.what();
-        std::cerr << "✗ " << last_error_ << std::endl;
-        return false;
     } catch (const std::exception& e) {
         last_error_ = std::string("Error loading trace data: ") + e.what();
         std::cerr << "✗ " << last_error_ << std::endl;
         return false;
     }
 }
+
+bool JSONLoader::saveMemoryMap(const std::string& filepath, const MemoryMap& map) {
+    json tensors = json::array();
+    for (const MemoryTensor& tensor : map.tensors) {
+        json entry;
+        entry["name"] = tensor.name;
+        entry["offset_start"] = tensor.offset_start;
+        entry["offset_end"] = tensor.offset_end;
+        entry["size_bytes"] = tensor.size_bytes;
+        entry["shape"] = tensor.shape;
+        entry["category"] = tensor.category;
+        entry["layer_id"] = tensor.layer_id >= 0 ? json(tensor.layer_id) : json(nullptr);
+        entry["component"] = tensor.component;
+        entry["component_type"] = tensor.component_type;
+        // Only expert slices carry expert_id
+        if (tensor.expert_id >= 0) {
+            entry["expert_id"] = tensor.expert_id;
+        }
+        tensors.push_back(std::move(entry));
+    }
+
+    json j;
+    j["model_name"] = map.model_name;
+    j["total_size_bytes"] = map.total_size_bytes;
+    j["metadata"] = {{"n_layers", map.metadata.n_layers},
+                     {"n_vocab", map.metadata.n_vocab},
+                     {"n_embd", map.metadata.n_embd},
+                     {"n_tensors", map.metadata.n_tensors}};
+    j["tensors"] = tensors;
+
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        last_error_ = "Failed to write file: " + filepath;
+        return false;
+    }
+    file << j.dump(2) << std::endl;
+    if (!file) {
+        last_error_ = "Failed to write file: " + filepath;
+        return false;
+    }
+    return true;
+}
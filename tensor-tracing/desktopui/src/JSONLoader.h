@@ -15,9 +15,13 @@ public:
     // Returns true on success, false on failure
     static bool loadTraceData(const std::string& filepath, TraceData& out_data);
 
-    // Get last error message
+    // Write memory map in the format tools/parse_csv.py produces
+    // Returns true on success, false on failure
+    static bool saveMemoryMap(const std::string& filepath, const MemoryMap& map);
+
+    // Get last error message (per thread, loaders run on worker threads)
     static const std::string& getLastError() { return last_error_; }
 
 private:
-    static std::string last_error_;
+    static thread_local std::string last_error_;
 };
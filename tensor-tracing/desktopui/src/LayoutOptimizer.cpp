@@ -0,0 +1,354 @@
+#include "LayoutOptimizer.h"
+#include "ExpertCube.h"
+#include <algorithm>
+#include <numeric>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+constexpr uint32_t NEVER = 0xFFFFFFFF;
+
+// One GGUF tensor: a single MemoryMap entry, or the expert slices of an
+// "_exps." tensor (by expert_id), which have to stay contiguous
+struct LayoutUnit {
+    std::vector<uint32_t> tensors;
+    int layer = -1;
+    int group = 1;                    // 0 embedding, 1 layers, 2 other non-layer tensors
+    uint64_t original_start = 0;
+    uint32_t first_access = NEVER;    // Position in the access stream
+};
+
+std::vector<LayoutUnit> buildUnits(const MemoryMap& map) {
+    std::vector<uint32_t> by_offset(map.tensors.size());
+    std::iota(by_offset.begin(), by_offset.end(), 0);
+    std::sort(by_offset.begin(), by_offset.end(), [&map](uint32_t a, uint32_t b) {
+        return map.tensors[a].offset_start < map.tensors[b].offset_start;
+    });
+
+    std::vector<LayoutUnit> units;
+    std::unordered_map<std::string_view, size_t> expert_units;
+    for (uint32_t i : by_offset) {
+        const MemoryTensor& tensor = map.tensors[i];
+        size_t unit = units.size();
+        if (tensor.expert_id >= 0) {
+            std::string_view base(tensor.name);
+            base = base.substr(0, base.find('['));
+            auto inserted = expert_units.emplace(base, units.size());
+            unit = inserted.first->second;
+        }
+        if (unit == units.size()) {
+            units.emplace_back();
+            units.back().layer = tensor.layer_id;
+            units.back().group = tensor.layer_id >= 0 ? 1 : (tensor.category == "embedding" ? 0 : 2);
+            units.back().original_start = tensor.offset_start;
+        }
+        units[unit].tensors.push_back(i);
+    }
+
+    for (LayoutUnit& unit : units) {
+        std::sort(unit.tensors.begin(), unit.tensors.end(), [&map](uint32_t a, uint32_t b) {
+            return map.tensors[a].expert_id < map.tensors[b].expert_id;
+        });
+    }
+    return units;
+}
+
+// Greedy chain per layer: start at the most routed expert, then always
+// append the unplaced expert routed together with the last one most often
+std::vector<std::vector<int>> coactivationChains(const ExpertRouting& routing) {
+    ExpertActivity activity;
+    activity.compute(routing, 0);
+    const size_t experts = activity.expert_count;
+
+    std::vector<std::vector<int>> chains(activity.layer_count);
+    for (size_t layer = 0; layer < activity.layer_count; layer++) {
+        const uint32_t* frequency = activity.frequency.data() + layer * experts;
+        std::vector<uint8_t> placed(experts, 0);
+        std::vector<int>& chain = chains[layer];
+        int last = -1;
+        for (size_t step = 0; step < experts; step++) {
+            int best = -1;
+            uint64_t best_score = 0;
+            for (size_t e = 0; e < experts; e++) {
+                if (placed[e]) {
+                    continue;
+                }
+                // Co-activation with the last expert, ties by frequency then id
+                uint64_t together = last < 0 ? 0 : activity.coactivation[(layer * experts + last) * experts + e];
+                uint64_t score = (together << 32) | frequency[e];
+                if (best < 0 || score > best_score) {
+                    best = static_cast<int>(e);
+                    best_score = score;
+                }
+            }
+            placed[best] = 1;
+            chain.push_back(best);
+            last = best;
+        }
+    }
+    return chains;
+}
+
+void scoreLayout(const DomainLoader& loader, const LayoutConfig& config, TensorLayout& layout) {
+    const MemoryMap& map = loader.getMemoryMap();
+    LayoutScore& score = layout.score;
+    score = LayoutScore();
+
+    std::vector<uint32_t> stamp(map.tensors.size(), NEVER);
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    uint32_t previous = NEVER;
+    uint64_t previous_end = 0;
+    for (size_t t = 0; t < loader.getTokenCount(); t++) {
+        // Give up between tokens at shutdown
+        if (ThreadPool::isTaskCancelled()) {
+            return;
+        }
+        ranges.clear();
+        if (loader.isTokenReady(t)) {
+            const TraceStore& store = loader.getToken(t).entries;
+            for (size_t i = 0; store.hasAccesses() && i < store.size(); i++) {
+                const uint32_t* tensors = store.accesses(i);
+                for (size_t a = 0; a < store.accessCount(i); a++) {
+                    const uint32_t tensor = tensors[a];
+                    const uint64_t start = layout.offsets[tensor];
+                    const uint64_t end = start + map.tensors[tensor].size_bytes;
+                    score.accesses++;
+                    // Back-to-back accesses of one tensor need no new I/O
+                    if (tensor != previous && previous != NEVER && start != previous_end) {
+                        score.seeks++;
+                        score.seek_bytes += start > previous_end ? start - previous_end : previous_end - start;
+                    }
+                    previous = tensor;
+                    previous_end = end;
+
+                    if (stamp[tensor] != t) {
+                        stamp[tensor] = static_cast<uint32_t>(t);
+                        ranges.emplace_back(start, end);
+                    }
+                }
+            }
+        }
+
+        // Cold read of the token's distinct tensors, neighbours merged
+        std::sort(ranges.begin(), ranges.end());
+        uint32_t extents = 0;
+        uint64_t requests = 0;
+        uint64_t bytes = 0;
+        for (size_t r = 0; r < ranges.size();) {
+            uint64_t begin = ranges[r].first;
+            uint64_t end = ranges[r].second;
+            for (r++; r < ranges.size() && ranges[r].first <= end + config.merge_gap_bytes; r++) {
+                end = std::max(end, ranges[r].second);
+            }
+            extents++;
+            bytes += end - begin;
+            requests += (end - begin + config.ssd.max_request_bytes - 1) / std::max<uint64_t>(config.ssd.max_request_bytes, 1);
+        }
+        double ms = config.ssd.readMs(requests, bytes);
+        score.extents_per_token.push_back(extents);
+        score.read_ms_per_token.push_back(ms);
+        score.bytes_read += bytes;
+        score.read_ms += ms;
+    }
+}
+}
+
+const char* layoutOrderName(LayoutOrder order) {
+    switch (order) {
+        case LayoutOrder::Original: return "Original";
+        case LayoutOrder::FirstAccess: return "First access";
+        case LayoutOrder::LayerMajor: return "Layer-major";
+        case LayoutOrder::CoActivation: return "Co-activation";
+    }
+    return "";
+}
+
+bool layoutOrderFromName(const std::string& name, LayoutOrder& out_order) {
+    for (size_t i = 0; i < LAYOUT_ORDER_COUNT; i++) {
+        LayoutOrder order = static_cast<LayoutOrder>(i);
+        if (name == layoutOrderName(order)) {
+            out_order = order;
+            return true;
+        }
+    }
+    return false;
+}
+
+double SsdModel::readMs(uint64_t requests, uint64_t bytes) const {
+    double latency_ms = requests * read_latency_us / 1000.0 / std::max<uint32_t>(queue_depth, 1);
+    double transfer_ms = bandwidth_gb_s > 0.0 ? bytes / (bandwidth_gb_s * 1e9) * 1000.0 : 0.0;
+    return latency_ms + transfer_ms;
+}
+
+double LayoutScore::meanExtents() const {
+    if (extents_per_token.empty()) {
+        return 0.0;
+    }
+    uint64_t sum = 0;
+    for (uint32_t extents : extents_per_token) {
+        sum += extents;
+    }
+    return static_cast<double>(sum) / extents_per_token.size();
+}
+
+uint32_t LayoutScore::maxExtents() const {
+    return extents_per_token.empty() ? 0 : *std::max_element(extents_per_token.begin(), extents_per_token.end());
+}
+
+LayoutOptimizer::LayoutOptimizer(ThreadPool& pool)
+    : tasks_(pool)
+    , started_(false)
+    , completed_(0)
+    , finished_(false)
+{
+    tasks_.setCompletionCallback([this] { finishRun(); });
+}
+
+LayoutOptimizer::~LayoutOptimizer() {
+    wait();
+}
+
+void LayoutOptimizer::start(const DomainLoader& loader, const LayoutConfig& config) {
+    wait();
+    config_ = config;
+    started_ = true;
+    finished_.store(false, std::memory_order_release);
+    completed_ = 0;
+
+    tasks_.submit(LAYOUT_ORDER_COUNT, [this, &loader](size_t o) {
+        optimize(loader, static_cast<LayoutOrder>(o), config_, layouts_[o]);
+        finishTask();
+    });
+}
+
+void LayoutOptimizer::wait() {
+    tasks_.wait();
+}
+
+float LayoutOptimizer::getProgress() const {
+    if (isFinished()) {
+        return 1.0f;
+    }
+    return static_cast<float>(completed_.load(std::memory_order_relaxed)) / LAYOUT_ORDER_COUNT;
+}
+
+void LayoutOptimizer::optimize(const DomainLoader& loader, LayoutOrder order, const LayoutConfig& config,
+                               TensorLayout& out) {
+    out = TensorLayout();
+    out.order = order;
+    if (!loader.isMemoryMapReady() || loader.getMemoryMap().tensors.empty()) {
+        return;
+    }
+    const MemoryMap& map = loader.getMemoryMap();
+    std::vector<LayoutUnit> units = buildUnits(map);
+
+    if (order == LayoutOrder::Original) {
+        for (const LayoutUnit& unit : units) {
+            out.file_order.insert(out.file_order.end(), unit.tensors.begin(), unit.tensors.end());
+        }
+        out.offsets.resize(map.tensors.size());
+        for (size_t i = 0; i < map.tensors.size(); i++) {
+            out.offsets[i] = map.tensors[i].offset_start;
+        }
+        scoreLayout(loader, config, out);
+        return;
+    }
+
+    if (order == LayoutOrder::FirstAccess) {
+        std::vector<uint32_t> unit_of(map.tensors.size());
+        for (size_t u = 0; u < units.size(); u++) {
+            for (uint32_t tensor : units[u].tensors) {
+                unit_of[tensor] = static_cast<uint32_t>(u);
+            }
+        }
+        uint32_t position = 0;
+        for (size_t t = 0; t < loader.getTokenCount(); t++) {
+            if (!loader.isTokenReady(t)) {
+                continue;
+            }
+            const TraceStore& store = loader.getToken(t).entries;
+            for (size_t i = 0; store.hasAccesses() && i < store.size(); i++) {
+                for (size_t a = 0; a < store.accessCount(i); a++, position++) {
+                    LayoutUnit& unit = units[unit_of[store.accesses(i)[a]]];
+                    unit.first_access = std::min(unit.first_access, position);
+                }
+            }
+        }
+        // Never accessed tensors keep their relative order at the end
+        std::stable_sort(units.begin(), units.end(), [](const LayoutUnit& a, const LayoutUnit& b) {
+            return a.first_access < b.first_access;
+        });
+    } else {
+        std::stable_sort(units.begin(), units.end(), [](const LayoutUnit& a, const LayoutUnit& b) {
+            return a.group != b.group ? a.group < b.group : a.layer < b.layer;
+        });
+    }
+
+    if (order == LayoutOrder::CoActivation) {
+        std::vector<std::vector<int>> chains = coactivationChains(loader.getExpertRouting());
+        for (LayoutUnit& unit : units) {
+            if (unit.layer < 0 || static_cast<size_t>(unit.layer) >= chains.size() ||
+                map.tensors[unit.tensors[0]].expert_id < 0) {
+                continue;
+            }
+            // Rank in the chain; experts never routed follow in id order
+            std::vector<int> rank(ExpertRouting::MAX_EXPERTS, static_cast<int>(ExpertRouting::MAX_EXPERTS));
+            const std::vector<int>& chain = chains[unit.layer];
+            for (size_t r = 0; r < chain.size(); r++) {
+                rank[chain[r]] = static_cast<int>(r);
+            }
+            auto rankOf = [&](uint32_t tensor) {
+                int expert = map.tensors[tensor].expert_id;
+                return expert < static_cast<int>(rank.size()) ? rank[expert] : static_cast<int>(rank.size());
+            };
+            std::stable_sort(unit.tensors.begin(), unit.tensors.end(),
+                             [&](uint32_t a, uint32_t b) { return rankOf(a) < rankOf(b); });
+        }
+    }
+
+    // Repack from the start of the original data section
+    uint64_t cursor = UINT64_MAX;
+    for (const MemoryTensor& tensor : map.tensors) {
+        cursor = std::min(cursor, tensor.offset_start);
+    }
+    const uint64_t alignment = std::max<uint64_t>(config.alignment, 1);
+    out.offsets.resize(map.tensors.size());
+    for (const LayoutUnit& unit : units) {
+        cursor = (cursor + alignment - 1) / alignment * alignment;
+        for (uint32_t tensor : unit.tensors) {
+            out.file_order.push_back(tensor);
+            out.offsets[tensor] = cursor;
+            cursor += map.tensors[tensor].size_bytes;
+        }
+    }
+    scoreLayout(loader, config, out);
+}
+
+void LayoutOptimizer::applyLayout(const MemoryMap& map, const TensorLayout& layout, MemoryMap& out) {
+    out = map;
+    if (layout.offsets.size() != map.tensors.size()) {
+        return;
+    }
+    out.total_size_bytes = 0;
+    for (size_t i = 0; i < out.tensors.size(); i++) {
+        MemoryTensor& tensor = out.tensors[i];
+        tensor.offset_start = layout.offsets[i];
+        tensor.offset_end = tensor.offset_start + tensor.size_bytes;
+        out.total_size_bytes = std::max(out.total_size_bytes, tensor.offset_end);
+    }
+}
+
+void LayoutOptimizer::finishTask() {
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
+
+void LayoutOptimizer::finishRun() {
+    // Runs on the worker that finished the last task, before wait() returns
+    finished_.store(true, std::memory_order_release);
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
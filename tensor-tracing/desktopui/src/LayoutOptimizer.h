@@ -0,0 +1,118 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Candidate tensor orders for the model file
+enum class LayoutOrder : uint8_t {
+    Original = 0,       // The file as it is (GGUF sorts tensor names, so blk.10 precedes blk.2)
+    FirstAccess = 1,    // Tensors by their first DISK access over all tokens
+    LayerMajor = 2,     // Embedding, layers 0..n in numeric order, then output tensors
+    CoActivation = 3,   // Layer-major, experts of each layer chained by co-activation
+};
+
+constexpr size_t LAYOUT_ORDER_COUNT = 4;
+
+const char* layoutOrderName(LayoutOrder order);
+bool layoutOrderFromName(const std::string& name, LayoutOrder& out_order);
+
+// Cost model of a cold read of one token's extents
+//
+// Each extent is split into requests of at most max_request_bytes. Requests
+// pay read_latency_us, overlapped queue_depth at a time, and every byte is
+// transferred at bandwidth_gb_s:
+//   time = requests * latency / queue_depth + bytes / bandwidth
+struct SsdModel {
+    double read_latency_us = 80.0;
+    double bandwidth_gb_s = 3.0;
+    uint32_t queue_depth = 4;
+    uint64_t max_request_bytes = 1024 * 1024;
+
+    double readMs(uint64_t requests, uint64_t bytes) const;
+};
+
+struct LayoutConfig {
+    SsdModel ssd;
+    uint64_t alignment = 32;           // GGUF general.alignment (tensor starts)
+    uint64_t merge_gap_bytes = 4096;   // Extents closer than this are read as one
+};
+
+// Cost of one layout against the domain's trace
+struct LayoutScore {
+    uint64_t accesses = 0;             // Resolved DISK accesses replayed
+    uint64_t seeks = 0;                // Accesses not starting where the previous one ended
+    uint64_t seek_bytes = 0;           // Sum of |start - previous end| over those
+    uint64_t bytes_read = 0;           // Extent bytes over all tokens
+    double read_ms = 0.0;              // SsdModel time over all tokens
+    std::vector<uint32_t> extents_per_token;
+    std::vector<double> read_ms_per_token;
+
+    double meanExtents() const;
+    uint32_t maxExtents() const;
+};
+
+// One candidate order with its remapped offset table
+struct TensorLayout {
+    LayoutOrder order = LayoutOrder::Original;
+    std::vector<uint32_t> file_order;  // MemoryMap tensor indices front to back
+    std::vector<uint64_t> offsets;     // New offset_start per MemoryMap tensor
+    LayoutScore score;
+};
+
+// Proposes and scores tensor orders for a domain's model file
+//
+// Tensors move as whole GGUF tensors: the per-expert slices of an "_exps."
+// tensor stay together, and only CoActivation permutes the expert axis (one
+// permutation per layer, applied to gate/up/down alike, which a rewriter
+// pairs with the same permutation of the router's rows). Every candidate is
+// repacked from the first original data offset with the file's alignment,
+// then scored by replaying the DISK accesses against the new offsets. One
+// pool task per candidate; results are published once isFinished().
+class LayoutOptimizer {
+public:
+    explicit LayoutOptimizer(ThreadPool& pool);
+    ~LayoutOptimizer();
+
+    LayoutOptimizer(const LayoutOptimizer&) = delete;
+    LayoutOptimizer& operator=(const LayoutOptimizer&) = delete;
+
+    // Called from pool workers after each scored candidate
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Loader must be finished and outlive the run (returns immediately)
+    void start(const DomainLoader& loader, const LayoutConfig& config);
+
+    // Block until the current run has completed
+    void wait();
+
+    bool isRunning() const { return started_ && !isFinished(); }
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+    float getProgress() const;
+
+    // Valid once isFinished()
+    const LayoutConfig& getConfig() const { return config_; }
+    const TensorLayout& getLayout(LayoutOrder order) const { return layouts_[static_cast<size_t>(order)]; }
+
+    // Order + score one candidate on the calling thread
+    static void optimize(const DomainLoader& loader, LayoutOrder order, const LayoutConfig& config, TensorLayout& out);
+
+    // Copy of map with a layout's offsets (same tensor indices, so traces still resolve)
+    static void applyLayout(const MemoryMap& map, const TensorLayout& layout, MemoryMap& out);
+
+private:
+    TaskGroup tasks_;
+    LayoutConfig config_;
+    TensorLayout layouts_[LAYOUT_ORDER_COUNT];
+    std::function<void()> progress_callback_;
+
+    bool started_;
+    std::atomic<size_t> completed_;
+    std::atomic<bool> finished_;
+
+    void finishTask();
+    void finishRun();
+};
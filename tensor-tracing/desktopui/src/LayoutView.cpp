@@ -0,0 +1,182 @@
+#include "LayoutView.h"
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+LayoutView::LayoutView()
+    : displayed_(0)
+    , display_changed_(false)
+{
+}
+
+bool LayoutView::consumeDisplayChange() {
+    bool changed = display_changed_;
+    display_changed_ = false;
+    return changed;
+}
+
+void LayoutView::render(const DomainLoader& loader, ThreadPool& pool) {
+    if (!ImGui::CollapsingHeader("Tensor Layout")) {
+        return;
+    }
+
+    renderModelControls();
+
+    const bool running = optimizer_ && optimizer_->isRunning();
+    ImGui::BeginDisabled(running || !loader.isFinished() || !loader.isMemoryMapReady());
+    if (ImGui::Button(optimizer_ ? "Re-run##layout" : "Run##layout")) {
+        if (!optimizer_) {
+            optimizer_ = std::make_unique<LayoutOptimizer>(pool);
+            optimizer_->setProgressCallback(progress_callback_);
+        }
+        showLayout(loader, 0);   // Offsets are about to be replaced
+        optimizer_->start(loader, config_);
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+
+    if (!optimizer_) {
+        ImGui::TextWrapped("Proposes tensor orders for the model file (first access, layer-major, experts "
+                           "chained by co-activation) and scores each against this domain's trace.");
+        return;
+    }
+    if (running) {
+        ImGui::ProgressBar(optimizer_->getProgress(), ImVec2(200, 0), "Scoring...");
+        return;
+    }
+    ImGui::NewLine();
+
+    renderScoreTable(loader);
+    renderTokenPlots();
+}
+
+void LayoutView::renderModelControls() {
+    // Edits apply to the next run
+    SsdModel& ssd = config_.ssd;
+    float latency = static_cast<float>(ssd.read_latency_us);
+    float bandwidth = static_cast<float>(ssd.bandwidth_gb_s);
+    int queue_depth = static_cast<int>(ssd.queue_depth);
+    int request_kb = static_cast<int>(ssd.max_request_bytes / 1024);
+
+    ImGui::PushItemWidth(120);
+    ImGui::DragFloat("Latency (us)", &latency, 1.0f, 1.0f, 10000.0f, "%.0f");
+    ImGui::SameLine();
+    ImGui::DragFloat("Bandwidth (GB/s)", &bandwidth, 0.05f, 0.05f, 100.0f, "%.2f");
+    ImGui::SameLine();
+    ImGui::SliderInt("Queue depth", &queue_depth, 1, 256);
+    ImGui::SameLine();
+    ImGui::DragInt("Request (KB)", &request_kb, 4.0f, 4, 64 * 1024);
+    ImGui::PopItemWidth();
+
+    ssd.read_latency_us = latency;
+    ssd.bandwidth_gb_s = bandwidth;
+    ssd.queue_depth = static_cast<uint32_t>(std::max(queue_depth, 1));
+    ssd.max_request_bytes = static_cast<uint64_t>(std::max(request_kb, 4)) * 1024;
+}
+
+void LayoutView::renderScoreTable(const DomainLoader& loader) {
+    const LayoutScore& original = optimizer_->getLayout(LayoutOrder::Original).score;
+    ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersOuter | ImGuiTableFlags_BordersV;
+    if (ImGui::BeginTable("layout_scores", 6, flags)) {
+        ImGui::TableSetupColumn("Layout", ImGuiTableColumnFlags_WidthFixed, 110.0f);
+        ImGui::TableSetupColumn("Seek Distance", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Seeks", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Extents / Token", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Est. Read / Token", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Heatmap", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+        ImGui::TableHeadersRow();
+
+        for (size_t o = 0; o < LAYOUT_ORDER_COUNT; o++) {
+            const TensorLayout& layout = optimizer_->getLayout(static_cast<LayoutOrder>(o));
+            const LayoutScore& score = layout.score;
+            const size_t tokens = std::max<size_t>(score.extents_per_token.size(), 1);
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", layoutOrderName(layout.order));
+            ImGui::TableNextColumn();
+            ImGui::Text("%s", formatSize(score.seek_bytes).c_str());
+            if (o > 0 && original.seek_bytes > 0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%+.0f%%)", (static_cast<double>(score.seek_bytes) / original.seek_bytes - 1.0) * 100.0);
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(score.seeks));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f (max %u)", score.meanExtents(), score.maxExtents());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f ms", score.read_ms / tokens);
+            if (o > 0 && original.read_ms > 0.0) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(%+.1f%%)", (score.read_ms / original.read_ms - 1.0) * 100.0);
+            }
+            ImGui::TableNextColumn();
+            char label[32];
+            snprintf(label, sizeof(label), "##show_layout%zu", o);
+            if (ImGui::RadioButton(label, displayed_ == static_cast<int>(o))) {
+                showLayout(loader, static_cast<int>(o));
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void LayoutView::renderTokenPlots() {
+    if (ImPlot::BeginSubplots("##layout_tokens", 1, 2, ImVec2(-1, 220), ImPlotSubplotFlags_NoTitle)) {
+        if (ImPlot::BeginPlot("##layout_extents")) {
+            ImPlot::SetupAxis(ImAxis_X1, "Token", ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y1, "Extents", ImPlotAxisFlags_AutoFit);
+            for (size_t o = 0; o < LAYOUT_ORDER_COUNT; o++) {
+                const TensorLayout& layout = optimizer_->getLayout(static_cast<LayoutOrder>(o));
+                const std::vector<uint32_t>& extents = layout.score.extents_per_token;
+                ys_.assign(extents.begin(), extents.end());
+                ImPlot::PlotLine(layoutOrderName(layout.order), ys_.data(), static_cast<int>(ys_.size()));
+            }
+            ImPlot::EndPlot();
+        }
+        if (ImPlot::BeginPlot("##layout_read_ms")) {
+            ImPlot::SetupAxis(ImAxis_X1, "Token", ImPlotAxisFlags_AutoFit);
+            ImPlot::SetupAxis(ImAxis_Y1, "Est. Read (ms)", ImPlotAxisFlags_AutoFit);
+            for (size_t o = 0; o < LAYOUT_ORDER_COUNT; o++) {
+                const TensorLayout& layout = optimizer_->getLayout(static_cast<LayoutOrder>(o));
+                const std::vector<double>& ms = layout.score.read_ms_per_token;
+                ImPlot::PlotLine(layoutOrderName(layout.order), ms.data(), static_cast<int>(ms.size()));
+            }
+            ImPlot::EndPlot();
+        }
+        ImPlot::EndSubplots();
+    }
+}
+
+void LayoutView::showLayout(const DomainLoader& loader, int order) {
+    if (order == displayed_) {
+        return;
+    }
+    displayed_ = order;
+    display_changed_ = true;
+    displayed_index_.clear();
+    if (order > 0) {
+        LayoutOptimizer::applyLayout(loader.getMemoryMap(), optimizer_->getLayout(static_cast<LayoutOrder>(order)),
+                                     displayed_map_);
+        displayed_index_.build(displayed_map_);
+    } else {
+        displayed_map_ = MemoryMap();
+    }
+}
+
+std::string LayoutView::formatSize(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit_index = 0;
+    double size = static_cast<double>(bytes);
+
+    while (size >= 1024.0 && unit_index < 4) {
+        size /= 1024.0;
+        unit_index++;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[unit_index];
+    return oss.str();
+}
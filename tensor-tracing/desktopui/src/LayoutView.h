@@ -0,0 +1,52 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "LayoutOptimizer.h"
+#include "TensorIndex.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Tensor layout panel for one domain
+//
+// Runs a LayoutOptimizer on demand with an editable SSD model, compares the
+// candidate orders against the original file and can hand a remapped memory
+// map to the heatmaps so the same trace is drawn over the proposed layout.
+class LayoutView {
+public:
+    LayoutView();
+
+    // Called from pool workers while a run progresses (e.g. to wake the UI)
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Loader must be finished before Run is enabled; pool scores the candidates
+    void render(const DomainLoader& loader, ThreadPool& pool);
+
+    // Layout the heatmaps should draw, or nullptr for the file as it is
+    const MemoryMap* getDisplayedMap() const { return displayed_ > 0 ? &displayed_map_ : nullptr; }
+    const TensorIndex* getDisplayedIndex() const { return displayed_ > 0 ? &displayed_index_ : nullptr; }
+
+    // True once after the displayed layout changed
+    bool consumeDisplayChange();
+
+private:
+    std::unique_ptr<LayoutOptimizer> optimizer_;
+    std::function<void()> progress_callback_;
+    LayoutConfig config_;
+
+    int displayed_;                     // LayoutOrder shown in the heatmaps (0 = original)
+    bool display_changed_;
+    MemoryMap displayed_map_;
+    TensorIndex displayed_index_;       // Keys point into displayed_map_
+
+    std::vector<double> ys_;            // Plot scratch
+
+    void renderModelControls();
+    void renderScoreTable(const DomainLoader& loader);
+    void renderTokenPlots();
+    void showLayout(const DomainLoader& loader, int order);
+
+    static std::string formatSize(uint64_t bytes);
+};
@@ -0,0 +1,101 @@
+#include "MemoryMapCache.h"
+#include "GGUFFile.h"
+#include "JSONLoader.h"
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+#include <sys/stat.h>
+
+namespace {
+// Content key: size + hash (a file that cannot be read keys by path instead)
+std::string contentKey(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return "path:" + path;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    const std::string& bytes = contents.str();
+
+    std::ostringstream key;
+    key << bytes.size() << ":" << std::hex << std::hash<std::string_view>()(bytes);
+    return key.str();
+}
+
+bool isModelFile(const std::string& path) {
+    return path.size() > 5 && path.compare(path.size() - 5, 5, ".gguf") == 0;
+}
+
+// Model files are far too large to hash: device, inode, size and mtime
+std::string fileKey(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return "path:" + path;
+    }
+    std::ostringstream key;
+    key << "gguf:" << st.st_dev << ":" << st.st_ino << ":" << st.st_size << ":" << st.st_mtime;
+    return key.str();
+}
+
+bool loadModelFile(const std::string& path, SharedMemoryMap& out) {
+    auto started = std::chrono::steady_clock::now();
+    GGUFFile file;
+    if (!file.open(path)) {
+        out.error = file.getLastError();
+        return false;
+    }
+    file.buildMemoryMap(out.map);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << "✓ Read memory map from GGUF header: " << out.map.model_name << " (" << ms << " ms)" << std::endl;
+    std::cout << "  Tensors: " << out.map.tensors.size() << std::endl;
+    std::cout << "  Total size: " << out.map.getTotalSizeGB() << " GB" << std::endl;
+    return true;
+}
+}
+
+std::shared_ptr<const SharedMemoryMap> MemoryMapCache::acquire(const std::string& path) {
+    const bool model_file = isModelFile(path);
+    const std::string key = model_file ? fileKey(path) : contentKey(path);
+
+    std::promise<std::shared_ptr<const SharedMemoryMap>> promise;
+    std::shared_future<std::shared_ptr<const SharedMemoryMap>> existing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = maps_.find(key);
+        if (it != maps_.end()) {
+            existing = it->second;
+        } else {
+            maps_.emplace(key, promise.get_future().share());
+        }
+    }
+
+    // Already parsed or being parsed by another domain's worker
+    if (existing.valid()) {
+        return existing.get();
+    }
+
+    // First request for this content: parse on the calling thread
+    auto shared = std::make_shared<SharedMemoryMap>();
+    if (model_file) {
+        shared->ok = loadModelFile(path, *shared);
+    } else {
+        shared->ok = JSONLoader::loadMemoryMap(path, shared->map);
+        if (!shared->ok) {
+            shared->error = JSONLoader::getLastError();
+        }
+    }
+    if (shared->ok) {
+        shared->index.build(shared->map);
+    }
+    promise.set_value(shared);
+    return shared;
+}
+
+size_t MemoryMapCache::getMapCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maps_.size();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MemoryMap.h"
+#include "TensorIndex.h"
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// One parsed and indexed memory map, shared by every domain of the same model
+struct SharedMemoryMap {
+    MemoryMap map;
+    TensorIndex index;    // Points into map (never moved, always held by shared_ptr)
+    bool ok = false;
+    std::string error;    // Set when ok is false
+};
+
+// Parses each distinct memory-map.json once per process
+//
+// Every domain directory of an experiment carries its own copy of the same
+// memory-map.json. Files are keyed by content, so those copies resolve to a
+// single instance; callers asking for a file that is still being parsed
+// block until the first caller is done instead of parsing it again.
+//
+// A path ending in ".gguf" is a model file: its map is built from the GGUF
+// header alone (see GGUFFile), keyed by file identity instead of content.
+class MemoryMapCache {
+public:
+    MemoryMapCache() = default;
+    MemoryMapCache(const MemoryMapCache&) = delete;
+    MemoryMapCache& operator=(const MemoryMapCache&) = delete;
+
+    // Parsed map for path (never null; check ok)
+    std::shared_ptr<const SharedMemoryMap> acquire(const std::string& path);
+
+    // Number of distinct maps parsed so far
+    size_t getMapCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const SharedMemoryMap>>> maps_;
+};
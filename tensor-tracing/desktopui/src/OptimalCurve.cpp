@@ -0,0 +1,323 @@
+#include "OptimalCurve.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <random>
+
+namespace {
+constexpr uint32_t NIL = 0xFFFFFFFF;
+constexpr uint32_t NEVER = 0xFFFFFFFF;  // No next use
+
+// Mattson's OPT priority stack as an implicit treap (one node per page)
+//
+// Referencing the page at depth d puts it on top and pushes the old top
+// down: at each depth the entry with the later next use keeps going, so
+// only the running maxima ("records") of depths 2..d-1 move, each into the
+// next record's slot, and the last one lands at d. A strictly increasing
+// run of records shifts by one slot as a whole, which is one split + merge.
+class PriorityStack {
+public:
+    explicit PriorityStack(uint32_t node_count)
+        : nodes_(node_count)
+        , root_(NIL)
+    {
+        std::mt19937 rng(0x5eed);
+        for (Node& node : nodes_) {
+            node.priority = rng();
+        }
+    }
+
+    // Reference page (dense id) whose next use is next_use; returns the
+    // stack distance before the update (0 on first touch)
+    uint32_t access(uint32_t page, uint32_t next_use, bool seen) {
+        uint32_t above, below;
+        uint32_t distance = 0;
+        if (seen) {
+            distance = rank(page);
+            uint32_t self;
+            split(root_, distance - 1, above, self);
+            split(self, 1, self, below);
+        } else {
+            above = root_;
+            below = NIL;
+        }
+
+        Node& node = nodes_[page];
+        node.left = node.right = node.parent = NIL;
+        node.value = next_use;
+        pull(page);
+
+        if (above == NIL) {
+            root_ = merge(page, below);
+            return distance;
+        }
+
+        // Old top is the first carry; push it down through depths 2..d-1
+        uint32_t carry, rest;
+        split(above, 1, carry, rest);
+        uint32_t settled = NIL;
+        while (rest != NIL) {
+            uint32_t skip = firstAbove(rest, nodes_[carry].value);
+            if (skip == size(rest)) {
+                settled = merge(settled, rest);
+                break;
+            }
+
+            uint32_t lower, run, tail;
+            split(rest, skip, lower, rest);
+            settled = merge(settled, lower);
+            uint32_t run_length = increasingPrefix(rest, nodes_[carry].value);
+            split(rest, run_length, run, rest);
+            split(run, run_length - 1, run, tail);
+
+            // carry, run[0..len-2] take the run's slots; its last entry carries on
+            settled = merge(settled, merge(carry, run));
+            carry = tail;
+        }
+
+        root_ = merge(merge(page, settled), merge(carry, below));
+        return distance;
+    }
+
+private:
+    struct Node {
+        uint32_t left = NIL;
+        uint32_t right = NIL;
+        uint32_t parent = NIL;
+        uint32_t priority = 0;
+        uint32_t size = 1;
+        uint32_t value = 0;    // Next use of this page
+        uint32_t max = 0;      // Subtree aggregates over value
+        uint32_t first = 0;
+        uint32_t last = 0;
+        uint32_t increasing = 1;  // Subtree values strictly increase in stack order
+    };
+
+    std::vector<Node> nodes_;
+    uint32_t root_;
+
+    uint32_t size(uint32_t n) const { return n == NIL ? 0 : nodes_[n].size; }
+
+    void pull(uint32_t n) {
+        Node& node = nodes_[n];
+        node.size = 1;
+        node.max = node.first = node.last = node.value;
+        bool increasing = true;
+        if (node.left != NIL) {
+            Node& l = nodes_[node.left];
+            node.size += l.size;
+            node.max = std::max(node.max, l.max);
+            node.first = l.first;
+            increasing = l.increasing && l.last < node.value;
+            l.parent = n;
+        }
+        if (node.right != NIL) {
+            Node& r = nodes_[node.right];
+            node.size += r.size;
+            node.max = std::max(node.max, r.max);
+            node.last = r.last;
+            increasing = increasing && r.increasing && node.value < r.first;
+            r.parent = n;
+        }
+        node.increasing = increasing;
+    }
+
+    uint32_t merge(uint32_t a, uint32_t b) {
+        if (a == NIL || b == NIL) {
+            uint32_t n = a == NIL ? b : a;
+            if (n != NIL) {
+                nodes_[n].parent = NIL;
+            }
+            return n;
+        }
+        if (nodes_[a].priority > nodes_[b].priority) {
+            nodes_[a].right = merge(nodes_[a].right, b);
+            pull(a);
+            nodes_[a].parent = NIL;
+            return a;
+        }
+        nodes_[b].left = merge(a, nodes_[b].left);
+        pull(b);
+        nodes_[b].parent = NIL;
+        return b;
+    }
+
+    // First count entries into a, the rest into b
+    void split(uint32_t n, uint32_t count, uint32_t& a, uint32_t& b) {
+        if (n == NIL) {
+            a = b = NIL;
+            return;
+        }
+        Node& node = nodes_[n];
+        if (size(node.left) >= count) {
+            split(node.left, count, a, node.left);
+            pull(n);
+            b = n;
+        } else {
+            split(node.right, count - size(node.left) - 1, node.right, b);
+            pull(n);
+            a = n;
+        }
+        if (a != NIL) {
+            nodes_[a].parent = NIL;
+        }
+        if (b != NIL) {
+            nodes_[b].parent = NIL;
+        }
+    }
+
+    // 1-based depth of a node in the stack
+    uint32_t rank(uint32_t n) const {
+        uint32_t depth = size(nodes_[n].left) + 1;
+        while (nodes_[n].parent != NIL) {
+            uint32_t p = nodes_[n].parent;
+            if (nodes_[p].right == n) {
+                depth += size(nodes_[p].left) + 1;
+            }
+            n = p;
+        }
+        return depth;
+    }
+
+    // Index of the first entry with value > v (size if none)
+    uint32_t firstAbove(uint32_t n, uint32_t v) const {
+        uint32_t index = 0;
+        while (n != NIL) {
+            const Node& node = nodes_[n];
+            if (node.left != NIL && nodes_[node.left].max > v) {
+                n = node.left;
+                continue;
+            }
+            index += size(node.left);
+            if (node.value > v) {
+                return index;
+            }
+            index++;
+            if (node.right == NIL || nodes_[node.right].max <= v) {
+                return index + size(node.right);
+            }
+            n = node.right;
+        }
+        return index;
+    }
+
+    // Length of the strictly increasing prefix that starts above v
+    uint32_t increasingPrefix(uint32_t n, uint32_t v) const {
+        uint32_t length = 0;
+        while (n != NIL) {
+            const Node& node = nodes_[n];
+            if (node.left != NIL) {
+                const Node& l = nodes_[node.left];
+                if (!l.increasing || l.first <= v) {
+                    n = node.left;
+                    continue;
+                }
+                length += l.size;
+                v = l.last;
+            }
+            if (node.value <= v) {
+                return length;
+            }
+            length++;
+            v = node.value;
+            n = node.right;
+        }
+        return length;
+    }
+};
+}
+
+OptimalCurve::OptimalCurve()
+    : accesses_(0)
+    , cold_misses_(0)
+{
+}
+
+void OptimalCurve::clear() {
+    accesses_ = 0;
+    cold_misses_ = 0;
+    cumulative_hits_.clear();
+}
+
+bool OptimalCurve::build(const PageStream& stream) {
+    clear();
+
+    const std::vector<PageExtent>& extents = stream.getExtents();
+    if (stream.getAccessCount() >= NEVER) {
+        last_error_ = "Stream too long for 32-bit next-use indices";
+        return false;
+    }
+    const uint32_t n = static_cast<uint32_t>(stream.getAccessCount());
+
+    // Dense ids in first-touch order so the stack is sized by the footprint
+    std::vector<uint32_t> dense(stream.getPageCount(), NIL);
+    uint32_t distinct = 0;
+    for (const PageExtent& extent : extents) {
+        for (uint32_t p = extent.first_page; p < extent.first_page + extent.page_count; p++) {
+            if (dense[p] == NIL) {
+                dense[p] = distinct++;
+            }
+        }
+    }
+
+    // Next use of every access, walking the stream backwards
+    std::vector<uint32_t> next_use(n);
+    std::vector<uint32_t> upcoming(distinct, NEVER);
+    uint32_t t = n;
+    for (auto extent = extents.rbegin(); extent != extents.rend(); ++extent) {
+        for (uint32_t p = extent->first_page + extent->page_count; p-- > extent->first_page;) {
+            uint32_t page = dense[p];
+            next_use[--t] = upcoming[page];
+            upcoming[page] = t;
+        }
+    }
+    upcoming.clear();
+    upcoming.shrink_to_fit();
+
+    // One pass: histogram of stack distances
+    std::vector<uint64_t> distances(distinct + 1, 0);
+    std::vector<uint8_t> seen(distinct, 0);
+    PriorityStack stack(distinct);
+    t = 0;
+    for (const PageExtent& extent : extents) {
+        // Extents span thousands of pages, each a stack update; give up at shutdown
+        if (ThreadPool::isTaskCancelled()) {
+            last_error_ = "Cancelled";
+            return false;
+        }
+        for (uint32_t p = extent.first_page; p < extent.first_page + extent.page_count; p++, t++) {
+            uint32_t page = dense[p];
+            distances[stack.access(page, next_use[t], seen[page] != 0)]++;
+            seen[page] = 1;
+        }
+    }
+
+    accesses_ = n;
+    cold_misses_ = distances[0];
+
+    // Hits with k pages = accesses at distance 1..k
+    size_t max_distance = distinct;
+    while (max_distance > 0 && distances[max_distance] == 0) {
+        max_distance--;
+    }
+    cumulative_hits_.assign(max_distance + 1, 0);
+    for (size_t k = 1; k <= max_distance; k++) {
+        cumulative_hits_[k] = cumulative_hits_[k - 1] + distances[k];
+    }
+    return true;
+}
+
+uint64_t OptimalCurve::getHits(uint64_t capacity_pages) const {
+    if (cumulative_hits_.empty()) {
+        return 0;
+    }
+    return cumulative_hits_[std::min<uint64_t>(capacity_pages, cumulative_hits_.size() - 1)];
+}
+
+CacheSimStats OptimalCurve::getStats(uint64_t capacity_pages) const {
+    CacheSimStats stats;
+    stats.accesses = accesses_;
+    stats.hits = getHits(capacity_pages);
+    stats.cold_misses = cold_misses_;
+    stats.capacity_misses = accesses_ - stats.hits - cold_misses_;
+    return stats;
+}
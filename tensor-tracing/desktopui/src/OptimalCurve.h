@@ -0,0 +1,41 @@
+#pragma once
+
+#include "CachePolicy.h"
+#include "PageStream.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Belady's MIN (OPT) over a PageStream, for every cache size at once
+//
+// OPT is a stack algorithm (Mattson et al., 1970): the MIN cache of size k is
+// the top k of one priority stack ordered by next use, so a single pass
+// yields the stack distance of every access and the hit count of every
+// capacity is a prefix sum. Next-use indices are precomputed backwards over
+// the stream. Stack updates rotate whole increasing runs in O(log n), so the
+// pass costs O((n + r) log m) for n accesses, m distinct pages and r rotated
+// runs (well under one per access on tensor traces).
+class OptimalCurve {
+public:
+    OptimalCurve();
+
+    bool build(const PageStream& stream);
+    void clear();
+
+    bool empty() const { return accesses_ == 0; }
+
+    // Hits / miss breakdown of MIN with capacity_pages (clamped to the footprint)
+    uint64_t getHits(uint64_t capacity_pages) const;
+    CacheSimStats getStats(uint64_t capacity_pages) const;
+
+    // Capacity beyond which MIN only misses cold pages
+    uint64_t getMaxDistance() const { return cumulative_hits_.empty() ? 0 : cumulative_hits_.size() - 1; }
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    uint64_t accesses_;
+    uint64_t cold_misses_;
+    std::vector<uint64_t> cumulative_hits_;  // [k] = hits with k pages (trimmed after the last distance)
+    std::string last_error_;
+};
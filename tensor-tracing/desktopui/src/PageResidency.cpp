@@ -0,0 +1,277 @@
+#include "PageResidency.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+constexpr uint64_t LOW_BITS = 0x0101010101010101ull;  // Low bit of every mincore() byte in a word
+
+void putVarint(uint64_t value, std::vector<uint8_t>& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns false past end
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Flip bits [first, last) of a word bitset
+void flipBits(std::vector<uint64_t>& bits, uint64_t first, uint64_t last) {
+    while (first < last) {
+        const uint64_t word = first / 64;
+        const uint64_t shift = first % 64;
+        const uint64_t count = std::min<uint64_t>(64 - shift, last - first);
+        const uint64_t mask = count == 64 ? ~0ull : ((1ull << count) - 1) << shift;
+        bits[word] ^= mask;
+        first += count;
+    }
+}
+}
+
+uint32_t encodeResidencyDelta(const unsigned char* previous, const unsigned char* current, size_t pages,
+                              uint64_t first_page, std::vector<uint8_t>& out) {
+    uint32_t runs = 0;
+    bool in_run = false;
+    uint64_t run_start = 0;
+    uint64_t last_end = 0;
+    auto flipped = [&](uint64_t page, bool flip) {
+        if (flip && !in_run) {
+            in_run = true;
+            run_start = page;
+        } else if (!flip && in_run) {
+            in_run = false;
+            putVarint(run_start - last_end, out);
+            putVarint(page - run_start, out);
+            last_end = page;
+            runs++;
+        }
+    };
+
+    // Eight pages per step; unchanged stretches (the common case) cost one compare
+    size_t i = 0;
+    for (; i + 8 <= pages; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, previous + i, 8);
+        std::memcpy(&b, current + i, 8);
+        const uint64_t diff = (a ^ b) & LOW_BITS;
+        if (diff == (in_run ? LOW_BITS : 0)) {
+            continue;
+        }
+        for (size_t k = 0; k < 8; k++) {
+            flipped(first_page + i + k, (diff >> (k * 8)) & 1);
+        }
+    }
+    for (; i < pages; i++) {
+        flipped(first_page + i, ((previous[i] ^ current[i]) & 1) != 0);
+    }
+    flipped(first_page + pages, false);
+    return runs;
+}
+
+PageResidency::PageResidency()
+    : page_size_(0)
+    , file_size_(0)
+    , period_ns_(0)
+    , sweep_ns_(0)
+    , start_ns_(0)
+    , trace_base_ns_(RESIDENCY_NO_BASE)
+{
+}
+
+void PageResidency::clear() {
+    page_size_ = 0;
+    file_size_ = 0;
+    period_ns_ = 0;
+    sweep_ns_ = 0;
+    start_ns_ = 0;
+    trace_base_ns_ = RESIDENCY_NO_BASE;
+    records_.clear();
+    payload_.clear();
+}
+
+bool PageResidency::load(const std::string& path) {
+    clear();
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        last_error_ = "Failed to open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ResidencyFileHeader header;
+    if (data.size() < sizeof(header)) {
+        last_error_ = "Truncated residency file: " + path;
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, RESIDENCY_MAGIC, sizeof(header.magic)) != 0) {
+        last_error_ = "Not a residency file: " + path;
+        return false;
+    }
+    if (header.version != RESIDENCY_VERSION || header.page_size == 0) {
+        last_error_ = "Unsupported residency file version " + std::to_string(header.version) + ": " + path;
+        return false;
+    }
+
+    size_t position = sizeof(header);
+    while (position + sizeof(ResidencySampleHeader) <= data.size()) {
+        ResidencySampleHeader sample;
+        std::memcpy(&sample, data.data() + position, sizeof(sample));
+        position += sizeof(sample);
+        if (sample.payload_bytes > data.size() - position) {
+            break;
+        }
+        if (sample.run_count > 0) {
+            records_.push_back({sample.timestamp_ns, payload_.size(), sample.run_count});
+            payload_.insert(payload_.end(), data.begin() + position, data.begin() + position + sample.payload_bytes);
+        }
+        position += sample.payload_bytes;
+    }
+
+    page_size_ = header.page_size;
+    file_size_ = header.file_size;
+    period_ns_ = header.period_ns;
+    sweep_ns_ = header.sweep_ns;
+    start_ns_ = header.start_ns;
+    trace_base_ns_ = header.trace_base_ns;
+    return true;
+}
+
+int64_t PageResidency::getRecordTraceNs(size_t record) const {
+    const uint64_t base = hasTraceBase() ? trace_base_ns_ : start_ns_;
+    return static_cast<int64_t>(records_[record].timestamp_ns - base);
+}
+
+size_t PageResidency::recordAt(int64_t trace_ns) const {
+    // Records are in time order
+    size_t lo = 0, hi = records_.size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (getRecordTraceNs(mid) <= trace_ns) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo == 0 ? SIZE_MAX : lo - 1;
+}
+
+ResidencyCursor::ResidencyCursor()
+    : residency_(nullptr)
+    , record_(BEFORE_FIRST)
+    , page_size_(0)
+    , page_count_(0)
+{
+}
+
+void ResidencyCursor::reset() {
+    record_ = BEFORE_FIRST;
+    std::fill(bits_.begin(), bits_.end(), 0);
+}
+
+void ResidencyCursor::seek(const PageResidency& residency, size_t record) {
+    if (residency_ != &residency || page_count_ != residency.getPageCount()) {
+        residency_ = &residency;
+        page_size_ = residency.getPageSize();
+        page_count_ = residency.getPageCount();
+        bits_.assign((page_count_ + 63) / 64, 0);
+        record_ = BEFORE_FIRST;
+    }
+    if (record != BEFORE_FIRST && record >= residency.getRecordCount()) {
+        record = residency.getRecordCount() - 1;
+    }
+
+    // Positions shifted by one so BEFORE_FIRST is 0
+    size_t at = record_ + 1;
+    const size_t target = record + 1;
+    if (target < at && target < at - target) {
+        // Replaying from the start crosses fewer runs than undoing
+        reset();
+        at = 0;
+    }
+    for (; at < target; at++) {
+        apply(at);
+    }
+    for (; at > target; at--) {
+        apply(at - 1);
+    }
+    record_ = record;
+}
+
+void ResidencyCursor::apply(size_t record) {
+    const PageResidency::Record& entry = residency_->records_[record];
+    const uint8_t* p = residency_->payload_.data() + entry.payload_offset;
+    const uint8_t* end = residency_->payload_.data() + residency_->payload_.size();
+    uint64_t page = 0;
+    for (uint32_t r = 0; r < entry.run_count; r++) {
+        uint64_t gap = 0, length = 0;
+        if (!getVarint(p, end, gap) || !getVarint(p, end, length)) {
+            return;
+        }
+        page += gap;
+        flipBits(bits_, std::min(page, page_count_), std::min(page + length, page_count_));
+        page += length;
+    }
+}
+
+uint64_t ResidencyCursor::residentPages(uint64_t first, uint64_t last) const {
+    last = std::min(last, page_count_);
+    uint64_t count = 0;
+    while (first < last) {
+        const uint64_t word = first / 64;
+        const uint64_t shift = first % 64;
+        const uint64_t span = std::min<uint64_t>(64 - shift, last - first);
+        const uint64_t mask = span == 64 ? ~0ull : ((1ull << span) - 1) << shift;
+        count += __builtin_popcountll(bits_[word] & mask);
+        first += span;
+    }
+    return count;
+}
+
+uint64_t ResidencyCursor::residentBytes(uint64_t offset, uint64_t size) const {
+    if (page_size_ == 0 || size == 0) {
+        return 0;
+    }
+    const uint64_t end = offset + size;
+    const uint64_t first_page = offset / page_size_;
+    const uint64_t last_page = (end - 1) / page_size_;
+    uint64_t resident = residentPages(first_page, last_page + 1) * page_size_;
+
+    // Parts of the edge pages outside the extent
+    if (isResident(first_page)) {
+        resident -= offset - first_page * page_size_;
+    }
+    if (isResident(last_page)) {
+        resident -= (last_page + 1) * page_size_ - end;
+    }
+    return resident;
+}
+
+void ResidencyCursor::rasterize(uint64_t begin, uint64_t end, int width, std::vector<uint8_t>& out) const {
+    out.assign(width > 0 ? static_cast<size_t>(width) : 0, 0);
+    if (page_size_ == 0 || end <= begin || width <= 0) {
+        return;
+    }
+    const double bytes_per_column = static_cast<double>(end - begin) / width;
+    for (int c = 0; c < width; c++) {
+        const uint64_t b0 = begin + static_cast<uint64_t>(c * bytes_per_column);
+        const uint64_t b1 = begin + static_cast<uint64_t>((c + 1) * bytes_per_column);
+        const uint64_t p0 = b0 / page_size_;
+        const uint64_t p1 = std::max(p0 + 1, (b1 + page_size_ - 1) / page_size_);
+        const double share = static_cast<double>(residentPages(p0, p1)) / (p1 - p0);
+        out[c] = static_cast<uint8_t>(share * 255.0 + 0.5);
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Binary layout of page_residency.bin, written by residency-sampler
+//
+// A fixed header, then one record per sample that changed anything: a
+// ResidencySampleHeader followed by its runs of pages whose residency flipped
+// since they were last sampled, each run as LEB128 varints (pages since the
+// end of the previous run, starting from page 0; run length). A sample may
+// cover only a slice of the file. The first record flips from "nothing
+// resident". Timestamps are raw CLOCK_MONOTONIC; trace_base_ns is the
+// CLOCK_MONOTONIC time of the tracer's timestamp_ns 0.
+
+constexpr char RESIDENCY_MAGIC[8] = {'P', 'G', 'R', 'E', 'S', 'I', 'D', '1'};
+constexpr uint32_t RESIDENCY_VERSION = 1;
+constexpr uint64_t RESIDENCY_NO_BASE = UINT64_MAX;  // trace_base_ns sentinel for "unknown"
+constexpr const char* RESIDENCY_FILE_NAME = "page_residency.bin";
+
+#pragma pack(push, 1)
+
+struct ResidencyFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t page_size;
+    uint64_t file_size;             // Bytes of the sampled file
+    uint64_t period_ns;             // Requested sampling period
+    uint64_t start_ns;              // CLOCK_MONOTONIC of the first sample
+    uint64_t trace_base_ns;         // RESIDENCY_NO_BASE if unknown
+    uint64_t sample_count;          // Samples taken, including unchanged ones
+    uint64_t sweep_ns;              // Mean time between two samples of the same page
+};
+
+struct ResidencySampleHeader {
+    uint64_t timestamp_ns;          // CLOCK_MONOTONIC
+    uint32_t run_count;
+    uint32_t payload_bytes;         // Varint bytes that follow
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(ResidencyFileHeader) == 64, "ResidencyFileHeader must be 64 bytes");
+static_assert(sizeof(ResidencySampleHeader) == 16, "ResidencySampleHeader must be 16 bytes");
+
+// Append the runs that flipped between two mincore() vectors of pages
+// [first_page, first_page + pages) (low bit = resident) to out as varints;
+// returns the number of runs
+uint32_t encodeResidencyDelta(const unsigned char* previous, const unsigned char* current, size_t pages,
+                              uint64_t first_page, std::vector<uint8_t>& out);
+
+// A recorded page_residency.bin, read whole into memory (immutable once loaded)
+class PageResidency {
+public:
+    PageResidency();
+
+    // Returns true on success, false on failure (see getLastError); a record
+    // cut short by a killed sampler ends the file
+    bool load(const std::string& path);
+    void clear();
+
+    bool isLoaded() const { return page_size_ != 0; }
+    uint64_t getPageSize() const { return page_size_; }
+    uint64_t getFileSize() const { return file_size_; }
+    uint64_t getPageCount() const { return page_size_ ? (file_size_ + page_size_ - 1) / page_size_ : 0; }
+    uint64_t getPeriodNs() const { return period_ns_; }
+    // Mean time between two samples of the same page (the period unless the file was swept in slices)
+    uint64_t getSweepNs() const { return sweep_ns_; }
+
+    // Without a recorded trace base, trace time 0 is taken as the first sample
+    bool hasTraceBase() const { return trace_base_ns_ != RESIDENCY_NO_BASE; }
+
+    // Records (samples that changed something)
+    size_t getRecordCount() const { return records_.size(); }
+    // Record time in trace timestamp_ns (may be negative before the trace started)
+    int64_t getRecordTraceNs(size_t record) const;
+
+    // Last record at or before trace_ns, or SIZE_MAX before the first
+    size_t recordAt(int64_t trace_ns) const;
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    friend class ResidencyCursor;
+
+    struct Record {
+        uint64_t timestamp_ns;
+        uint64_t payload_offset;
+        uint32_t run_count;
+    };
+
+    uint64_t page_size_;
+    uint64_t file_size_;
+    uint64_t period_ns_;
+    uint64_t sweep_ns_;
+    uint64_t start_ns_;
+    uint64_t trace_base_ns_;
+    std::vector<Record> records_;
+    std::vector<uint8_t> payload_;
+    std::string last_error_;
+};
+
+// Residency bitmap at one record of a PageResidency
+//
+// Deltas are XOR flips, so the cursor walks forward and backward by applying
+// the runs in between; scrubbing costs the runs crossed, not the whole file.
+class ResidencyCursor {
+public:
+    static constexpr size_t BEFORE_FIRST = SIZE_MAX;
+
+    ResidencyCursor();
+
+    // Bring the bitmap to record (BEFORE_FIRST = nothing resident)
+    void seek(const PageResidency& residency, size_t record);
+    void reset();
+
+    size_t getRecord() const { return record_; }
+    bool isResident(uint64_t page) const {
+        return page / 64 < bits_.size() && (bits_[page / 64] >> (page % 64)) & 1;
+    }
+
+    // Resident bytes of [offset, offset + size)
+    uint64_t residentBytes(uint64_t offset, uint64_t size) const;
+
+    // Resident share of each of width equal columns of [begin, end), as 0..255
+    void rasterize(uint64_t begin, uint64_t end, int width, std::vector<uint8_t>& out) const;
+
+private:
+    const PageResidency* residency_;
+    size_t record_;
+    uint64_t page_size_;
+    uint64_t page_count_;
+    std::vector<uint64_t> bits_;
+
+    void apply(size_t record);
+    uint64_t residentPages(uint64_t first, uint64_t last) const;  // Pages [first, last)
+};
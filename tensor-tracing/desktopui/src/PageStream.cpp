@@ -0,0 +1,96 @@
+#include "PageStream.h"
+#include <algorithm>
+
+PageStream::PageStream()
+    : page_size_(DEFAULT_PAGE_SIZE)
+    , page_count_(0)
+    , token_count_(0)
+    , layer_slot_count_(1)
+    , access_count_(0)
+    , distinct_pages_(0)
+{
+}
+
+void PageStream::clear() {
+    page_count_ = 0;
+    token_count_ = 0;
+    layer_slot_count_ = 1;
+    access_count_ = 0;
+    distinct_pages_ = 0;
+    extents_.clear();
+}
+
+bool PageStream::build(const DomainLoader& loader, size_t page_size) {
+    clear();
+    page_size_ = std::max<size_t>(page_size, 1);
+
+    if (!loader.isMemoryMapReady()) {
+        last_error_ = "Memory map not loaded";
+        return false;
+    }
+
+    const MemoryMap& map = loader.getMemoryMap();
+    uint64_t pages = (map.total_size_bytes + page_size_ - 1) / page_size_;
+    if (pages > UINT32_MAX) {
+        last_error_ = "Page size too small for a " + std::to_string(map.total_size_bytes) + " byte file";
+        return false;
+    }
+    page_count_ = static_cast<uint32_t>(pages);
+
+    // Tensor -> page run + layer slot, computed once
+    struct TensorPages {
+        uint32_t first_page;
+        uint32_t page_count;
+        uint16_t layer_slot;
+    };
+    std::vector<TensorPages> tensor_pages(map.tensors.size());
+    for (size_t i = 0; i < map.tensors.size(); i++) {
+        const MemoryTensor& tensor = map.tensors[i];
+        uint64_t first = tensor.offset_start / page_size_;
+        uint64_t last = tensor.size_bytes > 0 ? (tensor.offset_start + tensor.size_bytes - 1) / page_size_ : first;
+        first = std::min<uint64_t>(first, page_count_);
+        last = std::min<uint64_t>(last, page_count_ ? page_count_ - 1 : 0);
+        tensor_pages[i].first_page = static_cast<uint32_t>(first);
+        tensor_pages[i].page_count = tensor.size_bytes > 0 && last >= first ? static_cast<uint32_t>(last - first + 1) : 0;
+        tensor_pages[i].layer_slot = static_cast<uint16_t>(std::max(tensor.layer_id, -1) + 1);
+        layer_slot_count_ = std::max<size_t>(layer_slot_count_, tensor_pages[i].layer_slot + 1);
+    }
+
+    // First-touch state per page (tensors may share boundary pages)
+    std::vector<uint8_t> seen(page_count_, 0);
+
+    token_count_ = loader.getTokenCount();
+    for (size_t t = 0; t < token_count_; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        if (!store.hasAccesses()) {
+            continue;
+        }
+
+        for (size_t i = 0; i < store.size(); i++) {
+            const uint32_t* tensors = store.accesses(i);
+            for (size_t a = 0; a < store.accessCount(i); a++) {
+                const TensorPages& run = tensor_pages[tensors[a]];
+                if (run.page_count == 0) {
+                    continue;
+                }
+
+                uint32_t cold = 0;
+                for (uint32_t p = run.first_page; p < run.first_page + run.page_count; p++) {
+                    cold += seen[p] == 0;
+                    seen[p] = 1;
+                }
+                extents_.push_back({run.first_page, run.page_count, static_cast<uint32_t>(t), run.layer_slot, cold});
+                access_count_ += run.page_count;
+                distinct_pages_ += cold;
+            }
+        }
+    }
+    return true;
+}
+
+std::string PageStream::layerSlotName(size_t slot) {
+    return slot == 0 ? "non-layer" : "L" + std::to_string(slot - 1);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include <cstdint>
+#include <vector>
+
+// One tensor read as a run of consecutive file pages
+struct PageExtent {
+    uint32_t first_page;
+    uint32_t page_count;
+    uint32_t token;       // Token index within the domain
+    uint16_t layer_slot;  // MemoryMap layer_id + 1 (0 = non-layer tensors)
+    uint32_t cold_pages;  // Pages of this run never touched before in the stream
+};
+
+// Page-granular replay stream of every DISK access of a domain, in trace order
+//
+// Built from the resolved accesses, so a routed "_exps." source only touches
+// the file range of the expert slices it used. Pages are dense ids
+// (offset / page_size), which lets cache models index plain arrays instead
+// of hashing. Cold (first-touch) pages are counted once here since they are
+// the same for every policy and budget.
+class PageStream {
+public:
+    static constexpr size_t DEFAULT_PAGE_SIZE = 4096;
+
+    PageStream();
+
+    // Loader must be finished (memory map + resolved tokens)
+    bool build(const DomainLoader& loader, size_t page_size = DEFAULT_PAGE_SIZE);
+    void clear();
+
+    size_t getPageSize() const { return page_size_; }
+    uint32_t getPageCount() const { return page_count_; }          // Pages in the whole file
+    size_t getTokenCount() const { return token_count_; }
+    size_t getLayerSlotCount() const { return layer_slot_count_; }
+    uint64_t getAccessCount() const { return access_count_; }      // Page accesses
+    uint64_t getDistinctPageCount() const { return distinct_pages_; }
+
+    const std::vector<PageExtent>& getExtents() const { return extents_; }
+
+    // Human-readable name of a layer slot ("L12" or "non-layer")
+    static std::string layerSlotName(size_t slot);
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    size_t page_size_;
+    uint32_t page_count_;
+    size_t token_count_;
+    size_t layer_slot_count_;
+    uint64_t access_count_;
+    uint64_t distinct_pages_;
+    std::vector<PageExtent> extents_;
+    std::string last_error_;
+};
@@ -0,0 +1,291 @@
+#include "PrefetchProgress.h"
+#include "TensorIndex.h"
+#include "TraceFormat.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t TAIL_BATCH_RECORDS = 64;
+constexpr auto TAIL_NAP = std::chrono::microseconds(200);
+constexpr size_t MAX_MESSAGE = 256;
+
+bool makeAddress(const std::string& path, sockaddr_un& out) {
+    std::memset(&out, 0, sizeof(out));
+    out.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(out.sun_path)) {
+        return false;
+    }
+    std::memcpy(out.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Returns false on anything malformed, including layers below -1 and expert
+// masks that do not fit 64 bits
+bool parseMessage(const char* message, ProgressEvent& out) {
+    unsigned token = 0;
+    int layer = -1;
+    unsigned long long experts = 0;
+    int mask_start = -1;
+    if (std::sscanf(message, "layer %u %d", &token, &layer) == 2) {
+        if (layer < -1) {
+            return false;
+        }
+        out.kind = ProgressEvent::Kind::Layer;
+    } else if (std::sscanf(message, "experts %u %d %n", &token, &layer, &mask_start) == 2 && mask_start >= 0) {
+        const char* mask = message + mask_start;
+        char* mask_end = nullptr;
+        errno = 0;
+        experts = std::strtoull(mask, &mask_end, 16);
+        if (layer < 0 || mask_end == mask || errno == ERANGE || *mask == '-' ||
+            (*mask_end != '\0' && *mask_end != '\n')) {
+            return false;
+        }
+        out.kind = ProgressEvent::Kind::Experts;
+    } else if (std::strncmp(message, "end", 3) == 0) {
+        out.kind = ProgressEvent::Kind::End;
+    } else {
+        return false;
+    }
+    out.token = token;
+    out.layer = layer;
+    out.experts = experts;
+    return true;
+}
+}
+
+TraceTail::TraceTail(const std::string& path, bool from_start)
+    : path_(path)
+    , from_start_(from_start)
+    , fd_(-1)
+    , next_record_(0)
+    , have_last_(false)
+    , last_token_(0)
+    , last_layer_(-1)
+    , buffer_(TAIL_BATCH_RECORDS * TRACE_ENTRY_SIZE)
+{
+}
+
+TraceTail::~TraceTail() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool TraceTail::tryOpen() {
+    fd_ = ::open(path_.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        return false;
+    }
+    next_record_ = 0;
+    if (!from_start_) {
+        // Skip to where the writer is
+        std::vector<ProgressEvent> skipped;
+        while (readRecords(skipped) > 0) {
+            skipped.clear();
+        }
+        have_last_ = false;
+    }
+    return true;
+}
+
+size_t TraceTail::readRecords(std::vector<ProgressEvent>& out) {
+    static const uint8_t mul_mat_id = ggmlOpFromName("MUL_MAT_ID");
+    ssize_t n = pread(fd_, buffer_.data(), buffer_.size(), static_cast<off_t>(next_record_ * TRACE_ENTRY_SIZE));
+    if (n <= 0) {
+        return 0;
+    }
+    const size_t records = static_cast<size_t>(n) / TRACE_ENTRY_SIZE;
+    size_t consumed = 0;
+    for (; consumed < records; consumed++) {
+        const TensorAccessLog* log = reinterpret_cast<const TensorAccessLog*>(buffer_.data() + consumed * TRACE_ENTRY_SIZE);
+        if (log->timestamp_ns == 0) {
+            break;
+        }
+        bool disk = false;
+        for (size_t s = 0; s < std::min<size_t>(log->num_sources, TRACE_MAX_SOURCES); s++) {
+            disk = disk || log->sources[s].memory_source == 0;
+        }
+        uint64_t experts = 0;
+        if (log->operation_type == mul_mat_id) {
+            const size_t top_k = std::min<size_t>({log->num_experts, TRACE_MAX_EXPERTS, EXPERT_ACCESS_TOP_K});
+            for (size_t e = 0; e < top_k; e++) {
+                if (log->expert_ids[e] >= 0 && log->expert_ids[e] < 64) {
+                    experts |= uint64_t(1) << log->expert_ids[e];
+                }
+            }
+        }
+        if (!disk && experts == 0) {
+            continue;
+        }
+
+        const int layer = log->layer_id == TRACE_NO_LAYER ? -1 : log->layer_id;
+        if (!have_last_ || log->token_id != last_token_ || layer != last_layer_) {
+            ProgressEvent event;
+            event.kind = ProgressEvent::Kind::Layer;
+            event.token = log->token_id;
+            event.layer = layer;
+            out.push_back(event);
+            have_last_ = true;
+            last_token_ = log->token_id;
+            last_layer_ = layer;
+        }
+        if (experts != 0) {
+            ProgressEvent event;
+            event.kind = ProgressEvent::Kind::Experts;
+            event.token = log->token_id;
+            event.layer = layer;
+            event.experts = experts;
+            out.push_back(event);
+        }
+    }
+    next_record_ += consumed;
+    return consumed;
+}
+
+bool TraceTail::poll(int timeout_ms, std::vector<ProgressEvent>& out) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (;;) {
+        if (fd_ >= 0 || tryOpen()) {
+            if (readRecords(out) > 0) {
+                return true;
+            }
+            // A file shorter than what was read is a new run
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) < next_record_ * TRACE_ENTRY_SIZE) {
+                next_record_ = 0;
+                have_last_ = false;
+                continue;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return true;
+        }
+        std::this_thread::sleep_for(TAIL_NAP);
+    }
+}
+
+ProgressSocket::ProgressSocket(const std::string& path)
+    : path_(path)
+    , fd_(-1)
+{
+}
+
+ProgressSocket::~ProgressSocket() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        unlink(path_.c_str());
+    }
+}
+
+bool ProgressSocket::bind() {
+    sockaddr_un address;
+    if (!makeAddress(path_, address)) {
+        last_error_ = "Socket path too long: " + path_;
+        return false;
+    }
+    fd_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        last_error_ = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    unlink(path_.c_str());
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        last_error_ = "Failed to bind " + path_ + ": " + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ProgressSocket::poll(int timeout_ms, std::vector<ProgressEvent>& out) {
+    pollfd descriptor = {fd_, POLLIN, 0};
+    int ready = ::poll(&descriptor, 1, timeout_ms);
+    if (ready < 0 && errno != EINTR) {
+        last_error_ = std::string("poll: ") + std::strerror(errno);
+        return false;
+    }
+    if (ready <= 0) {
+        return true;
+    }
+    char message[MAX_MESSAGE];
+    for (;;) {
+        ssize_t n = recv(fd_, message, sizeof(message) - 1, MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                return true;
+            }
+            last_error_ = std::string("recv: ") + std::strerror(errno);
+            return false;
+        }
+        message[n] = '\0';
+        ProgressEvent event;
+        if (parseMessage(message, event)) {
+            out.push_back(event);
+        }
+    }
+}
+
+ProgressSender::ProgressSender()
+    : fd_(-1)
+    , dropped_(0)
+{
+}
+
+ProgressSender::~ProgressSender() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+bool ProgressSender::open(const std::string& path) {
+    sockaddr_un address;
+    if (!makeAddress(path, address)) {
+        return false;
+    }
+    fd_ = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        return false;
+    }
+    fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+    path_ = path;
+    return true;
+}
+
+void ProgressSender::sendLayer(uint32_t token, int layer) {
+    send("layer " + std::to_string(token) + " " + std::to_string(layer));
+}
+
+void ProgressSender::sendExperts(uint32_t token, int layer, uint64_t experts) {
+    char mask[32];
+    std::snprintf(mask, sizeof(mask), "%" PRIx64, experts);
+    send("experts " + std::to_string(token) + " " + std::to_string(layer) + " " + mask);
+}
+
+void ProgressSender::sendEnd() {
+    send("end");
+}
+
+void ProgressSender::send(const std::string& message) {
+    sockaddr_un address;
+    if (fd_ < 0 || !makeAddress(path_, address)) {
+        return;
+    }
+    ssize_t n = sendto(fd_, message.data(), message.size(), 0, reinterpret_cast<const sockaddr*>(&address),
+                       sizeof(address));
+    if (n < 0) {
+        dropped_++;
+    }
+}
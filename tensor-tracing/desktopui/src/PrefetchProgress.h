@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Progress of a running inference, as the prefetch daemon sees it
+struct ProgressEvent {
+    enum class Kind : uint8_t {
+        Layer,     // The inference reached a layer (-1: a non-layer tensor)
+        Experts,   // The layer routed to these experts (bitmask)
+        End,       // The inference finished
+    };
+
+    Kind kind = Kind::Layer;
+    uint32_t token = 0;
+    int layer = -1;
+    uint64_t experts = 0;
+};
+
+// Where progress events come from
+class ProgressSource {
+public:
+    virtual ~ProgressSource() = default;
+
+    // Append whatever arrived, waiting up to timeout_ms for the first event.
+    // Returns false on an unrecoverable error (see getLastError).
+    virtual bool poll(int timeout_ms, std::vector<ProgressEvent>& out) = 0;
+
+    const std::string& getLastError() const { return last_error_; }
+
+protected:
+    std::string last_error_;
+};
+
+// Follows the tracer's tensor_trace.bin while llama.cpp writes it
+//
+// Records are read with pread in file order; a zeroed timestamp or the end of
+// the file marks where the writer is. Only records that read DISK tensors or
+// carry routed experts count as progress, so bookkeeping ops without a layer
+// do not bounce the position around. The file may appear later than the
+// daemon starts; if it shrinks (a new run), reading restarts at its top.
+class TraceTail : public ProgressSource {
+public:
+    // from_start = false skips the records already in the file
+    TraceTail(const std::string& path, bool from_start);
+    ~TraceTail() override;
+
+    bool poll(int timeout_ms, std::vector<ProgressEvent>& out) override;
+
+private:
+    std::string path_;
+    bool from_start_;
+    int fd_;
+    uint64_t next_record_;
+    bool have_last_;
+    uint32_t last_token_;
+    int last_layer_;
+    std::vector<uint8_t> buffer_;
+
+    bool tryOpen();
+    size_t readRecords(std::vector<ProgressEvent>& out);
+};
+
+// Datagram socket the inference process (or a replay driver) reports to
+//
+// One text message per datagram: "layer <token> <layer>",
+// "experts <token> <layer> <hex mask>" or "end". Bound at a filesystem path;
+// a stale socket file from an earlier run is replaced.
+class ProgressSocket : public ProgressSource {
+public:
+    explicit ProgressSocket(const std::string& path);
+    ~ProgressSocket() override;
+
+    // Returns true on success, false on failure (see getLastError)
+    bool bind();
+
+    bool poll(int timeout_ms, std::vector<ProgressEvent>& out) override;
+
+private:
+    std::string path_;
+    int fd_;
+};
+
+// Sending side of ProgressSocket (fire and forget: nothing blocks when no
+// daemon is listening)
+class ProgressSender {
+public:
+    ProgressSender();
+    ~ProgressSender();
+
+    ProgressSender(const ProgressSender&) = delete;
+    ProgressSender& operator=(const ProgressSender&) = delete;
+
+    // Returns true on success, false on failure
+    bool open(const std::string& path);
+
+    void sendLayer(uint32_t token, int layer);
+    void sendExperts(uint32_t token, int layer, uint64_t experts);
+    void sendEnd();
+
+    // Datagrams nobody received (daemon not running or too slow)
+    uint64_t getDroppedCount() const { return dropped_; }
+
+private:
+    std::string path_;
+    int fd_;
+    uint64_t dropped_;
+
+    void send(const std::string& message);
+};
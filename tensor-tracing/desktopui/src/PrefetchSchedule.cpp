@@ -0,0 +1,252 @@
+#include "PrefetchSchedule.h"
+#include "json.hpp"
+#include <algorithm>
+#include <fstream>
+
+using json = nlohmann::json;
+
+namespace {
+const std::vector<PrefetchExtent> NO_EXTENTS;
+
+json extentsJson(const std::vector<PrefetchExtent>& extents) {
+    json out = json::array();
+    for (const PrefetchExtent& extent : extents) {
+        out.push_back({{"name", extent.name}, {"offset", extent.offset}, {"size", extent.size}});
+    }
+    return out;
+}
+
+void extentsFromJson(const json& in, std::vector<PrefetchExtent>& out) {
+    out.clear();
+    for (const json& item : in) {
+        PrefetchExtent extent;
+        extent.name = item.value("name", std::string());
+        extent.offset = item.at("offset").get<uint64_t>();
+        extent.size = item.at("size").get<uint64_t>();
+        out.push_back(std::move(extent));
+    }
+}
+}
+
+PrefetchSchedule::PrefetchSchedule()
+    : layer_count_(0)
+    , expert_count_(0)
+    , top_k_(0)
+{
+}
+
+void PrefetchSchedule::build(const DomainLoader& loader, size_t top_k) {
+    const MemoryMap& map = loader.getMemoryMap();
+    model_name_ = map.model_name;
+    top_k_ = top_k > 0 ? top_k : EXPERT_ACCESS_TOP_K;
+    layer_count_ = 0;
+    expert_count_ = 0;
+    for (const MemoryTensor& tensor : map.tensors) {
+        if (tensor.layer_id >= 0) {
+            layer_count_ = std::max<size_t>(layer_count_, tensor.layer_id + 1);
+        }
+        if (tensor.expert_id >= 0 && static_cast<size_t>(tensor.expert_id) < ExpertRouting::MAX_EXPERTS) {
+            expert_count_ = std::max<size_t>(expert_count_, tensor.expert_id + 1);
+        }
+    }
+
+    // Non-expert tensors go to the step of their first access over all tokens
+    steps_.assign(layer_count_ + 2, std::vector<PrefetchExtent>());
+    std::vector<bool> placed(map.tensors.size(), false);
+    for (size_t t = 0; t < loader.getTokenCount(); t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        if (!store.hasAccesses()) {
+            continue;
+        }
+        bool seen_layer = false;
+        for (size_t i = 0; i < store.size(); i++) {
+            const size_t count = store.accessCount(i);
+            if (count == 0) {
+                continue;
+            }
+            const int layer = store.layerId(i);
+            size_t step = seen_layer ? tailStep() : HEAD_STEP;
+            if (layer >= 0 && static_cast<size_t>(layer) < layer_count_) {
+                seen_layer = true;
+                step = layerStep(layer);
+            }
+            const uint32_t* accesses = store.accesses(i);
+            for (size_t k = 0; k < count; k++) {
+                const MemoryTensor& tensor = map.tensors[accesses[k]];
+                if (tensor.expert_id >= 0 || placed[accesses[k]]) {
+                    continue;
+                }
+                placed[accesses[k]] = true;
+                steps_[step].push_back({tensor.name, tensor.offset_start, tensor.size_bytes});
+            }
+        }
+    }
+
+    experts_.assign(layer_count_ * expert_count_, std::vector<PrefetchExtent>());
+    for (const MemoryTensor& tensor : map.tensors) {
+        if (tensor.expert_id >= 0 && tensor.layer_id >= 0 && static_cast<size_t>(tensor.expert_id) < expert_count_) {
+            experts_[tensor.layer_id * expert_count_ + tensor.expert_id].push_back(
+                {tensor.name, tensor.offset_start, tensor.size_bytes});
+        }
+    }
+    for (std::vector<PrefetchExtent>& slices : experts_) {
+        std::sort(slices.begin(), slices.end(), [](const PrefetchExtent& a, const PrefetchExtent& b) {
+            return a.offset < b.offset;
+        });
+    }
+
+    // Hot set: top_k experts by routed token count per layer (ties to the lower id)
+    const ExpertRouting& routing = loader.getExpertRouting();
+    hot_experts_.assign(layer_count_, 0);
+    const size_t routed_layers = std::min(layer_count_, routing.getLayerCount());
+    for (size_t layer = 0; layer < routed_layers; layer++) {
+        std::vector<std::pair<uint32_t, size_t>> counts;
+        for (size_t e = 0; e < expert_count_; e++) {
+            counts.emplace_back(0, e);
+        }
+        for (size_t t = 0; t < routing.getTokenCount(); t++) {
+            const uint64_t mask = routing.getMask(t, layer);
+            for (size_t e = 0; e < expert_count_; e++) {
+                counts[e].first += (mask >> e) & 1;
+            }
+        }
+        std::stable_sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first;
+        });
+        for (size_t k = 0; k < std::min(top_k_, counts.size()) && counts[k].first > 0; k++) {
+            hot_experts_[layer] |= uint64_t(1) << counts[k].second;
+        }
+    }
+    computeStepBytes();
+}
+
+void PrefetchSchedule::computeStepBytes() {
+    step_bytes_.assign(steps_.size(), 0);
+    for (size_t s = 0; s < steps_.size(); s++) {
+        for (const PrefetchExtent& extent : steps_[s]) {
+            step_bytes_[s] += extent.size;
+        }
+    }
+}
+
+const std::vector<PrefetchExtent>& PrefetchSchedule::getExpert(size_t layer, size_t expert) const {
+    if (layer >= layer_count_ || expert >= expert_count_) {
+        return NO_EXTENTS;
+    }
+    return experts_[layer * expert_count_ + expert];
+}
+
+uint64_t PrefetchSchedule::getExpertBytes(size_t layer, size_t expert) const {
+    uint64_t bytes = 0;
+    for (const PrefetchExtent& extent : getExpert(layer, expert)) {
+        bytes += extent.size;
+    }
+    return bytes;
+}
+
+uint64_t PrefetchSchedule::getEndOffset() const {
+    uint64_t end = 0;
+    for (const auto& extents : steps_) {
+        for (const PrefetchExtent& extent : extents) {
+            end = std::max(end, extent.offset + extent.size);
+        }
+    }
+    for (const auto& extents : experts_) {
+        for (const PrefetchExtent& extent : extents) {
+            end = std::max(end, extent.offset + extent.size);
+        }
+    }
+    return end;
+}
+
+bool PrefetchSchedule::save(const std::string& filepath) const {
+    json steps = json::array();
+    for (const auto& extents : steps_) {
+        steps.push_back(extentsJson(extents));
+    }
+    json experts = json::array();
+    for (size_t layer = 0; layer < layer_count_; layer++) {
+        for (size_t e = 0; e < expert_count_; e++) {
+            const auto& slices = experts_[layer * expert_count_ + e];
+            if (!slices.empty()) {
+                experts.push_back({{"layer", layer}, {"expert", e}, {"slices", extentsJson(slices)}});
+            }
+        }
+    }
+    json hot = json::array();
+    for (uint64_t mask : hot_experts_) {
+        json ids = json::array();
+        for (size_t e = 0; e < ExpertRouting::MAX_EXPERTS; e++) {
+            if ((mask >> e) & 1) {
+                ids.push_back(e);
+            }
+        }
+        hot.push_back(ids);
+    }
+
+    json root;
+    root["model_name"] = model_name_;
+    root["layer_count"] = layer_count_;
+    root["expert_count"] = expert_count_;
+    root["top_k"] = top_k_;
+    root["steps"] = steps;
+    root["experts"] = experts;
+    root["hot_experts"] = hot;
+
+    std::ofstream file(filepath);
+    if (!file) {
+        last_error_ = "Failed to create " + filepath;
+        return false;
+    }
+    file << root.dump(1) << std::endl;
+    return true;
+}
+
+bool PrefetchSchedule::load(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file) {
+        last_error_ = "Failed to open " + filepath;
+        return false;
+    }
+    try {
+        json root = json::parse(file);
+        model_name_ = root.value("model_name", std::string());
+        layer_count_ = root.at("layer_count").get<size_t>();
+        expert_count_ = root.at("expert_count").get<size_t>();
+        top_k_ = root.value("top_k", EXPERT_ACCESS_TOP_K);
+        if (expert_count_ > ExpertRouting::MAX_EXPERTS || root.at("steps").size() != layer_count_ + 2) {
+            last_error_ = "Malformed prefetch schedule " + filepath;
+            return false;
+        }
+        steps_.assign(layer_count_ + 2, std::vector<PrefetchExtent>());
+        for (size_t s = 0; s < steps_.size(); s++) {
+            extentsFromJson(root["steps"][s], steps_[s]);
+        }
+        experts_.assign(layer_count_ * expert_count_, std::vector<PrefetchExtent>());
+        for (const json& item : root.at("experts")) {
+            const size_t layer = item.at("layer").get<size_t>();
+            const size_t expert = item.at("expert").get<size_t>();
+            if (layer < layer_count_ && expert < expert_count_) {
+                extentsFromJson(item.at("slices"), experts_[layer * expert_count_ + expert]);
+            }
+        }
+        hot_experts_.assign(layer_count_, 0);
+        const json& hot = root.at("hot_experts");
+        for (size_t layer = 0; layer < std::min(layer_count_, hot.size()); layer++) {
+            for (const json& id : hot[layer]) {
+                const size_t e = id.get<size_t>();
+                if (e < expert_count_) {
+                    hot_experts_[layer] |= uint64_t(1) << e;
+                }
+            }
+        }
+    } catch (const json::exception& e) {
+        last_error_ = "Failed to parse " + filepath + ": " + e.what();
+        return false;
+    }
+    computeStepBytes();
+    return true;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One tensor (or expert slice) of the model file
+struct PrefetchExtent {
+    std::string name;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// What a token reads, in order, for prefetching ahead of the inference
+//
+// A token walks steps: the head (non-layer tensors read before layer 0, i.e.
+// the embedding), one step per layer, then the tail (output norm and
+// projection); the next token starts over at the head. Each step lists the
+// non-expert tensors it reads in first-access order over the recorded trace.
+// Routed experts are kept apart, per layer and expert, because they change
+// every token: the hot set (the top_k most routed experts of each layer in
+// the trace) is a static guess a prefetcher can use when it has no
+// predictor of its own. Offsets are absolute, from the domain's memory map.
+class PrefetchSchedule {
+public:
+    PrefetchSchedule();
+
+    // From a finished loader; top_k = 0 uses EXPERT_ACCESS_TOP_K
+    void build(const DomainLoader& loader, size_t top_k = 0);
+
+    // JSON round trip. Returns true on success, false on failure (see getLastError)
+    bool save(const std::string& filepath) const;
+    bool load(const std::string& filepath);
+
+    bool empty() const { return steps_.empty(); }
+    const std::string& getModelName() const { return model_name_; }
+    size_t getLayerCount() const { return layer_count_; }
+    size_t getExpertCount() const { return expert_count_; }
+    size_t getTopK() const { return top_k_; }
+
+    // Steps: head, layers 0..n-1, tail
+    size_t getStepCount() const { return steps_.size(); }
+    const std::vector<PrefetchExtent>& getStep(size_t step) const { return steps_[step]; }
+    uint64_t getStepBytes(size_t step) const { return step_bytes_[step]; }
+    static constexpr size_t HEAD_STEP = 0;
+    size_t tailStep() const { return layer_count_ + 1; }
+    static size_t layerStep(int layer) { return static_cast<size_t>(layer) + 1; }
+    // Layer of a step, -1 for the head and the tail
+    int stepLayer(size_t step) const { return step == HEAD_STEP || step == tailStep() ? -1 : static_cast<int>(step) - 1; }
+
+    // Slices of one expert in a layer (gate/up/down and whatever else is stacked)
+    const std::vector<PrefetchExtent>& getExpert(size_t layer, size_t expert) const;
+    uint64_t getExpertBytes(size_t layer, size_t expert) const;
+    // Most routed experts of the layer in the recorded trace
+    uint64_t getHotExperts(size_t layer) const { return layer < hot_experts_.size() ? hot_experts_[layer] : 0; }
+
+    // End of the furthest extent (the file has to be at least this long)
+    uint64_t getEndOffset() const;
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    std::string model_name_;
+    size_t layer_count_;
+    size_t expert_count_;
+    size_t top_k_;
+    std::vector<std::vector<PrefetchExtent>> steps_;
+    std::vector<uint64_t> step_bytes_;
+    std::vector<std::vector<PrefetchExtent>> experts_;   // layer * expert_count_ + expert
+    std::vector<uint64_t> hot_experts_;                  // Expert mask per layer
+    mutable std::string last_error_;
+
+    void computeStepBytes();
+};
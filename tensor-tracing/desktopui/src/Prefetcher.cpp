@@ -0,0 +1,396 @@
+#include "Prefetcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+// Experts a schedule of expert_count can hold
+uint64_t expertMask(size_t expert_count) {
+    return expert_count >= 64 ? ~uint64_t(0) : (uint64_t(1) << expert_count) - 1;
+}
+}
+
+const char* prefetchMethodName(PrefetchMethod method) {
+    switch (method) {
+        case PrefetchMethod::Fadvise: return "fadvise";
+        case PrefetchMethod::Readahead: return "readahead";
+        case PrefetchMethod::IoUring: return "io_uring";
+    }
+    return "";
+}
+
+bool prefetchMethodFromName(const std::string& name, PrefetchMethod& out_method) {
+    for (size_t i = 0; i < PREFETCH_METHOD_COUNT; i++) {
+        PrefetchMethod method = static_cast<PrefetchMethod>(i);
+        if (name == prefetchMethodName(method)) {
+            out_method = method;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PrefetchStats::add(const PrefetchStats& other) {
+    steps += other.steps;
+    issued += other.issued;
+    needed += other.needed;
+    hits += other.hits;
+    late += other.late;
+    missed += other.missed;
+    wasted += other.wasted;
+}
+
+Prefetcher::Prefetcher()
+    : schedule_(nullptr)
+    , method_(PrefetchMethod::Fadvise)
+    , fd_(-1)
+    , file_size_(0)
+    , started_(false)
+    , position_(0)
+    , planned_until_(0)
+    , seen_layer_(false)
+    , current_{0, {}, 0, 0, 0}
+    , routed_(0)
+    , in_flight_bytes_(0)
+    , ring_in_flight_(0)
+    , ring_buffers_(nullptr)
+{
+}
+
+Prefetcher::~Prefetcher() {
+    close();
+}
+
+bool Prefetcher::open(const std::string& file_path, const PrefetchSchedule& schedule, const PrefetchConfig& config) {
+    close();
+    schedule_ = &schedule;
+    config_ = config;
+    config_.lookahead = std::max<uint32_t>(config_.lookahead, 1);
+    config_.queue_depth = std::max<uint32_t>(config_.queue_depth, 1);
+    config_.request_bytes = std::max<uint64_t>(config_.request_bytes, BUFFER_ALIGNMENT);
+    method_ = config_.method;
+
+    fd_ = ::open(file_path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        last_error_ = "Failed to open " + file_path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        last_error_ = "Failed to stat " + file_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+    if (schedule.getEndOffset() > file_size_) {
+        last_error_ = "The schedule reaches past the end of " + file_path + " (is it for another file?)";
+        close();
+        return false;
+    }
+
+    if (!page_cache_.map(fd_, file_size_)) {
+        last_error_ = "Failed to map " + file_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    if (method_ == PrefetchMethod::IoUring) {
+        void* memory = nullptr;
+        if (!ring_.init(config_.queue_depth) ||
+            posix_memalign(&memory, BUFFER_ALIGNMENT, config_.queue_depth * config_.request_bytes) != 0) {
+            last_error_ = ring_.isOpen() ? "Failed to allocate read buffers" : ring_.getLastError();
+            ring_.close();
+            method_ = PrefetchMethod::Fadvise;
+        } else {
+            ring_buffers_ = static_cast<uint8_t*>(memory);
+            for (uint32_t s = config_.queue_depth; s > 0; s--) {
+                ring_free_.push_back(s - 1);
+            }
+        }
+    }
+
+    if (config_.experts == ExpertSource::Predictor) {
+        predictor_ = createExpertPredictor(config_.predictor);
+        predictor_->reset(schedule.getLayerCount(), schedule.getExpertCount(), schedule.getTopK());
+    }
+    return true;
+}
+
+void Prefetcher::close() {
+    // Reads still in flight write into ring_buffers_, so drain them first
+    ring_chunks_.clear();
+    while (ring_.isOpen() && ring_in_flight_ > 0) {
+        if (!ring_.submitAndWait(1, [this](uint64_t, int32_t) { ring_in_flight_--; })) {
+            break;
+        }
+    }
+    ring_.close();
+    std::free(ring_buffers_);
+    ring_buffers_ = nullptr;
+    ring_chunks_.clear();
+    ring_free_.clear();
+    ring_in_flight_ = 0;
+    page_cache_.unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    predictor_.reset();
+    planned_.clear();
+    started_ = false;
+    in_flight_bytes_ = 0;
+    step_stats_ = PrefetchStats();
+    total_ = PrefetchStats();
+}
+
+void Prefetcher::onLayer(uint32_t token, int layer) {
+    if (!schedule_ || (layer >= 0 && static_cast<size_t>(layer) >= schedule_->getLayerCount())) {
+        return;
+    }
+    const uint64_t step_count = schedule_->getStepCount();
+    const bool same_token = started_ && position_ / step_count == token;
+    if (!same_token) {
+        seen_layer_ = false;
+    }
+    size_t step = seen_layer_ ? schedule_->tailStep() : PrefetchSchedule::HEAD_STEP;
+    if (layer >= 0) {
+        seen_layer_ = true;
+        step = PrefetchSchedule::layerStep(layer);
+    }
+    const uint64_t position = token * step_count + step;
+    if (started_ && position <= position_) {
+        return;   // Only forward progress counts
+    }
+    enter(position);
+}
+
+void Prefetcher::onExperts(uint32_t token, int layer, uint64_t experts) {
+    if (!started_ || layer < 0) {
+        return;
+    }
+    const uint64_t step_count = schedule_->getStepCount();
+    if (position_ / step_count != token || position_ % step_count != PrefetchSchedule::layerStep(layer)) {
+        return;
+    }
+    // Ids past the schedule's experts would index past the predictors' tables
+    experts &= expertMask(schedule_->getExpertCount());
+    const uint64_t added = experts & ~routed_;
+    routed_ |= experts;
+    for (size_t e = 0; e < schedule_->getExpertCount(); e++) {
+        if (!((added >> e) & 1)) {
+            continue;
+        }
+        if ((current_.experts >> e) & 1) {
+            for (size_t i = 0; i < current_.extents.size(); i++) {
+                if (current_.extents[i].expert == static_cast<int>(e)) {
+                    accountExtent(current_, i);
+                }
+            }
+        } else {
+            const uint64_t bytes = schedule_->getExpertBytes(layer, e);
+            step_stats_.needed += bytes;
+            step_stats_.missed += bytes;
+        }
+    }
+}
+
+void Prefetcher::finish() {
+    if (!started_) {
+        return;
+    }
+    leaveStep();
+    for (const Planned& planned : planned_) {
+        total_.wasted += planned.issued_bytes;
+    }
+    planned_.clear();
+    in_flight_bytes_ = 0;
+    started_ = false;
+}
+
+void Prefetcher::enter(uint64_t position) {
+    if (started_) {
+        leaveStep();
+    }
+    started_ = true;
+    position_ = position;
+
+    // Steps jumped over never get read: what went out for them was wasted
+    while (!planned_.empty() && planned_.front().position < position) {
+        in_flight_bytes_ -= planned_.front().issued_bytes;
+        step_stats_.wasted += planned_.front().issued_bytes;
+        planned_.pop_front();
+    }
+    if (!planned_.empty() && planned_.front().position == position) {
+        current_ = std::move(planned_.front());
+        planned_.pop_front();
+        in_flight_bytes_ -= current_.issued_bytes;
+    } else {
+        plan(position);
+        current_ = std::move(planned_.back());
+        planned_.pop_back();
+    }
+    routed_ = 0;
+
+    step_stats_.steps = 1;
+    for (size_t i = 0; i < current_.extents.size(); i++) {
+        if (current_.extents[i].expert < 0) {
+            accountExtent(current_, i);
+        }
+    }
+
+    planned_until_ = std::max(planned_until_, position);
+    for (uint64_t ahead = position + 1; ahead <= position + config_.lookahead; ahead++) {
+        if (ahead > planned_until_) {
+            plan(ahead);
+            planned_until_ = ahead;
+        }
+    }
+    issuePlanned();
+}
+
+void Prefetcher::leaveStep() {
+    const uint64_t step_count = schedule_->getStepCount();
+    const int layer = schedule_->stepLayer(position_ % step_count);
+    if (layer >= 0 && routed_ != 0) {
+        for (size_t i = 0; i < current_.issued_count; i++) {
+            const Extent& extent = current_.extents[i];
+            if (extent.expert >= 0 && !((routed_ >> extent.expert) & 1)) {
+                step_stats_.wasted += extent.size;
+            }
+        }
+        if (predictor_) {
+            predictor_->observe(layer, routed_);
+        }
+    }
+    total_.add(step_stats_);
+    if (step_callback_) {
+        step_callback_(static_cast<uint32_t>(position_ / step_count), layer, step_stats_);
+    }
+    step_stats_ = PrefetchStats();
+}
+
+void Prefetcher::plan(uint64_t position) {
+    const size_t step = position % schedule_->getStepCount();
+    Planned planned{position, {}, 0, 0, 0};
+    for (const PrefetchExtent& extent : schedule_->getStep(step)) {
+        planned.extents.push_back({extent.offset, extent.size, -1});
+    }
+    const int layer = schedule_->stepLayer(step);
+    if (layer >= 0) {
+        if (config_.experts == ExpertSource::Schedule) {
+            planned.experts = schedule_->getHotExperts(layer);
+        } else if (config_.experts == ExpertSource::Predictor) {
+            planned.experts = predictor_->predict(layer);
+        }
+        for (size_t e = 0; e < schedule_->getExpertCount(); e++) {
+            if ((planned.experts >> e) & 1) {
+                for (const PrefetchExtent& slice : schedule_->getExpert(layer, e)) {
+                    planned.extents.push_back({slice.offset, slice.size, static_cast<int>(e)});
+                }
+            }
+        }
+    }
+    planned_.push_back(std::move(planned));
+}
+
+void Prefetcher::issuePlanned() {
+    for (Planned& planned : planned_) {
+        while (planned.issued_count < planned.extents.size()) {
+            const Extent& extent = planned.extents[planned.issued_count];
+            // Over budget waits for the inference to catch up (one extent always fits)
+            if (in_flight_bytes_ > 0 && in_flight_bytes_ + extent.size > config_.budget_bytes) {
+                return;
+            }
+            issue(extent);
+            planned.issued_count++;
+            planned.issued_bytes += extent.size;
+            in_flight_bytes_ += extent.size;
+            step_stats_.issued += extent.size;
+        }
+    }
+}
+
+void Prefetcher::issue(const Extent& extent) {
+    switch (method_) {
+        case PrefetchMethod::Fadvise:
+            posix_fadvise(fd_, static_cast<off_t>(extent.offset), static_cast<off_t>(extent.size), POSIX_FADV_WILLNEED);
+            break;
+        case PrefetchMethod::Readahead:
+#ifdef __linux__
+            readahead(fd_, static_cast<off64_t>(extent.offset), static_cast<size_t>(extent.size));
+#else
+            posix_fadvise(fd_, static_cast<off_t>(extent.offset), static_cast<off_t>(extent.size), POSIX_FADV_WILLNEED);
+#endif
+            break;
+        case PrefetchMethod::IoUring:
+            for (uint64_t offset = extent.offset; offset < extent.offset + extent.size; offset += config_.request_bytes) {
+                ring_chunks_.push_back({offset, static_cast<uint32_t>(
+                    std::min(config_.request_bytes, extent.offset + extent.size - offset))});
+            }
+            pump();
+            break;
+    }
+}
+
+void Prefetcher::pump() {
+    if (!ring_.isOpen()) {
+        return;
+    }
+    while (!ring_chunks_.empty() && !ring_free_.empty()) {
+        const uint32_t slot = ring_free_.back();
+        const Chunk& chunk = ring_chunks_.front();
+        if (!ring_.queueRead(fd_, ring_buffers_ + slot * config_.request_bytes, chunk.length, chunk.offset, slot)) {
+            break;
+        }
+        ring_free_.pop_back();
+        ring_chunks_.pop_front();
+        ring_in_flight_++;
+    }
+    if (!ring_.submitAndWait(0, [this](uint64_t slot, int32_t) {
+            ring_free_.push_back(static_cast<uint32_t>(slot));
+            ring_in_flight_--;
+        })) {
+        last_error_ = ring_.getLastError();
+    }
+}
+
+uint64_t Prefetcher::residentBytes(uint64_t offset, uint64_t size) {
+    if (size == 0 || offset >= file_size_) {
+        return 0;
+    }
+    const uint64_t page_size = page_cache_.getPageSize();
+    const uint64_t end = std::min(offset + size, file_size_);
+    const uint64_t first_page = offset / page_size;
+    const uint64_t page_count = (end - 1) / page_size - first_page + 1;
+    residency_.resize(page_count);
+    if (!page_cache_.residency(first_page, page_count, residency_.data())) {
+        return 0;
+    }
+    uint64_t resident = 0;
+    for (uint64_t p = 0; p < page_count; p++) {
+        if (residency_[p] & 1) {
+            const uint64_t page_begin = std::max(offset, (first_page + p) * page_size);
+            const uint64_t page_end = std::min(end, (first_page + p + 1) * page_size);
+            resident += page_end - page_begin;
+        }
+    }
+    return resident;
+}
+
+void Prefetcher::accountExtent(const Planned& planned, size_t index) {
+    const Extent& extent = planned.extents[index];
+    step_stats_.needed += extent.size;
+    if (index < planned.issued_count) {
+        const uint64_t resident = residentBytes(extent.offset, extent.size);
+        step_stats_.hits += resident;
+        step_stats_.late += extent.size - resident;
+    } else {
+        step_stats_.missed += extent.size;
+    }
+}
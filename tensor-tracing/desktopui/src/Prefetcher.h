@@ -0,0 +1,156 @@
+#pragma once
+
+#include "ExpertPredictor.h"
+#include "FileUtil.h"
+#include "IoRing.h"
+#include "PrefetchSchedule.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How prefetches reach the page cache
+enum class PrefetchMethod : uint8_t {
+    Fadvise = 0,     // posix_fadvise(WILLNEED): asynchronous readahead hint
+    Readahead = 1,   // readahead(2) (Linux; fadvise elsewhere)
+    IoUring = 2,     // Buffered reads into scratch buffers through io_uring
+};
+
+constexpr size_t PREFETCH_METHOD_COUNT = 3;
+
+const char* prefetchMethodName(PrefetchMethod method);
+bool prefetchMethodFromName(const std::string& name, PrefetchMethod& out_method);
+
+// Which experts are prefetched for a layer
+enum class ExpertSource : uint8_t {
+    None = 0,        // Only the non-expert tensors
+    Schedule = 1,    // The schedule's hot set
+    Predictor = 2,   // An online ExpertPredictor fed with the observed routing
+};
+
+struct PrefetchConfig {
+    PrefetchMethod method = PrefetchMethod::Fadvise;
+    uint32_t lookahead = 1;                         // Steps (layers) ahead of the inference
+    uint64_t budget_bytes = 1024ull * 1024 * 1024;  // Prefetched bytes the inference has not reached yet
+    uint32_t queue_depth = 16;                      // io_uring only
+    uint64_t request_bytes = 1024 * 1024;           // io_uring only
+    ExpertSource experts = ExpertSource::Schedule;
+    ExpertPredictorKind predictor = ExpertPredictorKind::PreviousToken;
+};
+
+// Byte counters, per step or summed
+struct PrefetchStats {
+    uint64_t steps = 0;          // Steps the inference reached
+    uint64_t issued = 0;         // Bytes handed to the kernel
+    uint64_t needed = 0;         // Bytes the reached steps read (tensors + routed experts)
+    uint64_t hits = 0;           // Prefetched and resident when needed
+    uint64_t late = 0;           // Prefetched but not resident yet when needed
+    uint64_t missed = 0;         // Needed but not prefetched (unpredicted experts, over budget)
+    uint64_t wasted = 0;         // Prefetched for experts not routed to, or for steps never reached
+
+    void add(const PrefetchStats& other);
+    double hitRate() const { return needed ? static_cast<double>(hits) / needed : 0.0; }
+};
+
+// Follows an inference through a PrefetchSchedule and prefetches ahead of it
+//
+// Positions are (token, step); every step reached plans the next lookahead
+// steps, which go out at once while the bytes in flight (prefetched for steps
+// not reached yet) stay under the budget, and wait in a queue otherwise.
+// Whether a prefetch was in time is measured, not assumed: when a step is
+// reached (or a layer's routing arrives) the needed extents are checked with
+// mincore() against a PROT_NONE mapping of the file. Not thread-safe; one
+// loop feeds events and calls pump().
+class Prefetcher {
+public:
+    Prefetcher();
+    ~Prefetcher();
+
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+
+    // Schedule must outlive the prefetcher. Returns true on success, false on
+    // failure (see getLastError); io_uring falls back to fadvise
+    bool open(const std::string& file_path, const PrefetchSchedule& schedule, const PrefetchConfig& config);
+    void close();
+
+    void onLayer(uint32_t token, int layer);
+    void onExperts(uint32_t token, int layer, uint64_t experts);
+    // Finish the current step's accounting (end of inference)
+    void finish();
+
+    // Reap io_uring completions and issue reads the queue depth held back
+    void pump();
+    bool isBusy() const { return !ring_chunks_.empty() || ring_in_flight_ > 0; }
+
+    // Called with the counters of each step as the inference leaves it
+    void setStepCallback(std::function<void(uint32_t token, int layer, const PrefetchStats&)> callback) {
+        step_callback_ = std::move(callback);
+    }
+
+    PrefetchMethod getMethod() const { return method_; }
+    const PrefetchStats& getStats() const { return total_; }
+    uint64_t getInFlightBytes() const { return in_flight_bytes_; }
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    struct Extent {
+        uint64_t offset;
+        uint64_t size;
+        int expert;          // -1 for the step's own tensors
+    };
+
+    // Prefetches for one position ahead of the inference
+    struct Planned {
+        uint64_t position;
+        std::vector<Extent> extents;
+        size_t issued_count;     // Extents [0, issued_count) went out
+        uint64_t issued_bytes;
+        uint64_t experts;        // Experts among the extents
+    };
+
+    struct Chunk {
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    const PrefetchSchedule* schedule_;
+    PrefetchConfig config_;
+    PrefetchMethod method_;
+    int fd_;
+    uint64_t file_size_;
+    PageCacheMapping page_cache_;
+    std::vector<unsigned char> residency_;
+    std::string last_error_;
+
+    std::unique_ptr<ExpertPredictor> predictor_;
+
+    bool started_;
+    uint64_t position_;              // token * step count + step
+    uint64_t planned_until_;         // Last position planned
+    bool seen_layer_;                // The current token reached a layer (so -1 is the tail)
+    std::deque<Planned> planned_;    // Ordered by position
+    Planned current_;                // The step the inference is in
+    uint64_t routed_;                // Experts routed so far in the current step
+    uint64_t in_flight_bytes_;
+
+    PrefetchStats step_stats_;
+    PrefetchStats total_;
+    std::function<void(uint32_t, int, const PrefetchStats&)> step_callback_;
+
+    IoRing ring_;
+    std::deque<Chunk> ring_chunks_;
+    uint32_t ring_in_flight_;
+    std::vector<uint32_t> ring_free_;
+    uint8_t* ring_buffers_;
+
+    void enter(uint64_t position);
+    void leaveStep();
+    void plan(uint64_t position);
+    void issuePlanned();
+    void issue(const Extent& extent);
+    uint64_t residentBytes(uint64_t offset, uint64_t size);
+    void accountExtent(const Planned& planned, size_t index);
+};
@@ -0,0 +1,196 @@
+#include "ResidencySampler.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t MIN_SLICE_PAGES = 256;
+}
+
+ResidencySampler::ResidencySampler()
+    : fd_(-1)
+    , file_size_(0)
+    , out_fd_(-1)
+    , trace_base_ns_(RESIDENCY_NO_BASE)
+    , sees_page_cache_(true)
+    , cpu_budget_(1.0)
+    , ns_per_page_(0.0)
+    , page_size_(4096)
+    , next_page_(0)
+    , sample_count_(0)
+    , record_count_(0)
+    , sweep_count_(0)
+    , last_sweep_ns_(0)
+    , bytes_written_(0)
+    , total_sample_ns_(0)
+    , max_sample_ns_(0)
+{
+    std::memset(&header_, 0, sizeof(header_));
+}
+
+ResidencySampler::~ResidencySampler() {
+    close();
+}
+
+uint64_t ResidencySampler::nowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool ResidencySampler::open(const std::string& file_path, const std::string& out_path, uint64_t period_ns) {
+    close();
+    fd_ = ::open(file_path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) {
+        last_error_ = "Failed to open " + file_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+    if (file_size_ == 0) {
+        last_error_ = "Empty file: " + file_path;
+        close();
+        return false;
+    }
+    sees_page_cache_ = geteuid() == 0 || st.st_uid == geteuid() || access(file_path.c_str(), W_OK) == 0;
+
+    if (!page_cache_.map(fd_, file_size_)) {
+        last_error_ = "Failed to map " + file_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    out_fd_ = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd_ < 0) {
+        last_error_ = "Failed to create " + out_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    page_size_ = page_cache_.getPageSize();
+    state_.assign(static_cast<size_t>(page_cache_.getPageCount()), 0);
+    next_page_ = 0;
+    ns_per_page_ = 0.0;
+
+    std::memcpy(header_.magic, RESIDENCY_MAGIC, sizeof(header_.magic));
+    header_.version = RESIDENCY_VERSION;
+    header_.page_size = static_cast<uint32_t>(page_size_);
+    header_.file_size = file_size_;
+    header_.period_ns = period_ns;
+    header_.trace_base_ns = trace_base_ns_;
+    sample_count_ = 0;
+    record_count_ = 0;
+    sweep_count_ = 0;
+    last_sweep_ns_ = 0;
+    bytes_written_ = 0;
+    total_sample_ns_ = 0;
+    max_sample_ns_ = 0;
+    if (!writeAll(out_fd_, &header_, sizeof(header_), 0)) {
+        last_error_ = "Failed to write " + out_path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    bytes_written_ = sizeof(header_);
+    return true;
+}
+
+void ResidencySampler::close() {
+    if (out_fd_ >= 0) {
+        flush();
+        ::close(out_fd_);
+        out_fd_ = -1;
+    }
+    page_cache_.unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool ResidencySampler::sample() {
+    if (!page_cache_.isMapped() || out_fd_ < 0) {
+        return false;
+    }
+    const uint64_t started = nowNs();
+
+    // The slice the budget pays for, continuing where the last one ended
+    const size_t pages = state_.size();
+    size_t count = pages - next_page_;
+    if (sample_count_ > 0 && cpu_budget_ < 1.0 && ns_per_page_ > 0.0) {
+        const double affordable = cpu_budget_ * header_.period_ns / ns_per_page_;
+        count = std::min(count, std::max(MIN_SLICE_PAGES, static_cast<size_t>(affordable)));
+    }
+    const size_t first = next_page_;
+    slice_.resize(count);
+    if (!page_cache_.residency(first, count, slice_.data())) {
+        last_error_ = std::string("mincore: ") + std::strerror(errno);
+        return false;
+    }
+
+    // Header, then the runs, in one write
+    record_.resize(sizeof(ResidencySampleHeader));
+    ResidencySampleHeader sample;
+    sample.timestamp_ns = started;
+    sample.run_count = encodeResidencyDelta(state_.data() + first, slice_.data(), count, first, record_);
+    sample.payload_bytes = static_cast<uint32_t>(record_.size() - sizeof(ResidencySampleHeader));
+    std::memcpy(state_.data() + first, slice_.data(), count);
+    if (sample_count_ == 0) {
+        header_.start_ns = started;
+    }
+    sample_count_++;
+    if (sample.run_count > 0) {
+        std::memcpy(record_.data(), &sample, sizeof(sample));
+        if (!writeAll(out_fd_, record_.data(), record_.size(), bytes_written_)) {
+            last_error_ = std::string("write: ") + std::strerror(errno);
+            return false;
+        }
+        record_count_++;
+        bytes_written_ += record_.size();
+    }
+
+    const uint64_t finished = nowNs();
+    next_page_ = first + count;
+    if (next_page_ >= pages) {
+        next_page_ = 0;
+        sweep_count_++;
+        last_sweep_ns_ = finished;
+    }
+    const uint64_t elapsed = finished - started;
+    const double cost = static_cast<double>(elapsed) / std::max<size_t>(count, 1);
+    ns_per_page_ = ns_per_page_ > 0.0 ? 0.8 * ns_per_page_ + 0.2 * cost : cost;
+    total_sample_ns_ += elapsed;
+    max_sample_ns_ = std::max(max_sample_ns_, elapsed);
+    return true;
+}
+
+uint64_t ResidencySampler::getSweepNs() const {
+    // The first sample covers the whole file, so sweeps after it are the ones timed
+    return sweep_count_ > 1 ? (last_sweep_ns_ - header_.start_ns) / (sweep_count_ - 1) : header_.period_ns;
+}
+
+bool ResidencySampler::flush() {
+    if (out_fd_ < 0) {
+        return false;
+    }
+    header_.trace_base_ns = trace_base_ns_;
+    header_.sample_count = sample_count_;
+    header_.sweep_ns = getSweepNs();
+    if (!writeAll(out_fd_, &header_, sizeof(header_), 0)) {
+        last_error_ = std::string("write: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+uint64_t ResidencySampler::countResidentPages() const {
+    uint64_t count = 0;
+    for (unsigned char page : state_) {
+        count += page & 1;
+    }
+    return count;
+}
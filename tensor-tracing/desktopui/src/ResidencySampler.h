@@ -0,0 +1,86 @@
+#pragma once
+
+#include "FileUtil.h"
+#include "PageResidency.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Records which pages of a file sit in the page cache, as page_residency.bin
+//
+// Each sample() is one mincore() through a PageCacheMapping (nothing is
+// faulted in), diffed against what was last seen and appended as run-length
+// flips (see PageResidency.h). mincore() costs tens of ns per page, so under
+// a CPU budget a sample covers only the slice of the file that fits and the
+// next one continues after it; the first sample always covers the whole file.
+// Unchanged samples only bump the header's sample count.
+class ResidencySampler {
+public:
+    ResidencySampler();
+    ~ResidencySampler();
+
+    ResidencySampler(const ResidencySampler&) = delete;
+    ResidencySampler& operator=(const ResidencySampler&) = delete;
+
+    // CLOCK_MONOTONIC, the tracer's clock
+    static uint64_t nowNs();
+
+    // Returns true on success, false on failure (see getLastError)
+    bool open(const std::string& file_path, const std::string& out_path, uint64_t period_ns);
+    // Flushes the header
+    void close();
+
+    // Share of one core mincore() may use per period; 1 (the default) samples
+    // the whole file every time
+    void setCpuBudget(double fraction) { cpu_budget_ = fraction; }
+
+    // Take one sample now; returns false if mincore() or the write failed
+    bool sample();
+
+    // CLOCK_MONOTONIC time of the trace's timestamp_ns 0 (written on flush)
+    void setTraceBase(uint64_t base_ns) { trace_base_ns_ = base_ns; }
+    uint64_t getTraceBase() const { return trace_base_ns_; }
+
+    // Rewrite the header (sample count, trace base) so a killed sampler leaves a usable file
+    bool flush();
+
+    // False when mincore() cannot see the page cache of this file (not owned, not writable)
+    bool seesPageCache() const { return sees_page_cache_; }
+
+    uint64_t getPageCount() const { return state_.size(); }
+    uint64_t countResidentPages() const;  // As last seen
+    uint64_t getSweepCount() const { return sweep_count_; }
+    uint64_t getSweepNs() const;          // Mean time to sample every page once
+    uint64_t getSampleCount() const { return sample_count_; }
+    uint64_t getRecordCount() const { return record_count_; }
+    uint64_t getBytesWritten() const { return bytes_written_; }
+    uint64_t getTotalSampleNs() const { return total_sample_ns_; }
+    uint64_t getMaxSampleNs() const { return max_sample_ns_; }
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    int fd_;
+    PageCacheMapping page_cache_;
+    uint64_t file_size_;
+    int out_fd_;
+    ResidencyFileHeader header_;
+    uint64_t trace_base_ns_;
+    bool sees_page_cache_;
+
+    double cpu_budget_;
+    double ns_per_page_;                // Smoothed mincore() cost
+    uint64_t page_size_;
+    size_t next_page_;                  // Where the next slice starts
+    std::vector<unsigned char> state_;  // Residency as last seen, one mincore() byte per page
+    std::vector<unsigned char> slice_;
+    std::vector<uint8_t> record_;
+
+    uint64_t sample_count_;
+    uint64_t record_count_;
+    uint64_t sweep_count_;
+    uint64_t last_sweep_ns_;            // When the last full pass ended
+    uint64_t bytes_written_;
+    uint64_t total_sample_ns_;
+    uint64_t max_sample_ns_;
+    std::string last_error_;
+};
@@ -0,0 +1,291 @@
+#include "ReuseAnalysis.h"
+#include "PageStream.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+constexpr uint32_t NONE = 0xFFFFFFFF;
+
+// Flattened references of one granularity, units renumbered densely
+struct ReferenceStream {
+    std::vector<uint32_t> units;          // One per reference, in trace order
+    std::vector<size_t> token_offsets;    // References of token t: [offsets[t], offsets[t + 1])
+    std::vector<uint64_t> unit_bytes;     // By dense unit id
+};
+
+// Fenwick tree of byte weights over reference positions
+class FenwickTree {
+public:
+    explicit FenwickTree(size_t size) : tree_(size + 1, 0) {}
+
+    void add(size_t position, uint64_t delta) {
+        for (size_t i = position + 1; i < tree_.size(); i += i & (~i + 1)) {
+            tree_[i] += delta;
+        }
+    }
+
+    // Sum of positions [0, end)
+    uint64_t prefix(size_t end) const {
+        uint64_t sum = 0;
+        for (size_t i = end; i > 0; i -= i & (~i + 1)) {
+            sum += tree_[i];
+        }
+        return sum;
+    }
+
+private:
+    std::vector<uint64_t> tree_;
+};
+
+// Whole tensors: expert slices "base[e]" fold into their base name
+void buildTensorStream(const DomainLoader& loader, bool fold_experts, ReferenceStream& out) {
+    const MemoryMap& map = loader.getMemoryMap();
+    std::vector<uint32_t> unit_of(map.tensors.size());
+    std::unordered_map<std::string_view, uint32_t> groups;
+    std::vector<uint64_t> tensor_unit_bytes;
+    for (size_t i = 0; i < map.tensors.size(); i++) {
+        const MemoryTensor& tensor = map.tensors[i];
+        if (fold_experts && tensor.expert_id >= 0) {
+            std::string_view base(tensor.name);
+            base = base.substr(0, base.find('['));
+            auto inserted = groups.emplace(base, static_cast<uint32_t>(tensor_unit_bytes.size()));
+            if (inserted.second) {
+                tensor_unit_bytes.push_back(0);
+            }
+            unit_of[i] = inserted.first->second;
+        } else {
+            unit_of[i] = static_cast<uint32_t>(tensor_unit_bytes.size());
+            tensor_unit_bytes.push_back(0);
+        }
+        tensor_unit_bytes[unit_of[i]] += tensor.size_bytes;
+    }
+
+    // Renumber in first-reference order so only referenced units get slots
+    std::vector<uint32_t> dense(tensor_unit_bytes.size(), NONE);
+    out.token_offsets.assign(1, 0);
+    for (size_t t = 0; t < loader.getTokenCount(); t++) {
+        if (loader.isTokenReady(t)) {
+            const TraceStore& store = loader.getToken(t).entries;
+            for (size_t i = 0; store.hasAccesses() && i < store.size(); i++) {
+                const uint32_t* tensors = store.accesses(i);
+                const size_t entry_begin = out.units.size();
+                for (size_t a = 0; a < store.accessCount(i); a++) {
+                    uint32_t unit = unit_of[tensors[a]];
+                    if (dense[unit] == NONE) {
+                        dense[unit] = static_cast<uint32_t>(out.unit_bytes.size());
+                        out.unit_bytes.push_back(tensor_unit_bytes[unit]);
+                    }
+                    // One reference per unit and entry (all routed slices of a folded tensor)
+                    unit = dense[unit];
+                    if (std::find(out.units.begin() + entry_begin, out.units.end(), unit) == out.units.end()) {
+                        out.units.push_back(unit);
+                    }
+                }
+            }
+        }
+        out.token_offsets.push_back(out.units.size());
+    }
+}
+
+void buildPageStream(const DomainLoader& loader, ReferenceStream& out) {
+    PageStream stream;
+    out.token_offsets.assign(1, 0);
+    if (!stream.build(loader)) {
+        return;
+    }
+
+    std::vector<uint32_t> dense(stream.getPageCount(), NONE);
+    out.units.reserve(stream.getAccessCount());
+    for (const PageExtent& extent : stream.getExtents()) {
+        while (out.token_offsets.size() <= extent.token) {
+            out.token_offsets.push_back(out.units.size());
+        }
+        for (uint32_t p = extent.first_page; p < extent.first_page + extent.page_count; p++) {
+            if (dense[p] == NONE) {
+                dense[p] = static_cast<uint32_t>(out.unit_bytes.size());
+                out.unit_bytes.push_back(stream.getPageSize());
+            }
+            out.units.push_back(dense[p]);
+        }
+    }
+    while (out.token_offsets.size() <= stream.getTokenCount()) {
+        out.token_offsets.push_back(out.units.size());
+    }
+}
+}
+
+const char* reuseGranularityName(ReuseGranularity granularity) {
+    switch (granularity) {
+        case ReuseGranularity::Tensor: return "Tensor";
+        case ReuseGranularity::ExpertSlice: return "Expert slice";
+        case ReuseGranularity::Page: return "4 KiB page";
+    }
+    return "";
+}
+
+void ReuseHistogram::add(uint64_t distance_bytes) {
+    size_t bin = 0;
+    while (bin + 1 < BIN_COUNT && (distance_bytes >> (bin + 1)) != 0) {
+        bin++;
+    }
+    bins[bin]++;
+    references++;
+}
+
+double ReuseHistogram::hitRatioBelow(size_t bin) const {
+    if (references == 0) {
+        return 0.0;
+    }
+    uint64_t hits = 0;
+    for (size_t b = 0; b <= bin && b < BIN_COUNT; b++) {
+        hits += bins[b];
+    }
+    return static_cast<double>(hits) / references;
+}
+
+ReuseAnalysis::ReuseAnalysis(ThreadPool& pool)
+    : tasks_(pool)
+    , started_(false)
+    , completed_(0)
+    , finished_(false)
+{
+    tasks_.setCompletionCallback([this] { finishRun(); });
+}
+
+ReuseAnalysis::~ReuseAnalysis() {
+    wait();
+}
+
+void ReuseAnalysis::start(const DomainLoader& loader) {
+    wait();
+    started_ = true;
+    finished_.store(false, std::memory_order_release);
+    completed_ = 0;
+
+    tasks_.submit(REUSE_GRANULARITY_COUNT, [this, &loader](size_t g) {
+        profiles_[g] = ReuseProfile();
+        analyze(loader, static_cast<ReuseGranularity>(g), profiles_[g]);
+        finishTask();
+    });
+}
+
+void ReuseAnalysis::wait() {
+    tasks_.wait();
+}
+
+float ReuseAnalysis::getProgress() const {
+    if (isFinished()) {
+        return 1.0f;
+    }
+    return static_cast<float>(completed_.load(std::memory_order_relaxed)) / REUSE_GRANULARITY_COUNT;
+}
+
+void ReuseAnalysis::analyze(const DomainLoader& loader, ReuseGranularity granularity, ReuseProfile& out) {
+    out.granularity = granularity;
+    if (!loader.isMemoryMapReady()) {
+        return;
+    }
+
+    ReferenceStream stream;
+    if (granularity == ReuseGranularity::Page) {
+        buildPageStream(loader, stream);
+    } else {
+        buildTensorStream(loader, granularity == ReuseGranularity::Tensor, stream);
+    }
+
+    const size_t token_count = stream.token_offsets.size() - 1;
+    out.unit_count = stream.unit_bytes.size();
+    out.footprint_bytes = 0;
+    for (uint64_t bytes : stream.unit_bytes) {
+        out.footprint_bytes += bytes;
+    }
+    out.per_token.assign(token_count, ReuseHistogram());
+
+    // Stack distances: the tree holds each unit's bytes at its last reference,
+    // so the bytes between two references are one range sum
+    FenwickTree tree(stream.units.size());
+    std::vector<uint32_t> last(stream.unit_bytes.size(), NONE);
+    for (size_t t = 0; t < token_count; t++) {
+        // Give up between tokens at shutdown
+        if (ThreadPool::isTaskCancelled()) {
+            return;
+        }
+        for (size_t i = stream.token_offsets[t]; i < stream.token_offsets[t + 1]; i++) {
+            const uint32_t unit = stream.units[i];
+            const uint64_t bytes = stream.unit_bytes[unit];
+            if (last[unit] == NONE) {
+                out.total.references++;
+                out.total.cold++;
+                out.per_token[t].references++;
+                out.per_token[t].cold++;
+            } else {
+                uint64_t distance = tree.prefix(i) - tree.prefix(last[unit] + 1) + bytes;
+                out.total.add(distance);
+                out.per_token[t].add(distance);
+                tree.add(last[unit], ~bytes + 1);  // Subtract (unsigned wrap)
+            }
+            tree.add(i, bytes);
+            last[unit] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Distinct units of each token, then sliding windows of whole tokens
+    std::vector<uint32_t> token_units;
+    std::vector<size_t> token_unit_offsets(1, 0);
+    std::vector<uint32_t> stamp(stream.unit_bytes.size(), NONE);
+    for (size_t t = 0; t < token_count; t++) {
+        for (size_t i = stream.token_offsets[t]; i < stream.token_offsets[t + 1]; i++) {
+            const uint32_t unit = stream.units[i];
+            if (stamp[unit] != t) {
+                stamp[unit] = static_cast<uint32_t>(t);
+                token_units.push_back(unit);
+            }
+        }
+        token_unit_offsets.push_back(token_units.size());
+    }
+
+    std::vector<uint32_t> in_window(stream.unit_bytes.size());
+    for (uint32_t window : WINDOW_TOKENS) {
+        if (window > token_count || ThreadPool::isTaskCancelled()) {
+            break;
+        }
+        std::fill(in_window.begin(), in_window.end(), 0);
+        std::vector<uint64_t> wss(token_count - window + 1, 0);
+        uint64_t window_bytes = 0;
+        for (size_t t = 0; t < token_count; t++) {
+            for (size_t i = token_unit_offsets[t]; i < token_unit_offsets[t + 1]; i++) {
+                if (in_window[token_units[i]]++ == 0) {
+                    window_bytes += stream.unit_bytes[token_units[i]];
+                }
+            }
+            if (t >= window) {
+                for (size_t i = token_unit_offsets[t - window]; i < token_unit_offsets[t - window + 1]; i++) {
+                    if (--in_window[token_units[i]] == 0) {
+                        window_bytes -= stream.unit_bytes[token_units[i]];
+                    }
+                }
+            }
+            if (t + 1 >= window) {
+                wss[t + 1 - window] = window_bytes;
+            }
+        }
+        out.window_tokens.push_back(window);
+        out.wss.push_back(std::move(wss));
+    }
+}
+
+void ReuseAnalysis::finishTask() {
+    completed_.fetch_add(1, std::memory_order_relaxed);
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
+
+void ReuseAnalysis::finishRun() {
+    // Runs on the worker that finished the last task, before wait() returns
+    finished_.store(true, std::memory_order_release);
+    if (progress_callback_) {
+        progress_callback_();
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Unit one reference is counted in
+enum class ReuseGranularity : uint8_t {
+    Tensor = 0,        // Whole tensors (the expert slices of an "_exps." tensor count as one)
+    ExpertSlice = 1,   // MemoryMap entries (one per routed expert slice)
+    Page = 2,          // 4 KiB file pages
+};
+
+constexpr size_t REUSE_GRANULARITY_COUNT = 3;
+
+const char* reuseGranularityName(ReuseGranularity granularity);
+
+// Reuse distances binned by powers of two of bytes
+//
+// The distance of a reference is the LRU stack distance weighted by size:
+// the bytes of every distinct unit touched since the previous reference to
+// this one, itself included. An LRU cache of at least that many bytes hits.
+struct ReuseHistogram {
+    static constexpr size_t BIN_COUNT = 48;   // Bin b: [2^b, 2^(b+1)) bytes
+
+    std::vector<uint64_t> bins = std::vector<uint64_t>(BIN_COUNT, 0);
+    uint64_t references = 0;
+    uint64_t cold = 0;                        // First references (infinite distance)
+
+    void add(uint64_t distance_bytes);
+    // Share of references an LRU cache of bin_upper(b) bytes would hit
+    double hitRatioBelow(size_t bin) const;
+    static double binUpperBytes(size_t bin) { return static_cast<double>(uint64_t(1) << (bin + 1)); }
+};
+
+// Results of one granularity
+struct ReuseProfile {
+    ReuseGranularity granularity = ReuseGranularity::Tensor;
+    size_t unit_count = 0;                    // Distinct units referenced
+    uint64_t footprint_bytes = 0;             // Bytes of those units
+    ReuseHistogram total;
+    std::vector<ReuseHistogram> per_token;    // By the token making the reference
+
+    // Working set over sliding windows: wss[w][t] = bytes of distinct units
+    // referenced in tokens [t, t + window_tokens[w])
+    std::vector<uint32_t> window_tokens;
+    std::vector<std::vector<uint64_t>> wss;
+};
+
+// Reuse-distance and working-set analytics over a domain's DISK accesses
+//
+// One pool task per granularity. Each one flattens the resolved accesses into
+// a reference stream in trace order and measures stack distances with a
+// Fenwick tree over time (one marked slot per unit at its last reference),
+// so a pass costs O(n log n). Results are published once isFinished().
+class ReuseAnalysis {
+public:
+    static constexpr uint32_t WINDOW_TOKENS[] = {1, 2, 4, 8, 16, 32, 64};
+
+    explicit ReuseAnalysis(ThreadPool& pool);
+    ~ReuseAnalysis();
+
+    ReuseAnalysis(const ReuseAnalysis&) = delete;
+    ReuseAnalysis& operator=(const ReuseAnalysis&) = delete;
+
+    // Called from pool workers after each finished granularity
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Loader must be finished and outlive the run (returns immediately)
+    void start(const DomainLoader& loader);
+
+    // Block until the current run has completed
+    void wait();
+
+    bool isRunning() const { return started_ && !isFinished(); }
+    bool isFinished() const { return finished_.load(std::memory_order_acquire); }
+    float getProgress() const;
+
+    // Valid once isFinished()
+    const ReuseProfile& getProfile(ReuseGranularity granularity) const {
+        return profiles_[static_cast<size_t>(granularity)];
+    }
+
+    // Profile of one granularity on the calling thread
+    static void analyze(const DomainLoader& loader, ReuseGranularity granularity, ReuseProfile& out);
+
+private:
+    TaskGroup tasks_;
+    ReuseProfile profiles_[REUSE_GRANULARITY_COUNT];
+    std::function<void()> progress_callback_;
+
+    bool started_;
+    std::atomic<size_t> completed_;
+    std::atomic<bool> finished_;
+
+    void finishTask();
+    void finishRun();
+};
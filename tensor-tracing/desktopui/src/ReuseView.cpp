@@ -0,0 +1,140 @@
+#include "ReuseView.h"
+#include "imgui.h"
+#include "implot.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+constexpr double BYTES_PER_MB = 1024.0 * 1024.0;
+constexpr double BYTES_PER_GB = 1024.0 * 1024.0 * 1024.0;
+}
+
+ReuseView::ReuseView()
+    : granularity_(ReuseGranularity::ExpertSlice)
+{
+}
+
+void ReuseView::render(const DomainLoader& loader, ThreadPool& pool, int current_token) {
+    if (!ImGui::CollapsingHeader("Reuse Distance & Working Set")) {
+        return;
+    }
+
+    const bool running = analysis_ && analysis_->isRunning();
+    ImGui::BeginDisabled(running || !loader.isFinished() || !loader.isMemoryMapReady());
+    if (ImGui::Button(analysis_ ? "Re-run##reuse" : "Run##reuse")) {
+        if (!analysis_) {
+            analysis_ = std::make_unique<ReuseAnalysis>(pool);
+            analysis_->setProgressCallback(progress_callback_);
+        }
+        analysis_->start(loader);
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+
+    if (!analysis_) {
+        ImGui::TextWrapped("LRU stack distances of every DISK access at tensor, expert slice and "
+                           "4 KiB page granularity, plus working sets over sliding token windows.");
+        return;
+    }
+    if (running) {
+        ImGui::ProgressBar(analysis_->getProgress(), ImVec2(200, 0), "Analyzing...");
+        return;
+    }
+
+    int granularity = static_cast<int>(granularity_);
+    for (size_t g = 0; g < REUSE_GRANULARITY_COUNT; g++) {
+        if (g > 0) {
+            ImGui::SameLine();
+        }
+        ImGui::RadioButton(reuseGranularityName(static_cast<ReuseGranularity>(g)), &granularity, static_cast<int>(g));
+    }
+    granularity_ = static_cast<ReuseGranularity>(granularity);
+
+    const ReuseProfile& profile = analysis_->getProfile(granularity_);
+    ImGui::Text("%zu units, %s footprint, %llu references (%llu cold)", profile.unit_count,
+                formatSize(profile.footprint_bytes).c_str(),
+                static_cast<unsigned long long>(profile.total.references),
+                static_cast<unsigned long long>(profile.total.cold));
+
+    renderHitCurve(profile, current_token);
+    renderWorkingSet(profile, current_token);
+}
+
+void ReuseView::buildHitCurve(const ReuseHistogram& histogram) {
+    xs_.clear();
+    ys_.clear();
+    for (size_t b = 0; b < ReuseHistogram::BIN_COUNT; b++) {
+        xs_.push_back(ReuseHistogram::binUpperBytes(b) / BYTES_PER_MB);
+        ys_.push_back(histogram.hitRatioBelow(b));
+    }
+}
+
+void ReuseView::renderHitCurve(const ReuseProfile& profile, int current_token) {
+    if (ImPlot::BeginPlot("##reuse_hits", ImVec2(-1, 220))) {
+        ImPlot::SetupAxis(ImAxis_X1, "LRU RAM (MB)", ImPlotAxisFlags_None);
+        ImPlot::SetupAxis(ImAxis_Y1, "Hit Ratio", ImPlotAxisFlags_None);
+        ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Log10);
+        ImPlot::SetupAxisLimits(ImAxis_X1, 1.0 / 256.0, std::max(profile.footprint_bytes / BYTES_PER_MB * 2.0, 1.0),
+                                ImGuiCond_Always);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImGuiCond_Always);
+
+        buildHitCurve(profile.total);
+        ImPlot::PlotStairs("Whole run", xs_.data(), ys_.data(), static_cast<int>(xs_.size()));
+
+        if (current_token >= 0 && static_cast<size_t>(current_token) < profile.per_token.size()) {
+            buildHitCurve(profile.per_token[current_token]);
+            char label[32];
+            snprintf(label, sizeof(label), "Token %d", current_token);
+            ImPlot::PlotStairs(label, xs_.data(), ys_.data(), static_cast<int>(xs_.size()));
+        }
+
+        // Footprint: every reference that is not cold hits beyond this
+        double footprint = profile.footprint_bytes / BYTES_PER_MB;
+        ImPlot::PlotInfLines("Footprint", &footprint, 1);
+
+        ImPlot::EndPlot();
+    }
+}
+
+void ReuseView::renderWorkingSet(const ReuseProfile& profile, int current_token) {
+    if (profile.wss.empty()) {
+        return;
+    }
+
+    if (ImPlot::BeginPlot("##working_set", ImVec2(-1, 220))) {
+        ImPlot::SetupAxis(ImAxis_X1, "First Token of Window", ImPlotAxisFlags_AutoFit);
+        ImPlot::SetupAxis(ImAxis_Y1, "Working Set (GB)", ImPlotAxisFlags_AutoFit);
+
+        for (size_t w = 0; w < profile.wss.size(); w++) {
+            const std::vector<uint64_t>& wss = profile.wss[w];
+            ys_.resize(wss.size());
+            for (size_t t = 0; t < wss.size(); t++) {
+                ys_[t] = wss[t] / BYTES_PER_GB;
+            }
+            char label[32];
+            snprintf(label, sizeof(label), "%u token%s", profile.window_tokens[w], profile.window_tokens[w] > 1 ? "s" : "");
+            ImPlot::PlotLine(label, ys_.data(), static_cast<int>(ys_.size()));
+        }
+
+        double token = current_token;
+        ImPlot::PlotInfLines("##current_token", &token, 1);
+
+        ImPlot::EndPlot();
+    }
+}
+
+std::string ReuseView::formatSize(uint64_t bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    int unit_index = 0;
+    double size = static_cast<double>(bytes);
+
+    while (size >= 1024.0 && unit_index < 3) {
+        size /= 1024.0;
+        unit_index++;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << size << " " << units[unit_index];
+    return oss.str();
+}
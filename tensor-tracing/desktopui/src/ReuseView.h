@@ -0,0 +1,42 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "ReuseAnalysis.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Reuse distance / working set panel for one domain
+//
+// Runs a ReuseAnalysis on demand and plots, for the chosen granularity, the
+// LRU hit ratio reachable with a given amount of RAM (whole run and the
+// current token) and the working set of sliding token windows.
+class ReuseView {
+public:
+    ReuseView();
+
+    // Called from pool workers while a run progresses (e.g. to wake the UI)
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // Loader must be finished before Run is enabled; pool runs the analysis
+    void render(const DomainLoader& loader, ThreadPool& pool, int current_token);
+
+private:
+    std::unique_ptr<ReuseAnalysis> analysis_;
+    std::function<void()> progress_callback_;
+    ReuseGranularity granularity_;
+
+    // Plot scratch (rebuilt per frame, a few hundred points)
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+
+    void renderHitCurve(const ReuseProfile& profile, int current_token);
+    void renderWorkingSet(const ReuseProfile& profile, int current_token);
+
+    // LRU hit ratio after each bin, one point per power of two of bytes
+    void buildHitCurve(const ReuseHistogram& histogram);
+
+    static std::string formatSize(uint64_t bytes);
+};
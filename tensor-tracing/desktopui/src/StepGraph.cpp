@@ -0,0 +1,103 @@
+#include "StepGraph.h"
+#include <algorithm>
+
+StepGraph::StepGraph()
+    : dirty_(true)
+    , lo_(0)
+    , hi_(0)
+    , width_(0)
+{
+}
+
+bool StepGraph::update(const MemoryMap& map, const TensorIndex& index,
+                       const std::vector<uint32_t>& counts,
+                       uint64_t lo, uint64_t hi, int width) {
+    if (!dirty_ && lo == lo_ && hi == hi_ && width == width_) {
+        return false;
+    }
+    dirty_ = false;
+    lo_ = lo;
+    hi_ = hi;
+    width_ = width;
+
+    // clear() keeps capacity, so steady panning does not allocate
+    xs_.clear();
+    ys_.clear();
+
+    const uint64_t begin = std::min(lo, map.total_size_bytes);
+    const uint64_t end = std::min(hi, map.total_size_bytes);
+    if (end <= begin || width <= 0) {
+        return true;
+    }
+
+    size_t first = 0, last = 0;
+    index.findRange(begin, end - 1, first, last);
+
+    const double bytes_per_gb = 1024.0 * 1024.0 * 1024.0;
+    const size_t pixels = static_cast<size_t>(width);
+
+    // Few enough tensors: exact steps (two points per tensor)
+    if (last - first <= pixels) {
+        xs_.reserve(2 * (last - first));
+        ys_.reserve(2 * (last - first));
+        for (size_t p = first; p < last; p++) {
+            uint32_t i = index.byOffset(p);
+            const MemoryTensor& tensor = map.tensors[i];
+            double count = i < counts.size() ? static_cast<double>(counts[i]) : 0.0;
+            addPoint(tensor.offset_start / bytes_per_gb, count);
+            addPoint(tensor.offset_end / bytes_per_gb, count);
+        }
+        return true;
+    }
+
+    // Otherwise min/max per pixel column
+    const double bytes_per_pixel = static_cast<double>(end - begin) / pixels;
+    columns_.assign(pixels, Column{0, 0, 0, 0, false});
+    for (size_t p = first; p < last; p++) {
+        uint32_t i = index.byOffset(p);
+        const MemoryTensor& tensor = map.tensors[i];
+        uint32_t count = i < counts.size() ? counts[i] : 0;
+
+        uint64_t first_byte = std::max(tensor.offset_start, begin);
+        uint64_t last_byte = tensor.offset_end > tensor.offset_start ? tensor.offset_end - 1 : tensor.offset_end;
+        last_byte = std::min(last_byte, end - 1);
+        if (last_byte < first_byte) {
+            continue;
+        }
+        size_t c0 = std::min(static_cast<size_t>((first_byte - begin) / bytes_per_pixel), pixels - 1);
+        size_t c1 = std::min(static_cast<size_t>((last_byte - begin) / bytes_per_pixel), pixels - 1);
+
+        for (size_t c = c0; c <= c1; c++) {
+            Column& column = columns_[c];
+            if (!column.used) {
+                column = Column{count, count, static_cast<uint32_t>(p), static_cast<uint32_t>(p), true};
+                continue;
+            }
+            if (count < column.min) {
+                column.min = count;
+                column.min_pos = static_cast<uint32_t>(p);
+            }
+            if (count > column.max) {
+                column.max = count;
+                column.max_pos = static_cast<uint32_t>(p);
+            }
+        }
+    }
+
+    xs_.reserve(2 * pixels);
+    ys_.reserve(2 * pixels);
+    for (size_t c = 0; c < pixels; c++) {
+        const Column& column = columns_[c];
+        if (!column.used) {
+            continue;
+        }
+
+        // Two points per column, extremes in the order they occur in the file
+        double x0 = (begin + c * bytes_per_pixel) / bytes_per_gb;
+        double x1 = (begin + (c + 1) * bytes_per_pixel) / bytes_per_gb;
+        bool min_first = column.min_pos <= column.max_pos;
+        addPoint(x0, static_cast<double>(min_first ? column.min : column.max));
+        addPoint(x1, static_cast<double>(min_first ? column.max : column.min));
+    }
+    return true;
+}
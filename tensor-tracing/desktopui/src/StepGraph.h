@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MemoryMap.h"
+#include "TensorIndex.h"
+#include <cstdint>
+#include <vector>
+
+// Cached vertex buffers for a per-tensor access count step graph
+//
+// X is the file offset in GB, Y the tensor's count. When the visible range
+// holds more tensors than the plot has pixels, each pixel column is reduced
+// to its min and max count (in file order), so ImPlot never receives more
+// than ~2 x width points. Buffers are reused and only rebuilt when the range,
+// the width or (after invalidate) the counts change.
+class StepGraph {
+public:
+    StepGraph();
+
+    // Rebuild for byte range [lo, hi) at width pixels if anything changed
+    // (counts must hold one slot per map tensor); returns true if rebuilt
+    bool update(const MemoryMap& map, const TensorIndex& index,
+                const std::vector<uint32_t>& counts,
+                uint64_t lo, uint64_t hi, int width);
+
+    // Force the next update to rebuild (counts changed)
+    void invalidate() { dirty_ = true; }
+
+    bool empty() const { return xs_.empty(); }
+    int getPointCount() const { return static_cast<int>(xs_.size()); }
+    const double* getXs() const { return xs_.data(); }
+    const double* getYs() const { return ys_.data(); }
+
+private:
+    // Per-pixel min/max of the counts of tensors falling into the column
+    struct Column {
+        uint32_t min;
+        uint32_t max;
+        uint32_t min_pos;   // Offset-order position of the tensor holding min
+        uint32_t max_pos;   // Offset-order position of the tensor holding max
+        bool used;
+    };
+
+    bool dirty_;
+    uint64_t lo_;
+    uint64_t hi_;
+    int width_;
+
+    std::vector<Column> columns_;  // Scratch for decimation
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+
+    void addPoint(double x, double y) {
+        xs_.push_back(x);
+        ys_.push_back(y);
+    }
+};
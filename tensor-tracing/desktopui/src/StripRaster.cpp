@@ -0,0 +1,82 @@
+#include "StripRaster.h"
+#include <algorithm>
+
+StripRaster::StripRaster()
+    : dirty_(true)
+    , lo_(0)
+    , hi_(0)
+    , width_(0)
+    , reduce_(Reduce::Max)
+    , begin_(0)
+    , end_(0)
+{
+}
+
+bool StripRaster::update(const MemoryMap& map, const TensorIndex& index,
+                         const std::vector<uint32_t>& counts, uint32_t max_count,
+                         uint64_t lo, uint64_t hi, int width, Reduce reduce) {
+    if (!dirty_ && lo == lo_ && hi == hi_ && width == width_ && reduce == reduce_) {
+        return false;
+    }
+    dirty_ = false;
+    lo_ = lo;
+    hi_ = hi;
+    width_ = width;
+    reduce_ = reduce;
+
+    begin_ = std::min(lo, map.total_size_bytes);
+    end_ = std::min(hi, map.total_size_bytes);
+    if (end_ <= begin_ || width <= 0) {
+        bins_.clear();
+        levels_.clear();
+        return true;
+    }
+
+    const size_t columns = static_cast<size_t>(width);
+    const double bytes_per_column = static_cast<double>(end_ - begin_) / columns;
+    bins_.assign(columns, 0);
+
+    size_t first = 0, last = 0;
+    index.findRange(begin_, end_ - 1, first, last);
+    for (size_t p = first; p < last; p++) {
+        uint32_t i = index.byOffset(p);
+        uint32_t count = i < counts.size() ? counts[i] : 0;
+        if (count == 0) {
+            continue;
+        }
+
+        // Columns holding the first and last byte of the tensor
+        const MemoryTensor& tensor = map.tensors[i];
+        uint64_t first_byte = std::max(tensor.offset_start, begin_);
+        uint64_t last_byte = tensor.offset_end > tensor.offset_start ? tensor.offset_end - 1 : tensor.offset_end;
+        last_byte = std::min(last_byte, end_ - 1);
+        if (last_byte < first_byte) {
+            continue;
+        }
+        size_t c0 = std::min(static_cast<size_t>((first_byte - begin_) / bytes_per_column), columns - 1);
+        size_t c1 = std::min(static_cast<size_t>((last_byte - begin_) / bytes_per_column), columns - 1);
+
+        if (reduce == Reduce::Max) {
+            for (size_t c = c0; c <= c1; c++) {
+                bins_[c] = std::max<uint64_t>(bins_[c], count);
+            }
+        } else {
+            for (size_t c = c0; c <= c1; c++) {
+                bins_[c] += count;
+            }
+        }
+    }
+
+    // Level 0 stays reserved for "not accessed", so any access is visible
+    levels_.resize(columns);
+    const double scale = max_count > 0 ? (LEVELS - 2) / static_cast<double>(max_count) : 0.0;
+    for (size_t c = 0; c < columns; c++) {
+        if (bins_[c] == 0) {
+            levels_[c] = 0;
+        } else {
+            double level = 1.0 + bins_[c] * scale + 0.5;
+            levels_[c] = static_cast<uint8_t>(std::min(level, static_cast<double>(LEVELS - 1)));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "MemoryMap.h"
+#include "TensorIndex.h"
+#include <cstdint>
+#include <vector>
+
+// Pixel-resolution raster of the heatmap strip for one visible byte range
+//
+// Every tensor overlapping the range is folded into the pixel columns it
+// covers, so drawing costs one heatmap item of `width` cells no matter how
+// many tensors the map holds. Columns hold colormap levels: 0 = not accessed,
+// 1..LEVELS-1 = heat relative to the max count. The raster is only rebuilt
+// when the range, the width or (after invalidate) the counts change.
+class StripRaster {
+public:
+    static constexpr int LEVELS = 256;
+
+    // How tensors sharing one pixel column are combined
+    enum class Reduce {
+        Max,  // Hottest tensor in the column
+        Sum,  // Total accesses of the column (clamped to the max count)
+    };
+
+    StripRaster();
+
+    // Rebuild for byte range [lo, hi) at width columns if anything changed
+    // (counts must hold one slot per map tensor); returns true if rebuilt
+    bool update(const MemoryMap& map, const TensorIndex& index,
+                const std::vector<uint32_t>& counts, uint32_t max_count,
+                uint64_t lo, uint64_t hi, int width, Reduce reduce);
+
+    // Force the next update to rebuild (counts changed)
+    void invalidate() { dirty_ = true; }
+
+    bool empty() const { return levels_.empty(); }
+    int getWidth() const { return static_cast<int>(levels_.size()); }
+    const uint8_t* getLevels() const { return levels_.data(); }
+    const uint64_t* getBins() const { return bins_.data(); }  // Reduced counts behind the levels
+
+    // Byte range actually covered by the columns (clamped to the file)
+    uint64_t getBegin() const { return begin_; }
+    uint64_t getEnd() const { return end_; }
+
+private:
+    bool dirty_;
+    uint64_t lo_;
+    uint64_t hi_;
+    int width_;
+    Reduce reduce_;
+
+    uint64_t begin_;
+    uint64_t end_;
+    std::vector<uint64_t> bins_;   // Reduced counts per column
+    std::vector<uint8_t> levels_;  // Colormap level per column
+};
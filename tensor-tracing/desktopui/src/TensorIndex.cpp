@@ -0,0 +1,111 @@
+#include "TensorIndex.h"
+#include <algorithm>
+
+TensorIndex::TensorIndex()
+    : tensor_count_(0)
+    , expert_stride_(0)
+{
+}
+
+void TensorIndex::clear() {
+    tensor_count_ = 0;
+    by_name_.clear();
+    expert_groups_.clear();
+    expert_slices_.clear();
+    expert_stride_ = 0;
+    by_offset_.clear();
+    starts_.clear();
+    ends_.clear();
+    end_prefix_max_.clear();
+}
+
+void TensorIndex::build(const MemoryMap& map) {
+    clear();
+    tensor_count_ = map.tensors.size();
+    by_name_.reserve(map.tensors.size());
+
+    for (size_t i = 0; i < map.tensors.size(); i++) {
+        const MemoryTensor& tensor = map.tensors[i];
+        by_name_.emplace(tensor.name, static_cast<uint32_t>(i));
+        if (tensor.expert_id >= 0) {
+            expert_stride_ = std::max(expert_stride_, static_cast<size_t>(tensor.expert_id) + 1);
+        }
+    }
+
+    // Group per-expert slices by the name the tracer reports ("name[N]" -> "name")
+    for (size_t i = 0; i < map.tensors.size(); i++) {
+        const MemoryTensor& tensor = map.tensors[i];
+        if (tensor.expert_id < 0) {
+            continue;
+        }
+
+        std::string_view name = tensor.name;
+        size_t bracket = name.rfind('[');
+        if (bracket == std::string_view::npos) {
+            continue;
+        }
+        std::string_view base_name = name.substr(0, bracket);
+
+        auto it = expert_groups_.find(base_name);
+        if (it == expert_groups_.end()) {
+            uint32_t group = static_cast<uint32_t>(expert_groups_.size());
+            it = expert_groups_.emplace(base_name, group).first;
+            expert_slices_.resize(expert_slices_.size() + expert_stride_, NO_TENSOR);
+        }
+        expert_slices_[it->second * expert_stride_ + tensor.expert_id] = static_cast<uint32_t>(i);
+    }
+
+    // Offset order (the map is usually sorted already; stable keeps ties in map order)
+    by_offset_.resize(map.tensors.size());
+    for (size_t i = 0; i < by_offset_.size(); i++) {
+        by_offset_[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(by_offset_.begin(), by_offset_.end(), [&map](uint32_t a, uint32_t b) {
+        return map.tensors[a].offset_start < map.tensors[b].offset_start;
+    });
+
+    starts_.resize(by_offset_.size());
+    ends_.resize(by_offset_.size());
+    end_prefix_max_.resize(by_offset_.size());
+    uint64_t max_end = 0;
+    for (size_t p = 0; p < by_offset_.size(); p++) {
+        const MemoryTensor& tensor = map.tensors[by_offset_[p]];
+        max_end = std::max(max_end, tensor.offset_end);
+        starts_[p] = tensor.offset_start;
+        ends_[p] = tensor.offset_end;
+        end_prefix_max_[p] = max_end;
+    }
+}
+
+uint32_t TensorIndex::findAt(uint64_t offset) const {
+    // Last tensor starting at or before offset
+    size_t p = static_cast<size_t>(std::upper_bound(starts_.begin(), starts_.end(), offset) - starts_.begin());
+    if (p == 0) {
+        return NO_TENSOR;
+    }
+    p--;
+
+    // Tensors in a GGUF file only touch, never overlap: prefer the one ending here
+    if (p > 0 && starts_[p] == offset && ends_[p - 1] >= offset) {
+        p--;
+    }
+    return ends_[p] >= offset ? by_offset_[p] : NO_TENSOR;
+}
+
+void TensorIndex::findRange(uint64_t lo, uint64_t hi, size_t& first, size_t& last) const {
+    first = static_cast<size_t>(std::lower_bound(end_prefix_max_.begin(), end_prefix_max_.end(), lo) - end_prefix_max_.begin());
+    last = static_cast<size_t>(std::upper_bound(starts_.begin(), starts_.end(), hi) - starts_.begin());
+    if (last < first) {
+        last = first;
+    }
+}
+
+uint32_t TensorIndex::find(std::string_view name) const {
+    auto it = by_name_.find(name);
+    return it != by_name_.end() ? it->second : NO_TENSOR;
+}
+
+uint32_t TensorIndex::findExpertGroup(std::string_view base_name) const {
+    auto it = expert_groups_.find(base_name);
+    return it != expert_groups_.end() ? it->second : NO_GROUP;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "MemoryMap.h"
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Experts counted per routed access (top-4, same as the WebUI)
+constexpr size_t EXPERT_ACCESS_TOP_K = 4;
+
+// Lookup structures over MemoryMap tensors, built once per memory map
+//
+// By name: memory-map.json splits "_exps.weight" tensors into one entry per
+// expert ("blk.0.ffn_down_exps.weight[3]"); those slices are grouped by base
+// name so an (expert tensor, expert_id) pair resolves with one hash lookup
+// plus an array index. Keys point into the MemoryMap's tensor names, so the
+// map must outlive the index.
+//
+// By offset: tensors sorted by offset_start for O(log n) hit-testing and for
+// culling everything outside the visible file range.
+class TensorIndex {
+public:
+    static constexpr uint32_t NO_TENSOR = 0xFFFFFFFF;
+    static constexpr uint32_t NO_GROUP = 0xFFFFFFFF;
+
+    TensorIndex();
+
+    void build(const MemoryMap& map);
+    void clear();
+
+    bool empty() const { return by_name_.empty(); }
+    size_t getTensorCount() const { return tensor_count_; }
+
+    // Tensor with exactly this name, or NO_TENSOR
+    uint32_t find(std::string_view name) const;
+
+    // Expert group of a tensor split per expert in the map, or NO_GROUP
+    uint32_t findExpertGroup(std::string_view base_name) const;
+
+    // Slice "base_name[expert_id]" of an expert group, or NO_TENSOR
+    uint32_t expertSlice(uint32_t group, int expert_id) const {
+        if (expert_id < 0 || static_cast<size_t>(expert_id) >= expert_stride_) {
+            return NO_TENSOR;
+        }
+        return expert_slices_[group * expert_stride_ + expert_id];
+    }
+
+    // Tensor whose [offset_start, offset_end] contains offset, or NO_TENSOR
+    // (on a shared boundary the earlier tensor wins, like a front-to-back scan)
+    uint32_t findAt(uint64_t offset) const;
+
+    // Offset-order positions [first, last) of tensors overlapping [lo, hi]
+    void findRange(uint64_t lo, uint64_t hi, size_t& first, size_t& last) const;
+    uint32_t byOffset(size_t position) const { return by_offset_[position]; }
+
+private:
+    size_t tensor_count_;
+    std::unordered_map<std::string_view, uint32_t> by_name_;
+    std::unordered_map<std::string_view, uint32_t> expert_groups_;
+    std::vector<uint32_t> expert_slices_;  // group * expert_stride_ + expert_id
+    size_t expert_stride_;                 // Max expert_id + 1
+
+    std::vector<uint32_t> by_offset_;      // Tensor indices sorted by offset_start
+    std::vector<uint64_t> starts_;         // offset_start in offset order
+    std::vector<uint64_t> ends_;           // offset_end in offset order
+    std::vector<uint64_t> end_prefix_max_; // Running max of offset_end in offset order
+};
@@ -0,0 +1,220 @@
+#include "ThreadPool.h"
+#include <chrono>
+
+namespace {
+// Index of the pool worker running on this thread (-1 for non-worker threads)
+thread_local int current_worker_index = -1;
+thread_local const ThreadPool* current_worker_pool = nullptr;
+}
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : queued_(0)
+    , active_(0)
+    , next_queue_(0)
+    , stopping_(false)
+    , cancelled_(false)
+{
+    if (num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    size_t target;
+    if (current_worker_pool == this) {
+        target = static_cast<size_t>(current_worker_index);
+    } else {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        target = next_queue_++ % queues_.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        queued_++;
+    }
+    wake_cv_.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    idle_cv_.wait(lock, [this] { return queued_ == 0 && active_ == 0; });
+}
+
+bool ThreadPool::runPendingTask() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (queued_ == 0) {
+            return false;
+        }
+        queued_--;
+        active_++;
+    }
+    runReservedTask(isWorkerThread() ? static_cast<size_t>(current_worker_index) : 0);
+    return true;
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return current_worker_pool == this;
+}
+
+bool ThreadPool::isTaskCancelled() {
+    return current_worker_pool && current_worker_pool->isCancelled();
+}
+
+bool ThreadPool::popTask(size_t index, std::function<void()>& out) {
+    // Own deque first (LIFO keeps freshly split work cache-warm)
+    {
+        WorkQueue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            out = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest task from another worker
+    for (size_t offset = 1; offset < queues_.size(); offset++) {
+        WorkQueue& victim = *queues_[(index + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            out = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    current_worker_index = static_cast<int>(index);
+    current_worker_pool = this;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex_);
+            wake_cv_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (queued_ == 0) {
+                return;  // Stopping and fully drained
+            }
+            // Reserve one task; it is guaranteed to be in some deque
+            queued_--;
+            active_++;
+        }
+
+        runReservedTask(index);
+    }
+}
+
+void ThreadPool::runReservedTask(size_t index) {
+    std::function<void()> task;
+    while (!popTask(index, task)) {
+        std::this_thread::yield();
+    }
+
+    task();
+
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    active_--;
+    if (queued_ == 0 && active_ == 0) {
+        idle_cv_.notify_all();
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool_(pool)
+    , pending_(0)
+{
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_++;
+    }
+    pool_.submit([this, task = std::move(task)] {
+        task();
+        finishTask();
+    });
+}
+
+void TaskGroup::submit(size_t count, std::function<void(size_t)> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ += count;
+    }
+    for (size_t i = 0; i < count; i++) {
+        pool_.submit([this, task, i] {
+            task(i);
+            finishTask();
+        });
+    }
+}
+
+void TaskGroup::wait() {
+    const bool on_worker = pool_.isWorkerThread();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (pending_ > 0) {
+        if (!on_worker) {
+            idle_cv_.wait(lock, [this] { return pending_ == 0; });
+            break;
+        }
+
+        // The group's tasks may be queued behind this worker, so run pool work meanwhile
+        lock.unlock();
+        bool ran = pool_.runPendingTask();
+        lock.lock();
+        if (!ran && pending_ > 0) {
+            idle_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    }
+}
+
+bool TaskGroup::isIdle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_ == 0;
+}
+
+void TaskGroup::finishTask() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (pending_ == 1 && completion_callback_) {
+        // The last task stays pending while the callback runs, so wait() returns after it
+        lock.unlock();
+        completion_callback_();
+        lock.lock();
+    }
+    if (--pending_ == 0) {
+        idle_cv_.notify_all();
+    }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool
+// Each worker owns a deque: it pops its own work LIFO and steals FIFO from others.
+class ThreadPool {
+public:
+    // num_threads = 0 uses all hardware threads
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task (tasks submitted from a worker go to that worker's own deque)
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished
+    void waitIdle();
+
+    // Run one queued task on the calling thread; false if none was queued
+    bool runPendingTask();
+
+    // True on this pool's own worker threads
+    bool isWorkerThread() const;
+
+    // Ask queued and running tasks to return early (set before waiting at shutdown)
+    // Tasks still run, so groups and callbacks complete, but skip their work
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+    // True while the calling thread works for a cancelled pool; long loops in
+    // routines that are also called outside any pool poll this
+    static bool isTaskCancelled();
+
+    size_t getThreadCount() const { return workers_.size(); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // Guards the counters below (tasks are coarse, so one lock is cheap enough)
+    std::mutex state_mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable idle_cv_;
+    size_t queued_;
+    size_t active_;
+    size_t next_queue_;
+    bool stopping_;
+    std::atomic<bool> cancelled_;
+
+    void workerLoop(size_t index);
+    bool popTask(size_t index, std::function<void()>& out);
+    void runReservedTask(size_t index);
+};
+
+// The tasks of one job on a shared ThreadPool, waited on as a group
+//
+// The group counts only its own tasks (and the ones they submit to it), so
+// wait() never waits on unrelated work elsewhere in the pool. An optional
+// completion callback runs on the worker that finishes the last task, before
+// wait() returns. Waiting from a pool worker runs queued pool tasks meanwhile,
+// so the group's tasks cannot starve behind the waiting worker.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Set while the group is idle; the callback must not submit to the group
+    void setCompletionCallback(std::function<void()> callback) { completion_callback_ = std::move(callback); }
+
+    // Queue a task of this group (also from inside the group's own tasks)
+    // Several tasks queued from outside the group go through the batch form,
+    // or the group may complete (and run the callback) between them
+    void submit(std::function<void()> task);
+
+    // Queue task(0) .. task(count - 1), all counted before the first one runs
+    void submit(size_t count, std::function<void(size_t)> task);
+
+    // Block until no task of the group is pending (and the completion callback has run)
+    void wait();
+
+    bool isIdle() const;
+
+private:
+    ThreadPool& pool_;
+    std::function<void()> completion_callback_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable idle_cv_;
+    size_t pending_;
+
+    void finishTask();
+};
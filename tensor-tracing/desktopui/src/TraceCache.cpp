@@ -0,0 +1,673 @@
+#include "TraceCache.h"
+#include "TraceFormat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char CACHE_MAGIC[8] = {'T', 'T', 'C', 'A', 'C', 'H', 'E', '\0'};
+constexpr uint32_t CACHE_BYTE_ORDER = 0x01020304;
+constexpr size_t CACHE_ALIGNMENT = 64;
+
+// memory_source column values (DISK/BUFFER match the binary trace format)
+constexpr uint8_t CACHE_MEMORY_DISK = 0;
+constexpr uint8_t CACHE_MEMORY_BUFFER = 1;
+constexpr uint8_t CACHE_MEMORY_OTHER = 2;
+static_assert(CACHE_MEMORY_DISK == static_cast<uint8_t>(MemorySource::Disk) &&
+              CACHE_MEMORY_BUFFER == static_cast<uint8_t>(MemorySource::Buffer) &&
+              CACHE_MEMORY_OTHER == static_cast<uint8_t>(MemorySource::Other),
+              "Cache memory_source values are stored as MemorySource");
+
+// Entry columns are attached to TraceStore as they are mapped
+static_assert(sizeof(TracePhase) == 1, "Phase column is one byte per entry");
+static_assert(sizeof(std::array<uint32_t, TRACE_MAX_SOURCES>) == TRACE_MAX_SOURCES * sizeof(uint32_t) &&
+              sizeof(std::array<uint8_t, TRACE_MAX_EXPERTS>) == TRACE_MAX_EXPERTS,
+              "Source and expert slots are stored unpadded");
+
+struct CacheSourceFileRecord {
+    uint64_t size_bytes;
+    int64_t mtime_ns;
+    uint32_t path_string;
+    uint32_t pad;
+};
+
+struct CacheTokenRecord {
+    uint32_t token_id;
+    uint32_t first_entry;
+    uint32_t entry_count;
+    uint32_t total_entries;
+    double duration_ms;
+    uint64_t timestamp_start_ns;
+    uint32_t format_version_string;
+    uint32_t pad;
+};
+
+// Interns strings into a single blob + offset table
+class StringTable {
+public:
+    uint32_t intern(const std::string& str) {
+        auto it = ids_.find(str);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(offsets_.size() - 1);
+        ids_.emplace(str, id);
+        data_.insert(data_.end(), str.begin(), str.end());
+        offsets_.push_back(static_cast<uint32_t>(data_.size()));
+        return id;
+    }
+
+    size_t count() const { return offsets_.size() - 1; }
+    const std::vector<uint32_t>& offsets() const { return offsets_; }
+    const std::vector<char>& data() const { return data_; }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<uint32_t> offsets_{0};
+    std::vector<char> data_;
+};
+
+// Fixed-size file header; section table follows the counts
+struct TraceCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t token_count;
+    uint64_t entry_count;
+    uint64_t string_count;
+    uint64_t source_file_count;
+    uint64_t source_count;
+    uint64_t section_offsets[64];
+    uint64_t section_sizes[64];
+};
+
+// True if offsets[0..count] start at 0, never decrease and end at end_value,
+// so every range [offsets[i], offsets[i + 1]) lies inside its data section
+bool offsetsValid(const uint32_t* offsets, size_t count, uint64_t end_value) {
+    if (offsets[0] != 0 || offsets[count] != end_value) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// Every column of the file, built in memory before it is written
+struct TraceCache::Columns {
+    StringTable strings;
+    std::vector<CacheSourceFileRecord> source_files;
+    std::vector<CacheTokenRecord> tokens;
+
+    std::vector<uint64_t> timestamps;
+    std::vector<float> relative_ms;
+    std::vector<uint32_t> entry_ids, entry_tokens, dst_names;
+    std::vector<int16_t> layers;
+    std::vector<uint16_t> threads;
+    std::vector<uint8_t> ops, phases, num_sources, num_experts;
+    std::vector<std::array<uint32_t, TRACE_MAX_SOURCES>> entry_sources;
+    std::vector<std::array<uint8_t, TRACE_MAX_EXPERTS>> entry_experts;
+
+    // One row per distinct source tensor
+    std::vector<uint32_t> source_names;
+    std::vector<uint64_t> source_ptrs, source_sizes, source_offsets;
+    std::vector<int16_t> source_layers;
+    std::vector<uint8_t> source_memory;
+
+    void reserve(size_t entry_count) {
+        timestamps.reserve(entry_count);
+        relative_ms.reserve(entry_count);
+        entry_ids.reserve(entry_count);
+        entry_tokens.reserve(entry_count);
+        dst_names.reserve(entry_count);
+        layers.reserve(entry_count);
+        threads.reserve(entry_count);
+        ops.reserve(entry_count);
+        phases.reserve(entry_count);
+        num_sources.reserve(entry_count);
+        num_experts.reserve(entry_count);
+        entry_sources.reserve(entry_count);
+        entry_experts.reserve(entry_count);
+    }
+
+    // info.name_id must already be a cache string id
+    uint32_t addSource(const TraceSourceInfo& info) {
+        source_names.push_back(info.name_id);
+        source_ptrs.push_back(info.tensor_ptr);
+        source_sizes.push_back(info.size_bytes);
+        source_layers.push_back(info.layer_id);
+        source_memory.push_back(static_cast<uint8_t>(info.memory_source));
+        source_offsets.push_back(info.offset);
+        return static_cast<uint32_t>(source_names.size() - 1);
+    }
+
+    // record.dst_name and record.sources must already be cache ids
+    void addEntry(const TraceRecord& record, uint32_t token_id) {
+        timestamps.push_back(record.timestamp_ns);
+        relative_ms.push_back(record.relative_ms);
+        entry_ids.push_back(record.entry_id);
+        entry_tokens.push_back(token_id);
+        layers.push_back(record.layer_id);
+        threads.push_back(record.thread_id);
+        ops.push_back(record.op);
+        phases.push_back(static_cast<uint8_t>(record.phase));
+        num_sources.push_back(record.num_sources);
+        num_experts.push_back(record.num_experts);
+        dst_names.push_back(record.dst_name);
+        entry_sources.push_back(record.sources);
+        entry_experts.push_back(record.expert_ids);
+    }
+};
+
+TraceCache::TraceCache()
+    : data_(nullptr)
+    , mapped_size_(0)
+    , token_count_(0)
+    , entry_count_(0)
+    , string_count_(0)
+    , source_count_(0)
+    , sections_()
+{
+}
+
+TraceCache::~TraceCache() {
+    close();
+}
+
+std::string TraceCache::getCachePath(const std::string& domain_path) {
+    return domain_path + "/.ttcache";
+}
+
+bool TraceCache::statSourceFile(const std::string& domain_path, const std::string& relative_path, TraceSourceFile& out) {
+    struct stat st;
+    if (stat((domain_path + "/" + relative_path).c_str(), &st) != 0) {
+        return false;
+    }
+
+    out.path = relative_path;
+    out.size_bytes = static_cast<uint64_t>(st.st_size);
+#ifdef __APPLE__
+    out.mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    out.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    return true;
+}
+
+bool TraceCache::write(const std::string& filepath, const std::vector<TraceSourceFile>& sources,
+                       const std::vector<TraceData>& tokens) {
+    Columns columns;
+    for (const auto& source : sources) {
+        columns.source_files.push_back({source.size_bytes, source.mtime_ns, columns.strings.intern(source.path), 0});
+    }
+
+    size_t entry_count = 0;
+    for (const auto& token : tokens) {
+        entry_count += token.entries.size();
+    }
+    columns.reserve(entry_count);
+
+    // Symbol ids -> cache ids, assigned on first use
+    std::unordered_map<uint32_t, uint32_t> string_ids;
+    std::unordered_map<uint32_t, uint32_t> source_ids;
+    auto cacheString = [&](const TraceStore& store, uint32_t symbol_id) {
+        auto it = string_ids.find(symbol_id);
+        if (it == string_ids.end()) {
+            it = string_ids.emplace(symbol_id, columns.strings.intern(store.getString(symbol_id))).first;
+        }
+        return it->second;
+    };
+
+    for (const auto& token : tokens) {
+        const TraceStore& store = token.entries;
+
+        CacheTokenRecord record{};
+        record.token_id = store.tokenId();
+        record.first_entry = static_cast<uint32_t>(columns.timestamps.size());
+        record.entry_count = static_cast<uint32_t>(store.size());
+        record.total_entries = token.metadata.total_entries;
+        record.duration_ms = token.metadata.duration_ms;
+        record.timestamp_start_ns = token.metadata.timestamp_start_ns;
+        record.format_version_string = columns.strings.intern(token.metadata.format_version);
+        columns.tokens.push_back(record);
+
+        for (size_t i = 0; i < store.size(); i++) {
+            TraceRecord entry{};
+            entry.timestamp_ns = store.timestampNs(i);
+            entry.relative_ms = store.relativeMs(i);
+            entry.entry_id = store.entryId(i);
+            entry.layer_id = static_cast<int16_t>(store.layerId(i));
+            entry.thread_id = store.threadId(i);
+            entry.op = store.op(i);
+            entry.phase = store.phase(i);
+            entry.num_sources = static_cast<uint8_t>(store.numSources(i));
+            entry.num_experts = static_cast<uint8_t>(store.numExperts(i));
+            entry.dst_name = cacheString(store, store.dstNameId(i));
+
+            entry.sources.fill(TraceSymbols::NO_ID);
+            for (size_t s = 0; s < store.numSources(i); s++) {
+                uint32_t symbol_id = store.sourceId(i, s);
+                auto it = source_ids.find(symbol_id);
+                if (it == source_ids.end()) {
+                    TraceSourceInfo info = store.source(i, s);
+                    info.name_id = cacheString(store, info.name_id);
+                    it = source_ids.emplace(symbol_id, columns.addSource(info)).first;
+                }
+                entry.sources[s] = it->second;
+            }
+
+            const uint8_t* experts = store.expertIds(i);
+            entry.expert_ids.fill(TRACE_NO_EXPERT);
+            std::copy(experts, experts + store.numExperts(i), entry.expert_ids.begin());
+
+            columns.addEntry(entry, store.tokenId());
+        }
+    }
+
+    return writeColumns(filepath, columns);
+}
+
+bool TraceCache::write(const std::string& filepath, const std::vector<TraceSourceFile>& sources, const TraceFile& trace) {
+    Columns columns;
+    for (const auto& source : sources) {
+        columns.source_files.push_back({source.size_bytes, source.mtime_ns, columns.strings.intern(source.path), 0});
+    }
+    columns.reserve(trace.getEntryCount());
+
+    // Names and sources get cache ids directly, the workspace symbols are never touched
+    std::unordered_map<TraceSourceInfo, uint32_t, TraceSymbols::SourceKeyHash, TraceSymbols::SourceKeyEqual> source_ids;
+    std::string name;  // Reused, so lookups of known names don't allocate
+    auto cacheString = [&columns, &name](std::string_view str) {
+        name.assign(str.data(), str.size());
+        return columns.strings.intern(name);
+    };
+    auto cacheSource = [&columns, &source_ids](const TraceSourceInfo& info) {
+        auto it = source_ids.find(info);
+        if (it == source_ids.end()) {
+            it = source_ids.emplace(info, columns.addSource(info)).first;
+        }
+        return it->second;
+    };
+
+    TraceMetadata metadata;
+    TraceRecord entry;
+    for (const TraceTokenRange& range : trace.getTokenRanges()) {
+        trace.buildMetadata(range, metadata);
+
+        CacheTokenRecord record{};
+        record.token_id = range.token_id;
+        record.first_entry = static_cast<uint32_t>(columns.timestamps.size());
+        record.entry_count = static_cast<uint32_t>(range.entry_count);
+        record.total_entries = metadata.total_entries;
+        record.duration_ms = metadata.duration_ms;
+        record.timestamp_start_ns = metadata.timestamp_start_ns;
+        record.format_version_string = columns.strings.intern(metadata.format_version);
+        columns.tokens.push_back(record);
+
+        for (size_t i = 0; i < range.entry_count; i++) {
+            trace.decodeRecord(range, i, metadata.timestamp_start_ns, cacheString, cacheSource, entry);
+            columns.addEntry(entry, range.token_id);
+        }
+    }
+
+    return writeColumns(filepath, columns);
+}
+
+bool TraceCache::writeColumns(const std::string& filepath, const Columns& columns) {
+    static_assert(SECTION_COUNT <= 64, "Section table too small");
+
+    // Write to a temporary file, then rename so readers never see a partial cache
+    std::string temp_path = filepath + ".tmp";
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        last_error_ = "Failed to create cache file: " + temp_path;
+        return false;
+    }
+
+    TraceCacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.byte_order = CACHE_BYTE_ORDER;
+    header.token_count = columns.tokens.size();
+    header.entry_count = columns.timestamps.size();
+    header.string_count = columns.strings.count();
+    header.source_file_count = columns.source_files.size();
+    header.source_count = columns.source_names.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t position = sizeof(header);
+    auto writeSection = [&](Section section, const void* bytes, size_t size) {
+        static const char zeros[CACHE_ALIGNMENT] = {};
+        size_t padding = (CACHE_ALIGNMENT - position % CACHE_ALIGNMENT) % CACHE_ALIGNMENT;
+        file.write(zeros, static_cast<std::streamsize>(padding));
+        position += padding;
+
+        header.section_offsets[section] = position;
+        header.section_sizes[section] = size;
+        file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+        position += size;
+    };
+    auto writeColumn = [&](Section section, const auto& column) {
+        writeSection(section, column.data(), column.size() * sizeof(column[0]));
+    };
+
+    writeColumn(SECTION_SOURCE_FILES, columns.source_files);
+    writeColumn(SECTION_TOKENS, columns.tokens);
+    writeColumn(SECTION_ENTRY_TIMESTAMP, columns.timestamps);
+    writeColumn(SECTION_ENTRY_RELATIVE_MS, columns.relative_ms);
+    writeColumn(SECTION_ENTRY_ID, columns.entry_ids);
+    writeColumn(SECTION_ENTRY_TOKEN, columns.entry_tokens);
+    writeColumn(SECTION_ENTRY_LAYER, columns.layers);
+    writeColumn(SECTION_ENTRY_THREAD, columns.threads);
+    writeColumn(SECTION_ENTRY_OP, columns.ops);
+    writeColumn(SECTION_ENTRY_PHASE, columns.phases);
+    writeColumn(SECTION_ENTRY_NUM_SOURCES, columns.num_sources);
+    writeColumn(SECTION_ENTRY_NUM_EXPERTS, columns.num_experts);
+    writeColumn(SECTION_ENTRY_DST_NAME, columns.dst_names);
+    writeColumn(SECTION_ENTRY_SOURCES, columns.entry_sources);
+    writeColumn(SECTION_ENTRY_EXPERTS, columns.entry_experts);
+    writeColumn(SECTION_SOURCE_NAME, columns.source_names);
+    writeColumn(SECTION_SOURCE_PTR, columns.source_ptrs);
+    writeColumn(SECTION_SOURCE_SIZE, columns.source_sizes);
+    writeColumn(SECTION_SOURCE_LAYER, columns.source_layers);
+    writeColumn(SECTION_SOURCE_MEMORY, columns.source_memory);
+    writeColumn(SECTION_SOURCE_OFFSET, columns.source_offsets);
+    writeColumn(SECTION_STRING_OFFSETS, columns.strings.offsets());
+    writeColumn(SECTION_STRING_DATA, columns.strings.data());
+
+    // Patch section table
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if (!file) {
+        last_error_ = "Failed to write cache file: " + temp_path;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+    if (std::rename(temp_path.c_str(), filepath.c_str()) != 0) {
+        last_error_ = "Failed to rename cache file to: " + filepath;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+
+    std::cout << "✓ Wrote trace cache: " << filepath << " (" << (position / (1024.0 * 1024.0)) << " MB)" << std::endl;
+    return true;
+}
+
+bool TraceCache::open(const std::string& filepath, const std::vector<TraceSourceFile>& sources) {
+    close();
+
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        last_error_ = "No trace cache at: " + filepath;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TraceCacheHeader)) {
+        last_error_ = "Trace cache is truncated: " + filepath;
+        ::close(fd);
+        return false;
+    }
+
+    mapped_size_ = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (addr == MAP_FAILED) {
+        last_error_ = "Failed to mmap trace cache: " + filepath;
+        mapped_size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(addr);
+
+    if (!validate(sources)) {
+        close();
+        return false;
+    }
+
+    std::cout << "✓ Mapped trace cache: " << token_count_ << " tokens, " << entry_count_ << " entries" << std::endl;
+    return true;
+}
+
+void TraceCache::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), mapped_size_);
+    }
+    data_ = nullptr;
+    mapped_size_ = 0;
+    token_count_ = 0;
+    entry_count_ = 0;
+    string_count_ = 0;
+    source_count_ = 0;
+    string_ids_.clear();
+    source_ids_.clear();
+}
+
+bool TraceCache::validate(const std::vector<TraceSourceFile>& sources) {
+    const auto* header = reinterpret_cast<const TraceCacheHeader*>(data_);
+
+    if (std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header->byte_order != CACHE_BYTE_ORDER) {
+        last_error_ = "Not a trace cache file";
+        return false;
+    }
+    if (header->version != VERSION) {
+        last_error_ = "Trace cache version mismatch (found " + std::to_string(header->version) + ")";
+        return false;
+    }
+
+    // Each counted item takes at least a byte, so larger counts are corrupt
+    // (and could wrap the size products below)
+    if (header->token_count > mapped_size_ || header->entry_count > mapped_size_ ||
+        header->string_count > mapped_size_ || header->source_file_count > mapped_size_ ||
+        header->source_count > mapped_size_) {
+        last_error_ = "Trace cache is corrupt (counts)";
+        return false;
+    }
+    token_count_ = header->token_count;
+    entry_count_ = header->entry_count;
+    string_count_ = header->string_count;
+    source_count_ = header->source_count;
+
+    // Every section must lie inside the file and have the size its count implies
+    const size_t expected_sizes[SECTION_COUNT] = {
+        header->source_file_count * sizeof(CacheSourceFileRecord),
+        token_count_ * sizeof(CacheTokenRecord),
+        entry_count_ * sizeof(uint64_t),
+        entry_count_ * sizeof(float),
+        entry_count_ * sizeof(uint32_t),
+        entry_count_ * sizeof(uint32_t),
+        entry_count_ * sizeof(int16_t),
+        entry_count_ * sizeof(uint16_t),
+        entry_count_,
+        entry_count_,
+        entry_count_,
+        entry_count_,
+        entry_count_ * sizeof(uint32_t),
+        entry_count_ * sizeof(std::array<uint32_t, TRACE_MAX_SOURCES>),
+        entry_count_ * sizeof(std::array<uint8_t, TRACE_MAX_EXPERTS>),
+        source_count_ * sizeof(uint32_t),
+        source_count_ * sizeof(uint64_t),
+        source_count_ * sizeof(uint64_t),
+        source_count_ * sizeof(int16_t),
+        source_count_,
+        source_count_ * sizeof(uint64_t),
+        (string_count_ + 1) * sizeof(uint32_t),
+        header->section_sizes[SECTION_STRING_DATA],
+    };
+
+    for (uint32_t i = 0; i < SECTION_COUNT; i++) {
+        sections_[i].offset = header->section_offsets[i];
+        sections_[i].size_bytes = header->section_sizes[i];
+        if (sections_[i].size_bytes != expected_sizes[i] ||
+            sections_[i].offset % CACHE_ALIGNMENT != 0 ||
+            sections_[i].offset > mapped_size_ ||
+            sections_[i].size_bytes > mapped_size_ - sections_[i].offset) {
+            last_error_ = "Trace cache is corrupt (section " + std::to_string(i) + ")";
+            return false;
+        }
+    }
+
+    // Offsets index the string data directly, so check every one
+    if (!offsetsValid(column<uint32_t>(SECTION_STRING_OFFSETS), string_count_,
+                      sections_[SECTION_STRING_DATA].size_bytes)) {
+        last_error_ = "Trace cache is corrupt (string table)";
+        return false;
+    }
+    const CacheTokenRecord* tokens = column<CacheTokenRecord>(SECTION_TOKENS);
+    for (size_t i = 0; i < token_count_; i++) {
+        if (static_cast<size_t>(tokens[i].first_entry) + tokens[i].entry_count > entry_count_) {
+            last_error_ = "Trace cache is corrupt (token table)";
+            return false;
+        }
+    }
+    if (!validateEntries()) {
+        return false;
+    }
+
+    // Invalidate when any source file was added, removed or modified
+    const CacheSourceFileRecord* cached_sources = column<CacheSourceFileRecord>(SECTION_SOURCE_FILES);
+    if (header->source_file_count != sources.size()) {
+        last_error_ = "Trace cache is stale (source file count changed)";
+        return false;
+    }
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (cached_sources[i].path_string >= string_count_ ||
+            getString(cached_sources[i].path_string) != sources[i].path ||
+            cached_sources[i].size_bytes != sources[i].size_bytes ||
+            cached_sources[i].mtime_ns != sources[i].mtime_ns) {
+            last_error_ = "Trace cache is stale (" + sources[i].path + " changed)";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TraceCache::validateEntries() {
+    // Attached stores index these columns without checks, so every id must be in range
+    const uint8_t* num_sources = column<uint8_t>(SECTION_ENTRY_NUM_SOURCES);
+    const uint8_t* num_experts = column<uint8_t>(SECTION_ENTRY_NUM_EXPERTS);
+    const uint32_t* dst_names = column<uint32_t>(SECTION_ENTRY_DST_NAME);
+    const auto* entry_sources = column<std::array<uint32_t, TRACE_MAX_SOURCES>>(SECTION_ENTRY_SOURCES);
+    for (size_t i = 0; i < entry_count_; i++) {
+        bool ok = num_sources[i] <= TRACE_MAX_SOURCES && num_experts[i] <= TRACE_MAX_EXPERTS &&
+                  dst_names[i] < string_count_;
+        for (size_t s = 0; ok && s < TRACE_MAX_SOURCES; s++) {
+            uint32_t id = entry_sources[i][s];
+            ok = s < num_sources[i] ? id < source_count_ : id == TraceSymbols::NO_ID;
+        }
+        if (!ok) {
+            last_error_ = "Trace cache is corrupt (entry " + std::to_string(i) + ")";
+            return false;
+        }
+    }
+
+    const uint32_t* source_names = column<uint32_t>(SECTION_SOURCE_NAME);
+    for (size_t k = 0; k < source_count_; k++) {
+        if (source_names[k] >= string_count_) {
+            last_error_ = "Trace cache is corrupt (source table)";
+            return false;
+        }
+    }
+    return true;
+}
+
+void TraceCache::internSymbols(TraceSymbols& symbols) {
+    string_ids_.assign(string_count_, TraceSymbols::NO_ID);
+    auto intern = [&](uint32_t cache_id) {
+        if (string_ids_[cache_id] == TraceSymbols::NO_ID) {
+            string_ids_[cache_id] = symbols.internString(getStringView(cache_id));
+        }
+        return string_ids_[cache_id];
+    };
+
+    const uint32_t* source_names = column<uint32_t>(SECTION_SOURCE_NAME);
+    const uint64_t* source_ptrs = column<uint64_t>(SECTION_SOURCE_PTR);
+    const uint64_t* source_sizes = column<uint64_t>(SECTION_SOURCE_SIZE);
+    const int16_t* source_layers = column<int16_t>(SECTION_SOURCE_LAYER);
+    const uint8_t* source_memory = column<uint8_t>(SECTION_SOURCE_MEMORY);
+    const uint64_t* source_offsets = column<uint64_t>(SECTION_SOURCE_OFFSET);
+    source_ids_.resize(source_count_);
+    for (size_t k = 0; k < source_count_; k++) {
+        TraceSourceInfo info{};
+        info.tensor_ptr = source_ptrs[k];
+        info.size_bytes = source_sizes[k];
+        info.name_id = intern(source_names[k]);
+        info.layer_id = source_layers[k];
+        info.memory_source = source_memory[k] <= CACHE_MEMORY_OTHER
+            ? static_cast<MemorySource>(source_memory[k]) : MemorySource::Other;
+        info.offset = info.memory_source == MemorySource::Other ? 0 : source_offsets[k];
+        source_ids_[k] = symbols.internSource(info);
+    }
+
+    // Destination names are few and repeat across tokens
+    const uint32_t* dst_names = column<uint32_t>(SECTION_ENTRY_DST_NAME);
+    for (size_t i = 0; i < entry_count_; i++) {
+        intern(dst_names[i]);
+    }
+}
+
+std::string TraceCache::getString(uint32_t id) const {
+    return std::string(getStringView(id));
+}
+
+std::string_view TraceCache::getStringView(uint32_t id) const {
+    if (id >= string_count_) {
+        return std::string_view();
+    }
+    const uint32_t* offsets = column<uint32_t>(SECTION_STRING_OFFSETS);
+    const char* chars = column<char>(SECTION_STRING_DATA);
+    return std::string_view(chars + offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+void TraceCache::attachTraceData(size_t token_index, TraceData& out_data) const {
+    out_data.clear();
+    if (!data_ || token_index >= token_count_) {
+        return;
+    }
+
+    const CacheTokenRecord& token = column<CacheTokenRecord>(SECTION_TOKENS)[token_index];
+    out_data.metadata.total_entries = token.total_entries;
+    out_data.metadata.duration_ms = token.duration_ms;
+    out_data.metadata.timestamp_start_ns = token.timestamp_start_ns;
+    out_data.metadata.format_version = getString(token.format_version_string);
+
+    const size_t first = token.first_entry;
+    TraceColumns columns;
+    columns.count = token.entry_count;
+    columns.timestamps = column<uint64_t>(SECTION_ENTRY_TIMESTAMP) + first;
+    columns.relative_ms = column<float>(SECTION_ENTRY_RELATIVE_MS) + first;
+    columns.entry_ids = column<uint32_t>(SECTION_ENTRY_ID) + first;
+    columns.layers = column<int16_t>(SECTION_ENTRY_LAYER) + first;
+    columns.threads = column<uint16_t>(SECTION_ENTRY_THREAD) + first;
+    columns.ops = column<uint8_t>(SECTION_ENTRY_OP) + first;
+    columns.phases = column<TracePhase>(SECTION_ENTRY_PHASE) + first;
+    columns.num_sources = column<uint8_t>(SECTION_ENTRY_NUM_SOURCES) + first;
+    columns.num_experts = column<uint8_t>(SECTION_ENTRY_NUM_EXPERTS) + first;
+    columns.dst_names = column<uint32_t>(SECTION_ENTRY_DST_NAME) + first;
+    columns.sources = column<std::array<uint32_t, TRACE_MAX_SOURCES>>(SECTION_ENTRY_SOURCES) + first;
+    columns.experts = column<std::array<uint8_t, TRACE_MAX_EXPERTS>>(SECTION_ENTRY_EXPERTS) + first;
+    columns.string_ids = string_ids_.data();
+    columns.source_ids = source_ids_.data();
+
+    TraceStore& store = out_data.entries;
+    store.attach(columns);
+    store.setTokenId(token.token_id);
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "TraceData.h"
+#include "TraceFile.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Identity of one input file the cache was built from (for invalidation)
+struct TraceSourceFile {
+    std::string path;       // Relative to the domain directory
+    uint64_t size_bytes;
+    int64_t mtime_ns;
+};
+
+// Persistent columnar cache of a domain's traces (<domain>/.ttcache)
+//
+// Written once after the first successful load, then memory-mapped on later
+// launches. Entry columns have exactly TraceStore's layout, so tokens attach
+// to the mapping instead of copying it and windows opened on the same domain
+// share its pages. Names and source tensors are cache-local ids into a string
+// table and a table of distinct sources; internSymbols() translates them to
+// the workspace's TraceSymbols once per open. The cache is rejected if the
+// version differs, any id or offset is out of range, or any source file
+// changed size or mtime.
+class TraceCache {
+public:
+    static constexpr uint32_t VERSION = 2;
+
+    TraceCache();
+    ~TraceCache();
+
+    TraceCache(const TraceCache&) = delete;
+    TraceCache& operator=(const TraceCache&) = delete;
+
+    static std::string getCachePath(const std::string& domain_path);
+
+    // Stat a source file relative to domain_path
+    // Returns true on success, false if the file does not exist
+    static bool statSourceFile(const std::string& domain_path, const std::string& relative_path, TraceSourceFile& out);
+
+    // Write tokens to filepath (atomically via rename)
+    // Returns true on success, false on failure
+    bool write(const std::string& filepath, const std::vector<TraceSourceFile>& sources,
+               const std::vector<TraceData>& tokens);
+
+    // Write every token of a mapped binary trace, decoded straight into the
+    // columns (no TraceData in between)
+    bool write(const std::string& filepath, const std::vector<TraceSourceFile>& sources, const TraceFile& trace);
+
+    // Map and validate filepath against the current source files
+    // Returns true if the cache is usable, false if missing, stale or corrupt
+    bool open(const std::string& filepath, const std::vector<TraceSourceFile>& sources);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    size_t getTokenCount() const { return token_count_; }
+    size_t getEntryCount() const { return entry_count_; }
+
+    // Intern the cache's names and sources into symbols (once, after open())
+    void internSymbols(TraceSymbols& symbols);
+
+    // Point one cached token's TraceStore at the mapped columns
+    // (out_data must use the symbols given to internSymbols; valid until close())
+    void attachTraceData(size_t token_index, TraceData& out_data) const;
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    // Section ids (each section is one column)
+    enum Section : uint32_t {
+        SECTION_SOURCE_FILES = 0,
+        SECTION_TOKENS,
+        SECTION_ENTRY_TIMESTAMP,
+        SECTION_ENTRY_RELATIVE_MS,
+        SECTION_ENTRY_ID,
+        SECTION_ENTRY_TOKEN,
+        SECTION_ENTRY_LAYER,
+        SECTION_ENTRY_THREAD,
+        SECTION_ENTRY_OP,
+        SECTION_ENTRY_PHASE,
+        SECTION_ENTRY_NUM_SOURCES,
+        SECTION_ENTRY_NUM_EXPERTS,
+        SECTION_ENTRY_DST_NAME,
+        SECTION_ENTRY_SOURCES,
+        SECTION_ENTRY_EXPERTS,
+        SECTION_SOURCE_NAME,
+        SECTION_SOURCE_PTR,
+        SECTION_SOURCE_SIZE,
+        SECTION_SOURCE_LAYER,
+        SECTION_SOURCE_MEMORY,
+        SECTION_SOURCE_OFFSET,
+        SECTION_STRING_OFFSETS,
+        SECTION_STRING_DATA,
+        SECTION_COUNT
+    };
+
+    struct SectionInfo {
+        uint64_t offset;
+        uint64_t size_bytes;
+    };
+
+    // Columns of a cache being written (defined in TraceCache.cpp)
+    struct Columns;
+
+    const uint8_t* data_;
+    size_t mapped_size_;
+    size_t token_count_;
+    size_t entry_count_;
+    size_t string_count_;
+    size_t source_count_;
+    SectionInfo sections_[SECTION_COUNT];
+    std::vector<uint32_t> string_ids_;   // Cache string id -> TraceSymbols id
+    std::vector<uint32_t> source_ids_;   // Cache source id -> TraceSymbols id
+    std::string last_error_;
+
+    template <typename T>
+    const T* column(Section section) const {
+        return reinterpret_cast<const T*>(data_ + sections_[section].offset);
+    }
+
+    std::string getString(uint32_t id) const;
+    std::string_view getStringView(uint32_t id) const;
+    bool validate(const std::vector<TraceSourceFile>& sources);
+    bool validateEntries();
+    bool writeColumns(const std::string& filepath, const Columns& columns);
+};
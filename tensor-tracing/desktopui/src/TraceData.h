@@ -1,9 +1,12 @@
 #pragma once
 
+#include "TraceStore.h"
 #include <string>
 #include <vector>
 #include <cstdint>
 
+// Loader-side row types: one decoded entry before it is interned into a TraceStore
+
 // Represents a source tensor in a trace entry
 struct TraceSource {
     std::string name;
@@ -30,24 +33,6 @@ struct TraceEntry {
     std::vector<TraceSource> sources;
     std::vector<int32_t> expert_ids;
     uint8_t num_experts;
-
-    // Helper methods
-    bool isDiskAccess() const {
-        for (const auto& src : sources) {
-            if (src.memory_source == "DISK") {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    uint64_t getTotalInputSize() const {
-        uint64_t total = 0;
-        for (const auto& src : sources) {
-            total += src.size_bytes;
-        }
-        return total;
-    }
 };
 
 // Metadata about the trace
@@ -58,42 +43,49 @@ struct TraceMetadata {
     std::string format_version;
 };
 
-// Complete trace data
+// Complete trace data for one token
 struct TraceData {
     TraceMetadata metadata;
-    std::vector<TraceEntry> entries;
+    TraceStore entries;
 
     // Helper methods
     size_t getEntryCount() const { return entries.size(); }
 
-    // Get entries by layer
-    std::vector<const TraceEntry*> getEntriesByLayer(int layer_id) const {
-        std::vector<const TraceEntry*> result;
-        for (const auto& entry : entries) {
-            if (entry.layer_id == layer_id) {
-                result.push_back(&entry);
+    // Reset for reloading (keeps the shared symbol table)
+    void clear() {
+        metadata = TraceMetadata();
+        entries.clear();
+    }
+
+    // Get indices of entries in a layer
+    std::vector<uint32_t> getEntriesByLayer(int layer_id) const {
+        std::vector<uint32_t> result;
+        const int16_t* layers = entries.layerColumn();
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (layers[i] == layer_id) {
+                result.push_back(static_cast<uint32_t>(i));
             }
         }
         return result;
     }
 
-    // Get disk access entries only
-    std::vector<const TraceEntry*> getDiskAccessEntries() const {
-        std::vector<const TraceEntry*> result;
-        for (const auto& entry : entries) {
-            if (entry.isDiskAccess()) {
-                result.push_back(&entry);
+    // Get indices of disk access entries only
+    std::vector<uint32_t> getDiskAccessEntries() const {
+        std::vector<uint32_t> result;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries.isDiskAccess(i)) {
+                result.push_back(static_cast<uint32_t>(i));
             }
         }
         return result;
     }
 
-    // Get entries with expert IDs
-    std::vector<const TraceEntry*> getExpertEntries() const {
-        std::vector<const TraceEntry*> result;
-        for (const auto& entry : entries) {
-            if (!entry.expert_ids.empty()) {
-                result.push_back(&entry);
+    // Get indices of entries with expert IDs
+    std::vector<uint32_t> getExpertEntries() const {
+        std::vector<uint32_t> result;
+        for (size_t i = 0; i < entries.size(); i++) {
+            if (entries.numExperts(i) > 0) {
+                result.push_back(static_cast<uint32_t>(i));
             }
         }
         return result;
@@ -0,0 +1,133 @@
+#include "TraceFile.h"
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TraceFile::TraceFile()
+    : data_(nullptr)
+    , mapped_size_(0)
+    , entry_count_(0)
+{
+}
+
+TraceFile::~TraceFile() {
+    close();
+}
+
+bool TraceFile::open(const std::string& filepath) {
+    close();
+
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        last_error_ = "Failed to open file: " + filepath;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        last_error_ = "Failed to stat file: " + filepath;
+        ::close(fd);
+        return false;
+    }
+
+    size_t record_count = static_cast<size_t>(st.st_size) / TRACE_ENTRY_SIZE;
+    if (record_count == 0) {
+        last_error_ = "Trace file is empty: " + filepath;
+        ::close(fd);
+        return false;
+    }
+
+    mapped_size_ = record_count * TRACE_ENTRY_SIZE;
+    void* addr = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // Mapping keeps its own reference
+
+    if (addr == MAP_FAILED) {
+        last_error_ = "Failed to mmap file: " + filepath;
+        mapped_size_ = 0;
+        return false;
+    }
+
+    // Token indexing walks the file front to back
+    madvise(addr, mapped_size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const TensorAccessLog*>(addr);
+
+    // The tracer pre-allocates the file: first zero timestamp marks the end
+    entry_count_ = 0;
+    while (entry_count_ < record_count && data_[entry_count_].timestamp_ns != 0) {
+        entry_count_++;
+    }
+
+    indexTokenRanges();
+
+    // Views are random access from here on
+    madvise(addr, mapped_size_, MADV_NORMAL);
+
+    std::cout << "✓ Mapped trace file: " << entry_count_ << " entries" << std::endl;
+    std::cout << "  Tokens: " << token_ranges_.size() << std::endl;
+
+    return true;
+}
+
+void TraceFile::close() {
+    if (data_) {
+        munmap(const_cast<TensorAccessLog*>(data_), mapped_size_);
+    }
+    data_ = nullptr;
+    mapped_size_ = 0;
+    entry_count_ = 0;
+    token_ranges_.clear();
+}
+
+void TraceFile::indexTokenRanges() {
+    token_ranges_.clear();
+
+    for (size_t i = 0; i < entry_count_; i++) {
+        uint32_t token_id = data_[i].token_id;
+        if (token_ranges_.empty() || token_ranges_.back().token_id != token_id) {
+            token_ranges_.push_back({token_id, i, 0});
+        }
+        token_ranges_.back().entry_count++;
+    }
+}
+
+void TraceFile::buildTraceData(const TraceTokenRange& range, TraceData& out_data) const {
+    out_data.clear();
+    if (!data_ || range.entry_count == 0) {
+        return;
+    }
+    buildMetadata(range, out_data.metadata);
+
+    // Records are interned straight from the mapping (no per-entry strings)
+    TraceStore& store = out_data.entries;
+    TraceSymbols& symbols = store.symbols();
+    store.reserve(range.entry_count);
+    store.setTokenId(range.token_id);
+
+    auto internString = [&symbols](std::string_view str) { return symbols.internString(str); };
+    auto internSource = [&symbols](const TraceSourceInfo& info) { return symbols.internSource(info); };
+    TraceRecord record;
+    for (size_t i = 0; i < range.entry_count; i++) {
+        decodeRecord(range, i, out_data.metadata.timestamp_start_ns, internString, internSource, record);
+        store.append(record);
+    }
+}
+
+void TraceFile::buildMetadata(const TraceTokenRange& range, TraceMetadata& out_metadata) const {
+    uint64_t ts_min = UINT64_MAX;
+    uint64_t ts_max = 0;
+    for (size_t i = 0; i < range.entry_count; i++) {
+        uint64_t ts = data_[range.first_entry + i].timestamp_ns;
+        ts_min = std::min(ts_min, ts);
+        ts_max = std::max(ts_max, ts);
+    }
+
+    out_metadata.total_entries = static_cast<uint32_t>(range.entry_count);
+    out_metadata.duration_ms = (ts_max - ts_min) / 1e6;
+    out_metadata.timestamp_start_ns = ts_min;
+    out_metadata.format_version = "1024-byte";
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "TraceFormat.h"
+#include "TraceData.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+
+// Zero-copy view of one SourceTensorInfo inside a mapped trace file
+class TraceSourceView {
+public:
+    explicit TraceSourceView(const SourceTensorInfo* info) : info_(info) {}
+
+    std::string_view name() const { return std::string_view(info_->name, strnlen(info_->name, TRACE_NAME_SIZE)); }
+    uint64_t tensorPtr() const { return info_->tensor_ptr; }
+    uint64_t sizeBytes() const { return info_->size_bytes; }
+    int layerId() const { return info_->layer_id == TRACE_NO_LAYER ? -1 : info_->layer_id; }
+    bool isDisk() const { return info_->memory_source == 0; }
+    const char* memorySource() const { return isDisk() ? "DISK" : "BUFFER"; }
+    uint64_t diskOffset() const { return isDisk() ? info_->disk_offset_or_buffer_id : 0; }
+    uint64_t bufferId() const { return isDisk() ? 0 : info_->disk_offset_or_buffer_id; }
+
+private:
+    const SourceTensorInfo* info_;
+};
+
+// Zero-copy view of one TensorAccessLog inside a mapped trace file
+class TraceEntryView {
+public:
+    explicit TraceEntryView(const TensorAccessLog* log) : log_(log) {}
+
+    uint64_t timestampNs() const { return log_->timestamp_ns; }
+    uint32_t tokenId() const { return log_->token_id; }
+    int layerId() const { return log_->layer_id == TRACE_NO_LAYER ? -1 : log_->layer_id; }
+    uint16_t threadId() const { return log_->thread_id; }
+    uint8_t opCode() const { return log_->operation_type; }
+    const char* operationType() const { return ggmlOpName(log_->operation_type); }
+    uint8_t phaseCode() const { return log_->phase; }
+    const char* phase() const { return log_->phase == 0 ? "PROMPT" : "GENERATE"; }
+    std::string_view dstName() const { return std::string_view(log_->dst_name, strnlen(log_->dst_name, TRACE_NAME_SIZE)); }
+
+    // Clamped to the fixed-size arrays so corrupt records can't read out of bounds
+    uint8_t numSources() const { return log_->num_sources < TRACE_MAX_SOURCES ? log_->num_sources : TRACE_MAX_SOURCES; }
+    TraceSourceView source(size_t i) const { return TraceSourceView(&log_->sources[i]); }
+
+    uint8_t numExperts() const { return log_->num_experts < TRACE_MAX_EXPERTS ? log_->num_experts : TRACE_MAX_EXPERTS; }
+    const int32_t* expertIds() const { return log_->expert_ids; }
+
+    const TensorAccessLog* raw() const { return log_; }
+
+private:
+    const TensorAccessLog* log_;
+};
+
+// Contiguous run of entries belonging to one token
+struct TraceTokenRange {
+    uint32_t token_id;
+    size_t first_entry;
+    size_t entry_count;
+};
+
+// Memory-mapped reader for the raw 1024-byte tensor_trace.bin
+// Records are never copied: views point straight into the mapping.
+class TraceFile {
+public:
+    TraceFile();
+    ~TraceFile();
+
+    TraceFile(const TraceFile&) = delete;
+    TraceFile& operator=(const TraceFile&) = delete;
+
+    // Map file and index token ranges
+    // Returns true on success, false on failure
+    bool open(const std::string& filepath);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    size_t getEntryCount() const { return entry_count_; }
+    TraceEntryView getEntry(size_t index) const { return TraceEntryView(&data_[index]); }
+
+    // One range per token, in file order
+    const std::vector<TraceTokenRange>& getTokenRanges() const { return token_ranges_; }
+
+    // Materialize one token range as TraceData (same fields parse_trace.py --export-json writes)
+    void buildTraceData(const TraceTokenRange& range, TraceData& out_data) const;
+
+    // Metadata of one token range (as parse_trace.py export_to_json_per_token computes it)
+    void buildMetadata(const TraceTokenRange& range, TraceMetadata& out_metadata) const;
+
+    // Decode entry i of a range straight from the mapping. Names go through
+    // intern_string(std::string_view) and sources through
+    // intern_source(const TraceSourceInfo&) with name_id already interned, so
+    // callers pick their own id space.
+    template <typename InternString, typename InternSource>
+    void decodeRecord(const TraceTokenRange& range, size_t i, uint64_t timestamp_start_ns,
+                      InternString&& intern_string, InternSource&& intern_source, TraceRecord& out) const;
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    const TensorAccessLog* data_;
+    size_t mapped_size_;
+    size_t entry_count_;
+    std::vector<TraceTokenRange> token_ranges_;
+    std::string last_error_;
+
+    void indexTokenRanges();
+};
+
+template <typename InternString, typename InternSource>
+void TraceFile::decodeRecord(const TraceTokenRange& range, size_t i, uint64_t timestamp_start_ns,
+                             InternString&& intern_string, InternSource&& intern_source, TraceRecord& out) const {
+    TraceEntryView view = getEntry(range.first_entry + i);
+
+    out = TraceRecord{};
+    out.timestamp_ns = view.timestampNs();
+    out.relative_ms = static_cast<float>((view.timestampNs() - timestamp_start_ns) / 1e6);
+    out.entry_id = static_cast<uint32_t>(i);
+    out.layer_id = static_cast<int16_t>(view.layerId());
+    out.thread_id = view.threadId();
+    out.op = view.opCode();
+    out.phase = view.phaseCode() == 0 ? TracePhase::Prompt : TracePhase::Generate;
+    out.dst_name = intern_string(view.dstName());
+
+    out.num_sources = view.numSources();
+    out.sources.fill(TraceSymbols::NO_ID);
+    for (size_t s = 0; s < view.numSources(); s++) {
+        TraceSourceView src_view = view.source(s);
+
+        TraceSourceInfo info{};
+        info.tensor_ptr = src_view.tensorPtr();
+        info.offset = src_view.isDisk() ? src_view.diskOffset() : src_view.bufferId();
+        info.size_bytes = src_view.sizeBytes();
+        info.name_id = intern_string(src_view.name());
+        info.layer_id = static_cast<int16_t>(src_view.layerId());
+        info.memory_source = src_view.isDisk() ? MemorySource::Disk : MemorySource::Buffer;
+        out.sources[s] = intern_source(info);
+    }
+
+    out.num_experts = view.numExperts();
+    out.expert_ids.fill(TRACE_NO_EXPERT);
+    for (size_t e = 0; e < view.numExperts(); e++) {
+        out.expert_ids[e] = toStoredExpertId(view.expertIds()[e]);
+    }
+}
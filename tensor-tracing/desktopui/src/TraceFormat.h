@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+// Binary layout of /tmp/tensor_trace.bin (1024-byte format with 128-byte names)
+// Must match TensorAccessLog in the llama.cpp tracer and
+// METADATA_FORMAT / SOURCE_FORMAT in tools/parse_trace.py
+
+constexpr size_t TRACE_ENTRY_SIZE = 1024;
+constexpr size_t TRACE_SOURCE_SIZE = 160;
+constexpr size_t TRACE_NAME_SIZE = 128;
+constexpr size_t TRACE_MAX_SOURCES = 4;
+constexpr size_t TRACE_MAX_EXPERTS = 16;
+
+constexpr uint16_t TRACE_NO_LAYER = 65535;          // layer_id sentinel for "null"
+constexpr uint32_t TRACE_NO_TENSOR_IDX = 0xFFFFFFFF; // tensor_idx sentinel for "null"
+
+#pragma pack(push, 1)
+
+// SourceTensorInfo: 160 bytes ('<128sQIHBBQI4s')
+struct SourceTensorInfo {
+    char name[TRACE_NAME_SIZE];
+    uint64_t tensor_ptr;
+    uint32_t size_bytes;
+    uint16_t layer_id;                  // TRACE_NO_LAYER for null
+    uint8_t memory_source;              // 0 = DISK, 1 = BUFFER
+    uint8_t pad1;
+    uint64_t disk_offset_or_buffer_id;
+    uint32_t tensor_idx;                // TRACE_NO_TENSOR_IDX for null
+    uint8_t pad2[4];
+};
+
+// TensorAccessLog: 1024 bytes
+// - Metadata: 24 bytes ('<QIHHBBB5s')
+// - Destination name: 128 bytes
+// - Sources: 640 bytes (4 x 160 bytes)
+// - Expert IDs: 64 bytes (16 x int32)
+// - num_experts: 1 byte
+// - Padding: 167 bytes
+struct TensorAccessLog {
+    uint64_t timestamp_ns;              // 0 marks an empty (unused) record
+    uint32_t token_id;
+    uint16_t layer_id;                  // TRACE_NO_LAYER for null
+    uint16_t thread_id;
+    uint8_t operation_type;             // ggml_op enum
+    uint8_t phase;                      // 0 = PROMPT, 1 = GENERATE
+    uint8_t num_sources;
+    uint8_t padding[5];
+    char dst_name[TRACE_NAME_SIZE];
+    SourceTensorInfo sources[TRACE_MAX_SOURCES];
+    int32_t expert_ids[TRACE_MAX_EXPERTS];
+    uint8_t num_experts;
+    uint8_t padding2[167];
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(SourceTensorInfo) == TRACE_SOURCE_SIZE, "SourceTensorInfo must be 160 bytes");
+static_assert(sizeof(TensorAccessLog) == TRACE_ENTRY_SIZE, "TensorAccessLog must be 1024 bytes");
+
+// Operation type names (ggml_op enum)
+// IMPORTANT: Must match OPERATION_TYPES in tools/parse_trace.py (same order as ggml.h)
+constexpr const char* GGML_OP_NAMES[] = {
+    "NONE", "DUP", "ADD", "ADD_ID", "ADD1", "ACC", "SUB", "MUL", "DIV", "SQR",
+    "SQRT", "LOG", "SIN", "COS", "SUM", "SUM_ROWS", "CUMSUM", "MEAN", "ARGMAX", "COUNT_EQUAL",
+    "REPEAT", "REPEAT_BACK", "CONCAT", "SILU_BACK", "NORM", "RMS_NORM", "RMS_NORM_BACK", "GROUP_NORM", "L2_NORM", "MUL_MAT",
+    "MUL_MAT_ID", "OUT_PROD", "SCALE", "SET", "CPY", "CONT", "RESHAPE", "VIEW", "PERMUTE", "TRANSPOSE",
+    "GET_ROWS", "GET_ROWS_BACK", "SET_ROWS", "DIAG", "DIAG_MASK_INF", "DIAG_MASK_ZERO", "SOFT_MAX", "SOFT_MAX_BACK", "ROPE", "ROPE_BACK",
+    "CLAMP", "CONV_TRANSPOSE_1D", "IM2COL", "IM2COL_BACK", "IM2COL_3D", "CONV_2D", "CONV_3D", "CONV_2D_DW", "CONV_TRANSPOSE_2D", "POOL_1D",
+    "POOL_2D", "POOL_2D_BACK", "UPSCALE", "PAD", "PAD_REFLECT_1D", "ROLL", "ARANGE", "TIMESTEP_EMBEDDING", "ARGSORT", "TOP_K",
+    "LEAKY_RELU", "TRI", "FILL", "FLASH_ATTN_EXT", "FLASH_ATTN_BACK", "SSM_CONV", "SSM_SCAN", "WIN_PART", "WIN_UNPART", "GET_REL_POS",
+    "ADD_REL_POS", "RWKV_WKV6", "GATED_LINEAR_ATTN", "RWKV_WKV7", "SOLVE_TRI", "UNARY", "MAP_CUSTOM1", "MAP_CUSTOM2", "MAP_CUSTOM3", "CUSTOM",
+    "CROSS_ENTROPY_LOSS", "CROSS_ENTROPY_LOSS_BACK", "OPT_STEP_ADAMW", "OPT_STEP_SGD", "GLU",
+};
+
+constexpr size_t GGML_OP_COUNT = sizeof(GGML_OP_NAMES) / sizeof(GGML_OP_NAMES[0]);
+
+// Returns "UNKNOWN" for ops newer than the table above
+inline const char* ggmlOpName(uint8_t op) {
+    return op < GGML_OP_COUNT ? GGML_OP_NAMES[op] : "UNKNOWN";
+}
+
+constexpr uint8_t GGML_OP_UNKNOWN = 255;
+
+// Reverse lookup for traces that carry op names (JSON export)
+inline uint8_t ggmlOpFromName(std::string_view name) {
+    static const std::unordered_map<std::string_view, uint8_t> ops = [] {
+        std::unordered_map<std::string_view, uint8_t> table;
+        for (size_t i = 0; i < GGML_OP_COUNT; i++) {
+            table.emplace(GGML_OP_NAMES[i], static_cast<uint8_t>(i));
+        }
+        return table;
+    }();
+    auto it = ops.find(name);
+    return it != ops.end() ? it->second : GGML_OP_UNKNOWN;
+}
@@ -0,0 +1,473 @@
+#include "TraceReplay.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint64_t DIRECT_ALIGNMENT = 4096;
+constexpr uint64_t TOUCH_STRIDE = 4096;
+constexpr int64_t PACING_POLL_NS = 50000;   // Longest nap while a paced access is not yet due
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void sleepUntilNs(int64_t deadline_ns) {
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline_ns)));
+}
+
+// Nearest-rank percentile of an unsorted sample (reorders it)
+double percentile(std::vector<float>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+    size_t index = std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void summarize(std::vector<float>& latencies_us, ReplayCategoryStats& out) {
+    out.requests = latencies_us.size();
+    if (latencies_us.empty()) {
+        return;
+    }
+    double sum = 0.0;
+    for (float latency : latencies_us) {
+        sum += latency;
+        out.max_us = std::max(out.max_us, static_cast<double>(latency));
+    }
+    out.mean_us = sum / latencies_us.size();
+    out.p50_us = percentile(latencies_us, 0.50);
+    out.p99_us = percentile(latencies_us, 0.99);
+}
+}
+
+const char* replayModeName(ReplayMode mode) {
+    switch (mode) {
+        case ReplayMode::Buffered: return "buffered";
+        case ReplayMode::Direct: return "direct";
+        case ReplayMode::MmapTouch: return "mmap";
+    }
+    return "";
+}
+
+bool replayModeFromName(const std::string& name, ReplayMode& out_mode) {
+    for (size_t i = 0; i < REPLAY_MODE_COUNT; i++) {
+        ReplayMode mode = static_cast<ReplayMode>(i);
+        if (name == replayModeName(mode)) {
+            out_mode = mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+TraceReplay::TraceReplay()
+    : fd_(-1)
+    , mapping_(nullptr)
+    , file_size_(0)
+    , buffers_(nullptr)
+    , buffer_stride_(0)
+{
+}
+
+TraceReplay::~TraceReplay() {
+    closeFile();
+}
+
+bool TraceReplay::openFile(const std::string& file_path, const ReplayConfig& config) {
+    int flags = O_RDONLY;
+    if (config.mode == ReplayMode::Direct) {
+#ifdef O_DIRECT
+        flags |= O_DIRECT;
+#else
+        last_error_ = "O_DIRECT is not supported on this platform";
+        return false;
+#endif
+    }
+    fd_ = ::open(file_path.c_str(), flags);
+    if (fd_ < 0) {
+        last_error_ = "Failed to open " + file_path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        last_error_ = "Failed to stat " + file_path + ": " + std::strerror(errno);
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(st.st_size);
+
+    if (config.drop_cache) {
+        // Dirty pages (a freshly written image) are not dropped, so flush first
+        fsync(fd_);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    }
+
+    if (config.mode == ReplayMode::MmapTouch) {
+        void* mapping = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            last_error_ = "Failed to map " + file_path + ": " + std::strerror(errno);
+            return false;
+        }
+        mapping_ = static_cast<uint8_t*>(mapping);
+        return true;
+    }
+
+    buffer_stride_ = static_cast<size_t>(config.request_bytes);
+    void* memory = nullptr;
+    if (posix_memalign(&memory, DIRECT_ALIGNMENT, buffer_stride_ * config.queue_depth) != 0) {
+        last_error_ = "Failed to allocate read buffers";
+        return false;
+    }
+    buffers_ = static_cast<uint8_t*>(memory);
+    return true;
+}
+
+void TraceReplay::closeFile() {
+    if (mapping_) {
+        munmap(mapping_, file_size_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    std::free(buffers_);
+    buffers_ = nullptr;
+    buffer_stride_ = 0;
+}
+
+bool TraceReplay::run(const DomainLoader& loader, const std::string& file_path, const ReplayConfig& input_config,
+                      ReplayResult& out) {
+    out = ReplayResult();
+    closeFile();
+    if (!loader.isMemoryMapReady()) {
+        last_error_ = "No memory map";
+        return false;
+    }
+
+    ReplayConfig config = input_config;
+    config.queue_depth = std::max<uint32_t>(config.queue_depth, 1);
+    config.request_bytes = std::max<uint64_t>(config.request_bytes, DIRECT_ALIGNMENT);
+    if (config.mode == ReplayMode::Direct) {
+        config.request_bytes = (config.request_bytes + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+    }
+    if (config.speed <= 0.0) {
+        config.speed = 1.0;
+    }
+    if (!openFile(file_path, config)) {
+        closeFile();
+        return false;
+    }
+
+    IoRing ring;
+    std::unique_ptr<ThreadPool> readers;
+    if (config.mode == ReplayMode::MmapTouch) {
+        out.engine = "mmap";
+    } else if (config.io_uring && ring.init(config.queue_depth)) {
+        out.engine = "io_uring";
+    } else {
+        if (config.io_uring) {
+            out.fallback_reason = ring.getLastError();
+        }
+        out.engine = "pread";
+        readers = std::make_unique<ThreadPool>(config.queue_depth);
+    }
+
+    // Category slot per tensor
+    const MemoryMap& map = loader.getMemoryMap();
+    std::map<std::string, uint16_t> category_slots;
+    for (const MemoryTensor& tensor : map.tensors) {
+        category_slots.emplace(tensor.category, 0);
+    }
+    uint16_t slot = 0;
+    for (auto& entry : category_slots) {
+        entry.second = slot++;
+        ReplayCategoryStats stats;
+        stats.category = entry.first;
+        out.categories.push_back(stats);
+    }
+    std::vector<uint16_t> tensor_category(map.tensors.size());
+    for (size_t t = 0; t < map.tensors.size(); t++) {
+        tensor_category[t] = category_slots[map.tensors[t].category];
+    }
+    std::vector<std::vector<float>> latencies(out.categories.size());
+    std::vector<float> all_latencies;
+
+    size_t token_count = loader.getTokenCount();
+    if (config.max_tokens > 0) {
+        token_count = std::min(token_count, config.max_tokens);
+    }
+
+    const int64_t start_ns = nowNs();
+    bool have_base = false;
+    uint64_t base_timestamp = 0;
+    std::vector<Request> requests;
+    std::vector<Completion> completions;
+    bool ok = true;
+    for (size_t t = 0; t < token_count && ok; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        const TraceStore& store = loader.getToken(t).entries;
+        if (!store.hasAccesses()) {
+            continue;
+        }
+
+        ReplayTokenStats token_stats;
+        token_stats.token_id = store.tokenId();
+        requests.clear();
+        for (size_t i = 0; i < store.size() && ok; i++) {
+            const size_t count = store.accessCount(i);
+            if (count == 0) {
+                continue;
+            }
+            if (!have_base) {
+                base_timestamp = store.timestampNs(i);
+                have_base = true;
+            }
+            const int64_t due_ns = config.paced
+                ? static_cast<int64_t>((static_cast<int64_t>(store.timestampNs(i) - base_timestamp)) / config.speed)
+                : 0;
+            const uint32_t* accesses = store.accesses(i);
+            for (size_t k = 0; k < count; k++) {
+                const MemoryTensor& tensor = map.tensors[accesses[k]];
+                uint64_t begin = tensor.offset_start;
+                uint64_t end = tensor.offset_start + tensor.size_bytes;
+                if (end > file_size_) {
+                    last_error_ = tensor.name + " ends past the end of " + file_path +
+                                  " (is the memory map for another file?)";
+                    ok = false;
+                    break;
+                }
+                if (config.mode == ReplayMode::Direct) {
+                    begin = begin / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+                    end = (end + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+                }
+                for (uint64_t offset = begin; offset < end; offset += config.request_bytes) {
+                    Request request;
+                    request.offset = offset;
+                    request.length = static_cast<uint32_t>(std::min(config.request_bytes, end - offset));
+                    request.category = tensor_category[accesses[k]];
+                    request.due_ns = due_ns;
+                    requests.push_back(request);
+                }
+                token_stats.accesses++;
+            }
+        }
+        if (!ok || requests.empty()) {
+            continue;
+        }
+
+        completions.assign(requests.size(), Completion{0, 0, 0});
+        if (config.mode == ReplayMode::MmapTouch) {
+            replayMmap(requests, start_ns, completions);
+        } else if (ring.isOpen()) {
+            ok = replayRing(ring, requests, config, start_ns, completions);
+        } else {
+            ok = replayThreads(*readers, requests, config, start_ns, completions);
+        }
+        if (!ok) {
+            break;
+        }
+
+        // I/O time: union of the [issued, completed] intervals
+        std::vector<std::pair<int64_t, int64_t>> intervals;
+        intervals.reserve(completions.size());
+        for (size_t r = 0; r < requests.size(); r++) {
+            const Completion& completion = completions[r];
+            const float latency_us = (completion.completed_ns - completion.issued_ns) / 1000.0f;
+            latencies[requests[r].category].push_back(latency_us);
+            all_latencies.push_back(latency_us);
+            out.categories[requests[r].category].bytes += completion.bytes;
+            token_stats.bytes += completion.bytes;
+            intervals.emplace_back(completion.issued_ns, completion.completed_ns);
+        }
+        std::sort(intervals.begin(), intervals.end());
+        int64_t busy_ns = 0;
+        int64_t covered_until = intervals.front().first;
+        for (const auto& interval : intervals) {
+            const int64_t from = std::max(interval.first, covered_until);
+            if (interval.second > from) {
+                busy_ns += interval.second - from;
+                covered_until = interval.second;
+            }
+        }
+        token_stats.requests = static_cast<uint32_t>(requests.size());
+        token_stats.io_ms = busy_ns / 1e6;
+        out.accesses += token_stats.accesses;
+        out.tokens.push_back(token_stats);
+    }
+    out.seconds = (nowNs() - start_ns) / 1e9;
+    closeFile();
+    if (!ok) {
+        return false;
+    }
+
+    for (size_t c = 0; c < out.categories.size(); c++) {
+        summarize(latencies[c], out.categories[c]);
+        out.total.bytes += out.categories[c].bytes;
+    }
+    out.categories.erase(std::remove_if(out.categories.begin(), out.categories.end(),
+                                        [](const ReplayCategoryStats& stats) { return stats.requests == 0; }),
+                         out.categories.end());
+    out.total.category = "all";
+    summarize(all_latencies, out.total);
+    return true;
+}
+
+bool TraceReplay::replayRing(IoRing& ring, const std::vector<Request>& requests, const ReplayConfig& config,
+                             int64_t start_ns, std::vector<Completion>& out) {
+    const uint32_t depth = std::min(config.queue_depth, ring.getCapacity());
+    std::vector<uint32_t> free_slots;
+    for (uint32_t s = depth; s > 0; s--) {
+        free_slots.push_back(s - 1);
+    }
+    std::vector<size_t> slot_request(depth, 0);
+
+    size_t limit = requests.size();   // Shrinks to what was issued once a read fails
+    size_t next = 0;
+    size_t done = 0;
+    std::string error;
+    auto on_complete = [&](uint64_t s, int32_t result) {
+        const size_t r = slot_request[s];
+        out[r].completed_ns = nowNs() - start_ns;
+        if (result < 0) {
+            if (error.empty()) {
+                error = "Read of " + std::to_string(requests[r].length) + " bytes at offset " +
+                        std::to_string(requests[r].offset) + " failed: " + std::strerror(-result);
+            }
+            limit = next;
+        } else {
+            out[r].bytes = static_cast<uint32_t>(result);
+        }
+        free_slots.push_back(static_cast<uint32_t>(s));
+        done++;
+    };
+
+    while (done < limit) {
+        const int64_t now = nowNs() - start_ns;
+        while (next < limit && !free_slots.empty() && (!config.paced || requests[next].due_ns <= now)) {
+            const uint32_t s = free_slots.back();
+            const Request& request = requests[next];
+            if (!ring.queueRead(fd_, buffers_ + s * buffer_stride_, request.length, request.offset, s)) {
+                break;
+            }
+            free_slots.pop_back();
+            slot_request[s] = next;
+            out[next].issued_ns = now;
+            next++;
+        }
+
+        const bool in_flight = free_slots.size() < depth;
+        const bool waiting_for_due = next < limit && !free_slots.empty();
+        if (!in_flight) {
+            if (waiting_for_due) {
+                sleepUntilNs(start_ns + requests[next].due_ns);
+            }
+            continue;
+        }
+        const size_t done_before = done;
+        if (!ring.submitAndWait(waiting_for_due ? 0 : 1, on_complete)) {
+            // Reads may still be in flight into buffers_, so the ring has to go
+            last_error_ = ring.getLastError();
+            ring.close();
+            return false;
+        }
+        if (waiting_for_due && done == done_before) {
+            const int64_t due = start_ns + requests[next].due_ns;
+            sleepUntilNs(std::min(due, nowNs() + PACING_POLL_NS));
+        }
+    }
+    if (!error.empty()) {
+        last_error_ = error;
+        return false;
+    }
+    return true;
+}
+
+bool TraceReplay::replayThreads(ThreadPool& readers, const std::vector<Request>& requests, const ReplayConfig& config,
+                                int64_t start_ns, std::vector<Completion>& out) {
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex error_mutex;
+    std::string error;
+    for (uint32_t reader = 0; reader < config.queue_depth; reader++) {
+        // Each reader claims the next request, so reads are issued in trace order
+        readers.submit([&, reader] {
+            uint8_t* buffer = buffers_ + reader * buffer_stride_;
+            for (;;) {
+                const size_t r = next.fetch_add(1, std::memory_order_relaxed);
+                if (r >= requests.size() || failed.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                const Request& request = requests[r];
+                if (config.paced) {
+                    sleepUntilNs(start_ns + request.due_ns);
+                }
+                out[r].issued_ns = nowNs() - start_ns;
+                size_t total = 0;
+                while (total < request.length) {
+                    ssize_t n = pread(fd_, buffer + total, request.length - total,
+                                      static_cast<off_t>(request.offset + total));
+                    if (n < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (n < 0) {
+                        if (!failed.exchange(true)) {
+                            std::lock_guard<std::mutex> lock(error_mutex);
+                            error = "Read of " + std::to_string(request.length) + " bytes at offset " +
+                                    std::to_string(request.offset) + " failed: " + std::strerror(errno);
+                        }
+                        break;
+                    }
+                    if (n == 0) {
+                        break;   // End of file (O_DIRECT rounding past the last block)
+                    }
+                    total += static_cast<size_t>(n);
+                }
+                out[r].completed_ns = nowNs() - start_ns;
+                out[r].bytes = static_cast<uint32_t>(total);
+            }
+        });
+    }
+    readers.waitIdle();
+    if (failed.load()) {
+        last_error_ = error;
+        return false;
+    }
+    return true;
+}
+
+void TraceReplay::replayMmap(const std::vector<Request>& requests, int64_t start_ns, std::vector<Completion>& out) {
+    for (size_t r = 0; r < requests.size(); r++) {
+        const Request& request = requests[r];
+        sleepUntilNs(start_ns + request.due_ns);
+        out[r].issued_ns = nowNs() - start_ns;
+        const volatile uint8_t* data = mapping_ + request.offset;
+        uint8_t sink = 0;
+        for (uint64_t b = 0; b < request.length; b += TOUCH_STRIDE) {
+            sink ^= data[b];
+        }
+        sink ^= data[request.length - 1];
+        out[r].completed_ns = nowNs() - start_ns;
+        (void)sink;
+        out[r].bytes = request.length;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "IoRing.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// How the model file is read
+enum class ReplayMode : uint8_t {
+    Buffered = 0,    // read() through the page cache
+    Direct = 1,      // O_DIRECT: 4 KiB-aligned reads straight from the device
+    MmapTouch = 2,   // Fault the pages of a read-only mapping in, as llama.cpp does with mmap
+};
+
+constexpr size_t REPLAY_MODE_COUNT = 3;
+
+const char* replayModeName(ReplayMode mode);
+bool replayModeFromName(const std::string& name, ReplayMode& out_mode);
+
+struct ReplayConfig {
+    ReplayMode mode = ReplayMode::Buffered;
+    bool io_uring = true;                   // Otherwise queue_depth threads doing pread
+    uint32_t queue_depth = 8;               // Requests in flight (read modes only)
+    uint64_t request_bytes = 1024 * 1024;   // Accesses are split into requests of at most this
+    bool paced = false;                     // Issue each access at its trace timestamp
+    double speed = 1.0;                     // Pacing: trace time / replay time
+    bool drop_cache = true;                 // Evict the file from the page cache first
+    size_t max_tokens = 0;                  // 0 = every loaded token
+};
+
+// Request latency over one tensor category (or all of them)
+struct ReplayCategoryStats {
+    std::string category;
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+struct ReplayTokenStats {
+    uint32_t token_id = 0;
+    uint32_t accesses = 0;
+    uint32_t requests = 0;
+    uint64_t bytes = 0;
+    double io_ms = 0.0;    // First request issued to last completion
+};
+
+struct ReplayResult {
+    std::string engine;    // "io_uring", "pread" or "mmap"
+    uint64_t accesses = 0;
+    double seconds = 0.0;  // Wall time over all tokens
+    ReplayCategoryStats total;
+    std::vector<ReplayCategoryStats> categories;   // Sorted by name
+    std::vector<ReplayTokenStats> tokens;
+    std::string fallback_reason;   // Why io_uring was asked for but not used
+
+    double gbPerSecond() const { return seconds > 0.0 ? total.bytes / 1e9 / seconds : 0.0; }
+};
+
+// Replays a domain's DISK accesses as real reads of a model file
+//
+// Tokens run back to back in trace order, each one waiting for its last read
+// before the next starts. Within a token every resolved access becomes reads
+// of its MemoryMap extent (so an image written by gguf-image for a scaled map
+// replays the same pattern), split at request_bytes and kept queue_depth
+// deep. Paced replays hold each access until its trace timestamp; replays
+// that fall behind catch up without waiting. Runs synchronously on the
+// calling thread (plus queue_depth readers for the pread engine).
+class TraceReplay {
+public:
+    TraceReplay();
+    ~TraceReplay();
+
+    TraceReplay(const TraceReplay&) = delete;
+    TraceReplay& operator=(const TraceReplay&) = delete;
+
+    // Loader must be finished. Returns true on success, false on failure (see getLastError)
+    bool run(const DomainLoader& loader, const std::string& file_path, const ReplayConfig& config,
+             ReplayResult& out);
+
+    const std::string& getLastError() const { return last_error_; }
+
+private:
+    struct Request {
+        uint64_t offset;
+        uint32_t length;
+        uint16_t category;
+        int64_t due_ns;      // Relative to the replay start (paced only)
+    };
+
+    // Issue and completion times relative to the replay start
+    struct Completion {
+        int64_t issued_ns;
+        int64_t completed_ns;
+        uint32_t bytes;
+    };
+
+    int fd_;
+    uint8_t* mapping_;
+    uint64_t file_size_;
+    uint8_t* buffers_;          // queue_depth buffers of buffer_stride_ bytes, 4 KiB aligned
+    size_t buffer_stride_;
+    std::string last_error_;
+
+    bool openFile(const std::string& file_path, const ReplayConfig& config);
+    void closeFile();
+
+    bool replayRing(IoRing& ring, const std::vector<Request>& requests, const ReplayConfig& config,
+                    int64_t start_ns, std::vector<Completion>& out);
+    bool replayThreads(ThreadPool& readers, const std::vector<Request>& requests, const ReplayConfig& config,
+                       int64_t start_ns, std::vector<Completion>& out);
+    void replayMmap(const std::vector<Request>& requests, int64_t start_ns, std::vector<Completion>& out);
+};
@@ -0,0 +1,347 @@
+#include "TraceStore.h"
+#include "TraceData.h"
+#include "TensorIndex.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+
+size_t TraceSymbols::SourceKeyHash::operator()(const TraceSourceInfo& info) const {
+    size_t h = std::hash<uint64_t>()(info.tensor_ptr);
+    h = h * 31 + std::hash<uint64_t>()(info.offset);
+    h = h * 31 + std::hash<uint64_t>()(info.size_bytes);
+    h = h * 31 + info.name_id;
+    h = h * 31 + static_cast<uint16_t>(info.layer_id);
+    h = h * 31 + static_cast<uint8_t>(info.memory_source);
+    return h;
+}
+
+bool TraceSymbols::SourceKeyEqual::operator()(const TraceSourceInfo& a, const TraceSourceInfo& b) const {
+    return a.tensor_ptr == b.tensor_ptr && a.offset == b.offset && a.size_bytes == b.size_bytes &&
+           a.name_id == b.name_id && a.layer_id == b.layer_id && a.memory_source == b.memory_source;
+}
+
+uint32_t TraceSymbols::internString(std::string_view str) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return internStringLocked(str);
+}
+
+uint32_t TraceSymbols::internStringLocked(std::string_view str) {
+    auto it = string_ids_.find(str);
+    if (it != string_ids_.end()) {
+        return it->second;
+    }
+    if (strings_.full()) {
+        throw std::length_error("TraceSymbols string table is full");
+    }
+    uint32_t id = strings_.push(std::string(str));
+    string_ids_.emplace(strings_[id], id);
+    return id;
+}
+
+uint32_t TraceSymbols::internSource(const TraceSourceInfo& info) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = source_ids_.find(info);
+    if (it != source_ids_.end()) {
+        return it->second;
+    }
+    if (sources_.full()) {
+        throw std::length_error("TraceSymbols source table is full");
+    }
+
+    TraceSourceInfo stored = info;
+    stored.is_expert = strings_[info.name_id].find("_exps.") != std::string::npos;
+    uint32_t id = sources_.push(stored);
+    source_ids_.emplace(stored, id);
+    return id;
+}
+
+size_t TraceSymbols::getStringCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return strings_.size();
+}
+
+size_t TraceSymbols::getSourceCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sources_.size();
+}
+
+TraceSymbols& TraceStore::symbols() {
+    if (!symbols_) {
+        symbols_ = std::make_shared<TraceSymbols>();
+    }
+    return *symbols_;
+}
+
+TraceStore::TraceStore(const TraceStore& other) {
+    *this = other;
+}
+
+TraceStore& TraceStore::operator=(const TraceStore& other) {
+    if (this == &other) {
+        return *this;
+    }
+    symbols_ = other.symbols_;
+    token_id_ = other.token_id_;
+    columns_ = other.columns_;
+    attached_ = other.attached_;
+    timestamps_ = other.timestamps_;
+    relative_ms_ = other.relative_ms_;
+    entry_ids_ = other.entry_ids_;
+    layers_ = other.layers_;
+    threads_ = other.threads_;
+    ops_ = other.ops_;
+    phases_ = other.phases_;
+    num_sources_ = other.num_sources_;
+    num_experts_ = other.num_experts_;
+    dst_names_ = other.dst_names_;
+    sources_ = other.sources_;
+    experts_ = other.experts_;
+    access_offsets_ = other.access_offsets_;
+    access_tensors_ = other.access_tensors_;
+    if (!attached_) {
+        bindOwnedColumns();
+    }
+    return *this;
+}
+
+TraceStore::TraceStore(TraceStore&& other) noexcept {
+    *this = std::move(other);
+}
+
+TraceStore& TraceStore::operator=(TraceStore&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    symbols_ = std::move(other.symbols_);
+    token_id_ = other.token_id_;
+    columns_ = other.columns_;
+    attached_ = other.attached_;
+    timestamps_ = std::move(other.timestamps_);
+    relative_ms_ = std::move(other.relative_ms_);
+    entry_ids_ = std::move(other.entry_ids_);
+    layers_ = std::move(other.layers_);
+    threads_ = std::move(other.threads_);
+    ops_ = std::move(other.ops_);
+    phases_ = std::move(other.phases_);
+    num_sources_ = std::move(other.num_sources_);
+    num_experts_ = std::move(other.num_experts_);
+    dst_names_ = std::move(other.dst_names_);
+    sources_ = std::move(other.sources_);
+    experts_ = std::move(other.experts_);
+    access_offsets_ = std::move(other.access_offsets_);
+    access_tensors_ = std::move(other.access_tensors_);
+    if (!attached_) {
+        bindOwnedColumns();
+    }
+    other.clear();
+    return *this;
+}
+
+void TraceStore::bindOwnedColumns() {
+    columns_.count = timestamps_.size();
+    columns_.timestamps = timestamps_.data();
+    columns_.relative_ms = relative_ms_.data();
+    columns_.entry_ids = entry_ids_.data();
+    columns_.layers = layers_.data();
+    columns_.threads = threads_.data();
+    columns_.ops = ops_.data();
+    columns_.phases = phases_.data();
+    columns_.num_sources = num_sources_.data();
+    columns_.num_experts = num_experts_.data();
+    columns_.dst_names = dst_names_.data();
+    columns_.sources = sources_.data();
+    columns_.experts = experts_.data();
+    columns_.string_ids = nullptr;
+    columns_.source_ids = nullptr;
+}
+
+void TraceStore::reserve(size_t count) {
+    timestamps_.reserve(count);
+    relative_ms_.reserve(count);
+    entry_ids_.reserve(count);
+    layers_.reserve(count);
+    threads_.reserve(count);
+    ops_.reserve(count);
+    phases_.reserve(count);
+    num_sources_.reserve(count);
+    num_experts_.reserve(count);
+    dst_names_.reserve(count);
+    sources_.reserve(count);
+    experts_.reserve(count);
+    if (!attached_) {
+        bindOwnedColumns();
+    }
+}
+
+void TraceStore::clear() {
+    token_id_ = 0;
+    timestamps_.clear();
+    relative_ms_.clear();
+    entry_ids_.clear();
+    layers_.clear();
+    threads_.clear();
+    ops_.clear();
+    phases_.clear();
+    num_sources_.clear();
+    num_experts_.clear();
+    dst_names_.clear();
+    sources_.clear();
+    experts_.clear();
+    access_offsets_.clear();
+    access_tensors_.clear();
+    attached_ = false;
+    bindOwnedColumns();
+}
+
+void TraceStore::attach(const TraceColumns& columns) {
+    clear();
+    columns_ = columns;
+    attached_ = true;
+}
+
+void TraceStore::append(const TraceRecord& record) {
+    timestamps_.push_back(record.timestamp_ns);
+    relative_ms_.push_back(record.relative_ms);
+    entry_ids_.push_back(record.entry_id);
+    layers_.push_back(record.layer_id);
+    threads_.push_back(record.thread_id);
+    ops_.push_back(record.op);
+    phases_.push_back(record.phase);
+    num_sources_.push_back(std::min<uint8_t>(record.num_sources, TRACE_MAX_SOURCES));
+    num_experts_.push_back(std::min<uint8_t>(record.num_experts, TRACE_MAX_EXPERTS));
+    dst_names_.push_back(record.dst_name);
+    sources_.push_back(record.sources);
+    experts_.push_back(record.expert_ids);
+    bindOwnedColumns();
+}
+
+void TraceStore::append(const TraceEntry& entry) {
+    TraceSymbols& table = symbols();
+
+    if (empty()) {
+        token_id_ = entry.token_id;
+    }
+
+    TraceRecord record{};
+    record.timestamp_ns = entry.timestamp_ns;
+    record.relative_ms = static_cast<float>(entry.timestamp_relative_ms);
+    record.entry_id = entry.entry_id;
+    record.layer_id = static_cast<int16_t>(entry.layer_id);
+    record.thread_id = entry.thread_id;
+    record.op = ggmlOpFromName(entry.operation_type);
+    record.phase = entry.phase == "PROMPT" ? TracePhase::Prompt : TracePhase::Generate;
+    record.dst_name = table.internString(entry.dst_name);
+
+    record.num_sources = static_cast<uint8_t>(std::min(entry.sources.size(), TRACE_MAX_SOURCES));
+    record.sources.fill(TraceSymbols::NO_ID);
+    for (size_t s = 0; s < record.num_sources; s++) {
+        const TraceSource& source = entry.sources[s];
+
+        TraceSourceInfo info{};
+        info.tensor_ptr = std::strtoull(source.tensor_ptr.c_str(), nullptr, 16);
+        info.size_bytes = source.size_bytes;
+        info.name_id = table.internString(source.name);
+        info.layer_id = static_cast<int16_t>(source.layer_id);
+        info.memory_source = memorySourceFromName(source.memory_source);
+        if (info.memory_source == MemorySource::Disk) {
+            info.offset = source.disk_offset;
+        } else if (info.memory_source == MemorySource::Buffer) {
+            info.offset = source.buffer_id;
+        }
+        record.sources[s] = table.internSource(info);
+    }
+
+    record.num_experts = static_cast<uint8_t>(std::min(entry.expert_ids.size(), TRACE_MAX_EXPERTS));
+    for (size_t e = 0; e < record.num_experts; e++) {
+        record.expert_ids[e] = toStoredExpertId(entry.expert_ids[e]);
+    }
+
+    append(record);
+}
+
+bool TraceStore::isDiskAccess(size_t i) const {
+    for (size_t s = 0; s < numSources(i); s++) {
+        if (source(i, s).memory_source == MemorySource::Disk) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t TraceStore::getTotalInputSize(size_t i) const {
+    uint64_t total = 0;
+    for (size_t s = 0; s < numSources(i); s++) {
+        total += source(i, s).size_bytes;
+    }
+    return total;
+}
+
+void TraceStore::resolveAccesses(const TensorIndex& index) {
+    access_offsets_.clear();
+    access_tensors_.clear();
+    access_offsets_.reserve(size() + 1);
+    access_offsets_.push_back(0);
+
+    // Each distinct source is looked up once per token
+    struct ResolvedSource {
+        uint32_t tensor;
+        uint32_t expert_group;
+    };
+    std::unordered_map<uint32_t, ResolvedSource> resolved;
+
+    for (size_t i = 0; i < size(); i++) {
+        const size_t expert_count = numExperts(i);
+        const uint8_t* experts = expertIds(i);
+        for (size_t s = 0; s < numSources(i); s++) {
+            uint32_t id = sourceId(i, s);
+            const TraceSourceInfo& info = symbols_->getSource(id);
+            if (info.memory_source != MemorySource::Disk) {
+                continue;
+            }
+
+            auto it = resolved.find(id);
+            if (it == resolved.end()) {
+                const std::string& name = symbols_->getString(info.name_id);
+                ResolvedSource entry{index.find(name),
+                                     info.is_expert ? index.findExpertGroup(name) : TensorIndex::NO_GROUP};
+                it = resolved.emplace(id, entry).first;
+            }
+
+            size_t before = access_tensors_.size();
+            if (it->second.expert_group != TensorIndex::NO_GROUP && expert_count > 0) {
+                size_t top_k = std::min<size_t>(EXPERT_ACCESS_TOP_K, expert_count);
+                for (size_t e = 0; e < top_k; e++) {
+                    if (experts[e] == TRACE_NO_EXPERT) {
+                        continue;
+                    }
+                    uint32_t tensor = index.expertSlice(it->second.expert_group, experts[e]);
+                    if (tensor != TensorIndex::NO_TENSOR) {
+                        access_tensors_.push_back(tensor);
+                    }
+                }
+            }
+
+            // Tensors the map keeps whole (e.g. "_exps.bias") count once per access
+            if (access_tensors_.size() == before && it->second.tensor != TensorIndex::NO_TENSOR) {
+                access_tensors_.push_back(it->second.tensor);
+            }
+        }
+        access_offsets_.push_back(static_cast<uint32_t>(access_tensors_.size()));
+    }
+}
+
+void TraceStore::countAccesses(size_t entry_begin, size_t entry_end, std::vector<uint32_t>& counts) const {
+    if (access_offsets_.empty() || entry_begin >= entry_end) {
+        return;
+    }
+
+    const uint32_t begin = access_offsets_[std::min(entry_begin, size())];
+    const uint32_t end = access_offsets_[std::min(entry_end, size())];
+    const uint32_t* tensors = access_tensors_.data();
+    uint32_t* out = counts.data();
+    for (uint32_t k = begin; k < end; k++) {
+        out[tensors[k]]++;
+    }
+}
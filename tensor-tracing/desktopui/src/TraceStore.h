@@ -0,0 +1,293 @@
+#pragma once
+
+#include "TraceFormat.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct TraceEntry;
+class TensorIndex;
+
+// Execution phase (values match the binary trace format)
+enum class TracePhase : uint8_t {
+    Prompt = 0,
+    Generate = 1,
+};
+
+// Where a source tensor lives (DISK/BUFFER values match the binary trace format)
+enum class MemorySource : uint8_t {
+    Disk = 0,
+    Buffer = 1,
+    Other = 2,
+};
+
+inline const char* tracePhaseName(TracePhase phase) {
+    return phase == TracePhase::Prompt ? "PROMPT" : "GENERATE";
+}
+
+inline const char* memorySourceName(MemorySource source) {
+    switch (source) {
+        case MemorySource::Disk: return "DISK";
+        case MemorySource::Buffer: return "BUFFER";
+        default: return "";
+    }
+}
+
+inline MemorySource memorySourceFromName(std::string_view name) {
+    if (name == "DISK") return MemorySource::Disk;
+    if (name == "BUFFER") return MemorySource::Buffer;
+    return MemorySource::Other;
+}
+
+// One distinct source tensor as seen by the tracer (shared by every entry reading it)
+struct TraceSourceInfo {
+    uint64_t tensor_ptr;
+    uint64_t offset;             // disk_offset for DISK, buffer_id for BUFFER, else 0
+    uint64_t size_bytes;
+    uint32_t name_id;            // TraceSymbols string id
+    int16_t layer_id;            // -1 for null
+    MemorySource memory_source;
+    bool is_expert;              // Name contains "_exps." (per-expert slices in the memory map)
+
+    uint64_t diskOffset() const { return memory_source == MemorySource::Disk ? offset : 0; }
+    uint64_t bufferId() const { return memory_source == MemorySource::Buffer ? offset : 0; }
+};
+
+// Append-only table with stable element addresses
+// Readers may index any id handed out before without locking.
+template <typename T>
+class ChunkedTable {
+public:
+    static constexpr size_t CHUNK_BITS = 12;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+    static constexpr size_t MAX_CHUNKS = 4096;
+
+    size_t size() const { return size_; }
+    bool full() const { return size_ == CHUNK_SIZE * MAX_CHUNKS; }
+
+    const T& operator[](uint32_t id) const { return chunks_[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]; }
+
+    uint32_t push(T value) {
+        size_t chunk = size_ >> CHUNK_BITS;
+        if (!chunks_[chunk]) {
+            chunks_[chunk].reset(new T[CHUNK_SIZE]);
+        }
+        chunks_[chunk][size_ & (CHUNK_SIZE - 1)] = std::move(value);
+        return static_cast<uint32_t>(size_++);
+    }
+
+private:
+    std::unique_ptr<T[]> chunks_[MAX_CHUNKS];
+    size_t size_ = 0;
+};
+
+// Strings and source tensors interned once per domain
+// Interning is thread-safe so tokens can be decoded in parallel into one table.
+class TraceSymbols {
+public:
+    static constexpr uint32_t NO_ID = 0xFFFFFFFF;
+
+    TraceSymbols() = default;
+    TraceSymbols(const TraceSymbols&) = delete;
+    TraceSymbols& operator=(const TraceSymbols&) = delete;
+
+    uint32_t internString(std::string_view str);
+    uint32_t internSource(const TraceSourceInfo& info);
+
+    const std::string& getString(uint32_t id) const { return strings_[id]; }
+    const TraceSourceInfo& getSource(uint32_t id) const { return sources_[id]; }
+
+    size_t getStringCount() const;
+    size_t getSourceCount() const;
+
+    // Identity of a source tensor (every field but is_expert, which follows from the name)
+    struct SourceKeyHash {
+        size_t operator()(const TraceSourceInfo& info) const;
+    };
+    struct SourceKeyEqual {
+        bool operator()(const TraceSourceInfo& a, const TraceSourceInfo& b) const;
+    };
+
+private:
+    mutable std::mutex mutex_;
+    ChunkedTable<std::string> strings_;
+    ChunkedTable<TraceSourceInfo> sources_;
+    std::unordered_map<std::string_view, uint32_t> string_ids_;  // Keys point into strings_
+    std::unordered_map<TraceSourceInfo, uint32_t, SourceKeyHash, SourceKeyEqual> source_ids_;
+
+    uint32_t internStringLocked(std::string_view str);
+};
+
+// One entry with every string already interned (the row layout of TraceStore)
+struct TraceRecord {
+    uint64_t timestamp_ns;
+    float relative_ms;
+    uint32_t entry_id;
+    int16_t layer_id;                                   // -1 for null
+    uint16_t thread_id;
+    uint8_t op;                                         // ggml_op (GGML_OP_UNKNOWN if unmapped)
+    TracePhase phase;
+    uint8_t num_sources;                                // <= TRACE_MAX_SOURCES
+    uint8_t num_experts;                                // <= TRACE_MAX_EXPERTS
+    uint32_t dst_name;                                  // TraceSymbols string id
+    std::array<uint32_t, TRACE_MAX_SOURCES> sources;    // TraceSymbols source ids
+    std::array<uint8_t, TRACE_MAX_EXPERTS> expert_ids;   // See toStoredExpertId
+};
+
+// Stored expert id of "no expert" (routing masks hold 64 experts, so 0..254 is ample)
+constexpr uint8_t TRACE_NO_EXPERT = 0xFF;
+
+// Expert ids as stored: ids outside 0..254 read as TRACE_NO_EXPERT
+inline uint8_t toStoredExpertId(int64_t expert_id) {
+    return expert_id >= 0 && expert_id < TRACE_NO_EXPERT ? static_cast<uint8_t>(expert_id) : TRACE_NO_EXPERT;
+}
+
+// Read-only entry columns owned by someone else (e.g. a mapped TraceCache)
+// Names and sources are ids local to that storage; string_ids and source_ids
+// translate them to TraceSymbols ids.
+struct TraceColumns {
+    size_t count = 0;
+    const uint64_t* timestamps = nullptr;
+    const float* relative_ms = nullptr;
+    const uint32_t* entry_ids = nullptr;
+    const int16_t* layers = nullptr;
+    const uint16_t* threads = nullptr;
+    const uint8_t* ops = nullptr;
+    const TracePhase* phases = nullptr;
+    const uint8_t* num_sources = nullptr;
+    const uint8_t* num_experts = nullptr;
+    const uint32_t* dst_names = nullptr;
+    const std::array<uint32_t, TRACE_MAX_SOURCES>* sources = nullptr;   // Unused slots hold NO_ID
+    const std::array<uint8_t, TRACE_MAX_EXPERTS>* experts = nullptr;
+    const uint32_t* string_ids = nullptr;   // Local string id -> TraceSymbols string id
+    const uint32_t* source_ids = nullptr;   // Local source id -> TraceSymbols source id
+};
+
+// Struct-of-arrays storage for the entries of one token
+//
+// Each field is its own dense column so filters and counters stream through
+// only the bytes they need (~60 bytes per entry in total). Names and source
+// tensors are ids into a TraceSymbols table shared by all tokens of a domain.
+// Columns are either built by append() or attached read-only from storage
+// that outlives the store (a mapped trace cache), so a warm start shares the
+// cache's pages instead of copying them. Once a memory map is known, every
+// DISK access (and each routed expert slice) is resolved to a MemoryMap
+// tensor index, stored per entry as offsets + a flat index array, so counting
+// is a plain array increment loop.
+class TraceStore {
+public:
+    TraceStore() = default;
+    explicit TraceStore(std::shared_ptr<TraceSymbols> symbols) : symbols_(std::move(symbols)) {}
+
+    TraceStore(const TraceStore& other);
+    TraceStore& operator=(const TraceStore& other);
+    TraceStore(TraceStore&& other) noexcept;
+    TraceStore& operator=(TraceStore&& other) noexcept;
+
+    // Symbol table (created on first append if none was given)
+    void setSymbols(std::shared_ptr<TraceSymbols> symbols) { symbols_ = std::move(symbols); }
+    TraceSymbols& symbols();
+    const std::shared_ptr<TraceSymbols>& getSymbols() const { return symbols_; }
+
+    // Building (clear keeps the symbol table and makes an attached store owning again)
+    void reserve(size_t count);
+    void clear();
+    void append(const TraceRecord& record);
+    void append(const TraceEntry& entry);  // Interns strings of a loader-side row
+
+    // Use columns that must outlive this store instead of owned ones (until clear())
+    void attach(const TraceColumns& columns);
+    bool isAttached() const { return attached_; }
+
+    size_t size() const { return columns_.count; }
+    bool empty() const { return columns_.count == 0; }
+
+    uint32_t tokenId() const { return token_id_; }
+    void setTokenId(uint32_t token_id) { token_id_ = token_id; }
+
+    // Per-entry fields
+    uint32_t entryId(size_t i) const { return columns_.entry_ids[i]; }
+    uint64_t timestampNs(size_t i) const { return columns_.timestamps[i]; }
+    float relativeMs(size_t i) const { return columns_.relative_ms[i]; }
+    int layerId(size_t i) const { return columns_.layers[i]; }
+    uint16_t threadId(size_t i) const { return columns_.threads[i]; }
+    uint8_t op(size_t i) const { return columns_.ops[i]; }
+    const char* operationType(size_t i) const { return ggmlOpName(columns_.ops[i]); }
+    TracePhase phase(size_t i) const { return columns_.phases[i]; }
+    const char* phaseName(size_t i) const { return tracePhaseName(columns_.phases[i]); }
+    uint32_t dstNameId(size_t i) const {
+        uint32_t id = columns_.dst_names[i];
+        return columns_.string_ids ? columns_.string_ids[id] : id;
+    }
+    const std::string& dstName(size_t i) const { return symbols_->getString(dstNameId(i)); }
+
+    size_t numSources(size_t i) const { return columns_.num_sources[i]; }
+    uint32_t sourceId(size_t i, size_t slot) const {
+        uint32_t id = columns_.sources[i][slot];
+        return columns_.source_ids && id != TraceSymbols::NO_ID ? columns_.source_ids[id] : id;
+    }
+    const TraceSourceInfo& source(size_t i, size_t slot) const { return symbols_->getSource(sourceId(i, slot)); }
+    const std::string& sourceName(size_t i, size_t slot) const { return symbols_->getString(source(i, slot).name_id); }
+
+    size_t numExperts(size_t i) const { return columns_.num_experts[i]; }
+    const uint8_t* expertIds(size_t i) const { return columns_.experts[i].data(); }
+
+    const std::string& getString(uint32_t id) const { return symbols_->getString(id); }
+
+    bool isDiskAccess(size_t i) const;
+    uint64_t getTotalInputSize(size_t i) const;
+
+    // Resolve DISK sources to MemoryMap tensor indices (replaces earlier results)
+    void resolveAccesses(const TensorIndex& index);
+    bool hasAccesses() const { return !access_offsets_.empty(); }
+    size_t accessCount(size_t i) const { return access_offsets_[i + 1] - access_offsets_[i]; }
+    const uint32_t* accesses(size_t i) const { return access_tensors_.data() + access_offsets_[i]; }
+
+    // Add one per resolved access of entries [entry_begin, entry_end) to counts
+    // (counts must hold one slot per MemoryMap tensor)
+    void countAccesses(size_t entry_begin, size_t entry_end, std::vector<uint32_t>& counts) const;
+    void countAccesses(size_t entry_end, std::vector<uint32_t>& counts) const { countAccesses(0, entry_end, counts); }
+
+    // Raw columns for tight loops (size() elements each)
+    const int16_t* layerColumn() const { return columns_.layers; }
+    const uint8_t* opColumn() const { return columns_.ops; }
+    const float* relativeMsColumn() const { return columns_.relative_ms; }
+
+    static constexpr size_t BYTES_PER_ENTRY =
+        sizeof(uint64_t) + sizeof(float) + sizeof(uint32_t) + sizeof(int16_t) + sizeof(uint16_t) +
+        4 * sizeof(uint8_t) + sizeof(uint32_t) +
+        sizeof(std::array<uint32_t, TRACE_MAX_SOURCES>) + sizeof(std::array<uint8_t, TRACE_MAX_EXPERTS>);
+    static_assert(BYTES_PER_ENTRY < 64, "TraceStore entries must stay under 64 bytes");
+
+private:
+    std::shared_ptr<TraceSymbols> symbols_;
+    uint32_t token_id_ = 0;
+
+    // What accessors read: the owned vectors below, or attached columns
+    TraceColumns columns_;
+    bool attached_ = false;
+
+    std::vector<uint64_t> timestamps_;
+    std::vector<float> relative_ms_;
+    std::vector<uint32_t> entry_ids_;
+    std::vector<int16_t> layers_;
+    std::vector<uint16_t> threads_;
+    std::vector<uint8_t> ops_;
+    std::vector<TracePhase> phases_;
+    std::vector<uint8_t> num_sources_;
+    std::vector<uint8_t> num_experts_;
+    std::vector<uint32_t> dst_names_;
+    std::vector<std::array<uint32_t, TRACE_MAX_SOURCES>> sources_;
+    std::vector<std::array<uint8_t, TRACE_MAX_EXPERTS>> experts_;
+
+    // Resolved accesses (empty until resolveAccesses)
+    std::vector<uint32_t> access_offsets_;
+    std::vector<uint32_t> access_tensors_;
+
+    void bindOwnedColumns();
+};
@@ -8,6 +8,8 @@ TraceTableView::TraceTableView()
     , layer_filter_(-2)  // -2 = all layers
     , operation_filter_("")
     , memory_source_filter_("")
+    , operation_filter_op_(GGML_OP_UNKNOWN)
+    , memory_source_filter_value_(MemorySource::Other)
     , selected_entry_index_(-1)
 {
 }
@@ -24,11 +26,13 @@ void TraceTableView::setLayerFilter(int layer_id) {
 
 void TraceTableView::setOperationFilter(const std::string& op_type) {
     operation_filter_ = op_type;
+    operation_filter_op_ = ggmlOpFromName(op_type);
     applyFilters();
 }
 
 void TraceTableView::setMemorySourceFilter(const std::string& source) {
     memory_source_filter_ = source;
+    memory_source_filter_value_ = memorySourceFromName(source);
     applyFilters();
 }
 
@@ -46,23 +50,27 @@ void TraceTableView::applyFilters() {
         return;
     }
 
-    for (const auto& entry : trace_data_->entries) {
+    const TraceStore& store = trace_data_->entries;
+    const int16_t* layers = store.layerColumn();
+    const uint8_t* ops = store.opColumn();
+
+    for (size_t i = 0; i < store.size(); i++) {
         // Apply layer filter
         if (layer_filter_ != -2) {
-            if (layer_filter_ == -1 && entry.layer_id != -1) continue;
-            if (layer_filter_ >= 0 && entry.layer_id != layer_filter_) continue;
+            if (layer_filter_ == -1 && layers[i] != -1) continue;
+            if (layer_filter_ >= 0 && layers[i] != layer_filter_) continue;
         }
 
         // Apply operation filter
-        if (!operation_filter_.empty() && entry.operation_type != operation_filter_) {
+        if (!operation_filter_.empty() && ops[i] != operation_filter_op_) {
             continue;
         }
 
         // Apply memory source filter
         if (!memory_source_filter_.empty()) {
             bool has_matching_source = false;
-            for (const auto& src : entry.sources) {
-                if (src.memory_source == memory_source_filter_) {
+            for (size_t s = 0; s < store.numSources(i); s++) {
+                if (store.source(i, s).memory_source == memory_source_filter_value_) {
                     has_matching_source = true;
                     break;
                 }
@@ -70,7 +78,7 @@ void TraceTableView::applyFilters() {
             if (!has_matching_source) continue;
         }
 
-        filtered_entries_.push_back(&entry);
+        filtered_entries_.push_back(static_cast<uint32_t>(i));
     }
 }
 
@@ -180,53 +188,55 @@ void TraceTableView::renderTable() {
 
         while (clipper.Step()) {
             for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
-                const TraceEntry* entry = filtered_entries_[row];
+                const TraceStore& store = trace_data_->entries;
+                const size_t entry = filtered_entries_[row];
 
                 ImGui::TableNextRow();
                 ImGui::PushID(row);
 
                 // Column 0: Entry ID
                 ImGui::TableNextColumn();
-                ImGui::Text("%u", entry->entry_id);
+                ImGui::Text("%u", store.entryId(entry));
 
                 // Column 1: Timestamp
                 ImGui::TableNextColumn();
-                ImGui::Text("%.2f", entry->timestamp_relative_ms);
+                ImGui::Text("%.2f", store.relativeMs(entry));
 
                 // Column 2: Token ID
                 ImGui::TableNextColumn();
-                ImGui::Text("%u", entry->token_id);
+                ImGui::Text("%u", store.tokenId());
 
                 // Column 3: Layer ID
                 ImGui::TableNextColumn();
-                if (entry->layer_id == -1) {
+                if (store.layerId(entry) == -1) {
                     ImGui::Text("-");
                 } else {
-                    ImGui::Text("%d", entry->layer_id);
+                    ImGui::Text("%d", store.layerId(entry));
                 }
 
                 // Column 4: Phase
                 ImGui::TableNextColumn();
-                ImGui::Text("%s", entry->phase.c_str());
+                ImGui::Text("%s", store.phaseName(entry));
 
                 // Column 5: Operation
                 ImGui::TableNextColumn();
-                ImGui::Text("%s", entry->operation_type.c_str());
+                ImGui::Text("%s", store.operationType(entry));
 
                 // Column 6: Destination
                 ImGui::TableNextColumn();
-                ImGui::TextUnformatted(entry->dst_name.c_str());
+                ImGui::TextUnformatted(store.dstName(entry).c_str());
 
                 // Column 7: Number of sources
                 ImGui::TableNextColumn();
-                ImGui::Text("%u src", entry->num_sources);
+                ImGui::Text("%zu src", store.numSources(entry));
 
                 // Show memory source indicator
                 bool has_disk = false;
                 bool has_buffer = false;
-                for (const auto& src : entry->sources) {
-                    if (src.memory_source == "DISK") has_disk = true;
-                    if (src.memory_source == "BUFFER") has_buffer = true;
+                for (size_t s = 0; s < store.numSources(entry); s++) {
+                    MemorySource memory = store.source(entry, s).memory_source;
+                    if (memory == MemorySource::Disk) has_disk = true;
+                    if (memory == MemorySource::Buffer) has_buffer = true;
                 }
                 ImGui::SameLine();
                 if (has_disk && has_buffer) {
@@ -239,32 +249,37 @@ void TraceTableView::renderTable() {
 
                 // Column 8: Total input size
                 ImGui::TableNextColumn();
-                ImGui::Text("%s", formatSize(entry->getTotalInputSize()).c_str());
+                ImGui::Text("%s", formatSize(store.getTotalInputSize(entry)).c_str());
 
                 // Tooltip on hover
                 if (ImGui::IsItemHovered()) {
                     ImGui::BeginTooltip();
-                    ImGui::Text("Entry ID: %u", entry->entry_id);
-                    ImGui::Text("Destination: %s", entry->dst_name.c_str());
+                    ImGui::Text("Entry ID: %u", store.entryId(entry));
+                    ImGui::Text("Destination: %s", store.dstName(entry).c_str());
                     ImGui::Separator();
-                    ImGui::Text("Sources (%u):", entry->num_sources);
-                    for (size_t i = 0; i < entry->sources.size(); i++) {
-                        const auto& src = entry->sources[i];
-                        ImGui::BulletText("[%zu] %s", i, src.name.c_str());
+                    ImGui::Text("Sources (%zu):", store.numSources(entry));
+                    for (size_t i = 0; i < store.numSources(entry); i++) {
+                        const TraceSourceInfo& src = store.source(entry, i);
+                        ImGui::BulletText("[%zu] %s", i, store.getString(src.name_id).c_str());
                         ImGui::Indent();
-                        ImGui::Text("%s • %s", src.memory_source.c_str(), formatSize(src.size_bytes).c_str());
-                        if (src.memory_source == "DISK") {
-                            ImGui::Text("Offset: 0x%llx", src.disk_offset);
+                        ImGui::Text("%s • %s", memorySourceName(src.memory_source), formatSize(src.size_bytes).c_str());
+                        if (src.memory_source == MemorySource::Disk) {
+                            ImGui::Text("Offset: 0x%llx", static_cast<unsigned long long>(src.diskOffset()));
                         }
                         ImGui::Unindent();
                     }
-                    if (entry->num_experts > 0) {
+                    if (store.numExperts(entry) > 0) {
+                        const uint8_t* expert_ids = store.expertIds(entry);
                         ImGui::Separator();
-                        ImGui::Text("Experts (%u): ", entry->num_experts);
+                        ImGui::Text("Experts (%zu): ", store.numExperts(entry));
                         ImGui::SameLine();
-                        for (size_t i = 0; i < entry->expert_ids.size(); i++) {
-                            ImGui::Text("%d", entry->expert_ids[i]);
-                            if (i < entry->expert_ids.size() - 1) {
+                        for (size_t i = 0; i < store.numExperts(entry); i++) {
+                            if (expert_ids[i] == TRACE_NO_EXPERT) {
+                                ImGui::Text("-");
+                            } else {
+                                ImGui::Text("%d", expert_ids[i]);
+                            }
+                            if (i < store.numExperts(entry) - 1) {
                                 ImGui::SameLine();
                                 ImGui::Text(",");
                                 ImGui::SameLine();
@@ -282,11 +297,12 @@ void TraceTableView::renderTable() {
     }
 }
 
-void TraceTableView::renderEntryDetails(const TraceEntry* entry) {
+void TraceTableView::renderEntryDetails(size_t index) {
     // This could be expanded for a detailed view in a separate panel
-    ImGui::Text("Entry ID: %u", entry->entry_id);
-    ImGui::Text("Operation: %s", entry->operation_type.c_str());
-    ImGui::Text("Destination: %s", entry->dst_name.c_str());
+    const TraceStore& store = trace_data_->entries;
+    ImGui::Text("Entry ID: %u", store.entryId(index));
+    ImGui::Text("Operation: %s", store.operationType(index));
+    ImGui::Text("Destination: %s", store.dstName(index).c_str());
 }
 
 std::string TraceTableView::formatSize(uint64_t bytes) {
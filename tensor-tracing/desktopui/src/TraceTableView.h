@@ -36,8 +36,12 @@ private:
     std::string operation_filter_;      // "" = all
     std::string memory_source_filter_;  // "" = all
 
-    // Filtered entries (pointers to entries in trace_data_)
-    std::vector<const TraceEntry*> filtered_entries_;
+    // Filter values decoded once (columns store enums, not strings)
+    uint8_t operation_filter_op_;
+    MemorySource memory_source_filter_value_;
+
+    // Filtered entries (row indices into trace_data_->entries)
+    std::vector<uint32_t> filtered_entries_;
 
     // UI state
     int selected_entry_index_;
@@ -46,7 +50,7 @@ private:
     void applyFilters();
     void renderFilterControls();
     void renderTable();
-    void renderEntryDetails(const TraceEntry* entry);
+    void renderEntryDetails(size_t index);
 
     // Helper to format sizes
     static std::string formatSize(uint64_t bytes);
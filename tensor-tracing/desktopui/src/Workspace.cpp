@@ -0,0 +1,31 @@
+#include "Workspace.h"
+
+Workspace::Workspace(ThreadPool& pool)
+    : pool_(pool)
+    , symbols_(std::make_shared<TraceSymbols>())
+{
+}
+
+size_t Workspace::addDomain(const std::string& domain_path) {
+    auto loader = std::make_unique<DomainLoader>(pool_, memory_maps_, symbols_);
+    if (progress_callback_) {
+        loader->setProgressCallback(progress_callback_);
+    }
+    if (!model_path_.empty()) {
+        loader->setModelPath(model_path_);
+    }
+    loader->start(domain_path);
+
+    domains_.push_back(std::move(loader));
+    names_.push_back(domainNameFromPath(domain_path));
+    return domains_.size() - 1;
+}
+
+std::string Workspace::domainNameFromPath(const std::string& domain_path) {
+    std::string path = domain_path;
+    while (path.size() > 1 && (path.back() == '/' || path.back() == '\\')) {
+        path.pop_back();
+    }
+    size_t last_slash = path.find_last_of("/\\");
+    return last_slash != std::string::npos ? path.substr(last_slash + 1) : path;
+}
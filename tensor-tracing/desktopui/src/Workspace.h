@@ -0,0 +1,50 @@
+#pragma once
+
+#include "DomainLoader.h"
+#include "MemoryMapCache.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Several domain directories loaded side by side in one process
+//
+// All domains decode on one worker pool into one symbol table, and domains
+// of the same model share a single parsed + indexed memory map, so memory
+// and startup time grow with the trace data rather than the domain count.
+class Workspace {
+public:
+    explicit Workspace(ThreadPool& pool);
+
+    // Forwarded to every domain added afterwards (see DomainLoader)
+    void setProgressCallback(std::function<void()> callback) { progress_callback_ = std::move(callback); }
+
+    // GGUF model file (or memory-map JSON) every domain added afterwards reads its memory map from
+    void setModelPath(const std::string& model_path) { model_path_ = model_path; }
+
+    // Start loading a domain directory in the background; returns its index
+    size_t addDomain(const std::string& domain_path);
+
+    size_t getDomainCount() const { return domains_.size(); }
+    DomainLoader& getDomain(size_t index) { return *domains_[index]; }
+    const DomainLoader& getDomain(size_t index) const { return *domains_[index]; }
+    const std::string& getDomainName(size_t index) const { return names_[index]; }
+
+    // Distinct memory maps parsed for the domains so far
+    size_t getMemoryMapCount() const { return memory_maps_.getMapCount(); }
+
+    // Last path component ("…/domain-1-code" -> "domain-1-code")
+    static std::string domainNameFromPath(const std::string& domain_path);
+
+private:
+    ThreadPool& pool_;
+    MemoryMapCache memory_maps_;
+    std::shared_ptr<TraceSymbols> symbols_;
+    std::function<void()> progress_callback_;
+    std::string model_path_;
+
+    // DomainLoader is pinned in memory (workers hold `this`)
+    std::vector<std::unique_ptr<DomainLoader>> domains_;
+    std::vector<std::string> names_;
+};
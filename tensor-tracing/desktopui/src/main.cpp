@@ -3,19 +3,61 @@
 #include "imgui_impl_opengl3.h"
 #include "implot.h"
 #include <GLFW/glfw3.h>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 #include "JSONLoader.h"
+#include "DomainLoader.h"
+#include "Workspace.h"
+#include "ThreadPool.h"
 #include "MemoryMap.h"
 #include "TraceData.h"
 #include "TraceTableView.h"
 #include "HeatmapView.h"
+#include "CacheSimView.h"
+#include "ReuseView.h"
+#include "ExpertPredictionView.h"
+#include "ExpertCubeView.h"
+#include "LayoutView.h"
+#include "HeadlessReport.h"
+#include "StepGraph.h"
+
+// Idle rendering: the main loop blocks in glfwWaitEventsTimeout until input
+// or loader progress arrives, then draws a few frames so ImGui can settle
+// (hover/release state lags the input that caused it by a frame)
+constexpr int FRAMES_AFTER_WAKE = 3;
+constexpr double IDLE_WAIT_SECONDS = 0.5;  // Longest single block (text cursor blink rate)
+std::atomic<int> framesToDraw{FRAMES_AFTER_WAKE};
+
+void requestRedraw() {
+    framesToDraw.store(FRAMES_AFTER_WAKE, std::memory_order_relaxed);
+}
+
+// Must run before ImGui_ImplGlfw_InitForOpenGL so the backend chains to these
+void installRedrawCallbacks(GLFWwindow* window) {
+    glfwSetCursorPosCallback(window, [](GLFWwindow*, double, double) { requestRedraw(); });
+    glfwSetCursorEnterCallback(window, [](GLFWwindow*, int) { requestRedraw(); });
+    glfwSetMouseButtonCallback(window, [](GLFWwindow*, int, int, int) { requestRedraw(); });
+    glfwSetScrollCallback(window, [](GLFWwindow*, double, double) { requestRedraw(); });
+    glfwSetKeyCallback(window, [](GLFWwindow*, int, int, int, int) { requestRedraw(); });
+    glfwSetCharCallback(window, [](GLFWwindow*, unsigned int) { requestRedraw(); });
+    glfwSetWindowFocusCallback(window, [](GLFWwindow*, int) { requestRedraw(); });
+    glfwSetFramebufferSizeCallback(window, [](GLFWwindow*, int, int) { requestRedraw(); });
+    glfwSetWindowRefreshCallback(window, [](GLFWwindow*) { requestRedraw(); });
+}
 
 // Helper: Render accumulated access graph
 void renderAccumulatedGraph(const MemoryMap& memoryMap,
-                           const std::map<std::string, uint32_t>& accumulatedCounts,
-                           uint32_t maxCount) {
+                           const TensorIndex& tensorIndex,
+                           const std::vector<uint32_t>& accumulatedCounts,
+                           uint32_t maxCount,
+                           size_t tokenCount,
+                           StepGraph& graph) {
     ImGui::Separator();
-    ImGui::Text("Accumulated Access Pattern (All 100 Tokens)");
+    ImGui::Text("Accumulated Access Pattern (All %zu Tokens)", tokenCount);
 
     // Static hover state for tooltips
     static const MemoryTensor* hovered_tensor = nullptr;
@@ -29,51 +71,38 @@ void renderAccumulatedGraph(const MemoryMap& memoryMap,
         ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, max_gb, ImGuiCond_Once);
         ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, static_cast<double>(maxCount), ImGuiCond_Once);
 
-        // Build step function
-        std::vector<double> step_x, step_y;
-        for (const auto& tensor : memoryMap.tensors) {
-            uint32_t count = 0;
-            auto it = accumulatedCounts.find(tensor.name);
-            if (it != accumulatedCounts.end()) {
-                count = it->second;
-            }
-
-            double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-            double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
-
-            step_x.push_back(start_gb);
-            step_y.push_back(static_cast<double>(count));
-            step_x.push_back(end_gb);
-            step_y.push_back(static_cast<double>(count));
-        }
+        // Step function, decimated to the plot width (rebuilt only on zoom/scroll)
+        const double bytesPerGB = 1024.0 * 1024.0 * 1024.0;
+        ImPlotRect limits = ImPlot::GetPlotLimits();
+        graph.update(memoryMap, tensorIndex, accumulatedCounts,
+                     static_cast<uint64_t>(std::max(limits.X.Min, 0.0) * bytesPerGB),
+                     static_cast<uint64_t>(std::max(limits.X.Max, 0.0) * bytesPerGB),
+                     static_cast<int>(ImPlot::GetPlotSize().x));
 
-        if (!step_x.empty()) {
+        if (!graph.empty()) {
             // Blue color (same for fill and line)
             ImVec4 blue_color = ImVec4(0.2f, 0.5f, 0.8f, 1.0f);
 
             // Draw filled area
             ImPlot::PushStyleColor(ImPlotCol_Fill, blue_color);
-            ImPlot::PlotShaded("##accumulated_fill", step_x.data(), step_y.data(), step_x.size(), 0.0);
+            ImPlot::PlotShaded("##accumulated_fill", graph.getXs(), graph.getYs(), graph.getPointCount(), 0.0);
             ImPlot::PopStyleColor();
 
             // Draw line (same color)
             ImPlot::PushStyleColor(ImPlotCol_Line, blue_color);
-            ImPlot::PlotLine("##accumulated_line", step_x.data(), step_y.data(), step_x.size());
+            ImPlot::PlotLine("##accumulated_line", graph.getXs(), graph.getYs(), graph.getPointCount());
             ImPlot::PopStyleColor();
         }
 
         // Hover detection for tooltips
         if (ImPlot::IsPlotHovered()) {
             ImPlotPoint mouse_pos = ImPlot::GetPlotMousePos();
-            double mouse_gb = mouse_pos.x;
-
-            // Find which tensor mouse is over
-            for (const auto& tensor : memoryMap.tensors) {
-                double start_gb = tensor.offset_start / (1024.0 * 1024.0 * 1024.0);
-                double end_gb = tensor.offset_end / (1024.0 * 1024.0 * 1024.0);
-                if (mouse_gb >= start_gb && mouse_gb <= end_gb) {
-                    hovered_tensor = &tensor;
-                    break;
+
+            // Find which tensor mouse is over (binary search by offset)
+            if (mouse_pos.x >= 0.0) {
+                uint32_t index = tensorIndex.findAt(static_cast<uint64_t>(mouse_pos.x * bytesPerGB));
+                if (index != TensorIndex::NO_TENSOR) {
+                    hovered_tensor = &memoryMap.tensors[index];
                 }
             }
         }
@@ -110,10 +139,9 @@ void renderAccumulatedGraph(const MemoryMap& memoryMap,
                     hovered_tensor->offset_end / (1024.0 * 1024.0 * 1024.0));
 
         // Accumulated access count
-        auto it = accumulatedCounts.find(hovered_tensor->name);
-        if (it != accumulatedCounts.end() && it->second > 0) {
+        uint32_t count = accumulatedCounts[hovered_tensor - memoryMap.tensors.data()];
+        if (count > 0) {
             ImGui::Separator();
-            uint32_t count = it->second;
             float intensity = static_cast<float>(count) / static_cast<float>(maxCount);
             ImGui::Text("Total Accesses: %u (%.1f%% of max)", count, intensity * 100.0f);
             ImGui::ProgressBar(intensity, ImVec2(-1, 0), "");
@@ -126,21 +154,170 @@ void renderAccumulatedGraph(const MemoryMap& memoryMap,
     }
 }
 
+// Per-domain UI state (one tab per domain directory)
+struct DomainView {
+    bool memoryMapLoaded = false;
+    bool accumulatedReady = false;
+    int currentTokenId = 0;
+    int prevTokenId = -1;
+
+    TraceTableView traceTableView;
+    HeatmapView heatmapView;
+    StepGraph accumulatedGraph;
+    CacheSimView cacheSimView;
+    ReuseView reuseView;
+    ExpertPredictionView expertPredictionView;
+    LayoutView layoutView;
+};
+
+// --headless: load every domain, write figures + summaries, never touch GLFW
+int runHeadless(const std::vector<std::string>& domainPaths, const std::string& modelPath,
+                const HeadlessOptions& options) {
+    ThreadPool pool;
+    Workspace workspace(pool);
+    workspace.setModelPath(modelPath);
+    for (const std::string& path : domainPaths) {
+        workspace.addDomain(path);
+    }
+    for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+        workspace.getDomain(d).wait();
+    }
+
+    // Routing analytics span every domain, so they are built once up front
+    ExpertCube expertCube;
+    if (options.experts) {
+        std::vector<const ExpertRouting*> routings;
+        for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+            routings.push_back(&workspace.getDomain(d).getExpertRouting());
+        }
+        expertCube.build(routings);
+    }
+
+    // One task per domain; images and summaries are independent
+    HeadlessReport report(options);
+    std::atomic<size_t> failures{0};
+    for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+        pool.submit([&, d] {
+            const std::string& name = workspace.getDomainName(d);
+            if (report.writeDomain(name, domainPaths[d], workspace.getDomain(d))) {
+                std::cout << "✓ Wrote " << options.output_dir << "/" << name << std::endl;
+            } else {
+                std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+                failures++;
+            }
+            // Predictor replay is cheap, it rides along on the domain's task
+            if (options.experts) {
+                if (report.writeExperts(name, workspace.getDomain(d), expertCube.getActivity(d))) {
+                    std::cout << "✓ Wrote " << options.output_dir << "/" << name << "/experts.json" << std::endl;
+                } else {
+                    std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+                    failures++;
+                }
+            }
+        });
+    }
+    pool.waitIdle();
+
+    if (options.experts) {
+        std::vector<std::string> names;
+        for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+            names.push_back(workspace.getDomainName(d));
+        }
+        if (report.writeExpertSimilarity(names, expertCube)) {
+            std::cout << "✓ Wrote " << options.output_dir << "/expert-similarity.json" << std::endl;
+        } else {
+            std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+            failures++;
+        }
+    }
+
+    // Analyses fan out over the pool themselves, so domains go one at a time
+    if (options.reuse) {
+        for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+            const std::string& name = workspace.getDomainName(d);
+            ReuseAnalysis analysis(pool);
+            analysis.start(workspace.getDomain(d));
+            analysis.wait();
+            if (report.writeReuse(name, analysis)) {
+                std::cout << "✓ Wrote " << options.output_dir << "/" << name << "/reuse.json" << std::endl;
+            } else {
+                std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    if (options.layout) {
+        for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+            const std::string& name = workspace.getDomainName(d);
+            LayoutOptimizer optimizer(pool);
+            optimizer.start(workspace.getDomain(d), LayoutConfig());
+            optimizer.wait();
+            if (report.writeLayout(name, workspace.getDomain(d), optimizer)) {
+                std::cout << "✓ Wrote " << options.output_dir << "/" << name << "/layout.json" << std::endl;
+            } else {
+                std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    if (options.cache_sim) {
+        for (size_t d = 0; d < workspace.getDomainCount(); d++) {
+            const std::string& name = workspace.getDomainName(d);
+            CacheSimulation simulation(pool);
+            simulation.start(workspace.getDomain(d), CacheSimConfig());
+            simulation.wait();
+            if (report.writeCacheSim(name, simulation)) {
+                std::cout << "✓ Wrote " << options.output_dir << "/" << name << "/cache-sim.json ("
+                          << simulation.getResults().size() << " runs)" << std::endl;
+            } else {
+                std::cerr << "Error: " << HeadlessReport::getLastError() << std::endl;
+                failures++;
+            }
+        }
+    }
+
+    return failures.load() == 0 ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
     // Check command-line arguments
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <domain-path>" << std::endl;
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    std::string modelPath;
+    std::vector<std::string> domainPaths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--model" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            headlessOptions.output_dir = argv[++i];
+        } else if (arg == "--cache-sim") {
+            headlessOptions.cache_sim = true;
+        } else if (arg == "--reuse") {
+            headlessOptions.reuse = true;
+        } else if (arg == "--experts") {
+            headlessOptions.experts = true;
+        } else if (arg == "--layout") {
+            headlessOptions.layout = true;
+        } else if (arg == "--width" && i + 1 < argc) {
+            headlessOptions.width = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            domainPaths.push_back(arg);
+        }
+    }
+
+    if (domainPaths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--model <file.gguf>] [--headless [--out <dir>] [--width <pixels>] [--cache-sim] [--reuse] [--experts] [--layout]] <domain-path> [<domain-path> ...]" << std::endl;
         std::cerr << "Example: " << argv[0] << " ../expert-analysis-2026-01-26/domain-1-code" << std::endl;
         return 1;
     }
 
-    std::string domainPath = argv[1];
-    std::string domainName = domainPath;
-
-    // Extract domain name from path (e.g., "domain-1-code")
-    size_t lastSlash = domainPath.find_last_of("/\\");
-    if (lastSlash != std::string::npos) {
-        domainName = domainPath.substr(lastSlash + 1);
+    if (headless) {
+        return runHeadless(domainPaths, modelPath, headlessOptions);
     }
 
     // Initialize GLFW
@@ -157,7 +334,12 @@ int main(int argc, char** argv) {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // Required on macOS
 
     // Create window with domain name in title
-    std::string windowTitle = "Tensor Trace Analyzer - " + domainName;
+    std::string windowTitle = "Tensor Trace Analyzer - ";
+    if (domainPaths.size() == 1) {
+        windowTitle += Workspace::domainNameFromPath(domainPaths[0]);
+    } else {
+        windowTitle += std::to_string(domainPaths.size()) + " domains";
+    }
     GLFWwindow* window = glfwCreateWindow(1280, 720, windowTitle.c_str(), nullptr, nullptr);
     if (window == nullptr) {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -181,6 +363,7 @@ int main(int argc, char** argv) {
     io.ConfigFlags &= ~ImGuiConfigFlags_DockingEnable;
 
     // Setup Platform/Renderer backends
+    installRedrawCallbacks(window);
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
@@ -191,116 +374,131 @@ int main(int argc, char** argv) {
     std::cout << "Press ESC or close window to exit" << std::endl;
     std::cout << std::endl;
 
-    // Load data files
-    std::cout << "Loading domain data from: " << domainPath << std::endl;
-
-    MemoryMap memoryMap;
-    std::vector<TraceData> allTokens;
-    bool memoryMapLoaded = false;
-
-    // Load memory map (same for all tokens)
-    std::string memoryMapPath = domainPath + "/memory-map.json";
-    if (JSONLoader::loadMemoryMap(memoryMapPath, memoryMap)) {
-        memoryMapLoaded = true;
-        std::cout << "✓ Loaded memory map: " << memoryMap.tensors.size() << " tensors" << std::endl;
-    } else {
-        std::cerr << "Failed to load memory map: " << JSONLoader::getLastError() << std::endl;
+    // Load every domain in the background on one pool, sharing the memory map
+    ThreadPool loaderPool;
+    Workspace workspace(loaderPool);
+    workspace.setModelPath(modelPath);
+    workspace.setProgressCallback([] {
+        requestRedraw();
+        glfwPostEmptyEvent();  // Wake the main loop from its idle wait
+    });
+
+    std::vector<std::unique_ptr<DomainView>> views;
+    for (const std::string& path : domainPaths) {
+        workspace.addDomain(path);
+        views.push_back(std::make_unique<DomainView>());
+        auto wake = [] {
+            requestRedraw();
+            glfwPostEmptyEvent();
+        };
+        views.back()->cacheSimView.setProgressCallback(wake);
+        views.back()->reuseView.setProgressCallback(wake);
+        views.back()->layoutView.setProgressCallback(wake);
     }
+    size_t activeDomain = 0;
 
-    // Load all 100 token traces
-    std::cout << "Loading 100 token traces..." << std::endl;
-    allTokens.reserve(100);
-
-    for (int tokenId = 0; tokenId < 100; tokenId++) {
-        char tokenPath[512];
-        snprintf(tokenPath, sizeof(tokenPath), "%s/traces/token-%05d.json", domainPath.c_str(), tokenId);
-
-        TraceData tokenData;
-        if (JSONLoader::loadTraceData(tokenPath, tokenData)) {
-            allTokens.push_back(std::move(tokenData));
+    // Expert routing cube over every domain, rebuilt as domains finish
+    ExpertCube expertCube;
+    ExpertCubeView expertCubeView;
+    size_t expertCubeFinished = 0;
 
-            if ((tokenId + 1) % 10 == 0) {
-                std::cout << "  Loaded " << (tokenId + 1) << "/100 tokens..." << std::endl;
-            }
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        // Poll while frames are owed, otherwise sleep until input or loader progress
+        if (framesToDraw.load(std::memory_order_relaxed) > 0) {
+            glfwPollEvents();
         } else {
-            std::cerr << "Warning: Failed to load token " << tokenId << ": " << JSONLoader::getLastError() << std::endl;
+            glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
         }
-    }
-
-    std::cout << "✓ Loaded " << allTokens.size() << " tokens" << std::endl;
-    std::cout << std::endl;
-
-    bool dataLoaded = memoryMapLoaded && !allTokens.empty();
-
-    // Token selection state
-    int currentTokenId = 0;
-    int prevTokenId = -1;
 
-    // Create views
-    TraceTableView traceTableView;
-    HeatmapView heatmapView;
+        // Nothing changed: skip the frame (a focused text field still blinks)
+        if (framesToDraw.load(std::memory_order_relaxed) <= 0 && !io.WantTextInput) {
+            continue;
+        }
 
-    // Set memory map
-    if (memoryMapLoaded) {
-        heatmapView.setMemoryMap(&memoryMap);
-    }
+        // Pick up results from the loaders (aggregates are summed on the workers)
+        for (size_t d = 0; d < views.size(); d++) {
+            DomainLoader& domain = workspace.getDomain(d);
+            DomainView& domainView = *views[d];
 
-    // Calculate accumulated access counts across all tokens
-    std::map<std::string, uint32_t> accumulatedCounts;
-    uint32_t maxAccumulatedCount = 0;
+            if (!domainView.memoryMapLoaded && domain.isMemoryMapReady()) {
+                domainView.memoryMapLoaded = true;
+                domainView.heatmapView.setMemoryMap(&domain.getMemoryMap(), &domain.getTensorIndex());
+            }
 
-    if (dataLoaded) {
-        std::cout << "Calculating accumulated access counts..." << std::endl;
-        for (const auto& tensor : memoryMap.tensors) {
-            accumulatedCounts[tensor.name] = 0;
-        }
+            if (!domainView.accumulatedReady && domain.isFinished() && domainView.memoryMapLoaded) {
+                domainView.accumulatedReady = true;
+                domainView.accumulatedGraph.invalidate();
+                if (!domainView.layoutView.getDisplayedMap()) {
+                    domainView.heatmapView.setResidency(&domain.getResidency());
+                }
+                std::cout << "✓ " << workspace.getDomainName(d) << ": accumulated counts ready. Max: "
+                          << domain.getMaxAccumulatedCount() << std::endl;
+            }
 
-        for (const auto& tokenData : allTokens) {
-            for (const auto& entry : tokenData.entries) {
-                for (const auto& source : entry.sources) {
-                    if (source.memory_source != "DISK") continue;
-
-                    bool is_expert = source.name.find("_exps.weight") != std::string::npos ||
-                                    source.name.find("_exps.bias") != std::string::npos;
-
-                    if (is_expert && !entry.expert_ids.empty()) {
-                        size_t top_k = std::min(size_t(4), entry.expert_ids.size());
-                        for (size_t i = 0; i < top_k; i++) {
-                            std::string expertName = source.name + "[" + std::to_string(entry.expert_ids[i]) + "]";
-                            accumulatedCounts[expertName]++;
-                        }
-                    } else {
-                        accumulatedCounts[source.name]++;
-                    }
+            // Heatmaps follow the layout picked in the Tensor Layout panel
+            if (domainView.layoutView.consumeDisplayChange()) {
+                const MemoryMap* map = domainView.layoutView.getDisplayedMap();
+                // Residency was sampled on the file as recorded, so it only lines up with that layout
+                if (map) {
+                    domainView.heatmapView.setMemoryMap(map, domainView.layoutView.getDisplayedIndex());
+                    domainView.heatmapView.setResidency(nullptr);
+                } else {
+                    domainView.heatmapView.setMemoryMap(&domain.getMemoryMap(), &domain.getTensorIndex());
+                    domainView.heatmapView.setResidency(domain.isFinished() ? &domain.getResidency() : nullptr);
                 }
+                domainView.accumulatedGraph.invalidate();
             }
         }
 
-        for (const auto& pair : accumulatedCounts) {
-            if (pair.second > maxAccumulatedCount) {
-                maxAccumulatedCount = pair.second;
+        // Cross-domain routing analytics take milliseconds, so rebuild on the UI thread
+        size_t finishedDomains = 0;
+        for (size_t d = 0; d < views.size(); d++) {
+            finishedDomains += workspace.getDomain(d).isFinished() ? 1 : 0;
+        }
+        if (finishedDomains != expertCubeFinished) {
+            std::vector<const ExpertRouting*> routings;
+            for (size_t d = 0; d < views.size(); d++) {
+                const DomainLoader& domain = workspace.getDomain(d);
+                routings.push_back(domain.isFinished() ? &domain.getExpertRouting() : nullptr);
             }
+            expertCube.build(routings);
+            expertCubeFinished = finishedDomains;
         }
-        std::cout << "✓ Accumulated counts calculated. Max: " << maxAccumulatedCount << std::endl;
-    }
-
-    // Main loop
-    while (!glfwWindowShouldClose(window)) {
-        // Poll events
-        glfwPollEvents();
 
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        // Token selector bar (fullscreen at top)
+        // Token selector bar (fullscreen at top, domain tabs above it when several are open)
+        const bool showTabs = views.size() > 1;
+        const float selectorHeight = showTabs ? 85.0f : 60.0f;
         ImGui::SetNextWindowPos(ImVec2(0, 0));
-        ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x, 60));
+        ImGui::SetNextWindowSize(ImVec2(io.DisplaySize.x, selectorHeight));
         ImGui::Begin("Token Selector", nullptr,
                      ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
                      ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
 
+        if (showTabs && ImGui::BeginTabBar("##domains")) {
+            for (size_t d = 0; d < views.size(); d++) {
+                if (ImGui::BeginTabItem(workspace.getDomainName(d).c_str())) {
+                    activeDomain = d;
+                    ImGui::EndTabItem();
+                }
+            }
+            ImGui::EndTabBar();
+        }
+
+        // Only the active domain is drawn
+        DomainLoader& loader = workspace.getDomain(activeDomain);
+        DomainView& view = *views[activeDomain];
+        int& currentTokenId = view.currentTokenId;
+
+        const int tokenCount = static_cast<int>(loader.getTokenCount());
+        bool tokenReady = currentTokenId < tokenCount && loader.isTokenReady(currentTokenId);
+        bool dataLoaded = view.memoryMapLoaded && tokenReady;
+
         ImGui::Text("Token Selector:");
         ImGui::SameLine();
 
@@ -312,31 +510,41 @@ int main(int argc, char** argv) {
 
         // Token slider
         ImGui::PushItemWidth(400);
-        ImGui::SliderInt("##token", &currentTokenId, 0, (int)allTokens.size() - 1);
+        ImGui::SliderInt("##token", &currentTokenId, 0, std::max(tokenCount - 1, 0));
         ImGui::PopItemWidth();
         ImGui::SameLine();
 
         // Next button
-        if (ImGui::Button("Next >>") && currentTokenId < (int)allTokens.size() - 1) {
+        if (ImGui::Button("Next >>") && currentTokenId < tokenCount - 1) {
             currentTokenId++;
         }
         ImGui::SameLine();
 
-        ImGui::Text("Token %d / %zu", currentTokenId, allTokens.size());
+        ImGui::Text("Token %d / %d", currentTokenId, tokenCount);
+
+        // Loading progress (tokens can be browsed as soon as they are decoded)
+        if (!loader.isFinished()) {
+            ImGui::SameLine();
+            char progressLabel[64];
+            snprintf(progressLabel, sizeof(progressLabel), "Loading %zu / %d",
+                     loader.getLoadedCount() + loader.getFailedCount(), tokenCount);
+            ImGui::ProgressBar(loader.getProgress(), ImVec2(200, 0), progressLabel);
+        }
+
         ImGui::SameLine(io.DisplaySize.x - 150);
         ImGui::Text("FPS: %.1f", io.Framerate);
 
         ImGui::End();
 
         // Update views when token changes
-        if (dataLoaded && currentTokenId != prevTokenId && currentTokenId < (int)allTokens.size()) {
-            heatmapView.setTraceData(&allTokens[currentTokenId]);
-            traceTableView.setTraceData(&allTokens[currentTokenId]);
-            prevTokenId = currentTokenId;
+        if (dataLoaded && currentTokenId != view.prevTokenId) {
+            view.heatmapView.setTraceData(&loader.getToken(currentTokenId));
+            view.traceTableView.setTraceData(&loader.getToken(currentTokenId));
+            view.prevTokenId = currentTokenId;
         }
 
         // 50/50 Split Layout (Trace Table left | Heatmap right)
-        float split_y = 60.0f;  // Below token selector
+        float split_y = selectorHeight;  // Below token selector
         float split_width = io.DisplaySize.x * 0.5f;
 
         // Left: Trace Table (50%)
@@ -347,7 +555,11 @@ int main(int argc, char** argv) {
                      ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
 
         if (dataLoaded) {
-            traceTableView.render();
+            view.traceTableView.render();
+        } else if (loader.hasMemoryMapFailed()) {
+            ImGui::Text("Failed to load memory map: %s/memory-map.json", domainPaths[activeDomain].c_str());
+        } else {
+            ImGui::Text("Token %d is still loading...", currentTokenId);
         }
 
         ImGui::End();
@@ -360,10 +572,26 @@ int main(int argc, char** argv) {
                      ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
 
         if (dataLoaded) {
-            heatmapView.render();
+            view.heatmapView.render();
 
             // Accumulated graph below heatmap
-            renderAccumulatedGraph(memoryMap, accumulatedCounts, maxAccumulatedCount);
+            if (view.accumulatedReady) {
+                const MemoryMap* layoutMap = view.layoutView.getDisplayedMap();
+                renderAccumulatedGraph(layoutMap ? *layoutMap : loader.getMemoryMap(),
+                                       layoutMap ? *view.layoutView.getDisplayedIndex() : loader.getTensorIndex(),
+                                       loader.getAccumulatedCounts(), loader.getMaxAccumulatedCount(),
+                                       loader.getLoadedCount(), view.accumulatedGraph);
+            } else {
+                ImGui::Separator();
+                ImGui::Text("Accumulated Access Pattern: waiting for all tokens to load...");
+            }
+
+            ImGui::Separator();
+            view.cacheSimView.render(loader, loaderPool);
+            view.reuseView.render(loader, loaderPool, currentTokenId);
+            view.expertPredictionView.render(loader);
+            view.layoutView.render(loader, loaderPool);
+            expertCubeView.render(expertCube, workspace, activeDomain, currentTokenId);
         }
 
         ImGui::End();
@@ -378,9 +606,19 @@ int main(int argc, char** argv) {
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
         glfwSwapBuffers(window);
+
+        // Keep drawing while a widget is held (drags, sliders); otherwise wind down
+        if (ImGui::IsAnyItemActive()) {
+            requestRedraw();
+        } else if (framesToDraw.load(std::memory_order_relaxed) > 0) {
+            framesToDraw.fetch_sub(1, std::memory_order_relaxed);
+        }
     }
 
-    // Cleanup
+    // Cleanup; loads and analyses still running would post to a terminated GLFW,
+    // so ask them to stop early rather than finish every queued replay
+    loaderPool.cancel();
+    loaderPool.waitIdle();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImPlot::DestroyContext();
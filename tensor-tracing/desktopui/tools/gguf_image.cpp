@@ -0,0 +1,240 @@
+// gguf-image: synthetic stand-in for a model file, laid out like its memory map
+//
+// Every tensor of the memory map sits at the same offset with the same size,
+// so I/O replays of a trace behave as against the real model without needing
+// it. Data is either fast pseudo-random bytes (written in parallel, one
+// pwrite per chunk, deterministic for a given seed) or left sparse. --scale N
+// shrinks every offset and size by N for dev boxes and automated tests, and
+// the matching memory map is written next to the image. A .gguf source keeps
+// its header bytes in an unscaled image, so the result is a valid GGUF with
+// meaningless weights.
+
+#include "FileUtil.h"
+#include "GGUFFile.h"
+#include "JSONLoader.h"
+#include "MemoryMapCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint64_t CHUNK_BYTES = 64 * 1024 * 1024;
+constexpr size_t BUFFER_ALIGNMENT = 4096;
+
+enum class FillMode {
+    Random,      // Pseudo-random bytes, every block written
+    Allocated,   // Blocks reserved with fallocate, never written (reads as zeros)
+    Sparse,      // One hole (reads as zeros, no blocks behind it)
+};
+
+bool fillModeFromName(const std::string& name, FillMode& out_mode) {
+    if (name == "random") {
+        out_mode = FillMode::Random;
+    } else if (name == "allocated") {
+        out_mode = FillMode::Allocated;
+    } else if (name == "sparse") {
+        out_mode = FillMode::Sparse;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// splitmix64 seeds, xorshift64* fills: several GB/s per thread
+void fillRandom(uint64_t* words, size_t count, uint64_t seed) {
+    uint64_t state = seed + 0x9E3779B97F4A7C15ull;
+    state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ull;
+    state = (state ^ (state >> 27)) * 0x94D049BB133111EBull;
+    state ^= state >> 31;
+    state |= 1;
+    for (size_t i = 0; i < count; i++) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        words[i] = state * 0x2545F4914F6CDD1Dull;
+    }
+}
+
+// Offsets and sizes divided by scale (rounded up), kept in order and non-overlapping
+void scaleMemoryMap(const MemoryMap& map, uint64_t scale, MemoryMap& out) {
+    out = map;
+    std::stable_sort(out.tensors.begin(), out.tensors.end(), [](const MemoryTensor& a, const MemoryTensor& b) {
+        return a.offset_start < b.offset_start;
+    });
+    uint64_t previous_end = 0;
+    out.total_size_bytes = 0;
+    for (MemoryTensor& tensor : out.tensors) {
+        tensor.offset_start = std::max((tensor.offset_start + scale - 1) / scale, previous_end);
+        tensor.size_bytes = (tensor.size_bytes + scale - 1) / scale;
+        tensor.offset_end = tensor.offset_start + tensor.size_bytes;
+        previous_end = tensor.offset_end;
+        out.total_size_bytes = std::max(out.total_size_bytes, tensor.offset_end);
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--fill random|allocated|sparse] [--scale <N>] [--seed <N>]"
+              << " [--threads <N>] [--memory-map <out.json>] <memory-map.json|model.gguf> <out.img>" << std::endl;
+    std::cerr << "Example: " << program << " --scale 16 ../expert-analysis-2026-01-26/domain-1-code/memory-map.json"
+              << " /tmp/gpt-oss-20b.img" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    FillMode mode = FillMode::Random;
+    uint64_t scale = 1;
+    uint64_t seed = 1;
+    size_t threads = 0;
+    std::string memory_map_path;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--fill" && i + 1 < argc) {
+            if (!fillModeFromName(argv[++i], mode)) {
+                std::cerr << "Error: unknown fill mode " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--scale" && i + 1 < argc) {
+            scale = std::max<uint64_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<size_t>(std::max(std::atoi(argv[++i]), 0));
+        } else if (arg == "--memory-map" && i + 1 < argc) {
+            memory_map_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::string& source_path = paths[0];
+    const std::string& out_path = paths[1];
+    if (memory_map_path.empty()) {
+        const size_t dot = out_path.rfind('.');
+        const size_t slash = out_path.rfind('/');
+        const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        memory_map_path = (has_extension ? out_path.substr(0, dot) : out_path) + ".memory-map.json";
+    }
+
+    MemoryMapCache memory_maps;
+    std::shared_ptr<const SharedMemoryMap> source = memory_maps.acquire(source_path);
+    if (!source->ok) {
+        std::cerr << "Error: " << source->error << std::endl;
+        return 1;
+    }
+    MemoryMap map;
+    scaleMemoryMap(source->map, scale, map);
+    const uint64_t total = map.total_size_bytes;
+
+    int fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: failed to create " << out_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        std::cerr << "Error: failed to size " << out_path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    std::string error;
+    if (mode == FillMode::Allocated || mode == FillMode::Random) {
+        // Reserve every block up front: one extent instead of per-chunk growth
+#ifdef __linux__
+        int result = posix_fallocate(fd, 0, static_cast<off_t>(total));
+#else
+        int result = ENOTSUP;
+#endif
+        if (result != 0 && mode == FillMode::Allocated) {
+            error = std::string("posix_fallocate: ") + std::strerror(result);
+        }
+    }
+
+    if (mode == FillMode::Random && error.empty()) {
+        ThreadPool pool(threads);
+        std::atomic<bool> failed{false};
+        std::string first_error;
+        std::mutex error_mutex;
+        const uint64_t chunks = (total + CHUNK_BYTES - 1) / CHUNK_BYTES;
+        for (uint64_t c = 0; c < chunks; c++) {
+            pool.submit([&, c] {
+                if (failed.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                const uint64_t offset = c * CHUNK_BYTES;
+                const size_t length = static_cast<size_t>(std::min(CHUNK_BYTES, total - offset));
+                void* memory = nullptr;
+                std::string chunk_error;
+                if (posix_memalign(&memory, BUFFER_ALIGNMENT, CHUNK_BYTES) != 0) {
+                    chunk_error = "Failed to allocate a fill buffer";
+                } else {
+                    std::unique_ptr<uint8_t, decltype(&std::free)> buffer(static_cast<uint8_t*>(memory), std::free);
+                    // Seeded by chunk, so the image does not depend on the thread count
+                    fillRandom(reinterpret_cast<uint64_t*>(buffer.get()), CHUNK_BYTES / sizeof(uint64_t), seed * chunks + c);
+                    if (!writeAll(fd, buffer.get(), length, offset)) {
+                        chunk_error = std::string("pwrite: ") + std::strerror(errno);
+                    }
+                }
+                if (!chunk_error.empty() && !failed.exchange(true)) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    first_error = chunk_error;
+                }
+            });
+        }
+        pool.waitIdle();
+        error = first_error;
+    }
+
+    // An unscaled image of a GGUF keeps the real header in front of the fake data
+    GGUFFile model;
+    if (error.empty() && scale == 1 && model.open(source_path)) {
+        std::vector<uint8_t> header(static_cast<size_t>(model.getDataOffset()));
+        ssize_t n = pread(model.getFd(), header.data(), header.size(), 0);
+        if (n != static_cast<ssize_t>(header.size())) {
+            error = "Failed to read the header of " + source_path;
+        } else {
+            if (!writeAll(fd, header.data(), header.size(), 0)) {
+                error = std::string("pwrite: ") + std::strerror(errno);
+            }
+        }
+    }
+
+    if (::close(fd) != 0 && error.empty()) {
+        error = std::string("close: ") + std::strerror(errno);
+    }
+    if (!error.empty()) {
+        std::cerr << "Error: failed to write " << out_path << ": " << error << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const char* fill = mode == FillMode::Random ? "random" : (mode == FillMode::Allocated ? "allocated" : "sparse");
+    std::cout << "✓ Wrote " << out_path << " (" << fill << ", 1/" << scale << " scale): " << total / 1e9 << " GB in "
+              << seconds << " s";
+    if (mode == FillMode::Random && seconds > 0.0) {
+        std::cout << ", " << total / 1e9 / seconds << " GB/s";
+    }
+    std::cout << std::endl;
+
+    if (!JSONLoader::saveMemoryMap(memory_map_path, map)) {
+        std::cerr << "Error: " << JSONLoader::getLastError() << std::endl;
+        return 1;
+    }
+    std::cout << "✓ Wrote " << memory_map_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,437 @@
+// gguf-rewrite: copy a GGUF model with its tensors in a trace-derived order
+//
+// The order comes from LayoutOptimizer run against a domain's trace, so the
+// file matches what the Tensor Layout section scored. Metadata is copied
+// verbatim, tensor infos are rewritten with new offsets (same alignment),
+// and tensor data is streamed with copy_file_range where the kernel supports
+// it, otherwise through large aligned pread/pwrite buffers. Co-activation
+// permutes the expert axis of each layer: the "_exps" tensors, their biases
+// and the router (ffn_gate_inp) rows move together, so the model computes the
+// same function with renumbered experts. A memory-map.json for the new file
+// is written next to it.
+
+#include "DomainLoader.h"
+#include "FileUtil.h"
+#include "GGUFFile.h"
+#include "JSONLoader.h"
+#include "LayoutOptimizer.h"
+#include "ThreadPool.h"
+#include "Workspace.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t COPY_BUFFER_BYTES = 16 * 1024 * 1024;
+constexpr size_t COPY_BUFFER_ALIGNMENT = 4096;
+
+// "First access" -> "first-access"
+std::string orderSlug(LayoutOrder order) {
+    std::string slug = layoutOrderName(order);
+    for (char& c : slug) {
+        c = c == ' ' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return slug;
+}
+
+bool orderFromSlug(const std::string& slug, LayoutOrder& out_order) {
+    for (size_t i = 0; i < LAYOUT_ORDER_COUNT; i++) {
+        if (slug == orderSlug(static_cast<LayoutOrder>(i))) {
+            out_order = static_cast<LayoutOrder>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Tensors indexed by expert along their last dimension
+bool isExpertIndexed(const std::string& name) {
+    return name.find("_exps.") != std::string::npos || name.find("ffn_gate_inp.") != std::string::npos;
+}
+
+// Output tensor order plus the expert permutation of each tensor
+// (permutation[g][p] = original expert stored at position p; empty keeps the order)
+struct RewritePlan {
+    std::vector<size_t> order;                       // GGUF tensor indices front to back
+    std::vector<std::vector<uint32_t>> permutation;  // By GGUF tensor index
+};
+
+bool buildPlan(const GGUFFile& model, const MemoryMap& map, const TensorLayout& layout, RewritePlan& out,
+               std::string& error) {
+    const std::vector<GGUFTensorInfo>& tensors = model.getTensors();
+    std::unordered_map<std::string, size_t> by_name;
+    for (size_t g = 0; g < tensors.size(); g++) {
+        by_name.emplace(tensors[g].name, g);
+    }
+
+    // Every memory map entry has to sit where the model file says it does
+    std::vector<size_t> gguf_of(map.tensors.size());
+    for (size_t i = 0; i < map.tensors.size(); i++) {
+        const MemoryTensor& tensor = map.tensors[i];
+        auto found = by_name.find(tensor.name.substr(0, tensor.name.find('[')));
+        if (found == by_name.end()) {
+            error = "Tensor " + tensor.name + " of the memory map is not in the model file";
+            return false;
+        }
+        const GGUFTensorInfo& info = tensors[found->second];
+        uint64_t start = model.getDataOffset() + info.offset;
+        uint64_t size = info.size_bytes;
+        if (tensor.expert_id >= 0) {
+            const uint64_t experts = info.shape.empty() ? 0 : info.shape.back();
+            if (experts == 0 || static_cast<uint64_t>(tensor.expert_id) >= experts) {
+                error = "Expert slice " + tensor.name + " is out of range of " + info.name;
+                return false;
+            }
+            size /= experts;
+            start += tensor.expert_id * size;
+        }
+        if (tensor.offset_start != start || tensor.size_bytes != size) {
+            error = "Memory map does not match the model file at " + tensor.name;
+            return false;
+        }
+        gguf_of[i] = found->second;
+    }
+
+    out.order.clear();
+    out.permutation.assign(tensors.size(), std::vector<uint32_t>());
+    std::vector<uint8_t> placed(tensors.size(), 0);
+    for (uint32_t i : layout.file_order) {
+        const size_t g = gguf_of[i];
+        if (!placed[g]) {
+            placed[g] = 1;
+            out.order.push_back(g);
+        }
+        if (map.tensors[i].expert_id >= 0) {
+            out.permutation[g].push_back(static_cast<uint32_t>(map.tensors[i].expert_id));
+        }
+    }
+
+    // Tensors the memory map leaves out keep their relative order at the end
+    std::vector<size_t> rest;
+    for (size_t g = 0; g < tensors.size(); g++) {
+        if (!placed[g]) {
+            rest.push_back(g);
+        }
+    }
+    std::sort(rest.begin(), rest.end(), [&tensors](size_t a, size_t b) { return tensors[a].offset < tensors[b].offset; });
+    out.order.insert(out.order.end(), rest.begin(), rest.end());
+
+    // One permutation per layer, shared by every expert-indexed tensor of it
+    std::unordered_map<int, std::vector<uint32_t>> layer_permutation;
+    for (size_t g = 0; g < tensors.size(); g++) {
+        std::vector<uint32_t>& permutation = out.permutation[g];
+        if (permutation.empty()) {
+            continue;
+        }
+        if (permutation.size() != tensors[g].shape.back()) {
+            error = "Memory map lists " + std::to_string(permutation.size()) + " of the experts of " + tensors[g].name;
+            return false;
+        }
+        bool identity = true;
+        for (size_t p = 0; p < permutation.size(); p++) {
+            identity = identity && permutation[p] == p;
+        }
+        if (identity) {
+            permutation.clear();
+            continue;
+        }
+        auto inserted = layer_permutation.emplace(layerOf(tensors[g].name), permutation);
+        if (!inserted.second && inserted.first->second != permutation) {
+            error = "Experts of layer " + std::to_string(inserted.first->first) + " are permuted inconsistently";
+            return false;
+        }
+    }
+    for (size_t g = 0; g < tensors.size(); g++) {
+        auto found = layer_permutation.find(layerOf(tensors[g].name));
+        if (found == layer_permutation.end() || !isExpertIndexed(tensors[g].name)) {
+            continue;
+        }
+        if (tensors[g].shape.empty() || tensors[g].shape.back() != found->second.size()) {
+            error = "Cannot permute the experts of " + tensors[g].name;
+            return false;
+        }
+        out.permutation[g] = found->second;
+    }
+    return true;
+}
+
+// Streams byte ranges between two files, in kernel when possible
+class RangeCopier {
+public:
+    RangeCopier(int in_fd, int out_fd)
+        : in_fd_(in_fd)
+        , out_fd_(out_fd)
+        , buffer_(nullptr, std::free)
+#ifdef __linux__
+        , use_copy_file_range_(true)
+#else
+        , use_copy_file_range_(false)
+#endif
+    {
+    }
+
+    bool usesCopyFileRange() const { return use_copy_file_range_; }
+
+    bool copy(uint64_t in_offset, uint64_t out_offset, uint64_t size, std::string& error) {
+#ifdef __linux__
+        while (use_copy_file_range_ && size > 0) {
+            loff_t in = static_cast<loff_t>(in_offset);
+            loff_t out = static_cast<loff_t>(out_offset);
+            ssize_t n = copy_file_range(in_fd_, &in, out_fd_, &out, static_cast<size_t>(std::min<uint64_t>(size, 1ull << 30)), 0);
+            if (n > 0) {
+                in_offset += n;
+                out_offset += n;
+                size -= n;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL)) {
+                use_copy_file_range_ = false;   // Filesystem can't; buffers from here on
+            } else {
+                error = n == 0 ? "Unexpected end of the model file" : std::string("copy_file_range: ") + std::strerror(errno);
+                return false;
+            }
+        }
+#endif
+        return copyBuffered(in_offset, out_offset, size, error);
+    }
+
+private:
+    int in_fd_;
+    int out_fd_;
+    std::unique_ptr<uint8_t, decltype(&std::free)> buffer_;
+    bool use_copy_file_range_;
+
+    bool copyBuffered(uint64_t in_offset, uint64_t out_offset, uint64_t size, std::string& error) {
+        if (size > 0 && !buffer_) {
+            void* memory = nullptr;
+            if (posix_memalign(&memory, COPY_BUFFER_ALIGNMENT, COPY_BUFFER_BYTES) != 0) {
+                error = "Failed to allocate the copy buffer";
+                return false;
+            }
+            buffer_.reset(static_cast<uint8_t*>(memory));
+        }
+        while (size > 0) {
+            size_t length = static_cast<size_t>(std::min<uint64_t>(size, COPY_BUFFER_BYTES));
+            ssize_t n = pread(in_fd_, buffer_.get(), length, static_cast<off_t>(in_offset));
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                error = n == 0 ? "Unexpected end of the model file" : std::string("pread: ") + std::strerror(errno);
+                return false;
+            }
+            if (!writeAll(out_fd_, buffer_.get(), static_cast<size_t>(n), out_offset)) {
+                error = std::string("pwrite: ") + std::strerror(errno);
+                return false;
+            }
+            in_offset += n;
+            out_offset += n;
+            size -= n;
+        }
+        return true;
+    }
+};
+
+// Memory map of the rewritten file: same entries at their new offsets,
+// expert slices renamed after the position they now hold
+void remapMemoryMap(const MemoryMap& map, const GGUFFile& model, const RewritePlan& plan,
+                    const std::vector<GGUFTensorInfo>& infos, uint64_t data_offset, MemoryMap& out) {
+    const std::vector<GGUFTensorInfo>& tensors = model.getTensors();
+    std::unordered_map<std::string, size_t> by_name;
+    for (size_t g = 0; g < tensors.size(); g++) {
+        by_name.emplace(tensors[g].name, g);
+    }
+    std::vector<size_t> position(tensors.size());
+    for (size_t p = 0; p < plan.order.size(); p++) {
+        position[plan.order[p]] = p;
+    }
+
+    out = map;
+    out.total_size_bytes = 0;
+    for (MemoryTensor& tensor : out.tensors) {
+        const std::string base = tensor.name.substr(0, tensor.name.find('['));
+        const size_t g = by_name.at(base);
+        tensor.offset_start = data_offset + infos[position[g]].offset;
+        if (tensor.expert_id >= 0) {
+            const std::vector<uint32_t>& permutation = plan.permutation[g];
+            int slot = tensor.expert_id;
+            if (!permutation.empty()) {
+                slot = static_cast<int>(std::find(permutation.begin(), permutation.end(),
+                                                  static_cast<uint32_t>(tensor.expert_id)) - permutation.begin());
+            }
+            const std::string old_suffix = "Expert " + std::to_string(tensor.expert_id);
+            const size_t suffix = tensor.component_type.rfind(old_suffix);
+            if (suffix != std::string::npos && suffix + old_suffix.size() == tensor.component_type.size()) {
+                tensor.component_type = tensor.component_type.substr(0, suffix) + "Expert " + std::to_string(slot);
+            }
+            tensor.name = base + "[" + std::to_string(slot) + "]";
+            tensor.expert_id = slot;
+            tensor.offset_start += static_cast<uint64_t>(slot) * tensor.size_bytes;
+        }
+        tensor.offset_end = tensor.offset_start + tensor.size_bytes;
+        out.total_size_bytes = std::max(out.total_size_bytes, tensor.offset_end);
+    }
+    std::stable_sort(out.tensors.begin(), out.tensors.end(), [](const MemoryTensor& a, const MemoryTensor& b) {
+        return a.offset_start < b.offset_start;
+    });
+}
+
+void printUsage(const char* program) {
+    std::string orders;
+    for (size_t i = 0; i < LAYOUT_ORDER_COUNT; i++) {
+        orders += (i == 0 ? "" : "|") + orderSlug(static_cast<LayoutOrder>(i));
+    }
+    std::cerr << "Usage: " << program << " --order <" << orders << "> [--memory-map <out.json>]"
+              << " <model.gguf> <domain-path> <out.gguf>" << std::endl;
+    std::cerr << "Example: " << program << " --order co-activation gpt-oss-20b-F16.gguf"
+              << " ../expert-analysis-2026-01-26/domain-1-code gpt-oss-20b-F16.coact.gguf" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    LayoutOrder order = LayoutOrder::LayerMajor;
+    bool order_set = false;
+    std::string memory_map_path;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--order" && i + 1 < argc) {
+            order_set = orderFromSlug(argv[++i], order);
+            if (!order_set) {
+                std::cerr << "Error: unknown order " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--memory-map" && i + 1 < argc) {
+            memory_map_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (!order_set || paths.size() != 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::string& model_path = paths[0];
+    const std::string& domain_path = paths[1];
+    const std::string& out_path = paths[2];
+    if (memory_map_path.empty()) {
+        const size_t dot = out_path.rfind(".gguf");
+        memory_map_path = (dot != std::string::npos ? out_path.substr(0, dot) : out_path) + ".memory-map.json";
+    }
+
+    GGUFFile model;
+    if (!model.open(model_path)) {
+        std::cerr << "Error: " << model.getLastError() << std::endl;
+        return 1;
+    }
+    std::cout << "✓ Read GGUF header: " << model.getTensors().size() << " tensors, "
+              << model.getMetadata().size() << " metadata keys, alignment " << model.getAlignment() << std::endl;
+
+    ThreadPool pool;
+    Workspace workspace(pool);
+    DomainLoader& loader = workspace.getDomain(workspace.addDomain(domain_path));
+    loader.wait();
+    if (!loader.isMemoryMapReady()) {
+        std::cerr << "Error: no memory map for " << domain_path << std::endl;
+        return 1;
+    }
+
+    LayoutConfig config;
+    config.alignment = model.getAlignment();
+    TensorLayout layout;
+    LayoutOptimizer::optimize(loader, order, config, layout);
+
+    RewritePlan plan;
+    std::string error;
+    if (!buildPlan(model, loader.getMemoryMap(), layout, plan, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return 1;
+    }
+
+    // New tensor infos, repacked from the start of the data section
+    std::vector<GGUFTensorInfo> infos;
+    uint64_t cursor = 0;
+    for (size_t g : plan.order) {
+        GGUFTensorInfo info = model.getTensors()[g];
+        cursor = (cursor + model.getAlignment() - 1) / model.getAlignment() * model.getAlignment();
+        info.offset = cursor;
+        cursor += info.size_bytes;
+        infos.push_back(std::move(info));
+    }
+    std::vector<uint8_t> header;
+    uint64_t data_offset = 0;
+    if (!model.buildHeader(infos, header, data_offset)) {
+        std::cerr << "Error: " << model.getLastError() << std::endl;
+        return 1;
+    }
+
+    int out_fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        std::cerr << "Error: failed to create " << out_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    // Sized up front so alignment padding stays a hole
+    if (ftruncate(out_fd, static_cast<off_t>(data_offset + cursor)) != 0 ||
+        !writeAll(out_fd, header.data(), header.size(), 0)) {
+        std::cerr << "Error: failed to write " << out_path << ": " << std::strerror(errno) << std::endl;
+        ::close(out_fd);
+        return 1;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    RangeCopier copier(model.getFd(), out_fd);
+    uint64_t copied = 0;
+    size_t permuted = 0;
+    for (size_t p = 0; p < plan.order.size() && error.empty(); p++) {
+        const GGUFTensorInfo& source = model.getTensors()[plan.order[p]];
+        const uint64_t from = model.getDataOffset() + source.offset;
+        const uint64_t to = data_offset + infos[p].offset;
+        const std::vector<uint32_t>& permutation = plan.permutation[plan.order[p]];
+        if (permutation.empty()) {
+            copier.copy(from, to, source.size_bytes, error);
+        } else {
+            // Expert e of the source is a contiguous run along the last dimension
+            const uint64_t slice = source.size_bytes / permutation.size();
+            for (size_t slot = 0; slot < permutation.size() && error.empty(); slot++) {
+                copier.copy(from + permutation[slot] * slice, to + slot * slice, slice, error);
+            }
+            permuted++;
+        }
+        copied += source.size_bytes;
+    }
+    if (::close(out_fd) != 0 && error.empty()) {
+        error = std::string("close: ") + std::strerror(errno);
+    }
+    if (!error.empty()) {
+        std::cerr << "Error: failed to write " << out_path << ": " << error << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "✓ Wrote " << out_path << " (" << orderSlug(order) << "): " << copied / 1e9 << " GB in "
+              << seconds << " s, " << (seconds > 0.0 ? copied / 1e9 / seconds : 0.0) << " GB/s"
+              << (copier.usesCopyFileRange() ? " (copy_file_range)" : " (buffered)") << std::endl;
+    if (permuted > 0) {
+        std::cout << "  Expert axis permuted in " << permuted << " tensors" << std::endl;
+    }
+
+    MemoryMap new_map;
+    remapMemoryMap(loader.getMemoryMap(), model, plan, infos, data_offset, new_map);
+    if (!JSONLoader::saveMemoryMap(memory_map_path, new_map)) {
+        std::cerr << "Error: " << JSONLoader::getLastError() << std::endl;
+        return 1;
+    }
+    std::cout << "✓ Wrote " << memory_map_path << std::endl;
+    return 0;
+}
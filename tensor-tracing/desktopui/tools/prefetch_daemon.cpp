@@ -0,0 +1,331 @@
+// prefetch-daemon: read the model file ahead of a running inference
+//
+// The schedule (what each layer reads, plus a hot expert set per layer) is
+// built from a recorded domain or loaded from a saved JSON. Progress comes
+// from the tracer's tensor_trace.bin, tailed while llama.cpp writes it, or
+// from a datagram socket (see PrefetchProgress.h); prefetch-driver stands in
+// for llama.cpp in both modes. Every reached layer prefetches the next
+// --lookahead steps with fadvise, readahead or io_uring, within a budget of
+// bytes in flight, and the daemon logs how much of what the inference needed
+// was resident in time (hits), still on its way (late), not prefetched
+// (missed), and what was prefetched for nothing (wasted).
+
+#include "ByteSize.h"
+#include "DomainLoader.h"
+#include "PrefetchProgress.h"
+#include "PrefetchSchedule.h"
+#include "Prefetcher.h"
+#include "ThreadPool.h"
+#include "Workspace.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+// "Previous token" -> "previous-token"
+std::string predictorSlug(ExpertPredictorKind kind) {
+    std::string slug = expertPredictorName(kind);
+    for (char& c : slug) {
+        c = c == ' ' ? '-' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return slug;
+}
+
+bool expertSourceFromName(const std::string& name, PrefetchConfig& config) {
+    if (name == "none") {
+        config.experts = ExpertSource::None;
+        return true;
+    }
+    if (name == "hot") {
+        config.experts = ExpertSource::Schedule;
+        return true;
+    }
+    for (size_t i = 0; i < EXPERT_PREDICTOR_COUNT; i++) {
+        if (name == predictorSlug(static_cast<ExpertPredictorKind>(i))) {
+            config.experts = ExpertSource::Predictor;
+            config.predictor = static_cast<ExpertPredictorKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string expertSourceName(const PrefetchConfig& config) {
+    switch (config.experts) {
+        case ExpertSource::None: return "none";
+        case ExpertSource::Schedule: return "hot";
+        case ExpertSource::Predictor: return predictorSlug(config.predictor);
+    }
+    return "";
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+void printStats(const PrefetchStats& stats) {
+    std::cout << std::fixed << std::setprecision(1) << "  needed " << stats.needed / 1e6 << " MB: hits "
+              << stats.hits / 1e6 << " MB (" << percent(stats.hits, stats.needed) << "%), late " << stats.late / 1e6
+              << " MB (" << percent(stats.late, stats.needed) << "%), missed " << stats.missed / 1e6 << " MB ("
+              << percent(stats.missed, stats.needed) << "%)" << std::endl;
+    std::cout << "  issued " << stats.issued / 1e6 << " MB, wasted " << stats.wasted / 1e6 << " MB" << std::endl;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " (--domain <domain-path> [--memory-map <map.json|model.gguf>] | --schedule <schedule.json>)"
+              << " [--save-schedule <out.json>] [--trace <tensor_trace.bin> [--from-start] | --socket <path>]"
+              << " [--method fadvise|readahead|io_uring] [--lookahead <steps>] [--budget <bytes[K|M|G]>]"
+              << " [--queue-depth <N>] [--request-size <bytes[K|M]>]"
+              << " [--experts none|hot|previous-token|layer-frequency|markov] [--top-k <N>]"
+              << " [--idle-exit <s>] [--report-interval <s>] [--log <steps.csv>] [--json <stats.json>] <model-file>"
+              << std::endl;
+    std::cerr << "Example: " << program << " --domain ../expert-analysis-2026-01-26/domain-1-code"
+              << " --trace /tmp/tensor_trace.bin --lookahead 2 gpt-oss-20b-F16.gguf" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    PrefetchConfig config;
+    std::string domain_path;
+    std::string memory_map_path;
+    std::string schedule_path;
+    std::string save_schedule_path;
+    std::string trace_path;
+    std::string socket_path;
+    std::string log_path;
+    std::string json_path;
+    bool from_start = false;
+    size_t top_k = 0;
+    double idle_exit_s = 0.0;
+    double report_interval_s = 10.0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--domain" && i + 1 < argc) {
+            domain_path = argv[++i];
+        } else if (arg == "--memory-map" && i + 1 < argc) {
+            memory_map_path = argv[++i];
+        } else if (arg == "--schedule" && i + 1 < argc) {
+            schedule_path = argv[++i];
+        } else if (arg == "--save-schedule" && i + 1 < argc) {
+            save_schedule_path = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--from-start") {
+            from_start = true;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--method" && i + 1 < argc) {
+            if (!prefetchMethodFromName(argv[++i], config.method)) {
+                std::cerr << "Error: unknown method " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--lookahead" && i + 1 < argc) {
+            config.lookahead = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--budget" && i + 1 < argc) {
+            config.budget_bytes = parseBytes(argv[++i]);
+            if (config.budget_bytes == 0) {
+                std::cerr << "Error: bad budget " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--queue-depth" && i + 1 < argc) {
+            config.queue_depth = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--request-size" && i + 1 < argc) {
+            config.request_bytes = parseBytes(argv[++i]);
+            if (config.request_bytes == 0 || config.request_bytes > (1ull << 30)) {
+                std::cerr << "Error: bad request size " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--experts" && i + 1 < argc) {
+            if (!expertSourceFromName(argv[++i], config)) {
+                std::cerr << "Error: unknown expert source " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--top-k" && i + 1 < argc) {
+            top_k = static_cast<size_t>(std::max(std::atoi(argv[++i]), 0));
+        } else if (arg == "--idle-exit" && i + 1 < argc) {
+            idle_exit_s = std::atof(argv[++i]);
+        } else if (arg == "--report-interval" && i + 1 < argc) {
+            report_interval_s = std::atof(argv[++i]);
+        } else if (arg == "--log" && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    const bool has_source = !trace_path.empty() || !socket_path.empty();
+    const bool save_only = !has_source && !save_schedule_path.empty() && paths.empty();
+    if (domain_path.empty() == schedule_path.empty() || (!trace_path.empty() && !socket_path.empty()) ||
+        (!save_only && (!has_source || paths.size() != 1))) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    PrefetchSchedule schedule;
+    if (!schedule_path.empty()) {
+        if (!schedule.load(schedule_path)) {
+            std::cerr << "Error: " << schedule.getLastError() << std::endl;
+            return 1;
+        }
+    } else {
+        ThreadPool pool;
+        Workspace workspace(pool);
+        if (!memory_map_path.empty()) {
+            workspace.setModelPath(memory_map_path);
+        }
+        DomainLoader& loader = workspace.getDomain(workspace.addDomain(domain_path));
+        loader.wait();
+        if (!loader.isMemoryMapReady()) {
+            std::cerr << "Error: no memory map for " << domain_path << std::endl;
+            return 1;
+        }
+        schedule.build(loader, top_k);
+    }
+    uint64_t static_bytes = 0;
+    for (size_t s = 0; s < schedule.getStepCount(); s++) {
+        static_bytes += schedule.getStepBytes(s);
+    }
+    std::cout << "✓ Prefetch schedule: " << schedule.getLayerCount() << " layers, " << schedule.getExpertCount()
+              << " experts (top " << schedule.getTopK() << "), " << std::fixed << std::setprecision(1)
+              << static_bytes / 1e6 << " MB of non-expert tensors per token" << std::endl;
+    if (!save_schedule_path.empty()) {
+        if (!schedule.save(save_schedule_path)) {
+            std::cerr << "Error: " << schedule.getLastError() << std::endl;
+            return 1;
+        }
+        std::cout << "✓ Wrote " << save_schedule_path << std::endl;
+    }
+    if (save_only) {
+        return 0;
+    }
+
+    const std::string& model_path = paths[0];
+    Prefetcher prefetcher;
+    if (!prefetcher.open(model_path, schedule, config)) {
+        std::cerr << "Error: " << prefetcher.getLastError() << std::endl;
+        return 1;
+    }
+    if (prefetcher.getMethod() != config.method) {
+        std::cerr << "Warning: io_uring unavailable (" << prefetcher.getLastError() << "), using fadvise" << std::endl;
+    }
+
+    std::ofstream log;
+    if (!log_path.empty()) {
+        log.open(log_path);
+        if (!log) {
+            std::cerr << "Error: failed to create " << log_path << std::endl;
+            return 1;
+        }
+        log << "token,layer,needed,issued,hits,late,missed,wasted" << std::endl;
+        prefetcher.setStepCallback([&log](uint32_t token, int layer, const PrefetchStats& stats) {
+            log << token << ',' << layer << ',' << stats.needed << ',' << stats.issued << ',' << stats.hits << ','
+                << stats.late << ',' << stats.missed << ',' << stats.wasted << '\n';
+        });
+    }
+
+    std::unique_ptr<ProgressSource> source;
+    if (!socket_path.empty()) {
+        auto socket = std::make_unique<ProgressSocket>(socket_path);
+        if (!socket->bind()) {
+            std::cerr << "Error: " << socket->getLastError() << std::endl;
+            return 1;
+        }
+        source = std::move(socket);
+    } else {
+        source = std::make_unique<TraceTail>(trace_path, from_start);
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::cout << "✓ Following " << (socket_path.empty() ? trace_path : socket_path) << " ("
+              << prefetchMethodName(prefetcher.getMethod()) << ", lookahead " << config.lookahead << ", budget "
+              << config.budget_bytes / (1024 * 1024) << " MiB, experts " << expertSourceName(config) << ")"
+              << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto last_event = Clock::now();
+    auto last_report = Clock::now();
+    bool started = false;
+    bool ended = false;
+    std::vector<ProgressEvent> events;
+    while (!g_stop && !ended) {
+        events.clear();
+        if (!source->poll(prefetcher.isBusy() ? 1 : 50, events)) {
+            std::cerr << "Error: " << source->getLastError() << std::endl;
+            break;
+        }
+        for (const ProgressEvent& event : events) {
+            switch (event.kind) {
+                case ProgressEvent::Kind::Layer: prefetcher.onLayer(event.token, event.layer); break;
+                case ProgressEvent::Kind::Experts: prefetcher.onExperts(event.token, event.layer, event.experts); break;
+                case ProgressEvent::Kind::End: ended = true; break;
+            }
+        }
+        prefetcher.pump();
+
+        const auto now = Clock::now();
+        if (!events.empty()) {
+            last_event = now;
+            started = true;
+        } else if (started && idle_exit_s > 0.0 && std::chrono::duration<double>(now - last_event).count() >= idle_exit_s) {
+            break;
+        }
+        if (report_interval_s > 0.0 && std::chrono::duration<double>(now - last_report).count() >= report_interval_s) {
+            const PrefetchStats& stats = prefetcher.getStats();
+            std::cout << std::setprecision(1) << "  " << stats.steps << " steps, hits "
+                      << percent(stats.hits, stats.needed) << "%, late " << percent(stats.late, stats.needed)
+                      << "%, missed " << percent(stats.missed, stats.needed) << "%, wasted " << stats.wasted / 1e6
+                      << " MB, in flight " << prefetcher.getInFlightBytes() / 1e6 << " MB" << std::endl;
+            last_report = now;
+        }
+    }
+    prefetcher.finish();
+
+    const PrefetchStats& stats = prefetcher.getStats();
+    std::cout << "✓ Prefetched through " << stats.steps << " steps" << std::endl;
+    printStats(stats);
+    if (!json_path.empty()) {
+        json report;
+        report["model"] = model_path;
+        report["config"] = {{"method", prefetchMethodName(prefetcher.getMethod())}, {"lookahead", config.lookahead},
+                            {"budget_bytes", config.budget_bytes}, {"experts", expertSourceName(config)},
+                            {"top_k", schedule.getTopK()}};
+        report["steps"] = stats.steps;
+        report["needed_bytes"] = stats.needed;
+        report["issued_bytes"] = stats.issued;
+        report["hit_bytes"] = stats.hits;
+        report["late_bytes"] = stats.late;
+        report["missed_bytes"] = stats.missed;
+        report["wasted_bytes"] = stats.wasted;
+        report["hit_rate"] = stats.hitRate();
+        std::ofstream file(json_path);
+        if (!file) {
+            std::cerr << "Error: failed to write " << json_path << std::endl;
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+        std::cout << "✓ Wrote " << json_path << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+// prefetch-driver: stand-in for llama.cpp when testing prefetch-daemon
+//
+// Replays a domain's trace against the model file (or a gguf-image) the way
+// llama.cpp runs with mmap: entries follow each other with the trace's gaps
+// as compute time (divided by --speed), and every DISK access faults its
+// extent in from a read-only mapping, which stalls the "inference" for as
+// long as the page cache is missing it. Progress goes to the daemon's socket
+// and/or to a tensor_trace.bin written record by record like the tracer's,
+// stamped with the driver's own clock.
+// Per-token stall time is the number to compare with and without the daemon.
+
+#include "DomainLoader.h"
+#include "PrefetchProgress.h"
+#include "TensorIndex.h"
+#include "ThreadPool.h"
+#include "TraceFormat.h"
+#include "Workspace.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace {
+constexpr uint64_t TOUCH_STRIDE = 4096;
+
+// The tracer's record for entry i, numbered as the given token (no timestamp)
+void buildRecord(const TraceStore& store, size_t i, uint32_t token, TensorAccessLog& out) {
+    std::memset(&out, 0, sizeof(out));
+    out.token_id = token;
+    out.layer_id = store.layerId(i) < 0 ? TRACE_NO_LAYER : static_cast<uint16_t>(store.layerId(i));
+    out.thread_id = store.threadId(i);
+    out.operation_type = store.op(i);
+    out.phase = static_cast<uint8_t>(store.phase(i));
+    out.num_sources = static_cast<uint8_t>(store.numSources(i));
+    std::strncpy(out.dst_name, store.dstName(i).c_str(), TRACE_NAME_SIZE - 1);
+    for (size_t s = 0; s < store.numSources(i); s++) {
+        const TraceSourceInfo& info = store.source(i, s);
+        SourceTensorInfo& source = out.sources[s];
+        std::strncpy(source.name, store.sourceName(i, s).c_str(), TRACE_NAME_SIZE - 1);
+        source.tensor_ptr = info.tensor_ptr;
+        source.size_bytes = static_cast<uint32_t>(std::min<uint64_t>(info.size_bytes, UINT32_MAX));
+        source.layer_id = info.layer_id < 0 ? TRACE_NO_LAYER : static_cast<uint16_t>(info.layer_id);
+        source.memory_source = info.memory_source == MemorySource::Disk ? 0 : 1;
+        source.disk_offset_or_buffer_id = info.offset;
+        source.tensor_idx = TRACE_NO_TENSOR_IDX;
+    }
+    out.num_experts = static_cast<uint8_t>(store.numExperts(i));
+    for (size_t e = 0; e < store.numExperts(i); e++) {
+        out.expert_ids[e] = store.expertIds(i)[e] == TRACE_NO_EXPERT ? -1 : store.expertIds(i)[e];
+    }
+}
+
+// Routed experts of entry i as a mask (top-k, like ExpertRouting)
+uint64_t routedExperts(const TraceStore& store, size_t i) {
+    static const uint8_t mul_mat_id = ggmlOpFromName("MUL_MAT_ID");
+    uint64_t mask = 0;
+    if (store.op(i) == mul_mat_id) {
+        const size_t top_k = std::min<size_t>(EXPERT_ACCESS_TOP_K, store.numExperts(i));
+        for (size_t e = 0; e < top_k; e++) {
+            if (store.expertIds(i)[e] < 64) {
+                mask |= uint64_t(1) << store.expertIds(i)[e];
+            }
+        }
+    }
+    return mask;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--socket <path>] [--trace-out <tensor_trace.bin>] [--speed <X>] [--warm]"
+              << " [--tokens <N>] [--memory-map <map.json|model.gguf>] [--json <out.json>] <domain-path> <model-file>"
+              << std::endl;
+    std::cerr << "Example: " << program << " --socket /tmp/prefetch.sock"
+              << " ../expert-analysis-2026-01-26/domain-1-code gpt-oss-20b-F16.gguf" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    std::string socket_path;
+    std::string trace_out_path;
+    std::string memory_map_path;
+    std::string json_path;
+    double speed = 1.0;
+    bool drop_cache = true;
+    size_t max_tokens = 0;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--trace-out" && i + 1 < argc) {
+            trace_out_path = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            speed = std::atof(argv[++i]);
+        } else if (arg == "--warm") {
+            drop_cache = false;
+        } else if (arg == "--tokens" && i + 1 < argc) {
+            max_tokens = static_cast<size_t>(std::max(std::atoi(argv[++i]), 0));
+        } else if (arg == "--memory-map" && i + 1 < argc) {
+            memory_map_path = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (speed <= 0.0) {
+        speed = 1.0;
+    }
+    const std::string& domain_path = paths[0];
+    const std::string& model_path = paths[1];
+
+    ThreadPool pool;
+    Workspace workspace(pool);
+    if (!memory_map_path.empty()) {
+        workspace.setModelPath(memory_map_path);
+    }
+    DomainLoader& loader = workspace.getDomain(workspace.addDomain(domain_path));
+    loader.wait();
+    if (!loader.isMemoryMapReady()) {
+        std::cerr << "Error: no memory map for " << domain_path << std::endl;
+        return 1;
+    }
+    const MemoryMap& map = loader.getMemoryMap();
+
+    int fd = ::open(model_path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Error: failed to open " << model_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const uint64_t file_size = static_cast<uint64_t>(st.st_size);
+    if (drop_cache) {
+        fsync(fd);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    }
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: failed to map " << model_path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    const volatile uint8_t* data = static_cast<const uint8_t*>(mapping);
+
+    ProgressSender sender;
+    if (!socket_path.empty() && !sender.open(socket_path)) {
+        std::cerr << "Error: bad socket path " << socket_path << std::endl;
+        return 1;
+    }
+    int trace_fd = -1;
+    if (!trace_out_path.empty()) {
+        trace_fd = ::open(trace_out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (trace_fd < 0) {
+            std::cerr << "Error: failed to create " << trace_out_path << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+    size_t token_count = loader.getTokenCount();
+    if (max_tokens > 0) {
+        token_count = std::min(token_count, max_tokens);
+    }
+    std::vector<double> stall_ms;
+    uint64_t touched_bytes = 0;
+    uint64_t records = 0;
+    bool have_previous = false;
+    uint64_t previous_timestamp = 0;
+    auto deadline = Clock::now();
+    const auto started = deadline;
+    uint8_t sink = 0;
+    for (size_t t = 0; t < token_count; t++) {
+        if (!loader.isTokenReady(t)) {
+            continue;
+        }
+        // Tokens are numbered by their slot, so progress only moves forward
+        const uint32_t token = static_cast<uint32_t>(t);
+        const TraceStore& store = loader.getToken(t).entries;
+        bool have_layer = false;
+        int last_layer = -1;
+        Clock::duration stall = Clock::duration::zero();
+        for (size_t i = 0; i < store.size(); i++) {
+            // Trace gaps are the compute time; stalls push everything after them back
+            const uint64_t timestamp = store.timestampNs(i);
+            if (have_previous && timestamp > previous_timestamp) {
+                deadline += std::chrono::nanoseconds(static_cast<int64_t>((timestamp - previous_timestamp) / speed));
+            }
+            previous_timestamp = timestamp;
+            have_previous = true;
+            if (deadline > Clock::now()) {
+                std::this_thread::sleep_until(deadline);
+            }
+
+            if (trace_fd >= 0) {
+                TensorAccessLog record;
+                buildRecord(store, i, token, record);
+                // Stamped like the tracer: CLOCK_MONOTONIC since the start
+                record.timestamp_ns = std::max<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count(), 1);
+                if (pwrite(trace_fd, &record, sizeof(record), static_cast<off_t>(records * TRACE_ENTRY_SIZE)) !=
+                    static_cast<ssize_t>(sizeof(record))) {
+                    std::cerr << "Error: failed to write " << trace_out_path << ": " << std::strerror(errno) << std::endl;
+                    return 1;
+                }
+                records++;
+            }
+            const size_t count = store.hasAccesses() ? store.accessCount(i) : 0;
+            const uint64_t experts = routedExperts(store, i);
+            if (count == 0 && experts == 0) {
+                continue;
+            }
+            if (!socket_path.empty()) {
+                if (!have_layer || store.layerId(i) != last_layer) {
+                    sender.sendLayer(token, store.layerId(i));
+                    have_layer = true;
+                    last_layer = store.layerId(i);
+                }
+                if (experts != 0) {
+                    sender.sendExperts(token, store.layerId(i), experts);
+                }
+            }
+
+            const auto touch_start = Clock::now();
+            const uint32_t* accesses = store.accesses(i);
+            for (size_t k = 0; k < count; k++) {
+                const MemoryTensor& tensor = map.tensors[accesses[k]];
+                const uint64_t end = std::min(tensor.offset_start + tensor.size_bytes, file_size);
+                for (uint64_t offset = tensor.offset_start; offset < end; offset += TOUCH_STRIDE) {
+                    sink ^= data[offset];
+                }
+                touched_bytes += end > tensor.offset_start ? end - tensor.offset_start : 0;
+            }
+            const auto touch_end = Clock::now();
+            stall += touch_end - touch_start;
+            deadline = std::max(deadline, touch_end);
+        }
+        stall_ms.push_back(std::chrono::duration<double, std::milli>(stall).count());
+    }
+    if (!socket_path.empty()) {
+        sender.sendEnd();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    munmap(mapping, file_size);
+    ::close(fd);
+    if (trace_fd >= 0) {
+        ::close(trace_fd);
+    }
+    (void)sink;
+
+    double total_stall = 0.0;
+    for (double ms : stall_ms) {
+        total_stall += ms;
+    }
+    std::vector<double> sorted = stall_ms;
+    std::sort(sorted.begin(), sorted.end());
+    std::cout << std::fixed << std::setprecision(2) << "✓ Drove " << stall_ms.size() << " tokens in " << seconds
+              << " s (speed " << speed << "), touched " << touched_bytes / 1e9 << " GB" << std::endl;
+    if (!sorted.empty()) {
+        std::cout << "  Stall per token: mean " << total_stall / sorted.size() << " ms, p50 "
+                  << sorted[(sorted.size() - 1) / 2] << " ms, max " << sorted.back() << " ms, total " << total_stall
+                  << " ms" << std::endl;
+    }
+    if (sender.getDroppedCount() > 0) {
+        std::cerr << "Warning: " << sender.getDroppedCount() << " progress messages were not delivered" << std::endl;
+    }
+
+    if (!json_path.empty()) {
+        json report;
+        report["domain"] = domain_path;
+        report["file"] = model_path;
+        report["speed"] = speed;
+        report["seconds"] = seconds;
+        report["touched_bytes"] = touched_bytes;
+        report["stall_ms_total"] = total_stall;
+        report["stall_ms_per_token"] = stall_ms;
+        std::ofstream file(json_path);
+        if (!file) {
+            std::cerr << "Error: failed to write " << json_path << std::endl;
+            return 1;
+        }
+        file << report.dump(2) << std::endl;
+        std::cout << "✓ Wrote " << json_path << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+// residency-sampler: record which pages of the model file are in the page cache
+//
+// Every --period (5 ms by default) one mincore() over a PROT_NONE mapping of
+// the file gives its page cache residency; changes since the previous sample
+// go to page_residency.bin as run-length flips stamped with CLOCK_MONOTONIC,
+// the tracer's clock (see PageResidency.h). mincore() costs tens of ns per
+// page, far too much for a whole model every 5 ms, so each sample covers the
+// slice of the file that fits in --cpu percent of the period and the file is
+// swept in turns (--cpu 100 samples all of it every period).
+//
+// The tracer's timestamp_ns count from its own start, so the sampler also
+// records where that start lies: pass it with --trace-base-ns, or give
+// --trace and it is estimated while tensor_trace.bin grows (a record seen at
+// time T with timestamp t was written after base + t, so base <= T - t; the
+// smallest T - t seen is kept). Put the file next to tensor_trace.bin in the
+// domain directory and the analyzer overlays residency on the heatmap strip.
+
+#include "PageResidency.h"
+#include "ResidencySampler.h"
+#include "TraceFormat.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t TRACE_BATCH_RECORDS = 64;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+// Estimates the tracer's CLOCK_MONOTONIC start from records as they appear
+class TraceClock {
+public:
+    explicit TraceClock(const std::string& path)
+        : path_(path)
+        , fd_(-1)
+        , next_record_(0)
+        , base_ns_(RESIDENCY_NO_BASE)
+        , buffer_(TRACE_BATCH_RECORDS * TRACE_ENTRY_SIZE)
+    {
+    }
+
+    ~TraceClock() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    // Read what was appended since the last poll
+    void poll() {
+        if (fd_ < 0) {
+            fd_ = ::open(path_.c_str(), O_RDONLY);
+            if (fd_ < 0) {
+                return;
+            }
+        }
+        struct stat st;
+        if (fstat(fd_, &st) == 0 && static_cast<uint64_t>(st.st_size) < next_record_ * TRACE_ENTRY_SIZE) {
+            // A new run, with a new start
+            next_record_ = 0;
+            base_ns_ = RESIDENCY_NO_BASE;
+        }
+
+        uint64_t newest = 0;
+        for (;;) {
+            ssize_t n = pread(fd_, buffer_.data(), buffer_.size(), static_cast<off_t>(next_record_ * TRACE_ENTRY_SIZE));
+            const size_t records = n > 0 ? static_cast<size_t>(n) / TRACE_ENTRY_SIZE : 0;
+            size_t consumed = 0;
+            for (; consumed < records; consumed++) {
+                const TensorAccessLog* log =
+                    reinterpret_cast<const TensorAccessLog*>(buffer_.data() + consumed * TRACE_ENTRY_SIZE);
+                if (log->timestamp_ns == 0) {
+                    break;
+                }
+                newest = log->timestamp_ns;
+            }
+            next_record_ += consumed;
+            if (consumed < TRACE_BATCH_RECORDS) {
+                break;
+            }
+        }
+
+        // Only the newest record is fresh enough to bound the start tightly
+        const uint64_t now = ResidencySampler::nowNs();
+        if (newest > 0 && newest <= now) {
+            base_ns_ = std::min(base_ns_, now - newest);
+        }
+    }
+
+    uint64_t getBaseNs() const { return base_ns_; }
+
+private:
+    std::string path_;
+    int fd_;
+    uint64_t next_record_;
+    uint64_t base_ns_;
+    std::vector<uint8_t> buffer_;
+};
+
+void sleepUntil(uint64_t deadline_ns) {
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(deadline_ns / 1000000000ull);
+    ts.tv_nsec = static_cast<long>(deadline_ns % 1000000000ull);
+#ifdef __linux__
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+#else
+    const uint64_t now = ResidencySampler::nowNs();
+    if (deadline_ns > now) {
+        usleep(static_cast<useconds_t>((deadline_ns - now) / 1000));
+    }
+#endif
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--period <ms>] [--cpu <percent>] [--duration <s>]"
+              << " [--trace <tensor_trace.bin> | --trace-base-ns <ns>] [--out <page_residency.bin>] <model-file>"
+              << std::endl;
+    std::cerr << "Example: " << program << " --trace /tmp/tensor_trace.bin --out domain-1-code/page_residency.bin"
+              << " gpt-oss-20b-F16.gguf" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    double period_ms = 5.0;
+    double cpu_percent = 25.0;
+    double duration_s = 0.0;
+    std::string trace_path;
+    std::string out_path = RESIDENCY_FILE_NAME;
+    uint64_t trace_base_ns = RESIDENCY_NO_BASE;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--period" && i + 1 < argc) {
+            period_ms = std::atof(argv[++i]);
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            cpu_percent = std::atof(argv[++i]);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            duration_s = std::atof(argv[++i]);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--trace-base-ns" && i + 1 < argc) {
+            trace_base_ns = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 1 || period_ms <= 0.0 || cpu_percent <= 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::string& model_path = paths[0];
+    const uint64_t period_ns = static_cast<uint64_t>(period_ms * 1e6);
+
+    ResidencySampler sampler;
+    if (!sampler.open(model_path, out_path, period_ns)) {
+        std::cerr << "Error: " << sampler.getLastError() << std::endl;
+        return 1;
+    }
+    if (!sampler.seesPageCache()) {
+        std::cerr << "Warning: " << model_path << " is neither owned nor writable by this user;"
+                  << " mincore() will report every page as resident" << std::endl;
+    }
+    sampler.setTraceBase(trace_base_ns);
+    sampler.setCpuBudget(cpu_percent / 100.0);
+    TraceClock trace_clock(trace_path);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::cout << "✓ Sampling " << model_path << " (" << sampler.getPageCount() << " pages) every " << period_ms
+              << " ms (" << cpu_percent << "% CPU) into " << out_path << std::endl;
+
+    const uint64_t started = ResidencySampler::nowNs();
+    const uint64_t end = duration_s > 0.0 ? started + static_cast<uint64_t>(duration_s * 1e9) : UINT64_MAX;
+    uint64_t deadline = started;
+    uint64_t last_flush = started;
+    uint64_t overruns = 0;
+    while (!g_stop && deadline < end) {
+        if (!sampler.sample()) {
+            std::cerr << "Error: " << sampler.getLastError() << std::endl;
+            break;
+        }
+        if (!trace_path.empty() && trace_base_ns == RESIDENCY_NO_BASE) {
+            trace_clock.poll();
+            sampler.setTraceBase(trace_clock.getBaseNs());
+        }
+
+        // Keep the header current about once a second
+        const uint64_t now = ResidencySampler::nowNs();
+        if (now - last_flush >= 1000000000ull) {
+            sampler.flush();
+            last_flush = now;
+        }
+
+        // A sample that overran its period is not made up for
+        deadline += period_ns;
+        if (deadline < now) {
+            overruns += (now - deadline) / period_ns + 1;
+            deadline = now;
+        }
+        sleepUntil(deadline);
+    }
+    sampler.close();
+
+    const double seconds = (ResidencySampler::nowNs() - started) / 1e9;
+    const uint64_t samples = sampler.getSampleCount();
+    const double raw_bytes = static_cast<double>(samples) * ((sampler.getPageCount() + 7) / 8);
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "✓ " << samples << " samples in " << seconds << " s, " << sampler.getRecordCount()
+              << " with changes, " << sampler.getBytesWritten() / 1e6 << " MB written ("
+              << (sampler.getBytesWritten() > 0 ? raw_bytes / sampler.getBytesWritten() : 0.0)
+              << "x smaller than bitmaps)" << std::endl;
+    std::cout << "  Resident at the end: " << sampler.countResidentPages() << " of " << sampler.getPageCount()
+              << " pages" << std::endl;
+    std::cout << "  Sample cost: mean " << (samples ? sampler.getTotalSampleNs() / 1e6 / samples : 0.0)
+              << " ms, max " << sampler.getMaxSampleNs() / 1e6 << " ms, " << overruns << " periods missed" << std::endl;
+    std::cout << "  Every page seen every " << sampler.getSweepNs() / 1e6 << " ms (" << sampler.getSweepCount()
+              << " sweeps)" << std::endl;
+    if (sampler.getTraceBase() != RESIDENCY_NO_BASE) {
+        std::cout << "  Trace base: " << sampler.getTraceBase() << " ns CLOCK_MONOTONIC"
+                  << (trace_base_ns == RESIDENCY_NO_BASE ? " (estimated from " + trace_path + ")" : "") << std::endl;
+    } else {
+        std::cout << "  Trace base: unknown (the analyzer aligns trace time 0 with the first sample)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,207 @@
+// trace-replay: time a domain's DISK accesses as real reads of the model file
+//
+// Where the cache simulation and the layout scores model the SSD, this asks
+// the real one: every resolved access of the trace is read from the GGUF (or
+// a gguf-image stand-in) through the page cache, with O_DIRECT, or by
+// faulting in an mmap the way llama.cpp does. Reads go through io_uring at a
+// fixed queue depth, or queue-depth pread threads where io_uring is missing.
+// Prints throughput and per-category latency percentiles, and per-token I/O
+// time; --json writes everything including the per-token series.
+
+#include "ByteSize.h"
+#include "DomainLoader.h"
+#include "ThreadPool.h"
+#include "TraceReplay.h"
+#include "Workspace.h"
+#include "json.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+namespace {
+json categoryJson(const ReplayCategoryStats& stats) {
+    return {{"category", stats.category}, {"requests", stats.requests}, {"bytes", stats.bytes},
+            {"mean_us", stats.mean_us}, {"p50_us", stats.p50_us}, {"p99_us", stats.p99_us},
+            {"max_us", stats.max_us}};
+}
+
+bool writeJson(const std::string& path, const std::string& domain_path, const std::string& file_path,
+               const ReplayConfig& config, const ReplayResult& result) {
+    json categories = json::array();
+    for (const ReplayCategoryStats& stats : result.categories) {
+        categories.push_back(categoryJson(stats));
+    }
+    json tokens = json::array();
+    for (const ReplayTokenStats& token : result.tokens) {
+        tokens.push_back({{"token_id", token.token_id}, {"accesses", token.accesses}, {"requests", token.requests},
+                          {"bytes", token.bytes}, {"io_ms", token.io_ms}});
+    }
+
+    json report;
+    report["domain"] = domain_path;
+    report["file"] = file_path;
+    report["config"] = {{"mode", replayModeName(config.mode)}, {"engine", result.engine},
+                        {"queue_depth", config.queue_depth}, {"request_bytes", config.request_bytes},
+                        {"pace", config.paced ? "trace" : "asap"}, {"speed", config.speed},
+                        {"drop_cache", config.drop_cache}};
+    report["accesses"] = result.accesses;
+    report["seconds"] = result.seconds;
+    report["gb_per_second"] = result.gbPerSecond();
+    report["total"] = categoryJson(result.total);
+    report["categories"] = categories;
+    report["tokens"] = tokens;
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Error: failed to write " << path << std::endl;
+        return false;
+    }
+    file << report.dump(2) << std::endl;
+    return true;
+}
+
+void printStats(const ReplayCategoryStats& stats) {
+    std::cout << "  " << std::left << std::setw(12) << stats.category << std::right << std::setw(10)
+              << stats.requests << std::setw(12) << stats.bytes / 1e6 << std::setw(10) << stats.p50_us
+              << std::setw(10) << stats.p99_us << std::setw(10) << stats.mean_us << std::setw(10) << stats.max_us
+              << std::endl;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--mode buffered|direct|mmap] [--engine io_uring|pread]"
+              << " [--queue-depth <N>] [--request-size <bytes[K|M]>] [--pace asap|trace] [--speed <X>]"
+              << " [--warm] [--tokens <N>] [--memory-map <map.json|model.gguf>] [--json <out.json>]"
+              << " <domain-path> <model-file>" << std::endl;
+    std::cerr << "Example: " << program << " --mode direct --queue-depth 32"
+              << " ../expert-analysis-2026-01-26/domain-1-code gpt-oss-20b-F16.gguf" << std::endl;
+}
+}
+
+int main(int argc, char** argv) {
+    ReplayConfig config;
+    std::string memory_map_path;
+    std::string json_path;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--mode" && i + 1 < argc) {
+            if (!replayModeFromName(argv[++i], config.mode)) {
+                std::cerr << "Error: unknown mode " << argv[i] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--engine" && i + 1 < argc) {
+            std::string engine = argv[++i];
+            if (engine != "io_uring" && engine != "pread") {
+                std::cerr << "Error: unknown engine " << engine << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            config.io_uring = engine == "io_uring";
+        } else if (arg == "--queue-depth" && i + 1 < argc) {
+            config.queue_depth = static_cast<uint32_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--request-size" && i + 1 < argc) {
+            config.request_bytes = parseBytes(argv[++i]);
+            if (config.request_bytes == 0 || config.request_bytes > (1ull << 30)) {
+                std::cerr << "Error: bad request size " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--pace" && i + 1 < argc) {
+            std::string pace = argv[++i];
+            if (pace != "asap" && pace != "trace") {
+                std::cerr << "Error: unknown pacing " << pace << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            config.paced = pace == "trace";
+        } else if (arg == "--speed" && i + 1 < argc) {
+            config.speed = std::atof(argv[++i]);
+        } else if (arg == "--warm") {
+            config.drop_cache = false;
+        } else if (arg == "--tokens" && i + 1 < argc) {
+            config.max_tokens = static_cast<size_t>(std::max(std::atoi(argv[++i]), 0));
+        } else if (arg == "--memory-map" && i + 1 < argc) {
+            memory_map_path = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_path = argv[++i];
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (paths.size() != 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const std::string& domain_path = paths[0];
+    const std::string& file_path = paths[1];
+
+    ThreadPool pool;
+    Workspace workspace(pool);
+    if (!memory_map_path.empty()) {
+        workspace.setModelPath(memory_map_path);
+    }
+    DomainLoader& loader = workspace.getDomain(workspace.addDomain(domain_path));
+    loader.wait();
+    if (!loader.isMemoryMapReady()) {
+        std::cerr << "Error: no memory map for " << domain_path << std::endl;
+        return 1;
+    }
+    std::cout << "✓ Loaded " << domain_path << ": " << loader.getLoadedCount() << " tokens" << std::endl;
+
+    TraceReplay replay;
+    ReplayResult result;
+    if (!replay.run(loader, file_path, config, result)) {
+        std::cerr << "Error: " << replay.getLastError() << std::endl;
+        return 1;
+    }
+    if (!result.fallback_reason.empty()) {
+        std::cerr << "Warning: io_uring unavailable (" << result.fallback_reason << "), used pread threads"
+                  << std::endl;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "✓ Replayed " << result.tokens.size() << " tokens, " << result.accesses << " accesses ("
+              << replayModeName(config.mode);
+    if (config.mode != ReplayMode::MmapTouch) {
+        std::cout << ", " << result.engine << ", queue depth " << config.queue_depth << ", " << config.request_bytes / 1024 << " KiB requests";
+    }
+    std::cout << (config.paced ? ", paced" : "") << ")" << std::endl;
+    std::cout << std::setprecision(3) << "  " << result.total.bytes / 1e9 << " GB in " << result.seconds << " s: "
+              << result.gbPerSecond() << " GB/s" << std::endl;
+
+    std::cout << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(12) << "category" << std::right << std::setw(10) << "requests"
+              << std::setw(12) << "MB" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10)
+              << "mean us" << std::setw(10) << "max us" << std::endl;
+    for (const ReplayCategoryStats& stats : result.categories) {
+        printStats(stats);
+    }
+    printStats(result.total);
+
+    if (!result.tokens.empty()) {
+        std::vector<double> io_ms;
+        double sum = 0.0;
+        for (const ReplayTokenStats& token : result.tokens) {
+            io_ms.push_back(token.io_ms);
+            sum += token.io_ms;
+        }
+        std::sort(io_ms.begin(), io_ms.end());
+        std::cout << std::setprecision(2) << "  I/O per token: mean " << sum / io_ms.size() << " ms, p50 "
+                  << io_ms[(io_ms.size() - 1) / 2] << " ms, p99 " << io_ms[(io_ms.size() * 99 + 99) / 100 - 1]
+                  << " ms, max " << io_ms.back() << " ms" << std::endl;
+    }
+
+    if (!json_path.empty()) {
+        if (!writeJson(json_path, domain_path, file_path, config, result)) {
+            return 1;
+        }
+        std::cout << "✓ Wrote " << json_path << std::endl;
+    }
+    return 0;
+}